@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_Object.h>
+
+#include "ccnxPing_Admission.h"
+#include "ccnxPing_Common.h"
+
+typedef struct ccnx_ping_admission_entry {
+    CCNxMetaMessage *message;
+    uint64_t receiveTimeInUs;
+} _CCNxPingAdmissionEntry;
+
+struct ccnx_ping_admission {
+    CCNxPingAdmissionOptions options;
+
+    double tokens;
+    uint64_t lastRefillInUs;
+
+    // The queue is a ring of `options.queueCapacity` entries.
+    _CCNxPingAdmissionEntry *queue;
+    size_t head;
+    size_t depth;
+
+    CCNxPingAdmissionCounters counters;
+    CCNxPingHistogram queueWait;
+};
+
+static bool
+_ccnxPingAdmission_Destructor(CCNxPingAdmission **admissionPtr)
+{
+    CCNxPingAdmission *admission = *admissionPtr;
+    for (size_t i = 0; i < admission->depth; i++) {
+        ccnxMetaMessage_Release(&admission->queue[(admission->head + i) % admission->options.queueCapacity].message);
+    }
+    if (admission->queue != NULL) {
+        parcMemory_Deallocate(&admission->queue);
+    }
+    return true;
+}
+
+parcObject_Override(CCNxPingAdmission, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingAdmission_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingAdmission, CCNxPingAdmission);
+parcObject_ImplementRelease(ccnxPingAdmission, CCNxPingAdmission);
+
+void
+ccnxPingAdmissionOptions_Init(CCNxPingAdmissionOptions *options)
+{
+    options->rate = 0.0;
+    options->burst = 0.0;
+    options->queueCapacity = 0;
+    options->maxWaitInUs = 0;
+}
+
+bool
+ccnxPingAdmissionOptions_Parse(CCNxPingAdmissionOptions *options, const char *specification)
+{
+    CCNxPingAdmissionOptions result = *options;
+    char *fields = parcMemory_StringDuplicate(specification, strlen(specification));
+    char *cursor = fields;
+
+    char *field = strsep(&cursor, ",");
+    bool valid = sscanf(field, "%lf", &result.rate) == 1 && result.rate > 0.0;
+    result.burst = 0.0;
+
+    while (valid && (field = strsep(&cursor, ",")) != NULL) {
+        if (*field == '\0') {
+            continue;
+        } else if (strncmp(field, "burst=", 6) == 0) {
+            valid = sscanf(field + 6, "%lf", &result.burst) == 1 && result.burst >= 1.0;
+        } else if (strncmp(field, "queue=", 6) == 0) {
+            valid = sscanf(field + 6, "%zu", &result.queueCapacity) == 1;
+        } else if (strncmp(field, "wait=", 5) == 0) {
+            valid = sscanf(field + 5, "%" SCNu64, &result.maxWaitInUs) == 1;
+        } else {
+            valid = false;
+        }
+    }
+    parcMemory_Deallocate(&fields);
+
+    if (valid) {
+        if (result.burst == 0.0) {
+            result.burst = result.rate / 10.0 < 1.0 ? 1.0 : result.rate / 10.0;
+        }
+        *options = result;
+    }
+    return valid;
+}
+
+CCNxPingAdmission *
+ccnxPingAdmission_Create(const CCNxPingAdmissionOptions *options, uint64_t nowInUs)
+{
+    CCNxPingAdmission *admission = parcObject_CreateInstance(CCNxPingAdmission);
+
+    admission->options = *options;
+    admission->tokens = options->burst;
+    admission->lastRefillInUs = nowInUs;
+    admission->queue = NULL;
+    if (options->queueCapacity > 0) {
+        admission->queue = parcMemory_AllocateAndClear(options->queueCapacity * sizeof(_CCNxPingAdmissionEntry));
+    }
+    admission->head = 0;
+    admission->depth = 0;
+    memset(&admission->counters, 0, sizeof(admission->counters));
+    ccnxPingHistogram_Init(&admission->queueWait);
+
+    return admission;
+}
+
+static void
+_ccnxPingAdmission_Refill(CCNxPingAdmission *admission, uint64_t nowInUs)
+{
+    if (nowInUs > admission->lastRefillInUs) {
+        admission->tokens += (nowInUs - admission->lastRefillInUs) * admission->options.rate / 1000000.0;
+        if (admission->tokens > admission->options.burst) {
+            admission->tokens = admission->options.burst;
+        }
+        admission->lastRefillInUs = nowInUs;
+    }
+}
+
+static void
+_ccnxPingAdmission_SetDepth(CCNxPingAdmission *admission, size_t depth)
+{
+    admission->depth = depth;
+    ccnxPingCommon_CounterSet(admission->counters.queueDepth, depth);
+    if (depth > admission->counters.maxQueueDepth) {
+        ccnxPingCommon_CounterSet(admission->counters.maxQueueDepth, depth);
+    }
+}
+
+CCNxPingAdmissionResult
+ccnxPingAdmission_Offer(CCNxPingAdmission *admission, CCNxMetaMessage *message, uint64_t receiveTimeInUs)
+{
+    _ccnxPingAdmission_Refill(admission, receiveTimeInUs);
+
+    // Interests already waiting are served first.
+    if (admission->depth == 0 && admission->tokens >= 1.0) {
+        admission->tokens -= 1.0;
+        ccnxPingCommon_CounterAdd(admission->counters.admitted, 1);
+        return CCNxPingAdmissionResult_Admitted;
+    }
+
+    if (admission->options.queueCapacity == 0) {
+        ccnxPingCommon_CounterAdd(admission->counters.droppedRateLimited, 1);
+        return CCNxPingAdmissionResult_DroppedRateLimited;
+    }
+    if (admission->depth == admission->options.queueCapacity) {
+        ccnxPingCommon_CounterAdd(admission->counters.droppedQueueFull, 1);
+        return CCNxPingAdmissionResult_DroppedQueueFull;
+    }
+
+    _CCNxPingAdmissionEntry *entry = &admission->queue[(admission->head + admission->depth) % admission->options.queueCapacity];
+    entry->message = ccnxMetaMessage_Acquire(message);
+    entry->receiveTimeInUs = receiveTimeInUs;
+    _ccnxPingAdmission_SetDepth(admission, admission->depth + 1);
+    ccnxPingCommon_CounterAdd(admission->counters.queued, 1);
+    return CCNxPingAdmissionResult_Queued;
+}
+
+CCNxMetaMessage *
+ccnxPingAdmission_Poll(CCNxPingAdmission *admission, uint64_t nowInUs, uint64_t *receiveTimeInUs)
+{
+    _ccnxPingAdmission_Refill(admission, nowInUs);
+
+    while (admission->depth > 0) {
+        _CCNxPingAdmissionEntry *entry = &admission->queue[admission->head];
+        uint64_t waitInUs = nowInUs > entry->receiveTimeInUs ? nowInUs - entry->receiveTimeInUs : 0;
+        bool expired = admission->options.maxWaitInUs > 0 && waitInUs > admission->options.maxWaitInUs;
+        if (!expired && admission->tokens < 1.0) {
+            return NULL;
+        }
+
+        CCNxMetaMessage *message = entry->message;
+        entry->message = NULL;
+        *receiveTimeInUs = entry->receiveTimeInUs;
+        admission->head = (admission->head + 1) % admission->options.queueCapacity;
+        _ccnxPingAdmission_SetDepth(admission, admission->depth - 1);
+
+        if (expired) {
+            ccnxPingCommon_CounterAdd(admission->counters.droppedQueueTimeout, 1);
+            ccnxMetaMessage_Release(&message);
+            continue;
+        }
+
+        admission->tokens -= 1.0;
+        ccnxPingCommon_CounterAdd(admission->counters.admitted, 1);
+        ccnxPingHistogram_Record(&admission->queueWait, waitInUs);
+        return message;
+    }
+    return NULL;
+}
+
+uint64_t
+ccnxPingAdmission_NextDeadline(const CCNxPingAdmission *admission, uint64_t nowInUs)
+{
+    if (admission->depth == 0) {
+        return UINT64_MAX;
+    }
+
+    uint64_t elapsedInUs = nowInUs > admission->lastRefillInUs ? nowInUs - admission->lastRefillInUs : 0;
+    double tokens = admission->tokens + elapsedInUs * admission->options.rate / 1000000.0;
+    if (tokens >= 1.0) {
+        return nowInUs;
+    }
+    uint64_t deadlineInUs = nowInUs + (uint64_t) ceil((1.0 - tokens) * 1000000.0 / admission->options.rate);
+
+    // Wake up in time to drop the head of the queue if it expires first.
+    if (admission->options.maxWaitInUs > 0) {
+        uint64_t expiryInUs = admission->queue[admission->head].receiveTimeInUs + admission->options.maxWaitInUs + 1;
+        deadlineInUs = expiryInUs < deadlineInUs ? expiryInUs : deadlineInUs;
+    }
+    return deadlineInUs;
+}
+
+void
+ccnxPingAdmission_GetCounters(const CCNxPingAdmission *admission, CCNxPingAdmissionCounters *counters)
+{
+    counters->admitted = ccnxPingCommon_CounterGet(admission->counters.admitted);
+    counters->queued = ccnxPingCommon_CounterGet(admission->counters.queued);
+    counters->droppedRateLimited = ccnxPingCommon_CounterGet(admission->counters.droppedRateLimited);
+    counters->droppedQueueFull = ccnxPingCommon_CounterGet(admission->counters.droppedQueueFull);
+    counters->droppedQueueTimeout = ccnxPingCommon_CounterGet(admission->counters.droppedQueueTimeout);
+    counters->queueDepth = ccnxPingCommon_CounterGet(admission->counters.queueDepth);
+    counters->maxQueueDepth = ccnxPingCommon_CounterGet(admission->counters.maxQueueDepth);
+}
+
+const CCNxPingHistogram *
+ccnxPingAdmission_GetQueueWait(const CCNxPingAdmission *admission)
+{
+    return &admission->queueWait;
+}
+
+const CCNxPingAdmissionOptions *
+ccnxPingAdmission_GetOptions(const CCNxPingAdmission *admission)
+{
+    return &admission->options;
+}
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Admission_h
+#define ccnxPing_Admission_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ccnx/transport/common/transport_MetaMessage.h>
+
+#include "ccnxPing_Histogram.h"
+
+/**
+ * The capacity of a producer modelled by a `CCNxPingAdmission`.
+ *
+ * Options are parsed from a comma-separated specification whose first field is the rate:
+ *
+ *   <rate>                         the sustained rate in interests per second
+ *   burst=<n>                      the bucket size, in interests (a tenth of a second of the rate by default)
+ *   queue=<n>                      the capacity of the queue of interests waiting for a token (0, drop at once, by default)
+ *   wait=<us>                      drop interests that have waited longer than this (0, no limit, by default)
+ */
+typedef struct ccnx_ping_admission_options {
+    double rate;
+    double burst;
+    size_t queueCapacity;
+    uint64_t maxWaitInUs;
+} CCNxPingAdmissionOptions;
+
+/**
+ * Initialize admission options to an unlimited producer.
+ *
+ * @param [out] options The `CCNxPingAdmissionOptions` to initialize.
+ */
+void ccnxPingAdmissionOptions_Init(CCNxPingAdmissionOptions *options);
+
+/**
+ * Parse an admission specification (see `CCNxPingAdmissionOptions`).
+ *
+ * @param [in,out] options The `CCNxPingAdmissionOptions` to update.
+ * @param [in] specification The textual specification (e.g., `20000,burst=200,queue=1000,wait=50000`).
+ *
+ * @retval true If the specification was valid.
+ * @retval false Otherwise, in which case `options` is unchanged.
+ */
+bool ccnxPingAdmissionOptions_Parse(CCNxPingAdmissionOptions *options, const char *specification);
+
+/**
+ * What became of an interest offered to a `CCNxPingAdmission`.
+ */
+typedef enum {
+    CCNxPingAdmissionResult_Admitted,
+    CCNxPingAdmissionResult_Queued,
+    CCNxPingAdmissionResult_DroppedRateLimited,
+    CCNxPingAdmissionResult_DroppedQueueFull
+} CCNxPingAdmissionResult;
+
+/**
+ * The counters of a `CCNxPingAdmission`. Interests that wait longer than the `wait` option are
+ * dropped when they reach the head of the queue.
+ */
+typedef struct ccnx_ping_admission_counters {
+    uint64_t admitted;
+    uint64_t queued;
+    uint64_t droppedRateLimited;
+    uint64_t droppedQueueFull;
+    uint64_t droppedQueueTimeout;
+    uint64_t queueDepth;
+    uint64_t maxQueueDepth;
+} CCNxPingAdmissionCounters;
+
+/**
+ * A token-bucket admission control in front of a producer, with an optional bounded FIFO queue.
+ *
+ * An interest is admitted when a token is available and no earlier interest is waiting. Otherwise
+ * it joins the queue, or is dropped with a counted reason when there is no queue or it is full.
+ * Queued interests are released in order by `ccnxPingAdmission_Poll` as tokens accrue; the time
+ * each one waited is recorded in a histogram.
+ *
+ * The admission is driven by a single thread. Its counters and wait histogram may be read by
+ * other threads at any time.
+ */
+struct ccnx_ping_admission;
+typedef struct ccnx_ping_admission CCNxPingAdmission;
+
+/**
+ * Create a `CCNxPingAdmission` with a full bucket.
+ *
+ * @param [in] options The rate, burst and queue configuration. The rate must be positive.
+ * @param [in] nowInUs The current time (in microseconds).
+ *
+ * @return A new `CCNxPingAdmission` that must be released with `ccnxPingAdmission_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingAdmission *admission = ccnxPingAdmission_Create(&options, ccnxPingCommon_MonotonicTimeInUs());
+ *     if (ccnxPingAdmission_Offer(admission, request, receiveTimeInUs) == CCNxPingAdmissionResult_Admitted) {
+ *         handle(request, receiveTimeInUs);
+ *     }
+ *     ...
+ *     CCNxMetaMessage *queued;
+ *     while ((queued = ccnxPingAdmission_Poll(admission, ccnxPingCommon_MonotonicTimeInUs(), &receiveTimeInUs)) != NULL) {
+ *         handle(queued, receiveTimeInUs);
+ *         ccnxMetaMessage_Release(&queued);
+ *     }
+ *     ccnxPingAdmission_Release(&admission);
+ * }
+ * @endcode
+ */
+CCNxPingAdmission *ccnxPingAdmission_Create(const CCNxPingAdmissionOptions *options, uint64_t nowInUs);
+
+/**
+ * Increase the number of references to a `CCNxPingAdmission`.
+ *
+ * @param [in] admission A pointer to a `CCNxPingAdmission` instance.
+ *
+ * @return The input `CCNxPingAdmission` pointer.
+ */
+CCNxPingAdmission *ccnxPingAdmission_Acquire(const CCNxPingAdmission *admission);
+
+/**
+ * Release a previously acquired reference to the specified instance. Queued messages are released.
+ *
+ * @param [in,out] admissionPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingAdmission_Release(CCNxPingAdmission **admissionPtr);
+
+/**
+ * Offer a newly received interest.
+ *
+ * @param [in] admission The `CCNxPingAdmission` instance.
+ * @param [in] message The interest message. The admission acquires a reference if it queues it.
+ * @param [in] receiveTimeInUs The time (in microseconds) the interest was received.
+ *
+ * @return Whether the interest may be served now, was queued, or was dropped (and why).
+ */
+CCNxPingAdmissionResult ccnxPingAdmission_Offer(CCNxPingAdmission *admission, CCNxMetaMessage *message, uint64_t receiveTimeInUs);
+
+/**
+ * Release the interest at the head of the queue if a token is available, after dropping the
+ * interests that have waited too long.
+ *
+ * @param [in] admission The `CCNxPingAdmission` instance.
+ * @param [in] nowInUs The current time (in microseconds).
+ * @param [out] receiveTimeInUs The time the released interest was received.
+ *
+ * @return The released interest, which the caller must release, or NULL.
+ */
+CCNxMetaMessage *ccnxPingAdmission_Poll(CCNxPingAdmission *admission, uint64_t nowInUs, uint64_t *receiveTimeInUs);
+
+/**
+ * Return the time at which `ccnxPingAdmission_Poll` should next be called.
+ *
+ * @param [in] admission The `CCNxPingAdmission` instance.
+ * @param [in] nowInUs The current time (in microseconds).
+ *
+ * @return The time the next token accrues, `nowInUs` if one is available, or UINT64_MAX if the queue is empty.
+ */
+uint64_t ccnxPingAdmission_NextDeadline(const CCNxPingAdmission *admission, uint64_t nowInUs);
+
+/**
+ * Read the counters. May be called from any thread.
+ *
+ * @param [in] admission The `CCNxPingAdmission` instance.
+ * @param [out] counters The counters.
+ */
+void ccnxPingAdmission_GetCounters(const CCNxPingAdmission *admission, CCNxPingAdmissionCounters *counters);
+
+/**
+ * Return the histogram of the time (in microseconds) admitted interests spent in the queue.
+ * It may be read by other threads with `ccnxPingHistogram_Snapshot`.
+ */
+const CCNxPingHistogram *ccnxPingAdmission_GetQueueWait(const CCNxPingAdmission *admission);
+
+/**
+ * @return The options of the admission.
+ */
+const CCNxPingAdmissionOptions *ccnxPingAdmission_GetOptions(const CCNxPingAdmission *admission);
+#endif // ccnxPing_Admission_h
@@ -0,0 +1,574 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <parc/algol/parc_Buffer.h>
+#include <parc/security/parc_Security.h>
+
+#include <ccnx/common/ccnx_Name.h>
+#include <ccnx/transport/common/transport_MetaMessage.h>
+
+#include "ccnxPing_Common.h"
+#include "ccnxPing_PayloadSource.h"
+#include "ccnxPing_Stats.h"
+#include "ccnxPing_Workload.h"
+
+#define _defaultOperations 100000
+#define _defaultRepetitions 3
+
+/**
+ * Every heap allocation made by the process, counted by the allocator wrappers below.
+ *
+ * With glibc the program defines its own `malloc` family on top of the `__libc_` entry points, so
+ * allocations made inside the PARC and CCNx libraries are counted too. Elsewhere allocations are
+ * not counted and are reported as `-`.
+ */
+static uint64_t _ccnxPingBench_Allocations;
+
+#ifdef __GLIBC__
+#define _ccnxPingBench_CountsAllocations 1
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *pointer);
+
+void *
+malloc(size_t size)
+{
+    _ccnxPingBench_Allocations++;
+    return __libc_malloc(size);
+}
+
+void *
+calloc(size_t count, size_t size)
+{
+    _ccnxPingBench_Allocations++;
+    return __libc_calloc(count, size);
+}
+
+void *
+realloc(void *pointer, size_t size)
+{
+    if (pointer == NULL) {
+        _ccnxPingBench_Allocations++;
+    }
+    return __libc_realloc(pointer, size);
+}
+
+int
+posix_memalign(void **pointer, size_t alignment, size_t size)
+{
+    _ccnxPingBench_Allocations++;
+    *pointer = __libc_memalign(alignment, size);
+    return *pointer == NULL ? ENOMEM : 0;
+}
+
+void
+free(void *pointer)
+{
+    __libc_free(pointer);
+}
+#else
+#define _ccnxPingBench_CountsAllocations 0
+#endif
+
+/**
+ * Read the time-stamp counter. It ticks at the nominal frequency of the processor, so cycles/op
+ * are reference cycles; they are 0 on processors without such a counter.
+ */
+static inline uint64_t
+_ccnxPingBench_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static uint64_t
+_ccnxPingBench_NowInNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * A benchmark: `setup` builds the state for `operations` runs of the measured operation, `run`
+ * performs them, and `teardown` releases the state. Only `run` is measured.
+ */
+typedef struct ccnx_ping_benchmark {
+    const char *name;
+    size_t parameter;
+    void *(*setup)(size_t parameter, size_t operations);
+    void (*run)(void *state, size_t operations);
+    void (*teardown)(void *state);
+} CCNxPingBenchmark;
+
+typedef struct ccnx_ping_bench_state {
+    CCNxName *prefix;
+    CCNxName **names;
+    size_t nameCount;
+    CCNxPingStats *stats;
+    CCNxMetaMessage *response;
+    CCNxPingPayloadSource *payloadSource;
+    size_t payloadSize;
+    CCNxPingWorkload *workload;
+    int savedStdout;
+} CCNxPingBenchState;
+
+static CCNxPingBenchState *
+_ccnxPingBench_CreateState(size_t nameCount)
+{
+    CCNxPingBenchState *state = calloc(1, sizeof(CCNxPingBenchState));
+    state->prefix = ccnxName_CreateFromCString(ccnxPing_DefaultPrefix);
+    state->savedStdout = -1;
+
+    state->nameCount = nameCount;
+    state->names = calloc(nameCount, sizeof(CCNxName *));
+    for (size_t i = 0; i < nameCount; i++) {
+        state->names[i] = ccnxPingCommon_CreatePingName(state->prefix, 0x5eed, (int) ccnxPing_DefaultPayloadSize, (int) i);
+    }
+    return state;
+}
+
+static void
+_ccnxPingBench_Teardown(void *arg)
+{
+    CCNxPingBenchState *state = arg;
+
+    if (state->savedStdout >= 0) {
+        fflush(stdout);
+        dup2(state->savedStdout, STDOUT_FILENO);
+        close(state->savedStdout);
+    }
+    for (size_t i = 0; i < state->nameCount; i++) {
+        ccnxName_Release(&state->names[i]);
+    }
+    free(state->names);
+    if (state->stats != NULL) {
+        ccnxPingStats_Release(&state->stats);
+    }
+    if (state->response != NULL) {
+        ccnxMetaMessage_Release(&state->response);
+    }
+    if (state->payloadSource != NULL) {
+        ccnxPingPayloadSource_Release(&state->payloadSource);
+    }
+    if (state->workload != NULL) {
+        ccnxPingWorkload_Release(&state->workload);
+    }
+    ccnxName_Release(&state->prefix);
+    free(state);
+}
+
+/**
+ * Create a stats table holding a request, and optionally a response, for every name of the state.
+ */
+static void
+_ccnxPingBench_FillStats(CCNxPingBenchState *state, bool withResponses)
+{
+    state->stats = ccnxPingStats_Create(CCNxPingStatsLevel_Trace);
+
+    PARCBuffer *payload = parcBuffer_Allocate(ccnxPing_DefaultPayloadSize);
+    state->response = ccnxPingCommon_CreateResponse(state->prefix, payload);
+    parcBuffer_Release(&payload);
+
+    for (size_t i = 0; i < state->nameCount; i++) {
+        ccnxPingStats_RecordRequest(state->stats, state->names[i], i);
+        if (withResponses) {
+            ccnxPingStats_RecordResponse(state->stats, state->names[i], i + 100, state->response);
+        }
+    }
+}
+
+// client: the name of every interest
+
+static void *
+_ccnxPingBench_CreatePingName_Setup(size_t parameter, size_t operations)
+{
+    return _ccnxPingBench_CreateState(0);
+}
+
+static void
+_ccnxPingBench_CreatePingName_Run(void *arg, size_t operations)
+{
+    CCNxPingBenchState *state = arg;
+    for (size_t i = 0; i < operations; i++) {
+        CCNxName *name = ccnxPingCommon_CreatePingName(state->prefix, 0x5eed, (int) ccnxPing_DefaultPayloadSize, (int) i);
+        ccnxName_Release(&name);
+    }
+}
+
+// client: the next name of a pregenerated workload whose names carry `parameter` extra components
+
+static void *
+_ccnxPingBench_WorkloadName_Setup(size_t parameter, size_t operations)
+{
+    CCNxPingBenchState *state = _ccnxPingBench_CreateState(0);
+
+    CCNxPingWorkloadOptions options;
+    ccnxPingWorkloadOptions_Init(&options, ccnxPing_DefaultPayloadSize);
+    ccnxPingDistribution_InitConstant(&options.componentCount, parameter);
+    options.prefixCount = 1000;
+    state->workload = ccnxPingWorkload_Create(state->prefix, 0x5eed, &options);
+    return state;
+}
+
+static void
+_ccnxPingBench_WorkloadName_Run(void *arg, size_t operations)
+{
+    CCNxPingBenchState *state = arg;
+    for (size_t i = 0; i < operations; i++) {
+        CCNxName *name = ccnxPingWorkload_CreateName(state->workload, i);
+        ccnxName_Release(&name);
+    }
+}
+
+// stats: recording requests into a table that already holds `parameter` entries
+
+static void *
+_ccnxPingBench_RecordRequest_Setup(size_t parameter, size_t operations)
+{
+    CCNxPingBenchState *state = _ccnxPingBench_CreateState(parameter + operations);
+
+    // Only the first `parameter` names are recorded here; `run` records the others.
+    size_t nameCount = state->nameCount;
+    state->nameCount = parameter;
+    _ccnxPingBench_FillStats(state, false);
+    state->nameCount = nameCount;
+
+    return state;
+}
+
+static void
+_ccnxPingBench_RecordRequest_Run(void *arg, size_t operations)
+{
+    CCNxPingBenchState *state = arg;
+    size_t first = state->nameCount - operations;
+    for (size_t i = 0; i < operations; i++) {
+        ccnxPingStats_RecordRequest(state->stats, state->names[first + i], i);
+    }
+}
+
+// stats: matching responses against a table of `parameter` outstanding requests (after the
+// first pass over the table, every response takes the duplicate path)
+
+static void *
+_ccnxPingBench_RecordResponse_Setup(size_t parameter, size_t operations)
+{
+    CCNxPingBenchState *state = _ccnxPingBench_CreateState(parameter);
+    _ccnxPingBench_FillStats(state, false);
+    return state;
+}
+
+static void
+_ccnxPingBench_RecordResponse_Run(void *arg, size_t operations)
+{
+    CCNxPingBenchState *state = arg;
+    for (size_t i = 0; i < operations; i++) {
+        ccnxPingStats_RecordResponse(state->stats, state->names[i % state->nameCount], i + 100, state->response);
+    }
+}
+
+// stats: a request and its response at the level `parameter` (0 counters, 1 histogram, 2 trace)
+
+static void *
+_ccnxPingBench_Ping_Setup(size_t parameter, size_t operations)
+{
+    CCNxPingBenchState *state = _ccnxPingBench_CreateState(operations);
+    state->stats = ccnxPingStats_Create((CCNxPingStatsLevel) parameter);
+
+    PARCBuffer *payload = parcBuffer_Allocate(ccnxPing_DefaultPayloadSize);
+    state->response = ccnxPingCommon_CreateResponse(state->prefix, payload);
+    parcBuffer_Release(&payload);
+    return state;
+}
+
+static void
+_ccnxPingBench_Ping_Run(void *arg, size_t operations)
+{
+    CCNxPingBenchState *state = arg;
+    for (size_t i = 0; i < operations; i++) {
+        ccnxPingStats_RecordRequest(state->stats, state->names[i], i);
+        ccnxPingStats_RecordResponse(state->stats, state->names[i], i + 100, state->response);
+    }
+}
+
+// stats: the summary over a run of `parameter` pings (stdout goes to /dev/null)
+
+static void *
+_ccnxPingBench_Display_Setup(size_t parameter, size_t operations)
+{
+    CCNxPingBenchState *state = _ccnxPingBench_CreateState(parameter);
+    _ccnxPingBench_FillStats(state, true);
+
+    fflush(stdout);
+    state->savedStdout = dup(STDOUT_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+    close(devNull);
+
+    return state;
+}
+
+static void
+_ccnxPingBench_Display_Run(void *arg, size_t operations)
+{
+    CCNxPingBenchState *state = arg;
+    for (size_t i = 0; i < operations; i++) {
+        ccnxPingStats_Display(state->stats);
+    }
+    fflush(stdout);
+}
+
+// server: the size segment of every interest
+
+static void *
+_ccnxPingBench_GetPayloadSize_Setup(size_t parameter, size_t operations)
+{
+    return _ccnxPingBench_CreateState(1);
+}
+
+static void
+_ccnxPingBench_GetPayloadSize_Run(void *arg, size_t operations)
+{
+    CCNxPingBenchState *state = arg;
+    size_t sizeIndex = ccnxName_GetSegmentCount(state->prefix) + 1;
+    size_t total = 0;
+    for (size_t i = 0; i < operations; i++) {
+        size_t size = 0;
+        ccnxPingCommon_GetPayloadSize(state->names[0], sizeIndex, &size);
+        total += size;
+    }
+    if (total != operations * ccnxPing_DefaultPayloadSize) {
+        fprintf(stderr, "GetPayloadSize returned the wrong size\n");
+    }
+}
+
+// server: the unsigned response of `parameter` bytes to every interest
+
+static void *
+_ccnxPingBench_CreateResponse_Setup(size_t parameter, size_t operations)
+{
+    CCNxPingBenchState *state = _ccnxPingBench_CreateState(1);
+    state->payloadSource = ccnxPingPayloadSource_Create("pattern");
+    state->payloadSize = parameter;
+    return state;
+}
+
+static void
+_ccnxPingBench_CreateResponse_Run(void *arg, size_t operations)
+{
+    CCNxPingBenchState *state = arg;
+    uint64_t offset = 0;
+    for (size_t i = 0; i < operations; i++) {
+        PARCBuffer *payload = ccnxPingPayloadSource_CreatePayload(state->payloadSource, offset, state->payloadSize);
+        CCNxMetaMessage *message = ccnxPingCommon_CreateResponse(state->names[0], payload);
+        ccnxMetaMessage_Release(&message);
+        parcBuffer_Release(&payload);
+        offset += state->payloadSize;
+    }
+}
+
+static const CCNxPingBenchmark _ccnxPingBench_Benchmarks[] = {
+    { "client/CreatePingName",  0,      _ccnxPingBench_CreatePingName_Setup,  _ccnxPingBench_CreatePingName_Run,  _ccnxPingBench_Teardown },
+    { "client/WorkloadName",    0,      _ccnxPingBench_WorkloadName_Setup,    _ccnxPingBench_WorkloadName_Run,    _ccnxPingBench_Teardown },
+    { "client/WorkloadName",    8,      _ccnxPingBench_WorkloadName_Setup,    _ccnxPingBench_WorkloadName_Run,    _ccnxPingBench_Teardown },
+    { "stats/RecordRequest",    0,      _ccnxPingBench_RecordRequest_Setup,   _ccnxPingBench_RecordRequest_Run,   _ccnxPingBench_Teardown },
+    { "stats/RecordRequest",    10000,  _ccnxPingBench_RecordRequest_Setup,   _ccnxPingBench_RecordRequest_Run,   _ccnxPingBench_Teardown },
+    { "stats/RecordRequest",    100000, _ccnxPingBench_RecordRequest_Setup,   _ccnxPingBench_RecordRequest_Run,   _ccnxPingBench_Teardown },
+    { "stats/RecordResponse",   100,    _ccnxPingBench_RecordResponse_Setup,  _ccnxPingBench_RecordResponse_Run,  _ccnxPingBench_Teardown },
+    { "stats/RecordResponse",   10000,  _ccnxPingBench_RecordResponse_Setup,  _ccnxPingBench_RecordResponse_Run,  _ccnxPingBench_Teardown },
+    { "stats/RecordResponse",   100000, _ccnxPingBench_RecordResponse_Setup,  _ccnxPingBench_RecordResponse_Run,  _ccnxPingBench_Teardown },
+    { "stats/Ping",             0,      _ccnxPingBench_Ping_Setup,            _ccnxPingBench_Ping_Run,            _ccnxPingBench_Teardown },
+    { "stats/Ping",             1,      _ccnxPingBench_Ping_Setup,            _ccnxPingBench_Ping_Run,            _ccnxPingBench_Teardown },
+    { "stats/Ping",             2,      _ccnxPingBench_Ping_Setup,            _ccnxPingBench_Ping_Run,            _ccnxPingBench_Teardown },
+    { "stats/Display",          1000,   _ccnxPingBench_Display_Setup,         _ccnxPingBench_Display_Run,         _ccnxPingBench_Teardown },
+    { "stats/Display",          100000, _ccnxPingBench_Display_Setup,         _ccnxPingBench_Display_Run,         _ccnxPingBench_Teardown },
+    { "server/GetPayloadSize",  0,      _ccnxPingBench_GetPayloadSize_Setup,  _ccnxPingBench_GetPayloadSize_Run,  _ccnxPingBench_Teardown },
+    { "server/CreateResponse",  64,     _ccnxPingBench_CreateResponse_Setup,  _ccnxPingBench_CreateResponse_Run,  _ccnxPingBench_Teardown },
+    { "server/CreateResponse",  4096,   _ccnxPingBench_CreateResponse_Setup,  _ccnxPingBench_CreateResponse_Run,  _ccnxPingBench_Teardown },
+    { "server/CreateResponse",  64000,  _ccnxPingBench_CreateResponse_Setup,  _ccnxPingBench_CreateResponse_Run,  _ccnxPingBench_Teardown },
+    { NULL,                     0,      NULL,                                 NULL,                               NULL                    }
+};
+
+/**
+ * Run a benchmark `repetitions` times on a fresh state and report its fastest repetition.
+ */
+static void
+_ccnxPingBench_Run(const CCNxPingBenchmark *benchmark, size_t operations, size_t repetitions)
+{
+    uint64_t bestElapsedInNs = UINT64_MAX;
+    uint64_t bestCycles = 0;
+    uint64_t bestAllocations = 0;
+
+    for (size_t repetition = 0; repetition < repetitions; repetition++) {
+        void *state = benchmark->setup(benchmark->parameter, operations);
+
+        uint64_t allocations = _ccnxPingBench_Allocations;
+        uint64_t cycles = _ccnxPingBench_Cycles();
+        uint64_t startInNs = _ccnxPingBench_NowInNs();
+
+        benchmark->run(state, operations);
+
+        uint64_t elapsedInNs = _ccnxPingBench_NowInNs() - startInNs;
+        cycles = _ccnxPingBench_Cycles() - cycles;
+        allocations = _ccnxPingBench_Allocations - allocations;
+
+        benchmark->teardown(state);
+
+        if (elapsedInNs < bestElapsedInNs) {
+            bestElapsedInNs = elapsedInNs;
+            bestCycles = cycles;
+            bestAllocations = allocations;
+        }
+    }
+
+    printf("%-24s %8zu %12.1f %12.1f", benchmark->name, benchmark->parameter,
+           (double) bestElapsedInNs / operations, (double) bestCycles / operations);
+    if (_ccnxPingBench_CountsAllocations) {
+        printf(" %12.2f\n", (double) bestAllocations / operations);
+    } else {
+        printf(" %12s\n", "-");
+    }
+}
+
+/**
+ * Display the usage message.
+ */
+static void
+_displayUsage(char *progName)
+{
+    printf("CCNx Ping Microbenchmarks\n");
+    printf("\n");
+    printf("Usage: %s [ -n operations ] [ -r repetitions ] [ filter ]\n", progName);
+    printf("       %s -h\n", progName);
+    printf("\n");
+    printf("Example:\n");
+    printf("    ccnxPing_Bench -n 1000000 stats/\n");
+    printf("\n");
+    printf("Options:\n");
+    printf("     -h (--help) Show this help message\n");
+    printf("     -n (--operations) Number of operations timed per repetition (default %d)\n", _defaultOperations);
+    printf("     -r (--repetitions) Number of repetitions; the fastest is reported (default %d)\n", _defaultRepetitions);
+    printf("     filter Only run the benchmarks whose name contains this string\n");
+}
+
+int
+main(int argc, char *argv[argc])
+{
+    static struct option longopts[] = {
+        { "operations",  required_argument, NULL, 'n' },
+        { "repetitions", required_argument, NULL, 'r' },
+        { "help",        no_argument,       NULL, 'h' },
+        { NULL,          0,                 NULL, 0   }
+    };
+
+    size_t operations = _defaultOperations;
+    size_t repetitions = _defaultRepetitions;
+
+    int c;
+    while ((c = getopt_long(argc, argv, "n:r:h", longopts, NULL)) != -1) {
+        switch (c) {
+            case 'n':
+                sscanf(optarg, "%zu", &operations);
+                break;
+            case 'r':
+                sscanf(optarg, "%zu", &repetitions);
+                break;
+            case 'h':
+            default:
+                _displayUsage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (operations == 0 || repetitions == 0) {
+        _displayUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *filter = optind < argc ? argv[optind] : NULL;
+
+    parcSecurity_Init();
+
+    printf("%-24s %8s %12s %12s %12s\n", "Benchmark", "Param", "ns/op", "cycles/op", "allocs/op");
+    for (const CCNxPingBenchmark *benchmark = _ccnxPingBench_Benchmarks; benchmark->name != NULL; benchmark++) {
+        if (filter == NULL || strstr(benchmark->name, filter) != NULL) {
+            _ccnxPingBench_Run(benchmark, operations, repetitions);
+        }
+    }
+
+    parcSecurity_Fini();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,389 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ccnx/common/ccnx_NameSegment.h>
+
+#include <parc/algol/parc_Buffer.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_DisplayIndented.h>
+
+#include "ccnxPing_Breakdown.h"
+#include "ccnxPing_Common.h"
+
+#define _defaultPrefixCount 16
+
+/**
+ * The requested payload sizes are classed by their bit length: 0, 1, 2-3, 4-7, ... up to ccnxPing_MaxPayloadSize.
+ */
+#define _sizeClassCount 17
+
+/**
+ * The compact histogram of a cell: 2^(_cellPrecisionBits - 1) linear buckets per power of two,
+ * with values at or above 2^_cellMaxValueBits microseconds (about 134 s) clamped into the last one.
+ */
+#define _cellPrecisionBits 3
+#define _cellMaxValueBits 27
+#define _cellSubBucketHalf (1 << (_cellPrecisionBits - 1))
+#define _cellBucketCount (((_cellMaxValueBits - _cellPrecisionBits) + 2) << (_cellPrecisionBits - 1))
+#define _cellLargestValue ((UINT64_C(1) << _cellMaxValueBits) - 1)
+
+typedef struct ccnx_ping_breakdown_cell {
+    uint32_t sent;
+    uint32_t received;
+    uint32_t minRtt;
+    uint32_t maxRtt;
+    uint64_t sumRtt;
+    uint32_t buckets[_cellBucketCount];
+} _CCNxPingBreakdownCell;
+
+struct ccnx_ping_breakdown {
+    CCNxPingBreakdownOptions options;
+    size_t prefixSegmentCount;
+    unsigned int nonce;
+
+    size_t sizeCells;
+    size_t prefixCells;
+    size_t phaseCells;
+    const char **phaseNames;
+
+    _CCNxPingBreakdownCell *cells;
+};
+
+static bool
+_ccnxPingBreakdown_Destructor(CCNxPingBreakdown **breakdownPtr)
+{
+    CCNxPingBreakdown *breakdown = *breakdownPtr;
+    parcMemory_Deallocate(&breakdown->cells);
+    parcMemory_Deallocate(&breakdown->phaseNames);
+    return true;
+}
+
+parcObject_Override(CCNxPingBreakdown, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingBreakdown_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingBreakdown, CCNxPingBreakdown);
+parcObject_ImplementRelease(ccnxPingBreakdown, CCNxPingBreakdown);
+
+void
+ccnxPingBreakdownOptions_Init(CCNxPingBreakdownOptions *options)
+{
+    options->dimensions = 0;
+    options->prefixCount = _defaultPrefixCount;
+}
+
+bool
+ccnxPingBreakdownOptions_Parse(CCNxPingBreakdownOptions *options, const char *specification)
+{
+    CCNxPingBreakdownOptions result = *options;
+    char *fields = parcMemory_StringDuplicate(specification, strlen(specification));
+    char *cursor = fields;
+    bool valid = true;
+
+    char *field = NULL;
+    while (valid && (field = strsep(&cursor, ",")) != NULL) {
+        if (*field == '\0') {
+            continue;
+        } else if (strcmp(field, "size") == 0) {
+            result.dimensions |= CCNxPingBreakdownDimension_Size;
+        } else if (strcmp(field, "prefix") == 0) {
+            result.dimensions |= CCNxPingBreakdownDimension_Prefix;
+        } else if (strncmp(field, "prefix:", 7) == 0) {
+            result.dimensions |= CCNxPingBreakdownDimension_Prefix;
+            valid = sscanf(field + 7, "%zu", &result.prefixCount) == 1 && result.prefixCount > 0;
+        } else if (strcmp(field, "phase") == 0) {
+            result.dimensions |= CCNxPingBreakdownDimension_Phase;
+        } else {
+            valid = false;
+        }
+    }
+    parcMemory_Deallocate(&fields);
+
+    if (valid) {
+        *options = result;
+    }
+    return valid;
+}
+
+CCNxPingBreakdown *
+ccnxPingBreakdown_Create(const CCNxPingBreakdownOptions *options, const CCNxName *prefix, int nonce, size_t phaseCount)
+{
+    CCNxPingBreakdown *breakdown = parcObject_CreateInstance(CCNxPingBreakdown);
+
+    breakdown->options = *options;
+    breakdown->prefixSegmentCount = ccnxName_GetSegmentCount(prefix);
+    breakdown->nonce = (unsigned int) nonce;
+
+    breakdown->sizeCells = (options->dimensions & CCNxPingBreakdownDimension_Size) ? _sizeClassCount : 1;
+    breakdown->prefixCells = (options->dimensions & CCNxPingBreakdownDimension_Prefix) ? options->prefixCount : 1;
+    breakdown->phaseCells = (options->dimensions & CCNxPingBreakdownDimension_Phase) && phaseCount > 0 ? phaseCount : 1;
+    breakdown->phaseNames = parcMemory_AllocateAndClear(breakdown->phaseCells * sizeof(const char *));
+
+    size_t cellCount = breakdown->sizeCells * breakdown->prefixCells * breakdown->phaseCells;
+    breakdown->cells = parcMemory_AllocateAndClear(cellCount * sizeof(_CCNxPingBreakdownCell));
+    for (size_t i = 0; i < cellCount; i++) {
+        breakdown->cells[i].minRtt = UINT32_MAX;
+    }
+
+    return breakdown;
+}
+
+void
+ccnxPingBreakdown_SetPhaseName(CCNxPingBreakdown *breakdown, size_t phase, const char *name)
+{
+    if (phase < breakdown->phaseCells) {
+        breakdown->phaseNames[phase] = name;
+    }
+}
+
+/**
+ * Parse the segment `index` of `name` in place as a number in the given base (10 or 16).
+ */
+static bool
+_ccnxPingBreakdown_ParseSegment(const CCNxName *name, size_t index, unsigned int base, uint64_t *result)
+{
+    if (index >= ccnxName_GetSegmentCount(name)) {
+        return false;
+    }
+    PARCBuffer *value = ccnxNameSegment_GetValue(ccnxName_GetSegment(name, index));
+    size_t length = parcBuffer_Remaining(value);
+    if (length == 0 || length > 16) {
+        return false;
+    }
+
+    const uint8_t *digits = parcBuffer_Overlay(value, 0);
+    uint64_t number = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned int digit;
+        if (digits[i] >= '0' && digits[i] <= '9') {
+            digit = digits[i] - '0';
+        } else if (base == 16 && digits[i] >= 'a' && digits[i] <= 'f') {
+            digit = digits[i] - 'a' + 10;
+        } else {
+            return false;
+        }
+        number = number * base + digit;
+    }
+    *result = number;
+    return true;
+}
+
+/**
+ * Find the cell of a ping name: `prefix/<nonce + p>/<size>/...`.
+ */
+static _CCNxPingBreakdownCell *
+_ccnxPingBreakdown_GetCell(CCNxPingBreakdown *breakdown, size_t phase, const CCNxName *name)
+{
+    size_t sizeClass = 0;
+    if (breakdown->sizeCells > 1) {
+        uint64_t size;
+        if (!_ccnxPingBreakdown_ParseSegment(name, breakdown->prefixSegmentCount + 1, 10, &size)) {
+            return NULL;
+        }
+        size = size > ccnxPing_MaxPayloadSize ? ccnxPing_MaxPayloadSize : size;
+        sizeClass = size == 0 ? 0 : 64 - __builtin_clzll(size);
+    }
+
+    size_t prefixIndex = 0;
+    if (breakdown->prefixCells > 1) {
+        uint64_t segment;
+        if (!_ccnxPingBreakdown_ParseSegment(name, breakdown->prefixSegmentCount, 16, &segment)) {
+            return NULL;
+        }
+        prefixIndex = (unsigned int) ((unsigned int) segment - breakdown->nonce) % breakdown->prefixCells;
+    }
+
+    size_t phaseIndex = breakdown->phaseCells > 1 ? (phase < breakdown->phaseCells ? phase : breakdown->phaseCells - 1) : 0;
+
+    return &breakdown->cells[(phaseIndex * breakdown->prefixCells + prefixIndex) * breakdown->sizeCells + sizeClass];
+}
+
+static size_t
+_ccnxPingBreakdown_BucketIndex(uint64_t value)
+{
+    if (value < (2 * _cellSubBucketHalf)) {
+        return (size_t) value;
+    }
+    if (value > _cellLargestValue) {
+        value = _cellLargestValue;
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - (_cellPrecisionBits - 1);
+    return (size_t) shift * _cellSubBucketHalf + (size_t) (value >> shift);
+}
+
+static uint64_t
+_ccnxPingBreakdown_BucketUpperBound(size_t index)
+{
+    if (index < (2 * _cellSubBucketHalf)) {
+        return index;
+    }
+    size_t shift = index / _cellSubBucketHalf - 1;
+    uint64_t top = _cellSubBucketHalf + index % _cellSubBucketHalf;
+    return ((top + 1) << shift) - 1;
+}
+
+static uint64_t
+_ccnxPingBreakdownCell_Percentile(const _CCNxPingBreakdownCell *cell, double percentile)
+{
+    if (cell->received == 0) {
+        return 0;
+    }
+    uint64_t rank = (uint64_t) (percentile / 100.0 * cell->received + 0.5);
+    rank = rank == 0 ? 1 : rank;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < _cellBucketCount; i++) {
+        seen += cell->buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = _ccnxPingBreakdown_BucketUpperBound(i);
+            return upper > cell->maxRtt ? cell->maxRtt : upper;
+        }
+    }
+    return cell->maxRtt;
+}
+
+void
+ccnxPingBreakdown_RecordRequest(CCNxPingBreakdown *breakdown, size_t phase, const CCNxName *name)
+{
+    _CCNxPingBreakdownCell *cell = _ccnxPingBreakdown_GetCell(breakdown, phase, name);
+    if (cell != NULL) {
+        cell->sent++;
+    }
+}
+
+void
+ccnxPingBreakdown_RecordResponse(CCNxPingBreakdown *breakdown, size_t phase, const CCNxName *name, uint64_t rttInUs)
+{
+    _CCNxPingBreakdownCell *cell = _ccnxPingBreakdown_GetCell(breakdown, phase, name);
+    if (cell != NULL) {
+        uint32_t rtt = rttInUs > UINT32_MAX ? UINT32_MAX : (uint32_t) rttInUs;
+        cell->received++;
+        cell->sumRtt += rtt;
+        cell->minRtt = rtt < cell->minRtt ? rtt : cell->minRtt;
+        cell->maxRtt = rtt > cell->maxRtt ? rtt : cell->maxRtt;
+        cell->buckets[_ccnxPingBreakdown_BucketIndex(rtt)]++;
+    }
+}
+
+void
+ccnxPingBreakdown_Display(const CCNxPingBreakdown *breakdown, int indentation)
+{
+    char header[128] = "";
+    if (breakdown->phaseCells > 1) {
+        strcat(header, "Phase            ");
+    }
+    if (breakdown->sizeCells > 1) {
+        strcat(header, "Size (B)      ");
+    }
+    if (breakdown->prefixCells > 1) {
+        strcat(header, "Prefix ");
+    }
+    parcDisplayIndented_PrintLine(indentation, "Breakdown (RTT in us):");
+    parcDisplayIndented_PrintLine(indentation, "%s%10s %10s %7s %9s %9s %9s %9s %9s",
+                                  header, "Sent", "Received", "Loss", "Min", "Mean", "p50", "p99", "Max");
+
+    for (size_t phase = 0; phase < breakdown->phaseCells; phase++) {
+        for (size_t prefix = 0; prefix < breakdown->prefixCells; prefix++) {
+            for (size_t sizeClass = 0; sizeClass < breakdown->sizeCells; sizeClass++) {
+                const _CCNxPingBreakdownCell *cell =
+                    &breakdown->cells[(phase * breakdown->prefixCells + prefix) * breakdown->sizeCells + sizeClass];
+                if (cell->sent == 0 && cell->received == 0) {
+                    continue;
+                }
+
+                char row[128] = "";
+                size_t length = 0;
+                if (breakdown->phaseCells > 1) {
+                    if (breakdown->phaseNames[phase] != NULL) {
+                        length += snprintf(row + length, sizeof(row) - length, "%-16.16s ", breakdown->phaseNames[phase]);
+                    } else {
+                        length += snprintf(row + length, sizeof(row) - length, "%-16zu ", phase + 1);
+                    }
+                }
+                if (breakdown->sizeCells > 1) {
+                    uint64_t low = sizeClass == 0 ? 0 : UINT64_C(1) << (sizeClass - 1);
+                    uint64_t high = sizeClass == 0 ? 0 : (UINT64_C(1) << sizeClass) - 1;
+                    high = high > ccnxPing_MaxPayloadSize ? ccnxPing_MaxPayloadSize : high;
+                    char range[32];
+                    snprintf(range, sizeof(range), "%" PRIu64 "-%" PRIu64, low, high);
+                    length += snprintf(row + length, sizeof(row) - length, "%-13s ", range);
+                }
+                if (breakdown->prefixCells > 1) {
+                    length += snprintf(row + length, sizeof(row) - length, "%-6zu ", prefix);
+                }
+
+                double loss = cell->sent > 0 && cell->sent > cell->received ? 100.0 * (cell->sent - cell->received) / cell->sent : 0.0;
+                if (cell->received > 0) {
+                    parcDisplayIndented_PrintLine(indentation, "%s%10" PRIu32 " %10" PRIu32 " %6.2f%% %9" PRIu32 " %9.0f %9" PRIu64 " %9" PRIu64 " %9" PRIu32,
+                                                  row, cell->sent, cell->received, loss, cell->minRtt,
+                                                  (double) cell->sumRtt / cell->received,
+                                                  _ccnxPingBreakdownCell_Percentile(cell, 50.0),
+                                                  _ccnxPingBreakdownCell_Percentile(cell, 99.0), cell->maxRtt);
+                } else {
+                    parcDisplayIndented_PrintLine(indentation, "%s%10" PRIu32 " %10" PRIu32 " %6.2f%% %9s %9s %9s %9s %9s",
+                                                  row, cell->sent, cell->received, loss, "-", "-", "-", "-", "-");
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Breakdown_h
+#define ccnxPing_Breakdown_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ccnx/common/ccnx_Name.h>
+
+/**
+ * The dimensions a `CCNxPingBreakdown` splits the results by.
+ */
+typedef enum {
+    CCNxPingBreakdownDimension_Size = 1 << 0,
+    CCNxPingBreakdownDimension_Prefix = 1 << 1,
+    CCNxPingBreakdownDimension_Phase = 1 << 2
+} CCNxPingBreakdownDimension;
+
+/**
+ * The dimensions of a `CCNxPingBreakdown`.
+ *
+ * Options are parsed from a comma-separated list of dimensions:
+ *
+ *   size                           the requested payload size, in power-of-two classes
+ *   prefix[:<n>]                   the prefix of the name (see `CCNxPingWorkloadOptions`), folded into n cells (16 by default)
+ *   phase                          the phase of a scenario
+ */
+typedef struct ccnx_ping_breakdown_options {
+    unsigned int dimensions;
+    size_t prefixCount;
+} CCNxPingBreakdownOptions;
+
+/**
+ * Initialize breakdown options to no dimension at all.
+ *
+ * @param [out] options The `CCNxPingBreakdownOptions` to initialize.
+ */
+void ccnxPingBreakdownOptions_Init(CCNxPingBreakdownOptions *options);
+
+/**
+ * Parse a list of dimensions (see `CCNxPingBreakdownOptions`).
+ *
+ * @param [in,out] options The `CCNxPingBreakdownOptions` to update.
+ * @param [in] specification The textual specification (e.g., "size,prefix:8").
+ *
+ * @retval true If the specification was valid.
+ * @retval false Otherwise, in which case `options` is unchanged.
+ */
+bool ccnxPingBreakdownOptions_Parse(CCNxPingBreakdownOptions *options, const char *specification);
+
+/**
+ * Counts and round-trip times split by the dimensions of the interests.
+ *
+ * Each combination of the dimensions is a cell with its own counts and a compact, fixed-size RTT
+ * histogram (8 buckets per power of two, about 12% precision). The cells are allocated up front and
+ * the cell of an interest or a response is computed from its name in O(1): the size and the prefix
+ * segments that follow the client's prefix are parsed in place, without hashing or allocating.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingBreakdown *breakdown = ccnxPingBreakdown_Create(&options, prefix, nonce, 1);
+ *     ccnxPingBreakdown_RecordRequest(breakdown, 0, name);
+ *     ...
+ *     ccnxPingBreakdown_RecordResponse(breakdown, 0, name, rttInUs);
+ *     ccnxPingBreakdown_Display(breakdown, 0);
+ *     ccnxPingBreakdown_Release(&breakdown);
+ * }
+ * @endcode
+ */
+struct ccnx_ping_breakdown;
+typedef struct ccnx_ping_breakdown CCNxPingBreakdown;
+
+/**
+ * Create a `CCNxPingBreakdown` with all of its cells.
+ *
+ * @param [in] options The dimensions.
+ * @param [in] prefix The prefix of the client's names.
+ * @param [in] nonce The nonce of the client, which the prefix segment of its names is relative to.
+ * @param [in] phaseCount The number of phases (1 outside of a scenario).
+ *
+ * @return A new `CCNxPingBreakdown` that must be released with `ccnxPingBreakdown_Release`.
+ */
+CCNxPingBreakdown *ccnxPingBreakdown_Create(const CCNxPingBreakdownOptions *options, const CCNxName *prefix, int nonce, size_t phaseCount);
+
+/**
+ * Increase the number of references to a `CCNxPingBreakdown`.
+ *
+ * @param [in] breakdown A pointer to a `CCNxPingBreakdown` instance.
+ *
+ * @return The input `CCNxPingBreakdown` pointer.
+ */
+CCNxPingBreakdown *ccnxPingBreakdown_Acquire(const CCNxPingBreakdown *breakdown);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] breakdownPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingBreakdown_Release(CCNxPingBreakdown **breakdownPtr);
+
+/**
+ * Name a phase in the breakdown table.
+ *
+ * @param [in] breakdown The `CCNxPingBreakdown` instance.
+ * @param [in] phase The index of the phase.
+ * @param [in] name Its name, which must outlive the breakdown.
+ */
+void ccnxPingBreakdown_SetPhaseName(CCNxPingBreakdown *breakdown, size_t phase, const char *name);
+
+/**
+ * Count an interest in its cell.
+ *
+ * @param [in] breakdown The `CCNxPingBreakdown` instance.
+ * @param [in] phase The phase that sent the interest. It is ignored unless the phase is a dimension.
+ * @param [in] name The name of the interest.
+ */
+void ccnxPingBreakdown_RecordRequest(CCNxPingBreakdown *breakdown, size_t phase, const CCNxName *name);
+
+/**
+ * Count a response and its round-trip time in the cell of its interest.
+ *
+ * @param [in] breakdown The `CCNxPingBreakdown` instance.
+ * @param [in] phase The phase that sent the interest.
+ * @param [in] name The name of the response.
+ * @param [in] rttInUs The round-trip time.
+ */
+void ccnxPingBreakdown_RecordResponse(CCNxPingBreakdown *breakdown, size_t phase, const CCNxName *name, uint64_t rttInUs);
+
+/**
+ * Display the breakdown table: one row per cell that saw an interest, with its counts, loss and RTT percentiles.
+ *
+ * @param [in] breakdown The `CCNxPingBreakdown` instance.
+ * @param [in] indentation The level of indentation.
+ */
+void ccnxPingBreakdown_Display(const CCNxPingBreakdown *breakdown, int indentation);
+#endif // ccnxPing_Breakdown_h
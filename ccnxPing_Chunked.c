@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <pthread.h>
+#include <string.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+#include <ccnx/common/ccnx_NameSegment.h>
+#include <ccnx/common/ccnx_NameSegmentNumber.h>
+
+#include "ccnxPing_Chunked.h"
+#include "ccnxPing_Common.h"
+
+/**
+ * The object content repeats with this (prime) period. The pattern table holds one extra payload
+ * worth of bytes so that any chunk is a contiguous slice of it.
+ */
+#define _patternPeriod 4093
+
+static uint8_t _ccnxPingChunked_Pattern[_patternPeriod + ccnxPing_MaxPayloadSize];
+static pthread_once_t _ccnxPingChunked_PatternOnce = PTHREAD_ONCE_INIT;
+
+static void
+_ccnxPingChunked_InitPattern(void)
+{
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < _patternPeriod; i++) {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        _ccnxPingChunked_Pattern[i] = (uint8_t) ((state * 0x2545F4914F6CDD1DULL) >> 56);
+    }
+    for (size_t i = _patternPeriod; i < sizeof(_ccnxPingChunked_Pattern); i++) {
+        _ccnxPingChunked_Pattern[i] = _ccnxPingChunked_Pattern[i - _patternPeriod];
+    }
+}
+
+static uint8_t *
+_ccnxPingChunked_PatternAt(uint64_t offset)
+{
+    pthread_once(&_ccnxPingChunked_PatternOnce, _ccnxPingChunked_InitPattern);
+    return &_ccnxPingChunked_Pattern[offset % _patternPeriod];
+}
+
+uint64_t
+ccnxPingChunked_ChunkCount(uint64_t objectSize, size_t chunkSize)
+{
+    if (objectSize == 0) {
+        return 1;
+    }
+    return (objectSize + chunkSize - 1) / chunkSize;
+}
+
+size_t
+ccnxPingChunked_ChunkLength(uint64_t objectSize, size_t chunkSize, uint64_t chunkNumber)
+{
+    if (chunkNumber >= ccnxPingChunked_ChunkCount(objectSize, chunkSize)) {
+        return 0;
+    }
+    uint64_t offset = chunkNumber * chunkSize;
+    uint64_t remaining = objectSize - offset;
+    return remaining < chunkSize ? (size_t) remaining : chunkSize;
+}
+
+CCNxName *
+ccnxPingChunked_CreateName(const CCNxName *baseName, uint64_t chunkNumber)
+{
+    CCNxName *name = ccnxName_Copy(baseName);
+    CCNxNameSegment *segment = ccnxNameSegmentNumber_Create(CCNxNameLabelType_CHUNK, chunkNumber);
+    ccnxName_Append(name, segment);
+    ccnxNameSegment_Release(&segment);
+    return name;
+}
+
+bool
+ccnxPingChunked_GetChunkNumber(const CCNxName *name, size_t index, uint64_t *chunkNumber)
+{
+    if (ccnxName_GetSegmentCount(name) <= index) {
+        return false;
+    }
+
+    CCNxNameSegment *segment = ccnxName_GetSegment(name, index);
+    if (ccnxNameSegment_GetType(segment) != CCNxNameLabelType_CHUNK || !ccnxNameSegmentNumber_IsValid(segment)) {
+        return false;
+    }
+
+    *chunkNumber = ccnxNameSegmentNumber_Value(segment);
+    return true;
+}
+
+PARCBuffer *
+ccnxPingChunked_CreatePayload(uint64_t offset, size_t length)
+{
+    length = length > ccnxPing_MaxPayloadSize ? ccnxPing_MaxPayloadSize : length;
+    return parcBuffer_Wrap(_ccnxPingChunked_PatternAt(offset), length, 0, length);
+}
+
+bool
+ccnxPingChunked_Verify(uint64_t offset, PARCBuffer *payload)
+{
+    size_t length = parcBuffer_Remaining(payload);
+    if (length > ccnxPing_MaxPayloadSize) {
+        return false;
+    }
+    return length == 0 || memcmp(parcBuffer_Overlay(payload, 0), _ccnxPingChunked_PatternAt(offset), length) == 0;
+}
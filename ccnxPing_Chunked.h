@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Chunked_h
+#define ccnxPing_Chunked_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+#include <ccnx/common/ccnx_Name.h>
+
+/**
+ * Helpers shared by the server and the client for transferring a large virtual object as numbered chunks.
+ *
+ * Chunk `i` of an object is named `<base>/chunk=i`, where the last segment is a CHUNK segment, and
+ * covers the bytes [i * chunkSize, (i + 1) * chunkSize) of the object. Every chunk carries the final
+ * chunk number, so the client learns the size of the object from the first chunk it receives.
+ *
+ * The object content is a fixed pseudo-random pattern, so the server serves any chunk without copying
+ * and the client verifies any chunk without reassembling the object.
+ */
+
+/**
+ * Return the number of chunks of an object.
+ *
+ * @param [in] objectSize The size of the object (in bytes).
+ * @param [in] chunkSize The size of every chunk but the last (in bytes).
+ *
+ * @return The number of chunks; an empty object has a single empty chunk.
+ */
+uint64_t ccnxPingChunked_ChunkCount(uint64_t objectSize, size_t chunkSize);
+
+/**
+ * Return the length of a chunk of an object.
+ *
+ * @param [in] objectSize The size of the object (in bytes).
+ * @param [in] chunkSize The size of every chunk but the last (in bytes).
+ * @param [in] chunkNumber The number of the chunk.
+ *
+ * @return The length of the chunk (in bytes), or 0 if the chunk is past the end of the object.
+ */
+size_t ccnxPingChunked_ChunkLength(uint64_t objectSize, size_t chunkSize, uint64_t chunkNumber);
+
+/**
+ * Create the name of a chunk by appending a CHUNK segment to `baseName`.
+ *
+ * @param [in] baseName The name of the object.
+ * @param [in] chunkNumber The number of the chunk.
+ *
+ * @return A new `CCNxName` that must be released with `ccnxName_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxName *chunkName = ccnxPingChunked_CreateName(objectName, 12);
+ *     CCNxInterest *interest = ccnxInterest_CreateSimple(chunkName);
+ *     ccnxName_Release(&chunkName);
+ * }
+ * @endcode
+ */
+CCNxName *ccnxPingChunked_CreateName(const CCNxName *baseName, uint64_t chunkNumber);
+
+/**
+ * Determine whether a name segment is a chunk number, and return it.
+ *
+ * @param [in] name The name to inspect.
+ * @param [in] index The index of the segment that should hold the chunk number.
+ * @param [out] chunkNumber The chunk number, if the segment holds one.
+ *
+ * @retval true If the segment exists and is a valid CHUNK segment.
+ * @retval false Otherwise
+ */
+bool ccnxPingChunked_GetChunkNumber(const CCNxName *name, size_t index, uint64_t *chunkNumber);
+
+/**
+ * Create a payload holding the object bytes [offset, offset + length) without copying them.
+ *
+ * @param [in] offset The offset of the first byte in the object.
+ * @param [in] length The number of bytes, at most `ccnxPing_MaxPayloadSize`.
+ *
+ * @return A new `PARCBuffer` wrapping the static object pattern.
+ */
+PARCBuffer *ccnxPingChunked_CreatePayload(uint64_t offset, size_t length);
+
+/**
+ * Verify that a payload holds the object bytes that start at `offset`, without copying it.
+ *
+ * @param [in] offset The offset of the first byte of the payload in the object.
+ * @param [in] payload The payload to verify, from its position to its limit.
+ *
+ * @retval true If the payload matches the object content.
+ * @retval false Otherwise
+ */
+bool ccnxPingChunked_Verify(uint64_t offset, PARCBuffer *payload);
+#endif // ccnxPing_Chunked_h
@@ -57,214 +57,1450 @@
  * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
  */
 #include <stdio.h>
+#include <errno.h>
 #include <getopt.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
 
 #include <LongBow/runtime.h>
 
 #include <ccnx/api/ccnx_Portal/ccnx_Portal.h>
-#include <ccnx/api/ccnx_Portal/ccnx_PortalRTA.h>
 
-#include <parc/algol/parc_Clock.h>
+#include <parc/algol/parc_Object.h>
+
+#include <parc/security/parc_Security.h>
+#include <parc/security/parc_IdentityFile.h>
+#include <parc/algol/parc_DisplayIndented.h>
+
+#include "ccnxPing_Stats.h"
+#include "ccnxPing_Chunked.h"
+#include "ccnxPing_Common.h"
+#include "ccnxPing_Histogram.h"
+#include "ccnxPing_Isolation.h"
+#include "ccnxPing_Loopback.h"
+#include "ccnxPing_Orchestrator.h"
+#include "ccnxPing_Portal.h"
+#include "ccnxPing_ResourceUsage.h"
+#include "ccnxPing_ResponseLog.h"
+#include "ccnxPing_RollingHistogram.h"
+#include "ccnxPing_Scenario.h"
+#include "ccnxPing_Search.h"
+#include "ccnxPing_VirtualUsers.h"
+#include "ccnxPing_Telemetry.h"
+#include "ccnxPing_Workload.h"
+
+/**
+ * The default number of chunk interests kept outstanding when fetching an object.
+ */
+#define _defaultFetchWindow 16
+
+/**
+ * A fetch is abandoned after this many consecutive receive timeouts.
+ */
+#define _maxFetchTimeouts 5
+
+/**
+ * With --processes the controller reports the live aggregate at this interval.
+ */
+#define _orchestratorReportIntervalInUs 1000000
+
+/**
+ * In ping mode, the number of response lines that may wait for the output thread before lines are dropped.
+ */
+#define _responseLogCapacity 65536
+
+/**
+ * In daemon mode, the length of each rolling interval, and the interval at which the --json file is rewritten.
+ */
+#define _daemonIntervalInUs 10000000ULL
+
+/**
+ * In daemon mode, the portal is reopened after this many consecutive lost probes.
+ */
+#define _daemonReconnectAfterLosses 5
+
+/**
+ * In daemon mode, the longest wait between two attempts to reopen the portal.
+ */
+#define _daemonMaxBackoffInUs 60000000ULL
+
+typedef enum {
+    CCNxPingClientMode_None = 0,
+    CCNxPingClientMode_Flood,
+    CCNxPingClientMode_PingPong,
+    CCNxPingClientMode_Fetch,
+    CCNxPingClientMode_Daemon,
+    CCNxPingClientMode_Scenario,
+    CCNxPingClientMode_Search,
+    CCNxPingClientMode_Users,
+    CCNxPingClientMode_All
+} CCNxPingClientMode;
+
+typedef struct ccnx_Ping_client {
+    CCNxPingPortal *portal;
+    CCNxPingStats *stats;
+    CCNxPingClientMode mode;
+
+    CCNxName *prefix;
+
+    size_t numberOfOutstanding;
+    uint64_t receiveTimeoutInUs;
+    int interestCounter;
+    int count;
+    uint64_t intervalInMs;
+    int payloadSize;
+    int nonce;
+    size_t fetchWindow;
+
+    // With --loopback the client talks to an in-process, impaired responder instead of a forwarder.
+    bool useLoopback;
+    CCNxPingLoopbackOptions loopbackOptions;
+
+    // With --json the results of each run are also written to this file as a JSON object, with
+    // --histogram its complete RTT histogram is saved to this file for ccnxPing_Compare, and with
+    // --trace every ping is written to this file.
+    const char *jsonPath;
+    const char *histogramPath;
+    const char *tracePath;
+
+    // What the statistics record for each ping (--record).
+    CCNxPingStatsLevel statsLevel;
+
+    // With --isolate the client loop is pinned, locked in memory and real-time once its portal is open.
+    CCNxPingIsolation isolation;
+    bool isolated;
+
+    // How the client waits for responses (--busy-poll), and the CPU and wall time of the last run.
+    CCNxPingPortalPolling polling;
+    uint64_t runCpuTimeInUs;
+    uint64_t runWallTimeInUs;
+
+    // The resources used by the process over the last run. The meter is created with the first portal,
+    // so that its counters follow the threads of the transport stack.
+    CCNxPingResourceMeter *resourceMeter;
+    CCNxPingResourceUsage runUsage;
+
+    // With --processes the test runs in this many forked clients; in each child, its shared results slot.
+    size_t processCount;
+    CCNxPingOrchestratorSlot *slot;
+
+    // With --names the interests are drawn from a pool of names of the given shape, generated before the run.
+    const char *workloadSpecification;
+    CCNxPingWorkloadOptions workloadOptions;
+    CCNxPingWorkload *workload;
+
+    // With --scenario the phases of this scenario are run back to back on one portal.
+    CCNxPingScenario *scenario;
+
+    // With --search the offered rate is searched for the highest one that meets this objective.
+    CCNxPingSearchOptions searchOptions;
+
+    // With --breakdown the results are also split by these dimensions, into a table shown with the report.
+    CCNxPingBreakdownOptions breakdownOptions;
+    CCNxPingBreakdown *breakdown;
+
+    // With --users the interests come from this population of virtual users, all on one portal.
+    const char *usersSpecification;
+    CCNxPingVirtualUsersOptions usersOptions;
+
+    // In daemon mode: the rolling statistics, served on the --telemetry socket while the daemon runs.
+    const char *telemetryPath;
+    struct ccnx_ping_client_daemon *daemon;
+} CCNxPingClient;
+
+/**
+ * The state of the monitoring daemon. It has a fixed size however long the daemon runs.
+ */
+typedef struct ccnx_ping_client_daemon {
+    char *prefix;
+    uint64_t startTimeInUs;
+    uint64_t probes;
+    uint64_t lateResponses;
+    uint64_t reconnects;
+    CCNxPingRollingHistogram rolling;
+} CCNxPingClientDaemon;
+
+/**
+ * The rolling windows reported by the daemon.
+ */
+static const struct {
+    const char *name;
+    uint64_t lengthInUs;
+} _ccnxPingClient_DaemonWindows[] = {
+    { "1m",  60000000ULL  },
+    { "5m",  300000000ULL },
+    { "15m", 900000000ULL },
+    { NULL,  0            }
+};
+
+/**
+ * Set by SIGINT and SIGTERM to stop the daemon.
+ */
+static volatile sig_atomic_t _ccnxPingClient_Stopping = 0;
+
+/**
+ * The state of one chunked object fetch.
+ */
+typedef struct ccnx_ping_client_fetch {
+    CCNxName *objectName;
+
+    // Learned from the first chunk: until then only chunk 0 is requested.
+    bool sizeKnown;
+    uint64_t chunkCount;
+    size_t chunkSize;
+
+    // Indexed by chunk number. A send time is the time of the most recent (re)transmission.
+    uint64_t *sendTimeInUs;
+    bool *received;
+
+    uint64_t nextChunk;
+    uint64_t chunksReceived;
+    uint64_t bytesReceived;
+    size_t outstanding;
+
+    uint64_t retransmissions;
+    uint64_t duplicates;
+    uint64_t verifyFailures;
+
+    // The integral of the number of outstanding interests over time, for the window utilization.
+    double windowArea;
+    uint64_t lastEventInUs;
+
+    CCNxPingHistogram chunkLatency;
+} CCNxPingClientFetch;
+
+/**
+ * Open the client portal: over the RTA stack using a randomly generated identity saved to
+ * the client keystore, or over a loopback responder when `--loopback` was given.
+ *
+ * @return true If the portal was opened.
+ */
+static bool
+_ccnxPingClient_OpenPortal(CCNxPingClient *client)
+{
+    if (client->portal != NULL) {
+        ccnxPingPortal_Release(&client->portal);
+    }
+    if (client->resourceMeter == NULL) {
+        client->resourceMeter = ccnxPingResourceMeter_Create();
+    }
+
+    if (client->useLoopback) {
+        client->portal = ccnxPingPortal_CreateLoopback(client->prefix, &client->loopbackOptions);
+    } else {
+        const char *keystorePassword = "keystore_password";
+        const char *subjectName = "client";
+
+        // Each orchestrated child generates its own identity.
+        char *keystoreName = NULL;
+        if (client->slot != NULL) {
+            asprintf(&keystoreName, "client_%zu.keystore", client->slot->index);
+        } else {
+            keystoreName = strdup("client.keystore");
+        }
+        client->portal = ccnxPingPortal_CreateRTA(keystoreName, keystorePassword, subjectName);
+        free(keystoreName);
+    }
+
+    if (client->portal == NULL) {
+        fprintf(stderr, "Unable to open the client portal\n");
+        return false;
+    }
+    ccnxPingPortal_SetPolling(client->portal, &client->polling);
+
+    // Isolation comes after the portal, so that the threads of the transport stack keep their default scheduling.
+    if (!client->isolated) {
+        ccnxPingIsolation_ApplyToProcess(&client->isolation, stdout);
+        client->isolated = true;
+    }
+    return true;
+}
+
+/**
+ * Release the references held by the `CCNxPingClient`.
+ */
+static bool
+_ccnxPingClient_Destructor(CCNxPingClient **clientPtr)
+{
+    CCNxPingClient *client = *clientPtr;
+    if (client->portal != NULL) {
+        ccnxPingPortal_Release(&(client->portal));
+    }
+    if (client->stats != NULL) {
+        ccnxPingStats_Release(&(client->stats));
+    }
+    if (client->prefix != NULL) {
+        ccnxName_Release(&(client->prefix));
+    }
+    if (client->workload != NULL) {
+        ccnxPingWorkload_Release(&(client->workload));
+    }
+    if (client->resourceMeter != NULL) {
+        ccnxPingResourceMeter_Release(&(client->resourceMeter));
+    }
+    if (client->scenario != NULL) {
+        ccnxPingScenario_Release(&(client->scenario));
+    }
+    if (client->breakdown != NULL) {
+        ccnxPingBreakdown_Release(&(client->breakdown));
+    }
+    return true;
+}
+
+parcObject_Override(CCNxPingClient, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingClient_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingClient, CCNxPingClient);
+parcObject_ImplementRelease(ccnxPingClient, CCNxPingClient);
+
+/**
+ * Create a new empty `CCNxPingClient` instance.
+ */
+static CCNxPingClient *
+ccnxPingClient_Create(void)
+{
+    CCNxPingClient *client = parcObject_CreateInstance(CCNxPingClient);
+
+    client->statsLevel = ccnxPingStats_DefaultLevel;
+    client->stats = NULL;
+    client->interestCounter = 100;
+    client->prefix = ccnxName_CreateFromCString(ccnxPing_DefaultPrefix);
+    client->receiveTimeoutInUs = ccnxPing_DefaultReceiveTimeoutInUs;
+    client->count = 10;
+    client->intervalInMs = 1000;
+    client->nonce = rand();
+    client->numberOfOutstanding = 0;
+    client->fetchWindow = _defaultFetchWindow;
+    client->useLoopback = false;
+    ccnxPingLoopbackOptions_Init(&client->loopbackOptions);
+    client->jsonPath = NULL;
+    client->histogramPath = NULL;
+    client->tracePath = NULL;
+    ccnxPingIsolation_Init(&client->isolation);
+    client->isolated = false;
+    ccnxPingPortalPolling_Init(&client->polling);
+    client->runCpuTimeInUs = 0;
+    client->runWallTimeInUs = 0;
+    client->resourceMeter = NULL;
+    memset(&client->runUsage, 0, sizeof(client->runUsage));
+    client->processCount = 0;
+    client->slot = NULL;
+    client->workloadSpecification = NULL;
+    client->workload = NULL;
+    client->scenario = NULL;
+    ccnxPingSearchOptions_Init(&client->searchOptions);
+    client->usersSpecification = NULL;
+    ccnxPingBreakdownOptions_Init(&client->breakdownOptions);
+    client->breakdown = NULL;
+    client->telemetryPath = NULL;
+    client->daemon = NULL;
+
+    return client;
+}
+
+/**
+ * Get the next `CCNxName` to issue. Increment the interest counter
+ * for the client.
+ */
+static CCNxName *
+_ccnxPingClient_CreateNextName(CCNxPingClient *client)
+{
+    client->interestCounter++;
+    if (client->workload != NULL) {
+        return ccnxPingWorkload_CreateName(client->workload, client->interestCounter);
+    }
+    return ccnxPingCommon_CreatePingName(client->prefix, client->nonce, client->payloadSize, client->interestCounter);
+}
+
+/**
+ * Create a fresh --breakdown for a run of `phaseCount` phases, if one was requested.
+ *
+ * @return The breakdown, owned by the client, or NULL.
+ */
+static CCNxPingBreakdown *
+_ccnxPingClient_CreateBreakdown(CCNxPingClient *client, size_t phaseCount)
+{
+    if (client->breakdown != NULL) {
+        ccnxPingBreakdown_Release(&client->breakdown);
+    }
+    if (client->breakdownOptions.dimensions != 0) {
+        client->breakdown = ccnxPingBreakdown_Create(&client->breakdownOptions, client->prefix, client->nonce, phaseCount);
+    }
+    return client->breakdown;
+}
+
+/**
+ * Run a single ping test.
+ */
+static void
+_ccnxPingClient_RunPing(CCNxPingClient *client, size_t totalPings, uint64_t delayInUs)
+{
+    if (client->workloadSpecification != NULL && client->workload == NULL) {
+        client->workload = ccnxPingWorkload_Create(client->prefix, client->nonce, &client->workloadOptions);
+        ccnxPingWorkload_Display(client->workload, 0);
+    }
+
+    // In ping mode the response lines are formatted and written by another thread, off the measurement loop.
+    // It is started before the portal is opened, which isolates this thread, so that it does not inherit the
+    // CPU and real-time priority of the hot loop; with --isolate it takes a spare CPU of its own.
+    CCNxPingResponseLog *responseLog = NULL;
+    if (client->mode == CCNxPingClientMode_PingPong) {
+        responseLog = ccnxPingResponseLog_Create(stdout, _responseLogCapacity);
+    }
+    if (!_ccnxPingClient_OpenPortal(client)) {
+        if (responseLog != NULL) {
+            ccnxPingResponseLog_Release(&responseLog);
+        }
+        return;
+    }
+    if (responseLog != NULL) {
+        ccnxPingIsolation_ApplyToThread(&client->isolation, ccnxPingResponseLog_GetThread(responseLog), "response writer", stdout);
+    }
+    if (client->slot != NULL) {
+        ccnxPingOrchestratorSlot_WaitForStart(client->slot);
+    }
+    if (_ccnxPingClient_CreateBreakdown(client, 1) != NULL) {
+        ccnxPingStats_SetBreakdown(client->stats, client->breakdown, 0);
+    }
+
+    CCNxPingResourceUsage startUsage;
+    ccnxPingResourceMeter_Read(client->resourceMeter, &startUsage);
+    uint64_t startCpuTimeInUs = ccnxPingCommon_ProcessCpuTimeInUs();
+    uint64_t startTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+
+    size_t outstanding = 0;
+    bool checkOustanding = client->numberOfOutstanding > 0;
+    if (responseLog != NULL) {
+        // The writer bypasses stdio: print what was buffered since it started before its first line.
+        fflush(stdout);
+    }
+
+    // Each iteration sends one ping, or waits for responses when the window is full. The last
+    // iteration (pings == totalPings) waits for stragglers until a receive timeout.
+    for (int pings = 0; pings <= totalPings;) {
+        uint64_t nextPacketSendTime = 0;
+        uint64_t currentTimeInUs = 0;
+        bool windowOpen = !checkOustanding || outstanding < client->numberOfOutstanding;
+
+        // Continue to send ping messages until we've reached the capacity
+        if (pings < totalPings && windowOpen) {
+            CCNxName *name = _ccnxPingClient_CreateNextName(client);
+            CCNxInterest *interest = ccnxInterest_CreateSimple(name);
+            CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+
+            if (ccnxPingPortal_Send(client->portal, message, CCNxStackTimeout_Never)) {
+                currentTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+                nextPacketSendTime = currentTimeInUs + delayInUs;
+
+                ccnxPingStats_RecordRequest(client->stats, name, currentTimeInUs);
+                if (client->slot != NULL) {
+                    ccnxPingOrchestratorSlot_RecordRequest(client->slot);
+                }
+            }
+
+            outstanding++;
+            pings++;
+            ccnxMetaMessage_Release(&message);
+            ccnxInterest_Release(&interest);
+            ccnxName_Release(&name);
+        } else {
+            // The window is full, or we're done with pings and wait to see if we have any stragglers
+            currentTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+            nextPacketSendTime = currentTimeInUs + client->receiveTimeoutInUs;
+            if (pings == totalPings) {
+                pings++;
+            }
+        }
+
+        // Now wait for the responses and record their times
+        uint64_t receiveDelay = nextPacketSendTime > currentTimeInUs ? nextPacketSendTime - currentTimeInUs : 0;
+        CCNxMetaMessage *response = ccnxPingPortal_Receive(client->portal, &receiveDelay);
+        if (response == NULL && !windowOpen) {
+            // Nothing arrived within the timeout: the interests in the window are lost.
+            outstanding = 0;
+        }
+        while (response != NULL) {
+            uint64_t currentTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+            if (ccnxMetaMessage_IsContentObject(response)) {
+                CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(response);
+
+                CCNxName *responseName = ccnxContentObject_GetName(contentObject);
+                size_t receivedBefore = ccnxPingStats_GetReceivedCount(client->stats);
+                size_t delta = ccnxPingStats_RecordResponse(client->stats, responseName, currentTimeInUs, response);
+                if (client->slot != NULL && ccnxPingStats_GetReceivedCount(client->stats) > receivedBefore) {
+                    ccnxPingOrchestratorSlot_RecordResponse(client->slot, delta);
+                }
+
+                // Only display output if we're in ping mode
+                if (responseLog != NULL) {
+                    size_t contentSize = parcBuffer_Remaining(ccnxContentObject_GetPayload(contentObject));
+                    ccnxPingResponseLog_Append(responseLog, responseName, contentSize, delta);
+                }
+            }
+            ccnxMetaMessage_Release(&response);
+            if (outstanding > 0) {
+                outstanding--;
+            }
+
+            // With a window, go back to sending as soon as it has room.
+            if (checkOustanding && pings < totalPings && outstanding < client->numberOfOutstanding) {
+                break;
+            }
+
+            if (pings < totalPings) {
+                receiveDelay = nextPacketSendTime > currentTimeInUs ? nextPacketSendTime - currentTimeInUs : 0;
+            } else {
+                receiveDelay = client->receiveTimeoutInUs;
+            }
+
+            response = ccnxPingPortal_Receive(client->portal, &receiveDelay);
+        }
+    }
+
+    client->runCpuTimeInUs = ccnxPingCommon_ProcessCpuTimeInUs() - startCpuTimeInUs;
+    client->runWallTimeInUs = ccnxPingCommon_MonotonicTimeInUs() - startTimeInUs;
+
+    CCNxPingResourceUsage endUsage;
+    ccnxPingResourceMeter_Read(client->resourceMeter, &endUsage);
+    ccnxPingResourceUsage_Difference(&client->runUsage, &endUsage, &startUsage);
+    ccnxPingStats_SetResourceUsage(client->stats, &client->runUsage);
+
+    if (responseLog != NULL) {
+        unsigned long long dropped = ccnxPingResponseLog_GetDropped(responseLog);
+        ccnxPingResponseLog_Release(&responseLog);
+        if (dropped > 0) {
+            printf("%llu response lines dropped: the output could not keep up\n", dropped);
+        }
+    }
+}
+
+/**
+ * Integrate the number of outstanding chunk interests up to `nowInUs`.
+ */
+static void
+_ccnxPingClient_AccountWindow(CCNxPingClientFetch *fetch, uint64_t nowInUs)
+{
+    fetch->windowArea += (double) fetch->outstanding * (double) (nowInUs - fetch->lastEventInUs);
+    fetch->lastEventInUs = nowInUs;
+}
+
+/**
+ * Express the interest for one chunk of the object.
+ */
+static void
+_ccnxPingClient_SendChunkInterest(CCNxPingClient *client, CCNxPingClientFetch *fetch, uint64_t chunkNumber)
+{
+    CCNxName *name = ccnxPingChunked_CreateName(fetch->objectName, chunkNumber);
+    CCNxInterest *interest = ccnxInterest_CreateSimple(name);
+    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+
+    if (!ccnxPingPortal_Send(client->portal, message, CCNxStackTimeout_Never)) {
+        fprintf(stderr, "ccnxPortal_Send failed: %d\n", ccnxPingPortal_GetError(client->portal));
+    }
+    fetch->sendTimeInUs[chunkNumber] = ccnxPingCommon_MonotonicTimeInUs();
+
+    ccnxMetaMessage_Release(&message);
+    ccnxInterest_Release(&interest);
+    ccnxName_Release(&name);
+}
+
+/**
+ * Re-express the interests for chunks that have been outstanding for longer than the receive timeout.
+ */
+static void
+_ccnxPingClient_RetransmitChunks(CCNxPingClient *client, CCNxPingClientFetch *fetch, uint64_t nowInUs)
+{
+    for (uint64_t chunkNumber = 0; chunkNumber < fetch->nextChunk; chunkNumber++) {
+        if (!fetch->received[chunkNumber] && nowInUs - fetch->sendTimeInUs[chunkNumber] >= client->receiveTimeoutInUs) {
+            _ccnxPingClient_SendChunkInterest(client, fetch, chunkNumber);
+            fetch->retransmissions++;
+        }
+    }
+}
+
+/**
+ * Learn the size of the object from its first chunk, and size the per-chunk state accordingly.
+ */
+static void
+_ccnxPingClient_LearnObjectSize(CCNxPingClientFetch *fetch, CCNxContentObject *contentObject)
+{
+    fetch->sizeKnown = true;
+    fetch->chunkSize = parcBuffer_Remaining(ccnxContentObject_GetPayload(contentObject));
+    if (ccnxContentObject_HasFinalChunkNumber(contentObject)) {
+        fetch->chunkCount = ccnxContentObject_GetFinalChunkNumber(contentObject) + 1;
+    }
+
+    uint64_t firstSendTimeInUs = fetch->sendTimeInUs[0];
+    parcMemory_Deallocate(&fetch->sendTimeInUs);
+    parcMemory_Deallocate(&fetch->received);
+    fetch->sendTimeInUs = parcMemory_AllocateAndClear(fetch->chunkCount * sizeof(uint64_t));
+    fetch->received = parcMemory_AllocateAndClear(fetch->chunkCount * sizeof(bool));
+    fetch->sendTimeInUs[0] = firstSendTimeInUs;
+}
+
+/**
+ * Account for a received chunk, verifying its content in place.
+ */
+static void
+_ccnxPingClient_ReceiveChunk(CCNxPingClientFetch *fetch, CCNxContentObject *contentObject, uint64_t nowInUs)
+{
+    uint64_t chunkNumber = 0;
+    size_t chunkIndex = ccnxName_GetSegmentCount(fetch->objectName);
+    if (!ccnxPingChunked_GetChunkNumber(ccnxContentObject_GetName(contentObject), chunkIndex, &chunkNumber)) {
+        return;
+    }
+
+    if (!fetch->sizeKnown && chunkNumber == 0) {
+        _ccnxPingClient_LearnObjectSize(fetch, contentObject);
+    }
+    if (chunkNumber >= fetch->chunkCount) {
+        return;
+    }
+    if (fetch->received[chunkNumber]) {
+        fetch->duplicates++;
+        return;
+    }
+
+    _ccnxPingClient_AccountWindow(fetch, nowInUs);
+    fetch->received[chunkNumber] = true;
+    fetch->chunksReceived++;
+    fetch->outstanding--;
+    ccnxPingHistogram_Record(&fetch->chunkLatency, nowInUs - fetch->sendTimeInUs[chunkNumber]);
+
+    PARCBuffer *payload = ccnxContentObject_GetPayload(contentObject);
+    size_t length = payload != NULL ? parcBuffer_Remaining(payload) : 0;
+    bool isLastChunk = chunkNumber == fetch->chunkCount - 1;
+    bool lengthOk = isLastChunk ? length <= fetch->chunkSize : length == fetch->chunkSize;
+    if (!lengthOk || (payload != NULL && !ccnxPingChunked_Verify(chunkNumber * fetch->chunkSize, payload))) {
+        fetch->verifyFailures++;
+    }
+    fetch->bytesReceived += length;
+}
+
+/**
+ * Open the `--json` results file, replacing the results of any previous run.
+ *
+ * @return The open file, or NULL if no results file was requested or it could not be opened.
+ */
+static FILE *
+_ccnxPingClient_OpenJSON(CCNxPingClient *client)
+{
+    if (client->jsonPath == NULL) {
+        return NULL;
+    }
+    FILE *output = fopen(client->jsonPath, "w");
+    if (output == NULL) {
+        fprintf(stderr, "Unable to write the results to %s\n", client->jsonPath);
+    }
+    return output;
+}
+
+/**
+ * Save the RTT histogram of the last run to the --histogram file, if one was requested.
+ */
+static void
+_ccnxPingClient_SaveHistogram(CCNxPingClient *client, const CCNxPingHistogram *histogram)
+{
+    if (client->histogramPath == NULL) {
+        return;
+    }
+    FILE *output = fopen(client->histogramPath, "w");
+    if (output == NULL || !ccnxPingHistogram_Save(histogram, output)) {
+        fprintf(stderr, "Unable to save the histogram to %s\n", client->histogramPath);
+    }
+    if (output != NULL) {
+        fclose(output);
+    }
+}
+
+/**
+ * Write every ping of the last run to the --trace file, if one was requested.
+ */
+static void
+_ccnxPingClient_SaveTrace(CCNxPingClient *client)
+{
+    if (client->tracePath == NULL) {
+        return;
+    }
+    FILE *output = fopen(client->tracePath, "w");
+    if (output == NULL || !ccnxPingStats_WriteTrace(client->stats, output)) {
+        fprintf(stderr, "Unable to write the trace to %s\n", client->tracePath);
+    }
+    if (output != NULL) {
+        fclose(output);
+    }
+}
+
+/**
+ * Display the CPU time used by the last run next to its duration: the price of busy-polling.
+ */
+static void
+_ccnxPingClient_DisplayCpuTime(CCNxPingClient *client)
+{
+    double utilization = client->runWallTimeInUs > 0 ? 100.0 * client->runCpuTimeInUs / client->runWallTimeInUs : 0.0;
+    parcDisplayIndented_PrintLine(0, "CPU time = %.3f s in %.3f s (%.1f%% of a core) : Receive = %s",
+                                  client->runCpuTimeInUs / 1000000.0, client->runWallTimeInUs / 1000000.0, utilization,
+                                  ccnxPingPortalPolling_GetName(&client->polling));
+}
+
+/**
+ * Display the results of a chunked object fetch.
+ */
+static void
+_ccnxPingClient_DisplayFetch(CCNxPingClient *client, CCNxPingClientFetch *fetch, uint64_t elapsedInUs)
+{
+    double seconds = elapsedInUs / 1000000.0;
+    double goodput = seconds > 0 ? fetch->bytesReceived / seconds / 1000000.0 : 0.0;
+    double utilization = elapsedInUs > 0 ? 100.0 * fetch->windowArea / ((double) elapsedInUs * client->fetchWindow) : 0.0;
+
+    parcDisplayIndented_PrintLine(0, "Object = %" PRIu64 " bytes : Chunks = %" PRIu64 "/%" PRIu64 " of %zu bytes : Time = %.3f s",
+                                  fetch->bytesReceived, fetch->chunksReceived, fetch->chunkCount, fetch->chunkSize, seconds);
+    parcDisplayIndented_PrintLine(0, "Goodput = %.2f MB/s : Window = %zu : Utilization = %.1f%%",
+                                  goodput, client->fetchWindow, utilization);
+    parcDisplayIndented_PrintLine(0, "Retransmissions = %" PRIu64 " : Duplicates = %" PRIu64 " : Verify failures = %" PRIu64,
+                                  fetch->retransmissions, fetch->duplicates, fetch->verifyFailures);
+    ccnxPingHistogram_Display(&fetch->chunkLatency, 0, "Chunk latency (us)");
+    _ccnxPingClient_DisplayCpuTime(client);
+    ccnxPingResourceUsage_Display(&client->runUsage, 0, fetch->chunksReceived, fetch->bytesReceived);
+    ccnxPingPortal_WriteCounters(client->portal, stdout);
+
+    FILE *json = _ccnxPingClient_OpenJSON(client);
+    if (json != NULL) {
+        fprintf(json, "{\"bytes\":%" PRIu64 ",\"chunks\":%" PRIu64 ",\"duration_us\":%" PRIu64 ",\"throughput\":%.1f,"
+                "\"goodput_mbps\":%.2f,\"retransmissions\":%" PRIu64 ",\"duplicates\":%" PRIu64 ",\"verify_failures\":%" PRIu64 ",\"rtt_us\":",
+                fetch->bytesReceived, fetch->chunksReceived, elapsedInUs, seconds > 0 ? fetch->chunksReceived / seconds : 0.0,
+                goodput, fetch->retransmissions, fetch->duplicates, fetch->verifyFailures);
+        ccnxPingHistogram_WriteJSON(&fetch->chunkLatency, json);
+        fprintf(json, ",\"resources\":");
+        ccnxPingResourceUsage_WriteJSON(&client->runUsage, fetch->chunksReceived, fetch->bytesReceived, json);
+        fprintf(json, "}\n");
+        fclose(json);
+    }
+    _ccnxPingClient_SaveHistogram(client, &fetch->chunkLatency);
+}
+
+/**
+ * Fetch the object served under the prefix with a pipelined window of chunk interests.
+ */
+static void
+_ccnxPingClient_RunFetch(CCNxPingClient *client)
+{
+    if (!_ccnxPingClient_OpenPortal(client)) {
+        return;
+    }
+
+    char *nonceString = NULL;
+    asprintf(&nonceString, "%x", client->nonce);
+
+    CCNxPingClientFetch fetch;
+    memset(&fetch, 0, sizeof(fetch));
+    fetch.objectName = ccnxName_ComposeNAME(client->prefix, nonceString);
+    fetch.chunkCount = 1;
+    fetch.sendTimeInUs = parcMemory_AllocateAndClear(sizeof(uint64_t));
+    fetch.received = parcMemory_AllocateAndClear(sizeof(bool));
+    ccnxPingHistogram_Init(&fetch.chunkLatency);
+    free(nonceString);
+
+    CCNxPingResourceUsage startUsage;
+    ccnxPingResourceMeter_Read(client->resourceMeter, &startUsage);
+    uint64_t startCpuTimeInUs = ccnxPingCommon_ProcessCpuTimeInUs();
+    uint64_t startTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+    uint64_t lastRetransmitCheckInUs = startTimeInUs;
+    fetch.lastEventInUs = startTimeInUs;
+
+    size_t timeouts = 0;
+    while (fetch.chunksReceived < fetch.chunkCount) {
+        // Only chunk 0 is requested until the object size is known.
+        size_t window = fetch.sizeKnown ? client->fetchWindow : 1;
+        while (fetch.outstanding < window && fetch.nextChunk < fetch.chunkCount) {
+            _ccnxPingClient_AccountWindow(&fetch, ccnxPingCommon_MonotonicTimeInUs());
+            _ccnxPingClient_SendChunkInterest(client, &fetch, fetch.nextChunk++);
+            fetch.outstanding++;
+        }
+
+        uint64_t receiveDelay = client->receiveTimeoutInUs;
+        CCNxMetaMessage *response = ccnxPingPortal_Receive(client->portal, &receiveDelay);
+        uint64_t nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+
+        if (response == NULL) {
+            if (++timeouts > _maxFetchTimeouts) {
+                fprintf(stderr, "Abandoning the fetch after %d timeouts\n", _maxFetchTimeouts);
+                break;
+            }
+        } else {
+            timeouts = 0;
+            if (ccnxMetaMessage_IsContentObject(response)) {
+                _ccnxPingClient_ReceiveChunk(&fetch, ccnxMetaMessage_GetContentObject(response), nowInUs);
+            }
+            ccnxMetaMessage_Release(&response);
+        }
+
+        if (nowInUs - lastRetransmitCheckInUs >= client->receiveTimeoutInUs) {
+            _ccnxPingClient_RetransmitChunks(client, &fetch, nowInUs);
+            lastRetransmitCheckInUs = nowInUs;
+        }
+    }
+
+    uint64_t endTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+    client->runCpuTimeInUs = ccnxPingCommon_ProcessCpuTimeInUs() - startCpuTimeInUs;
+    client->runWallTimeInUs = endTimeInUs - startTimeInUs;
+    CCNxPingResourceUsage endUsage;
+    ccnxPingResourceMeter_Read(client->resourceMeter, &endUsage);
+    ccnxPingResourceUsage_Difference(&client->runUsage, &endUsage, &startUsage);
+    _ccnxPingClient_AccountWindow(&fetch, endTimeInUs);
+    _ccnxPingClient_DisplayFetch(client, &fetch, endTimeInUs - startTimeInUs);
+
+    parcMemory_Deallocate(&fetch.sendTimeInUs);
+    parcMemory_Deallocate(&fetch.received);
+    ccnxName_Release(&fetch.objectName);
+}
+
+/**
+ * One phase of a scenario run, and its results.
+ */
+typedef struct ccnx_ping_client_phase {
+    const CCNxPingScenarioPhase *phase;
+    CCNxPingWorkload *workload;
+    CCNxPingStats *stats;
+    uint64_t sent;
+    uint64_t durationInUs;
+} CCNxPingClientPhase;
+
+/**
+ * Account for a response received during a scenario. A response is credited to the phase that sent
+ * its interest: the current one or, for a straggler, the one before it. Older responses are dropped.
+ */
+static void
+_ccnxPingClient_ReceivePhaseResponse(CCNxPingClient *client, CCNxPingClientPhase *run, CCNxPingClientPhase *previous,
+                                     CCNxMetaMessage *response, uint64_t nowInUs)
+{
+    if (!ccnxMetaMessage_IsContentObject(response)) {
+        return;
+    }
+    CCNxName *responseName = ccnxContentObject_GetName(ccnxMetaMessage_GetContentObject(response));
+
+    CCNxPingClientPhase *candidates[] = { run, previous };
+    for (size_t i = 0; i < 2 && candidates[i] != NULL; i++) {
+        size_t receivedBefore = ccnxPingStats_GetReceivedCount(candidates[i]->stats);
+        size_t delta = ccnxPingStats_RecordResponse(candidates[i]->stats, responseName, nowInUs, response);
+        if (ccnxPingStats_GetReceivedCount(candidates[i]->stats) > receivedBefore) {
+            if (client->slot != NULL) {
+                ccnxPingOrchestratorSlot_RecordResponse(client->slot, delta);
+            }
+            return;
+        }
+    }
+}
+
+/**
+ * Run one phase of a scenario: send on its (possibly ramping) open-loop schedule, within its
+ * window, until its duration has elapsed. `outstanding` carries over from phase to phase.
+ */
+static void
+_ccnxPingClient_RunPhase(CCNxPingClient *client, CCNxPingClientPhase *run, CCNxPingClientPhase *previous, size_t *outstanding)
+{
+    const CCNxPingScenarioPhase *phase = run->phase;
+
+    CCNxPingResourceUsage startUsage;
+    ccnxPingResourceMeter_Read(client->resourceMeter, &startUsage);
+    uint64_t startTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+    uint64_t endTimeInUs = startTimeInUs + phase->durationInUs;
+    uint64_t nextSendInUs = startTimeInUs;
+
+    uint64_t nowInUs = startTimeInUs;
+    while (nowInUs < endTimeInUs) {
+        bool windowOpen = phase->window == 0 || *outstanding < phase->window;
+
+        if (windowOpen && nowInUs >= nextSendInUs) {
+            CCNxName *name = NULL;
+            if (run->workload != NULL) {
+                client->interestCounter++;
+                name = ccnxPingWorkload_CreateName(run->workload, client->interestCounter);
+            } else {
+                name = _ccnxPingClient_CreateNextName(client);
+            }
+            CCNxInterest *interest = ccnxInterest_CreateSimple(name);
+            CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+
+            if (ccnxPingPortal_Send(client->portal, message, CCNxStackTimeout_Never)) {
+                ccnxPingStats_RecordRequest(run->stats, name, ccnxPingCommon_MonotonicTimeInUs());
+                if (client->slot != NULL) {
+                    ccnxPingOrchestratorSlot_RecordRequest(client->slot);
+                }
+                run->sent++;
+                (*outstanding)++;
+            }
+            ccnxMetaMessage_Release(&message);
+            ccnxInterest_Release(&interest);
+            ccnxName_Release(&name);
+
+            // Keep to the schedule rather than to the time of the last send, so that a slow send
+            // does not lower the offered rate. A rate of 0 sends whenever the window allows.
+            double rate = ccnxPingScenarioPhase_GetRate(phase, nowInUs - startTimeInUs);
+            nextSendInUs = rate > 0.0 ? nextSendInUs + (uint64_t) (1000000.0 / rate) : nowInUs;
+        }
+
+        // Wait for a response until the next send, or for a whole receive timeout when the window is full.
+        uint64_t deadlineInUs = windowOpen ? nextSendInUs : nowInUs + client->receiveTimeoutInUs;
+        bool clipped = deadlineInUs > endTimeInUs;
+        if (clipped) {
+            deadlineInUs = endTimeInUs;
+        }
+        uint64_t receiveDelay = deadlineInUs > nowInUs ? deadlineInUs - nowInUs : 0;
+        CCNxMetaMessage *response = ccnxPingPortal_Receive(client->portal, &receiveDelay);
+        if (response == NULL && !windowOpen && !clipped) {
+            // Nothing arrived within the timeout: the interests in the window are lost.
+            *outstanding = 0;
+        }
+        while (response != NULL) {
+            _ccnxPingClient_ReceivePhaseResponse(client, run, previous, response, ccnxPingCommon_MonotonicTimeInUs());
+            ccnxMetaMessage_Release(&response);
+            if (*outstanding > 0) {
+                (*outstanding)--;
+            }
+
+            receiveDelay = 0;
+            response = ccnxPingPortal_Receive(client->portal, &receiveDelay);
+        }
+        nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+    }
+    run->durationInUs = nowInUs - startTimeInUs;
+
+    CCNxPingResourceUsage endUsage;
+    CCNxPingResourceUsage usage;
+    ccnxPingResourceMeter_Read(client->resourceMeter, &endUsage);
+    ccnxPingResourceUsage_Difference(&usage, &endUsage, &startUsage);
+    ccnxPingStats_SetResourceUsage(run->stats, &usage);
+}
+
+/**
+ * Wait for the stragglers of the last phase that was run, until no response arrives within a receive timeout.
+ */
+static void
+_ccnxPingClient_DrainPhase(CCNxPingClient *client, CCNxPingClientPhase *run, CCNxPingClientPhase *previous, size_t *outstanding)
+{
+    uint64_t receiveDelay = client->receiveTimeoutInUs;
+    CCNxMetaMessage *response = NULL;
+    while (*outstanding > 0 && (response = ccnxPingPortal_Receive(client->portal, &receiveDelay)) != NULL) {
+        _ccnxPingClient_ReceivePhaseResponse(client, run, previous, response, ccnxPingCommon_MonotonicTimeInUs());
+        ccnxMetaMessage_Release(&response);
+        (*outstanding)--;
+        receiveDelay = client->receiveTimeoutInUs;
+    }
+    *outstanding = 0;
+}
+
+/**
+ * Display the per-phase results of a scenario, write them to the --json file, and save the RTT
+ * histogram of the whole scenario to the --histogram file.
+ */
+static void
+_ccnxPingClient_DisplayScenario(CCNxPingClient *client, CCNxPingClientPhase *runs, size_t phaseCount)
+{
+    CCNxPingHistogram rtt;
+    ccnxPingHistogram_Init(&rtt);
+
+    FILE *json = _ccnxPingClient_OpenJSON(client);
+    if (json != NULL) {
+        fprintf(json, "{\"phases\":[");
+    }
+
+    for (size_t i = 0; i < phaseCount; i++) {
+        const CCNxPingScenarioPhase *phase = runs[i].phase;
+        double seconds = runs[i].durationInUs / 1000000.0;
+        double offeredRate = (phase->startRate + phase->endRate) / 2.0;
+        double sentRate = seconds > 0 ? runs[i].sent / seconds : 0.0;
+
+        if (offeredRate > 0.0) {
+            parcDisplayIndented_PrintLine(0, "Phase %zu/%zu %s : Duration = %.1f s : Offered = %.0f/s : Sent = %.0f/s",
+                                          i + 1, phaseCount, phase->name, seconds, offeredRate, sentRate);
+        } else {
+            parcDisplayIndented_PrintLine(0, "Phase %zu/%zu %s : Duration = %.1f s : Window = %zu : Sent = %.0f/s",
+                                          i + 1, phaseCount, phase->name, seconds, phase->window, sentRate);
+        }
+        if (!ccnxPingStats_Display(runs[i].stats)) {
+            parcDisplayIndented_PrintLine(1, "No packets were received.");
+        }
+        ccnxPingHistogram_Merge(&rtt, ccnxPingStats_GetRtt(runs[i].stats));
+
+        if (json != NULL) {
+            fprintf(json, "%s{\"name\":\"%s\",\"duration_us\":%" PRIu64 ",\"offered_rate\":%.1f,\"sent_rate\":%.1f,\"results\":",
+                    i > 0 ? "," : "", phase->name, runs[i].durationInUs, offeredRate, sentRate);
+            ccnxPingStats_WriteJSON(runs[i].stats, json);
+            fprintf(json, "}");
+        }
+    }
+    if (client->breakdown != NULL) {
+        ccnxPingBreakdown_Display(client->breakdown, 0);
+    }
+    ccnxPingPortal_WriteCounters(client->portal, stdout);
+
+    if (json != NULL) {
+        fprintf(json, "]}\n");
+        fclose(json);
+    }
+    _ccnxPingClient_SaveHistogram(client, &rtt);
+}
+
+/**
+ * Run the phases of the --scenario file back to back on one portal, and report each of them.
+ *
+ * The name pools of the phases are generated before the portal is opened. Responses that arrive
+ * after the end of the phase following the one that sent them are not counted; those of the last
+ * phase are awaited for one receive timeout.
+ */
+static void
+_ccnxPingClient_RunScenario(CCNxPingClient *client)
+{
+    size_t phaseCount = ccnxPingScenario_GetPhaseCount(client->scenario);
+    CCNxPingClientPhase *runs = parcMemory_AllocateAndClear(phaseCount * sizeof(CCNxPingClientPhase));
+    CCNxPingBreakdown *breakdown = _ccnxPingClient_CreateBreakdown(client, phaseCount);
+    for (size_t i = 0; i < phaseCount; i++) {
+        runs[i].phase = ccnxPingScenario_GetPhase(client->scenario, i);
+        runs[i].stats = ccnxPingStats_Create(client->statsLevel);
+        if (breakdown != NULL) {
+            ccnxPingStats_SetBreakdown(runs[i].stats, breakdown, i);
+            ccnxPingBreakdown_SetPhaseName(breakdown, i, runs[i].phase->name);
+        }
+        if (runs[i].phase->hasWorkload) {
+            runs[i].workload = ccnxPingWorkload_Create(client->prefix, client->nonce, &runs[i].phase->workloadOptions);
+            ccnxPingWorkload_Display(runs[i].workload, 0);
+        }
+    }
+    if (client->workloadSpecification != NULL && client->workload == NULL) {
+        client->workload = ccnxPingWorkload_Create(client->prefix, client->nonce, &client->workloadOptions);
+        ccnxPingWorkload_Display(client->workload, 0);
+    }
+
+    if (_ccnxPingClient_OpenPortal(client)) {
+        if (client->slot != NULL) {
+            ccnxPingOrchestratorSlot_WaitForStart(client->slot);
+        }
+
+        size_t outstanding = 0;
+        for (size_t i = 0; i < phaseCount; i++) {
+            _ccnxPingClient_RunPhase(client, &runs[i], i > 0 ? &runs[i - 1] : NULL, &outstanding);
+        }
+
+        _ccnxPingClient_DrainPhase(client, &runs[phaseCount - 1], phaseCount > 1 ? &runs[phaseCount - 2] : NULL, &outstanding);
+        _ccnxPingClient_DisplayScenario(client, runs, phaseCount);
+    }
+
+    for (size_t i = 0; i < phaseCount; i++) {
+        ccnxPingStats_Release(&runs[i].stats);
+        if (runs[i].workload != NULL) {
+            ccnxPingWorkload_Release(&runs[i].workload);
+        }
+    }
+    parcMemory_Deallocate(&runs);
+}
+
+/**
+ * Send the interest of a virtual user, and account for it in the shared statistics.
+ */
+static bool
+_ccnxPingClient_SendUserInterest(void *context, CCNxName *name, uint64_t nowInUs)
+{
+    CCNxPingClient *client = context;
 
-#include <parc/algol/parc_Object.h>
+    CCNxInterest *interest = ccnxInterest_CreateSimple(name);
+    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+    bool sent = ccnxPingPortal_Send(client->portal, message, CCNxStackTimeout_Never);
+    if (sent) {
+        ccnxPingStats_RecordRequest(client->stats, name, nowInUs);
+        if (client->slot != NULL) {
+            ccnxPingOrchestratorSlot_RecordRequest(client->slot);
+        }
+    }
+    ccnxMetaMessage_Release(&message);
+    ccnxInterest_Release(&interest);
+    return sent;
+}
 
-#include <parc/security/parc_Security.h>
-#include <parc/security/parc_IdentityFile.h>
-#include <parc/algol/parc_DisplayIndented.h>
+/**
+ * Run the --users population for its duration, then wait until every user has its answer or its timeout.
+ *
+ * A single loop drives every user: it runs the sends and timeouts that are due, then waits for
+ * responses until the next of them. The RTTs of all users are folded into the client's statistics.
+ */
+static void
+_ccnxPingClient_RunUsers(CCNxPingClient *client)
+{
+    if (!_ccnxPingClient_OpenPortal(client)) {
+        return;
+    }
+    if (client->slot != NULL) {
+        ccnxPingOrchestratorSlot_WaitForStart(client->slot);
+    }
+    if (_ccnxPingClient_CreateBreakdown(client, 1) != NULL) {
+        ccnxPingStats_SetBreakdown(client->stats, client->breakdown, 0);
+    }
+    // The users number their interests independently, so they match their own responses.
+    ccnxPingStats_SetExternalMatching(client->stats);
 
-#include "ccnxPing_Stats.h"
-#include "ccnxPing_Common.h"
+    CCNxPingResourceUsage startUsage;
+    ccnxPingResourceMeter_Read(client->resourceMeter, &startUsage);
+    uint64_t startCpuTimeInUs = ccnxPingCommon_ProcessCpuTimeInUs();
+    uint64_t startTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+    uint64_t endTimeInUs = startTimeInUs + client->usersOptions.durationInUs;
 
-typedef enum {
-    CCNxPingClientMode_None = 0,
-    CCNxPingClientMode_Flood,
-    CCNxPingClientMode_PingPong,
-    CCNxPingClientMode_All
-} CCNxPingClientMode;
+    CCNxPingVirtualUsers *users = ccnxPingVirtualUsers_Create(&client->usersOptions, client->prefix, client->nonce,
+                                                              client->receiveTimeoutInUs, startTimeInUs);
+    bool stopped = false;
+    uint64_t nowInUs = startTimeInUs;
+    while (true) {
+        if (!stopped && nowInUs >= endTimeInUs) {
+            ccnxPingVirtualUsers_Stop(users);
+            stopped = true;
+        }
+        ccnxPingVirtualUsers_Expire(users, nowInUs, _ccnxPingClient_SendUserInterest, client);
+        if (stopped && ccnxPingVirtualUsers_GetOutstanding(users) == 0) {
+            break;
+        }
 
-typedef struct ccnx_Ping_client {
-    CCNxPortal *portal;
-    CCNxPingStats *stats;
-    CCNxPingClientMode mode;
+        uint64_t deadlineInUs = ccnxPingVirtualUsers_NextDeadline(users);
+        if (!stopped && deadlineInUs > endTimeInUs) {
+            deadlineInUs = endTimeInUs;
+        }
+        uint64_t receiveDelay = deadlineInUs > nowInUs ? deadlineInUs - nowInUs : 0;
+        CCNxMetaMessage *response = ccnxPingPortal_Receive(client->portal, &receiveDelay);
+        while (response != NULL) {
+            if (ccnxMetaMessage_IsContentObject(response)) {
+                uint64_t receiveTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+                CCNxName *responseName = ccnxContentObject_GetName(ccnxMetaMessage_GetContentObject(response));
+                uint64_t rtt;
+                if (ccnxPingVirtualUsers_RecordResponse(users, responseName, receiveTimeInUs, &rtt)) {
+                    ccnxPingStats_RecordMatchedResponse(client->stats, responseName, rtt, receiveTimeInUs, response);
+                    if (client->slot != NULL) {
+                        ccnxPingOrchestratorSlot_RecordResponse(client->slot, rtt);
+                    }
+                }
+            }
+            ccnxMetaMessage_Release(&response);
 
-    CCNxName *prefix;
+            receiveDelay = 0;
+            response = ccnxPingPortal_Receive(client->portal, &receiveDelay);
+        }
+        nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+    }
 
-    size_t numberOfOutstanding;
-    uint64_t receiveTimeoutInUs;
-    int interestCounter;
-    int count;
-    uint64_t intervalInMs;
-    int payloadSize;
-    int nonce;
-} CCNxPingClient;
+    client->runCpuTimeInUs = ccnxPingCommon_ProcessCpuTimeInUs() - startCpuTimeInUs;
+    client->runWallTimeInUs = ccnxPingCommon_MonotonicTimeInUs() - startTimeInUs;
+
+    CCNxPingResourceUsage endUsage;
+    ccnxPingResourceMeter_Read(client->resourceMeter, &endUsage);
+    ccnxPingResourceUsage_Difference(&client->runUsage, &endUsage, &startUsage);
+    ccnxPingStats_SetResourceUsage(client->stats, &client->runUsage);
+
+    ccnxPingVirtualUsers_Display(users, 0);
+    ccnxPingVirtualUsers_Release(&users);
+}
 
 /**
- * Create a new CCNxPortalFactory instance using a randomly generated identity saved to
- * the specified keystore.
- *
- * @return A new CCNxPortalFactory instance which must eventually be released by calling ccnxPortalFactory_Release().
+ * Run one trial of a --search at a constant offered rate: a warmup, whose results are discarded,
+ * then the measured phase. Its stragglers are awaited before the trial is judged, so that the next
+ * trial starts with an empty window.
  */
-static CCNxPortalFactory *
-_setupClientPortalFactory(void)
+static void
+_ccnxPingClient_RunTrial(CCNxPingClient *client, const CCNxPingSearchOptions *options, CCNxPingSearchTrial *trial)
 {
-    const char *keystoreName = "client.keystore";
-    const char *keystorePassword = "keystore_password";
-    const char *subjectName = "client";
+    CCNxPingScenarioPhase warmupPhase = {
+        .name         = "warmup",
+        .durationInUs = options->warmupInUs,
+        .startRate    = trial->rate,
+        .endRate      = trial->rate,
+        .window       = options->window
+    };
+    CCNxPingScenarioPhase trialPhase = warmupPhase;
+    strcpy(trialPhase.name, "trial");
+    trialPhase.durationInUs = options->trialInUs;
+
+    CCNxPingClientPhase warmup = { .phase = &warmupPhase, .stats = ccnxPingStats_Create(CCNxPingStatsLevel_Counters) };
+    CCNxPingClientPhase run = { .phase = &trialPhase, .stats = ccnxPingStats_Create(client->statsLevel) };
+
+    size_t outstanding = 0;
+    if (warmupPhase.durationInUs > 0) {
+        _ccnxPingClient_RunPhase(client, &warmup, NULL, &outstanding);
+    }
+    _ccnxPingClient_RunPhase(client, &run, &warmup, &outstanding);
+    _ccnxPingClient_DrainPhase(client, &run, &warmup, &outstanding);
 
-    return ccnxPingCommon_SetupPortalFactory(keystoreName, keystorePassword, subjectName);
+    double seconds = run.durationInUs / 1000000.0;
+    trial->sent = run.sent;
+    trial->received = ccnxPingStats_GetReceivedCount(run.stats);
+    trial->sentRate = seconds > 0 ? run.sent / seconds : 0.0;
+    trial->latencyInUs = ccnxPingHistogram_Percentile(ccnxPingStats_GetRtt(run.stats), options->percentile);
+
+    ccnxPingStats_Release(&warmup.stats);
+    ccnxPingStats_Release(&run.stats);
 }
 
 /**
- * Release the references held by the `CCNxPingClient`.
+ * Search for the highest offered rate that meets the --search objective, trial after trial on one
+ * portal, and report the capacity found with the log of every trial.
  */
-static bool
-_ccnxPingClient_Destructor(CCNxPingClient **clientPtr)
+static void
+_ccnxPingClient_RunSearch(CCNxPingClient *client)
 {
-    CCNxPingClient *client = *clientPtr;
-    if (client->portal != NULL) {
-        ccnxPortal_Release(&(client->portal));
+    if (client->workloadSpecification != NULL && client->workload == NULL) {
+        client->workload = ccnxPingWorkload_Create(client->prefix, client->nonce, &client->workloadOptions);
+        ccnxPingWorkload_Display(client->workload, 0);
     }
-    if (client->prefix != NULL) {
-        ccnxName_Release(&(client->prefix));
+    if (!_ccnxPingClient_OpenPortal(client)) {
+        return;
     }
-    return true;
-}
 
-parcObject_Override(CCNxPingClient, PARCObject,
-                    .destructor = (PARCObjectDestructor *) _ccnxPingClient_Destructor);
+    CCNxPingSearch *search = ccnxPingSearch_Create(&client->searchOptions);
+    double rate;
+    while ((rate = ccnxPingSearch_NextRate(search)) > 0.0) {
+        CCNxPingSearchTrial trial = { .rate = rate };
+        _ccnxPingClient_RunTrial(client, &client->searchOptions, &trial);
+        ccnxPingSearch_Record(search, &trial);
+        ccnxPingSearch_DisplayTrial(search, ccnxPingSearch_GetTrialCount(search) - 1);
+    }
+    ccnxPingSearch_Display(search);
+    ccnxPingPortal_WriteCounters(client->portal, stdout);
 
-parcObject_ImplementAcquire(ccnxPingClient, CCNxPingClient);
-parcObject_ImplementRelease(ccnxPingClient, CCNxPingClient);
+    FILE *json = _ccnxPingClient_OpenJSON(client);
+    if (json != NULL) {
+        ccnxPingSearch_WriteJSON(search, json);
+        fclose(json);
+    }
+    ccnxPingSearch_Release(&search);
+}
+
+static void
+_ccnxPingClient_Stop(int signalNumber)
+{
+    _ccnxPingClient_Stopping = 1;
+}
 
 /**
- * Create a new empty `CCNxPingClient` instance.
+ * Write the daemon's rolling windows. Invoked on the telemetry thread, on the daemon thread for
+ * the --json file, and once more on exit.
  */
-static CCNxPingClient *
-ccnxPingClient_Create(void)
+static void
+_ccnxPingClient_WriteDaemonTelemetry(void *context, FILE *output, CCNxPingTelemetryFormat format)
 {
-    CCNxPingClient *client = parcObject_CreateInstance(CCNxPingClient);
+    CCNxPingClient *client = context;
+    CCNxPingClientDaemon *daemon = client->daemon;
+    uint64_t nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+    double uptime = (nowInUs - daemon->startTimeInUs) / 1000000.0;
+    unsigned long long probes = ccnxPingCommon_CounterGet(daemon->probes);
+    unsigned long long lateResponses = ccnxPingCommon_CounterGet(daemon->lateResponses);
+    unsigned long long reconnects = ccnxPingCommon_CounterGet(daemon->reconnects);
 
-    client->stats = ccnxPingStats_Create();
-    client->interestCounter = 100;
-    client->prefix = ccnxName_CreateFromCString(ccnxPing_DefaultPrefix);
-    client->receiveTimeoutInUs = ccnxPing_DefaultReceiveTimeoutInUs;
-    client->count = 10;
-    client->intervalInMs = 1000;
-    client->nonce = rand();
-    client->numberOfOutstanding = 0;
+    if (format == CCNxPingTelemetryFormat_JSON) {
+        fprintf(output, "{\"prefix\":\"%s\",\"uptime_s\":%.1f,\"probes\":%llu,\"late\":%llu,\"reconnects\":%llu,\"windows\":{",
+                daemon->prefix, uptime, probes, lateResponses, reconnects);
+    } else {
+        fprintf(output, "Prefix = %s : Uptime = %.1f s : Probes = %llu : Late = %llu : Reconnects = %llu\n",
+                daemon->prefix, uptime, probes, lateResponses, reconnects);
+    }
 
-    return client;
+    for (size_t i = 0; _ccnxPingClient_DaemonWindows[i].name != NULL; i++) {
+        CCNxPingRollingInterval window;
+        ccnxPingRollingHistogram_Window(&daemon->rolling, nowInUs, _ccnxPingClient_DaemonWindows[i].lengthInUs, &window);
+        unsigned long long received = ccnxPingHistogram_Count(&window.rtt);
+        double loss = received + window.lost > 0 ? (double) window.lost / (received + window.lost) : 0.0;
+
+        if (format == CCNxPingTelemetryFormat_JSON) {
+            fprintf(output, "%s\"%s\":{\"sent\":%llu,\"received\":%llu,\"lost\":%llu,\"loss\":%.4f,\"rtt_us\":",
+                    i > 0 ? "," : "", _ccnxPingClient_DaemonWindows[i].name,
+                    (unsigned long long) window.sent, received, (unsigned long long) window.lost, loss);
+            ccnxPingHistogram_WriteJSON(&window.rtt, output);
+            fprintf(output, "}");
+        } else {
+            fprintf(output, "%-3s : Sent = %llu : Received = %llu : Lost = %llu (%.2f%%) : RTT (us) ",
+                    _ccnxPingClient_DaemonWindows[i].name, (unsigned long long) window.sent, received,
+                    (unsigned long long) window.lost, 100.0 * loss);
+            ccnxPingHistogram_WriteText(&window.rtt, output);
+            fprintf(output, "\n");
+        }
+    }
+
+    if (format == CCNxPingTelemetryFormat_JSON) {
+        fprintf(output, "}}\n");
+    }
 }
 
 /**
- * Get the next `CCNxName` to issue. Increment the interest counter
- * for the client.
+ * Rewrite the --json file with the daemon's rolling windows, atomically for its readers.
  */
-static CCNxName *
-_ccnxPingClient_CreateNextName(CCNxPingClient *client)
+static void
+_ccnxPingClient_WriteDaemonFile(CCNxPingClient *client)
 {
-    client->interestCounter++;
-    char *suffixBuffer = NULL;
-    asprintf(&suffixBuffer, "%x", client->nonce);
-    CCNxName *name1 = ccnxName_ComposeNAME(ccnxName_Copy(client->prefix), suffixBuffer);
-    parcMemory_Deallocate(&suffixBuffer);
-
-    suffixBuffer = NULL;
-    asprintf(&suffixBuffer, "%u", client->payloadSize);
-    CCNxName *name2 = ccnxName_ComposeNAME(name1, suffixBuffer);
-    ccnxName_Release(&name1);
-
-    suffixBuffer = NULL;
-    asprintf(&suffixBuffer, "%06lu", (long) client->interestCounter);
-    CCNxName *name3 = ccnxName_ComposeNAME(name2, suffixBuffer);
-    ccnxName_Release(&name2);
+    char *temporaryPath = NULL;
+    asprintf(&temporaryPath, "%s.tmp", client->jsonPath);
 
-    return name3;
+    FILE *output = fopen(temporaryPath, "w");
+    if (output == NULL) {
+        fprintf(stderr, "Unable to write the results to %s\n", temporaryPath);
+    } else {
+        _ccnxPingClient_WriteDaemonTelemetry(client, output, CCNxPingTelemetryFormat_JSON);
+        fclose(output);
+        rename(temporaryPath, client->jsonPath);
+    }
+    free(temporaryPath);
 }
 
 /**
- * Convert a timeval struct to a single microsecond count.
+ * Sleep for `durationInUs`, or until a signal arrives.
  */
-static uint64_t
-_ccnxPingClient_CurrentTimeInUs(PARCClock *clock)
+static void
+_ccnxPingClient_Sleep(uint64_t durationInUs)
 {
-    struct timeval currentTimeVal;
-    parcClock_GetTimeval(clock, &currentTimeVal);
-    uint64_t microseconds = currentTimeVal.tv_sec * 1000000 + currentTimeVal.tv_usec;
-    return microseconds;
+    struct timespec duration = { (time_t) (durationInUs / 1000000), (long) (durationInUs % 1000000) * 1000 };
+    nanosleep(&duration, NULL);
 }
 
 /**
- * Run a single ping test.
+ * Probe the prefix every interval until stopped, keeping rolling statistics in fixed memory.
+ *
+ * One probe is outstanding at a time and it is matched by its sequence number, so no per-ping
+ * state accumulates. Between probes the daemon blocks in the portal. The portal is reopened,
+ * with exponential backoff, when it cannot be opened, a send or receive fails, or too many
+ * consecutive probes are lost.
  */
 static void
-_ccnxPingClient_RunPing(CCNxPingClient *client, size_t totalPings, uint64_t delayInUs)
+_ccnxPingClient_RunDaemon(CCNxPingClient *client)
 {
-    PARCClock *clock = parcClock_Wallclock();
+    CCNxPingClientDaemon *daemon = parcMemory_AllocateAndClear(sizeof(CCNxPingClientDaemon));
+    daemon->prefix = ccnxName_ToString(client->prefix);
+    daemon->startTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+    ccnxPingRollingHistogram_Init(&daemon->rolling, _daemonIntervalInUs);
+    client->daemon = daemon;
 
-    CCNxPortalFactory *factory = _setupClientPortalFactory();
-    client->portal = ccnxPortalFactory_CreatePortal(factory, ccnxPortalRTA_Message);
-    ccnxPortalFactory_Release(&factory);
+    // Probes are rare: block between them rather than spin.
+    ccnxPingPortalPolling_Init(&client->polling);
 
-    size_t outstanding = 0;
-    bool checkOustanding = client->numberOfOutstanding > 0;
+    CCNxPingTelemetry *telemetry = NULL;
+    if (client->telemetryPath != NULL) {
+        telemetry = ccnxPingTelemetry_Create(client->telemetryPath, _ccnxPingClient_WriteDaemonTelemetry, client);
+    }
 
-    for (int pings = 0; pings <= totalPings; pings++) {
-        uint64_t nextPacketSendTime = 0;
-        uint64_t currentTimeInUs = 0;
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = _ccnxPingClient_Stop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
 
-        // Continue to send ping messages until we've reached the capacity
-        if (pings < totalPings && (!checkOustanding || (checkOustanding && outstanding < client->numberOfOutstanding))) {
-            CCNxName *name = _ccnxPingClient_CreateNextName(client);
-            CCNxInterest *interest = ccnxInterest_CreateSimple(name);
-            CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+    uint64_t intervalInUs = client->intervalInMs * 1000;
+    uint64_t timeoutInUs = client->receiveTimeoutInUs < intervalInUs ? client->receiveTimeoutInUs : intervalInUs;
+    uint64_t backoffInUs = intervalInUs;
+    bool connected = false;
 
-            if (ccnxPortal_Send(client->portal, message, CCNxStackTimeout_Never)) {
-                currentTimeInUs = _ccnxPingClient_CurrentTimeInUs(clock);
-                nextPacketSendTime = currentTimeInUs + delayInUs;
+    bool outstanding = false;
+    uint64_t probeSequence = 0;
+    uint64_t probeSendTimeInUs = 0;
+    size_t consecutiveLosses = 0;
 
-                ccnxPingStats_RecordRequest(client->stats, name, currentTimeInUs);
+    uint64_t nextProbeInUs = ccnxPingCommon_MonotonicTimeInUs();
+    uint64_t nextFileInUs = nextProbeInUs + _daemonIntervalInUs;
+
+    while (!_ccnxPingClient_Stopping) {
+        if (!connected) {
+            connected = _ccnxPingClient_OpenPortal(client);
+            if (!connected) {
+                _ccnxPingClient_Sleep(backoffInUs);
+                backoffInUs = backoffInUs * 2 < _daemonMaxBackoffInUs ? backoffInUs * 2 : _daemonMaxBackoffInUs;
+                continue;
             }
+            backoffInUs = intervalInUs;
+            outstanding = false;
+        }
 
-            outstanding++;
-            ccnxName_Release(&name);
-        } else {
-            // We're done with pings, so let's wait to see if we have any stragglers
-            currentTimeInUs = _ccnxPingClient_CurrentTimeInUs(clock);
-            nextPacketSendTime = currentTimeInUs + client->receiveTimeoutInUs;
+        uint64_t nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+
+        if (outstanding && nowInUs - probeSendTimeInUs >= timeoutInUs) {
+            outstanding = false;
+            ccnxPingRollingHistogram_RecordLoss(&daemon->rolling, nowInUs);
+            if (++consecutiveLosses >= _daemonReconnectAfterLosses) {
+                fprintf(stderr, "%zu consecutive probes lost, reopening the portal\n", consecutiveLosses);
+                ccnxPingCommon_CounterAdd(daemon->reconnects, 1);
+                consecutiveLosses = 0;
+                connected = false;
+                continue;
+            }
         }
 
-        // Now wait for the responses and record their times
-        uint64_t receiveDelay = nextPacketSendTime - currentTimeInUs;
-        CCNxMetaMessage *response = ccnxPortal_Receive(client->portal, &receiveDelay);
-        while (response != NULL && (!checkOustanding || (checkOustanding && outstanding < client->numberOfOutstanding))) {
-            uint64_t currentTimeInUs = _ccnxPingClient_CurrentTimeInUs(clock);
-            if (ccnxMetaMessage_IsContentObject(response)) {
-                CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(response);
+        if (!outstanding && nowInUs >= nextProbeInUs) {
+            CCNxName *name = _ccnxPingClient_CreateNextName(client);
+            CCNxInterest *interest = ccnxInterest_CreateSimple(name);
+            CCNxMetaMessage *message = ccnxMetaMessage_CreateFromInterest(interest);
+            bool sent = ccnxPingPortal_Send(client->portal, message, CCNxStackTimeout_Never);
+            ccnxMetaMessage_Release(&message);
+            ccnxInterest_Release(&interest);
+            ccnxName_Release(&name);
 
-                CCNxName *responseName = ccnxContentObject_GetName(contentObject);
-                size_t delta = ccnxPingStats_RecordResponse(client->stats, responseName, currentTimeInUs, response);
+            if (!sent) {
+                fprintf(stderr, "Unable to send a probe (error %d), reopening the portal\n", ccnxPingPortal_GetError(client->portal));
+                ccnxPingCommon_CounterAdd(daemon->reconnects, 1);
+                connected = false;
+                continue;
+            }
 
-                // Only display output if we're in ping mode
-                if (client->mode == CCNxPingClientMode_PingPong) {
-                    size_t contentSize = parcBuffer_Remaining(ccnxContentObject_GetPayload(contentObject));
-                    char *nameString = ccnxName_ToString(responseName);
-                    printf("%zu bytes from %s: time=%zu us\n", contentSize, nameString, delta);
-                    parcMemory_Deallocate(&nameString);
-                }
+            outstanding = true;
+            probeSequence = (uint64_t) client->interestCounter;
+            probeSendTimeInUs = nowInUs;
+            ccnxPingRollingHistogram_RecordSent(&daemon->rolling, nowInUs);
+            ccnxPingCommon_CounterAdd(daemon->probes, 1);
+
+            nextProbeInUs += intervalInUs;
+            if (nextProbeInUs <= nowInUs) {
+                nextProbeInUs = nowInUs + intervalInUs;
             }
-            ccnxMetaMessage_Release(&response);
+        }
 
-            if (pings < totalPings) {
-                receiveDelay = nextPacketSendTime - currentTimeInUs;
+        if (client->jsonPath != NULL && nowInUs >= nextFileInUs) {
+            _ccnxPingClient_WriteDaemonFile(client);
+            nextFileInUs += _daemonIntervalInUs;
+        }
+
+        // Block until the next event: the probe's timeout, the next probe, or the next file rewrite.
+        uint64_t deadlineInUs = outstanding ? probeSendTimeInUs + timeoutInUs : nextProbeInUs;
+        if (client->jsonPath != NULL && nextFileInUs < deadlineInUs) {
+            deadlineInUs = nextFileInUs;
+        }
+        uint64_t waitInUs = deadlineInUs > nowInUs ? deadlineInUs - nowInUs : 0;
+        CCNxMetaMessage *response = ccnxPingPortal_Receive(client->portal, &waitInUs);
+        if (response != NULL) {
+            uint64_t receiveTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+            uint64_t sequence = 0;
+            if (ccnxMetaMessage_IsContentObject(response)
+                && ccnxPingCommon_GetSequenceNumber(ccnxContentObject_GetName(ccnxMetaMessage_GetContentObject(response)), &sequence)
+                && outstanding && sequence == probeSequence) {
+                outstanding = false;
+                consecutiveLosses = 0;
+                ccnxPingRollingHistogram_RecordResponse(&daemon->rolling, receiveTimeInUs, receiveTimeInUs - probeSendTimeInUs);
             } else {
-                receiveDelay = client->receiveTimeoutInUs;
+                ccnxPingCommon_CounterAdd(daemon->lateResponses, 1);
+            }
+            ccnxMetaMessage_Release(&response);
+        } else if (ccnxPingCommon_MonotonicTimeInUs() < deadlineInUs) {
+            // A wait cut short by a transport error: reopen now rather than spin until the probes are lost.
+            int error = ccnxPingPortal_GetError(client->portal);
+            if (error != 0 && error != EINTR && error != EAGAIN && error != ETIMEDOUT) {
+                fprintf(stderr, "Unable to receive (error %d), reopening the portal\n", error);
+                ccnxPingCommon_CounterAdd(daemon->reconnects, 1);
+                connected = false;
             }
-
-            response = ccnxPortal_Receive(client->portal, &receiveDelay);
-            outstanding--;
         }
     }
+
+    if (telemetry != NULL) {
+        ccnxPingTelemetry_Release(&telemetry);
+    }
+    _ccnxPingClient_WriteDaemonTelemetry(client, stdout, CCNxPingTelemetryFormat_Text);
+    if (client->jsonPath != NULL) {
+        _ccnxPingClient_WriteDaemonFile(client);
+    }
+
+    client->daemon = NULL;
+    parcMemory_Deallocate(&daemon->prefix);
+    parcMemory_Deallocate(&daemon);
 }
 
 /**
@@ -278,19 +1514,66 @@ _displayUsage(char *progName)
     printf("\n");
     printf("Usage: %s -p [ -c count ] [ -s size ] [ -i interval ]\n", progName);
     printf("       %s -f [ -c count ] [ -s size ]\n", progName);
+    printf("       %s -g [ -w window ]\n", progName);
+    printf("       %s -D [ -i interval ] [ -t socket ] [ -j file ]\n", progName);
+    printf("       %s -S scenario [ -s size ]\n", progName);
+    printf("       %s -Q p99=2000,loss=0.001 [ -s size ]\n", progName);
+    printf("       %s -U users=10000,think=exp:500000 [ -s size ]\n", progName);
+    printf("       %s -f --loopback=delay=uniform:50:150,loss=0.01\n", progName);
     printf("       %s -h\n", progName);
     printf("\n");
     printf("Example:\n");
     printf("    ccnxPing_Client -l ccnx:/some/prefix -c 100 -f\n");
+    printf("    ccnxPing_Client -l ccnx:/some/prefix -g -w 64\n");
+    printf("    ccnxPing_Client -l ccnx:/some/prefix -S scenarios/daily.scenario\n");
+    printf("    ccnxPing_Client -l ccnx:/some/prefix -Q p99.9=5000,max=200000 -j capacity.json\n");
     printf("\n");
     printf("Options:\n");
     printf("     -h (--help) Show this help message\n");
     printf("     -p (--ping) ping mode - \n");
     printf("     -f (--flood) flood mode - send as fast as possible\n");
+    printf("     -D (--daemon) monitoring mode - probe indefinitely every interval, keeping rolling 1m/5m/15m\n");
+    printf("                  statistics that are served on the -t socket and rewritten to the -j file every 10 s\n");
+    printf("     -S (--scenario) FILE Run the phases of a scenario file back to back, each with its own duration, rate\n");
+    printf("                  (ramped), window, payload-size mix and name workload, and report each phase\n");
+    printf("     -Q (--search) SPEC Search for the highest offered rate that meets a latency objective, confirming\n");
+    printf("                  the bounds with repeated trials. SPEC is a comma-separated list of pNN=US, loss=FRACTION,\n");
+    printf("                  min=RATE, max=RATE, precision=FRACTION, warmup=S, trial=S, window=N, confirm=N and\n");
+    printf("                  trials=N (e.g., p99=2000,loss=0.001,max=50000)\n");
+    printf("     -b (--breakdown) DIMS Also report the results split by a comma-separated list of dimensions: size\n");
+    printf("                  (power-of-two classes of the requested size), prefix[:N] (the prefix of -N or -U names,\n");
+    printf("                  folded into N cells) and phase (of a scenario)\n");
+    printf("     -U (--users) SPEC Simulate independent consumers on one portal: each sends, waits for its response\n");
+    printf("                  (or -o outstanding ones) and thinks before sending again. SPEC is a comma-separated list of\n");
+    printf("                  users=N, think=DIST (us), spread=FRACTION, outstanding=N, size=DIST, duration=S and seed=N\n");
+    printf("     -t (--telemetry) PATH In daemon mode, serve the rolling statistics on this UNIX-domain socket\n");
+    printf("     -g (--get) fetch mode - fetch the object served with ccnxPing_Server -o as pipelined chunks\n");
+    printf("     -w (--window) Number of chunk interests outstanding in fetch mode\n");
+    printf("     -o (--outstanding) Maximum number of interests outstanding in flood mode\n");
     printf("     -c (--count) Number of count to run\n");
     printf("     -i (--interval) Interval in milliseconds between interests in ping mode\n");
     printf("     -s (--size) Size of the interests\n");
     printf("     -l (--locator) Set the locator for this server. The default is 'ccnx:/locator'. \n");
+    printf("     -L (--loopback[=SPEC]) Run against an in-process responder over an impaired link instead of a forwarder.\n");
+    printf("                  SPEC is a comma-separated list of delay=DIST, loss=P, dup=P, reorder=P[:us],\n");
+    printf("                  object=BYTES, chunk=BYTES, seed=N and echo (stamp responses like ccnxPing_Server --echo)\n");
+    printf("                  (e.g., delay=uniform:80:120,loss=0.001)\n");
+    printf("     -j (--json) FILE Also write the results (throughput and RTT percentiles) to FILE as JSON\n");
+    printf("     -H (--histogram) FILE Save the complete RTT histogram to FILE, for comparing runs with ccnxPing_Compare\n");
+    printf("     -R (--record) LEVEL What the statistics record per ping: counters (counts only, duplicates included,\n");
+    printf("                  the cheapest; not with -p or -S), histogram (RTT histogram and sequence analysis, no\n");
+    printf("                  allocation) or trace (every ping, the default)\n");
+    printf("     -T (--trace) FILE Write every ping to FILE: RTT (us), sequence, send time (us) and size. Implies -R trace\n");
+    printf("     -B (--busy-poll[=MODE]) Wait for responses by spinning (spin, the default) or by spinning for an adaptive\n");
+    printf("                  budget of at most US microseconds before blocking (hybrid[:US]). CPU time is reported.\n");
+    printf("     -I (--isolate[=CPUS]) Pin the client loop to the first CPU of a list such as 2,4-7, lock and prefault\n");
+    printf("                  memory and request SCHED_FIFO. Each step is reported.\n");
+    printf("     -N (--names) SPEC Draw interest names from a pool generated before the run. SPEC is a comma-separated\n");
+    printf("                  list of components=DIST, length=DIST, prefixes=N, size=DIST, pool=N and seed=N\n");
+    printf("                  (e.g., components=uniform:2:12,length=exp:10,prefixes=1000,size=uniform:0:8192)\n");
+    printf("     -P (--processes) N Run the test in N forked client processes, each with its own identity and portal,\n");
+    printf("                  started together. Live and final aggregates are reported across all of them. Every mode\n");
+    printf("                  but fetch, daemon and search (i.e., ping, flood, all, scenario and users)\n");
 }
 
 /**
@@ -307,14 +1590,32 @@ _ccnxPingClient_ParseCommandline(CCNxPingClient *client, int argc, char *argv[ar
         { "interval",    required_argument, NULL, 'i' },
         { "locator",     required_argument, NULL, 'l' },
         { "outstanding", required_argument, NULL, 'o' },
+        { "get",         no_argument,       NULL, 'g' },
+        { "window",      required_argument, NULL, 'w' },
+        { "loopback",    optional_argument, NULL, 'L' },
+        { "json",        required_argument, NULL, 'j' },
+        { "histogram",   required_argument, NULL, 'H' },
+        { "record",      required_argument, NULL, 'R' },
+        { "trace",       required_argument, NULL, 'T' },
+        { "isolate",     optional_argument, NULL, 'I' },
+        { "busy-poll",   optional_argument, NULL, 'B' },
+        { "processes",   required_argument, NULL, 'P' },
+        { "names",       required_argument, NULL, 'N' },
+        { "daemon",      no_argument,       NULL, 'D' },
+        { "telemetry",   required_argument, NULL, 't' },
+        { "scenario",    required_argument, NULL, 'S' },
+        { "search",      required_argument, NULL, 'Q' },
+        { "users",       required_argument, NULL, 'U' },
+        { "breakdown",   required_argument, NULL, 'b' },
         { "help",        no_argument,       NULL, 'h' },
         { NULL,          0,                 NULL, 0   }
     };
 
     client->payloadSize = ccnxPing_DefaultPayloadSize;
+    const char *scenarioPath = NULL;
 
     int c;
-    while ((c = getopt_long(argc, argv, "phfc:s:i:l:o:", longopts, NULL)) != -1) {
+    while ((c = getopt_long(argc, argv, "phfgDS:Q:U:b:c:s:i:l:o:w:L::j:H:R:T:I::B::P:N:t:", longopts, NULL)) != -1) {
         switch (c) {
             case 'p':
                 if (client->mode != CCNxPingClientMode_None) {
@@ -328,6 +1629,54 @@ _ccnxPingClient_ParseCommandline(CCNxPingClient *client, int argc, char *argv[ar
                 }
                 client->mode = CCNxPingClientMode_Flood;
                 break;
+            case 'g':
+                if (client->mode != CCNxPingClientMode_None) {
+                    return false;
+                }
+                client->mode = CCNxPingClientMode_Fetch;
+                break;
+            case 'D':
+                if (client->mode != CCNxPingClientMode_None) {
+                    return false;
+                }
+                client->mode = CCNxPingClientMode_Daemon;
+                break;
+            case 'S':
+                if (client->mode != CCNxPingClientMode_None) {
+                    return false;
+                }
+                client->mode = CCNxPingClientMode_Scenario;
+                scenarioPath = optarg;
+                break;
+            case 'Q':
+                if (client->mode != CCNxPingClientMode_None) {
+                    _displayUsage(argv[0]);
+                    return false;
+                }
+                client->mode = CCNxPingClientMode_Search;
+                if (!ccnxPingSearchOptions_Parse(&client->searchOptions, optarg)) {
+                    fprintf(stderr, "Invalid search specification: %s\n", optarg);
+                    return false;
+                }
+                break;
+            case 'U':
+                if (client->mode != CCNxPingClientMode_None) {
+                    _displayUsage(argv[0]);
+                    return false;
+                }
+                client->mode = CCNxPingClientMode_Users;
+                client->usersSpecification = optarg;
+                break;
+            case 't':
+                client->telemetryPath = optarg;
+                break;
+            case 'w':
+                sscanf(optarg, "%zu", &(client->fetchWindow));
+                if (client->fetchWindow == 0) {
+                    _displayUsage(argv[0]);
+                    return false;
+                }
+                break;
             case 'c':
                 sscanf(optarg, "%u", &(client->count));
                 break;
@@ -343,6 +1692,52 @@ _ccnxPingClient_ParseCommandline(CCNxPingClient *client, int argc, char *argv[ar
             case 'l':
                 client->prefix = ccnxName_CreateFromCString(optarg);
                 break;
+            case 'L':
+                client->useLoopback = true;
+                if (optarg != NULL && !ccnxPingLoopbackOptions_Parse(&client->loopbackOptions, optarg)) {
+                    fprintf(stderr, "Invalid loopback specification: %s\n", optarg);
+                    return false;
+                }
+                break;
+            case 'j':
+                client->jsonPath = optarg;
+                break;
+            case 'H':
+                client->histogramPath = optarg;
+                break;
+            case 'R':
+                if (!ccnxPingStatsLevel_Parse(optarg, &client->statsLevel)) {
+                    fprintf(stderr, "Invalid or unavailable statistics level: %s\n", optarg);
+                    return false;
+                }
+                break;
+            case 'T':
+                client->tracePath = optarg;
+                break;
+            case 'B':
+                if (!ccnxPingPortalPolling_Parse(&client->polling, optarg != NULL ? optarg : "spin")) {
+                    fprintf(stderr, "Invalid receive mode: %s\n", optarg);
+                    return false;
+                }
+                break;
+            case 'I':
+                if (!ccnxPingIsolation_Parse(&client->isolation, optarg)) {
+                    fprintf(stderr, "Invalid CPU list: %s\n", optarg);
+                    return false;
+                }
+                break;
+            case 'P':
+                sscanf(optarg, "%zu", &(client->processCount));
+                break;
+            case 'N':
+                client->workloadSpecification = optarg;
+                break;
+            case 'b':
+                if (!ccnxPingBreakdownOptions_Parse(&client->breakdownOptions, optarg)) {
+                    fprintf(stderr, "Invalid breakdown: %s\n", optarg);
+                    return false;
+                }
+                break;
             case 'h':
                 _displayUsage(argv[0]);
                 return false;
@@ -355,6 +1750,63 @@ _ccnxPingClient_ParseCommandline(CCNxPingClient *client, int argc, char *argv[ar
         _displayUsage(argv[0]);
         return false;
     }
+    // The default size is only known once every option has been read.
+    if (client->workloadSpecification != NULL) {
+        ccnxPingWorkloadOptions_Init(&client->workloadOptions, client->payloadSize);
+        if (!ccnxPingWorkloadOptions_Parse(&client->workloadOptions, client->workloadSpecification)) {
+            fprintf(stderr, "Invalid name workload: %s\n", client->workloadSpecification);
+            return false;
+        }
+    }
+    if (client->usersSpecification != NULL) {
+        ccnxPingVirtualUsersOptions_Init(&client->usersOptions, client->payloadSize);
+        if (!ccnxPingVirtualUsersOptions_Parse(&client->usersOptions, client->usersSpecification)) {
+            fprintf(stderr, "Invalid virtual users: %s\n", client->usersSpecification);
+            return false;
+        }
+    }
+    if (client->tracePath != NULL && !ccnxPingStatsLevel_Parse("trace", &client->statsLevel)) {
+        fprintf(stderr, "--trace needs the trace statistics level, which this build does not have\n");
+        return false;
+    }
+    if (client->statsLevel == CCNxPingStatsLevel_Counters && client->processCount > 0) {
+        fprintf(stderr, "--processes aggregates RTTs, which the counters statistics level does not record\n");
+        return false;
+    }
+    if (client->breakdownOptions.dimensions != 0 && client->statsLevel == CCNxPingStatsLevel_Counters) {
+        fprintf(stderr, "--breakdown needs RTTs, which the counters statistics level does not record\n");
+        return false;
+    }
+    if (client->mode == CCNxPingClientMode_Search && client->statsLevel == CCNxPingStatsLevel_Counters) {
+        fprintf(stderr, "--search judges RTT percentiles, which the counters statistics level does not record\n");
+        return false;
+    }
+    if (client->mode == CCNxPingClientMode_PingPong && client->statsLevel == CCNxPingStatsLevel_Counters) {
+        fprintf(stderr, "--ping prints the RTT of each response, which the counters statistics level does not record\n");
+        return false;
+    }
+    if (client->mode == CCNxPingClientMode_Daemon && client->intervalInMs == 0) {
+        fprintf(stderr, "--daemon needs an interval of at least 1 ms between probes\n");
+        return false;
+    }
+    if (client->mode == CCNxPingClientMode_Scenario && client->statsLevel == CCNxPingStatsLevel_Counters) {
+        fprintf(stderr, "--scenario credits each response to the phase that sent it, which the counters statistics level cannot tell\n");
+        return false;
+    }
+    client->stats = ccnxPingStats_Create(client->statsLevel);
+
+    // The scenario is read once the default payload size is known.
+    if (client->mode == CCNxPingClientMode_Scenario) {
+        client->scenario = ccnxPingScenario_Load(scenarioPath, client->payloadSize);
+        if (client->scenario == NULL) {
+            return false;
+        }
+    }
+    if (client->processCount > 0 && (client->mode == CCNxPingClientMode_Fetch || client->mode == CCNxPingClientMode_Daemon
+                                     || client->mode == CCNxPingClientMode_Search)) {
+        fprintf(stderr, "--processes applies to every mode but fetch, daemon and search\n");
+        return false;
+    }
 
     return true;
 };
@@ -366,6 +1818,19 @@ _ccnxPingClient_DisplayStatistics(CCNxPingClient *client)
     if (!ableToCompute) {
         parcDisplayIndented_PrintLine(0, "No packets were received. Check to make sure the client and server are configured correctly and that the forwarder is running.\n");
     }
+    if (client->breakdown != NULL) {
+        ccnxPingBreakdown_Display(client->breakdown, 0);
+    }
+    _ccnxPingClient_DisplayCpuTime(client);
+    ccnxPingPortal_WriteCounters(client->portal, stdout);
+
+    FILE *json = _ccnxPingClient_OpenJSON(client);
+    if (json != NULL) {
+        ccnxPingStats_WriteJSON(client->stats, json);
+        fclose(json);
+    }
+    _ccnxPingClient_SaveHistogram(client, ccnxPingStats_GetRtt(client->stats));
+    _ccnxPingClient_SaveTrace(client);
 }
 
 static void
@@ -377,7 +1842,7 @@ _ccnxPingClient_RunPingormanceTest(CCNxPingClient *client)
             _ccnxPingClient_DisplayStatistics(client);
 
             ccnxPingStats_Release(&client->stats);
-            client->stats = ccnxPingStats_Create();
+            client->stats = ccnxPingStats_Create(client->statsLevel);
 
             _ccnxPingClient_RunPing(client, smallNumberOfPings, ccnxPing_DefaultReceiveTimeoutInUs);
             _ccnxPingClient_DisplayStatistics(client);
@@ -390,6 +1855,22 @@ _ccnxPingClient_RunPingormanceTest(CCNxPingClient *client)
             _ccnxPingClient_RunPing(client, client->count, client->intervalInMs * 1000);
             _ccnxPingClient_DisplayStatistics(client);
             break;
+        case CCNxPingClientMode_Fetch:
+            _ccnxPingClient_RunFetch(client);
+            break;
+        case CCNxPingClientMode_Daemon:
+            _ccnxPingClient_RunDaemon(client);
+            break;
+        case CCNxPingClientMode_Scenario:
+            _ccnxPingClient_RunScenario(client);
+            break;
+        case CCNxPingClientMode_Search:
+            _ccnxPingClient_RunSearch(client);
+            break;
+        case CCNxPingClientMode_Users:
+            _ccnxPingClient_RunUsers(client);
+            _ccnxPingClient_DisplayStatistics(client);
+            break;
         case CCNxPingClientMode_None:
         default:
             fprintf(stderr, "Error, unknown mode");
@@ -397,6 +1878,42 @@ _ccnxPingClient_RunPingormanceTest(CCNxPingClient *client)
     }
 }
 
+/**
+ * Run the test in `processCount` forked clients and report their aggregate.
+ *
+ * @return true If every client process completed its run.
+ */
+static bool
+_ccnxPingClient_RunProcesses(CCNxPingClient *client)
+{
+    CCNxPingOrchestrator *orchestrator = ccnxPingOrchestrator_Create(client->processCount);
+    if (orchestrator == NULL) {
+        return false;
+    }
+
+    bool result = true;
+    client->slot = ccnxPingOrchestrator_Fork(orchestrator);
+    if (client->slot != NULL) {
+        // A child: a nonce of its own keeps its names apart from those of its siblings.
+        client->nonce ^= getpid();
+        client->jsonPath = NULL;
+        client->histogramPath = NULL;
+        client->tracePath = NULL;
+        _ccnxPingClient_RunPingormanceTest(client);
+        ccnxPingOrchestratorSlot_Finish(client->slot);
+        client->slot = NULL;
+    } else {
+        FILE *json = _ccnxPingClient_OpenJSON(client);
+        result = ccnxPingOrchestrator_Run(orchestrator, _orchestratorReportIntervalInUs, json);
+        if (json != NULL) {
+            fclose(json);
+        }
+    }
+
+    ccnxPingOrchestrator_Release(&orchestrator);
+    return result;
+}
+
 int
 main(int argc, char *argv[argc])
 {
@@ -404,14 +1921,23 @@ main(int argc, char *argv[argc])
 
     CCNxPingClient *client = ccnxPingClient_Create();
 
+    int status = EXIT_SUCCESS;
     bool runPing = _ccnxPingClient_ParseCommandline(client, argc, argv);
     if (runPing) {
-        _ccnxPingClient_RunPingormanceTest(client);
+        if (client->processCount > 0) {
+            if (!_ccnxPingClient_RunProcesses(client)) {
+                status = EXIT_FAILURE;
+            }
+        } else {
+            _ccnxPingClient_RunPingormanceTest(client);
+        }
+    } else {
+        status = EXIT_FAILURE;
     }
 
     ccnxPingClient_Release(&client);
 
     parcSecurity_Fini();
 
-    return EXIT_SUCCESS;
+    return status;
 }
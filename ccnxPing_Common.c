@@ -57,6 +57,8 @@
  * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
  */
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 
 #include "ccnxPing_Common.h"
 
@@ -66,6 +68,8 @@
 #include <parc/security/parc_Pkcs12KeyStore.h>
 #include <parc/security/parc_IdentityFile.h>
 
+#include <ccnx/common/ccnx_NameSegment.h>
+
 const size_t ccnxPing_DefaultReceiveTimeoutInUs = 1000000; // 1 second
 const size_t ccnxPing_DefaultPayloadSize = 4096;
 const size_t mediumNumberOfPings = 100;
@@ -104,3 +108,96 @@ ccnxPingCommon_SetupPortalFactory(const char *keystoreName, const char *keystore
 
     return result;
 }
+
+uint64_t
+ccnxPingCommon_MonotonicTimeInUs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+uint64_t
+ccnxPingCommon_ProcessCpuTimeInUs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+CCNxName *
+ccnxPingCommon_CreatePingName(const CCNxName *prefix, int nonce, int payloadSize, int counter)
+{
+    char *suffixBuffer = NULL;
+    asprintf(&suffixBuffer, "%x", nonce);
+    CCNxName *name1 = ccnxName_ComposeNAME(prefix, suffixBuffer);
+    free(suffixBuffer);
+
+    suffixBuffer = NULL;
+    asprintf(&suffixBuffer, "%u", payloadSize);
+    CCNxName *name2 = ccnxName_ComposeNAME(name1, suffixBuffer);
+    ccnxName_Release(&name1);
+    free(suffixBuffer);
+
+    suffixBuffer = NULL;
+    asprintf(&suffixBuffer, "%06lu", (long) counter);
+    CCNxName *name3 = ccnxName_ComposeNAME(name2, suffixBuffer);
+    ccnxName_Release(&name2);
+    free(suffixBuffer);
+
+    return name3;
+}
+
+bool
+ccnxPingCommon_GetPayloadSize(const CCNxName *name, size_t sizeIndex, size_t *size)
+{
+    if (ccnxName_GetSegmentCount(name) <= sizeIndex) {
+        return false;
+    }
+
+    char *segmentString = ccnxNameSegment_ToString(ccnxName_GetSegment(name, sizeIndex));
+    int requested = atoi(segmentString);
+    requested = requested > ccnxPing_MaxPayloadSize ? ccnxPing_MaxPayloadSize : requested;
+    requested = requested < 0 ? 0 : requested;
+    parcMemory_Deallocate(&segmentString);
+
+    *size = (size_t) requested;
+    return true;
+}
+
+bool
+ccnxPingCommon_GetSequenceNumber(const CCNxName *name, uint64_t *sequence)
+{
+    size_t segmentCount = ccnxName_GetSegmentCount(name);
+    if (segmentCount == 0) {
+        return false;
+    }
+
+    PARCBuffer *value = ccnxNameSegment_GetValue(ccnxName_GetSegment(name, segmentCount - 1));
+    size_t length = parcBuffer_Remaining(value);
+    if (length == 0 || length > 20) {
+        return false;
+    }
+
+    const uint8_t *digits = parcBuffer_Overlay(value, 0);
+    uint64_t result = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (digits[i] < '0' || digits[i] > '9') {
+            return false;
+        }
+        result = result * 10 + (digits[i] - '0');
+    }
+
+    *sequence = result;
+    return true;
+}
+
+CCNxMetaMessage *
+ccnxPingCommon_CreateResponse(const CCNxName *name, const PARCBuffer *payload)
+{
+    CCNxContentObject *contentObject = ccnxContentObject_CreateWithNameAndPayload(name, payload);
+    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromContentObject(contentObject);
+    ccnxContentObject_Release(&contentObject);
+
+    return message;
+}
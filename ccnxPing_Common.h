@@ -60,6 +60,7 @@
 #ifndef ccnxPingCommon_h
 #define ccnxPingCommon_h
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include <ccnx/api/ccnx_Portal/ccnx_Portal.h>
@@ -95,6 +96,97 @@ extern const size_t mediumNumberOfPings;
  */
 extern const size_t smallNumberOfPings;
 
+/**
+ * Add to a counter that has a single writer but may be read concurrently by another
+ * thread or process. The update is atomic but issues no locked instruction.
+ */
+#define ccnxPingCommon_CounterAdd(counter, value) \
+    __atomic_store_n(&(counter), __atomic_load_n(&(counter), __ATOMIC_RELAXED) + (value), __ATOMIC_RELAXED)
+
+/**
+ * Store a value into a single-writer counter (see `ccnxPingCommon_CounterAdd`).
+ */
+#define ccnxPingCommon_CounterSet(counter, value) __atomic_store_n(&(counter), (value), __ATOMIC_RELAXED)
+
+/**
+ * Read a counter that may be concurrently updated (see `ccnxPingCommon_CounterAdd`).
+ */
+#define ccnxPingCommon_CounterGet(counter) __atomic_load_n(&(counter), __ATOMIC_RELAXED)
+
+/**
+ * Return the current time of the monotonic clock (in microseconds).
+ *
+ * This clock is not related to the wall clock and is only suitable for measuring intervals.
+ *
+ * @return The current monotonic time (in microseconds).
+ */
+uint64_t ccnxPingCommon_MonotonicTimeInUs(void);
+
+/**
+ * Return the CPU time consumed so far by all threads of the process (in microseconds).
+ *
+ * @return The CPU time of the process (in microseconds).
+ */
+uint64_t ccnxPingCommon_ProcessCpuTimeInUs(void);
+
+/**
+ * Create the name of a ping interest: `prefix/<nonce in hex>/<payloadSize>/<counter>`.
+ *
+ * The server reads the size of the payload to return from the segment after the nonce.
+ *
+ * @param [in] prefix The prefix served by the server.
+ * @param [in] nonce The nonce of the client.
+ * @param [in] payloadSize The size of the payload requested.
+ * @param [in] counter The sequence number of the interest.
+ *
+ * @return A new `CCNxName` that must be released with `ccnxName_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxName *name = ccnxPingCommon_CreatePingName(prefix, rand(), 4096, 101);
+ *     ...
+ *     ccnxName_Release(&name);
+ * }
+ * @endcode
+ */
+CCNxName *ccnxPingCommon_CreatePingName(const CCNxName *prefix, int nonce, int payloadSize, int counter);
+
+/**
+ * Read the payload size requested by a ping name, clamped to `ccnxPing_MaxPayloadSize`.
+ *
+ * @param [in] name The name of the interest.
+ * @param [in] sizeIndex The index of the size segment (the segment count of the prefix plus one).
+ * @param [out] size The requested size. A segment that is not a number requests 0 bytes.
+ *
+ * @retval true If the name has a size segment.
+ * @retval false Otherwise
+ */
+bool ccnxPingCommon_GetPayloadSize(const CCNxName *name, size_t sizeIndex, size_t *size);
+
+/**
+ * Read the sequence number (the counter given to `ccnxPingCommon_CreatePingName`) of a ping name.
+ *
+ * The last segment is parsed in place, without allocating.
+ *
+ * @param [in] name The name of the interest or of the response.
+ * @param [out] sequence The sequence number.
+ *
+ * @retval true If the last segment of the name is a decimal number.
+ * @retval false Otherwise
+ */
+bool ccnxPingCommon_GetSequenceNumber(const CCNxName *name, uint64_t *sequence);
+
+/**
+ * Create the response message carrying `payload` under `name`.
+ *
+ * @param [in] name The name of the content object.
+ * @param [in] payload The payload of the content object.
+ *
+ * @return A new `CCNxMetaMessage` holding an unsigned content object.
+ */
+CCNxMetaMessage *ccnxPingCommon_CreateResponse(const CCNxName *name, const PARCBuffer *payload);
+
 /**
  * Initialize and return a new instance of CCNxPortalFactory. A randomly generated identity is
  * used to initialize the factory. The returned instance must eventually be released by calling
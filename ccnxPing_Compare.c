@@ -0,0 +1,554 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <ctype.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnxPing_Distribution.h"
+#include "ccnxPing_Histogram.h"
+
+#define _defaultReplicates 1000
+#define _maxReplicates 100000
+#define _defaultAlpha 0.05
+// One histogram bucket: smaller deltas are below the resolution of the percentiles.
+#define _defaultThresholdPercent 6.25
+#define _maxPercentiles 16
+#define _maxFiles 64
+
+/**
+ * Above this mean the Poisson weights of the bootstrap are drawn from their normal approximation.
+ */
+#define _poissonNormalThreshold 30.0
+
+/**
+ * One result file, reduced to its histogram as it is read so that memory does not grow with the run.
+ */
+typedef struct ccnx_ping_compare_input {
+    const char *path;
+    CCNxPingHistogram histogram;
+    uint64_t skippedLines;
+} CCNxPingCompareInput;
+
+/**
+ * The comparison of one percentile of a candidate with the baseline. Deltas are relative to the baseline.
+ */
+typedef struct ccnx_ping_compare_percentile {
+    double percentile;
+    uint64_t baseline;
+    uint64_t candidate;
+    double delta;
+    double low;
+    double high;
+    const char *result;
+} CCNxPingComparePercentile;
+
+typedef struct ccnx_ping_compare_mann_whitney {
+    double u;
+    double z;
+    double p;
+    double superiority;
+} CCNxPingCompareMannWhitney;
+
+typedef struct ccnx_ping_compare_options {
+    double percentiles[_maxPercentiles];
+    size_t percentileCount;
+    size_t replicates;
+    double alpha;
+    double threshold;
+    int column;
+    uint64_t seed;
+} CCNxPingCompareOptions;
+
+/**
+ * Return field `column` (1-based) of a line whose fields are separated by blanks or commas, or NULL.
+ */
+static char *
+_ccnxPingCompare_Field(char *line, int column)
+{
+    char *cursor = line;
+    for (int i = 1; ; i++) {
+        while (*cursor != '\0' && (isspace((unsigned char) *cursor) || *cursor == ',')) {
+            cursor++;
+        }
+        if (*cursor == '\0') {
+            return NULL;
+        }
+        if (i == column) {
+            return cursor;
+        }
+        while (*cursor != '\0' && !isspace((unsigned char) *cursor) && *cursor != ',') {
+            cursor++;
+        }
+    }
+}
+
+/**
+ * Read a per-ping trace: one sample (in microseconds) per line, in the given column. Blank lines,
+ * comments (#) and lines without a number there (e.g., a CSV header) are skipped.
+ */
+static void
+_ccnxPingCompare_LoadTrace(CCNxPingCompareInput *input, FILE *file, int column)
+{
+    char *line = NULL;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, file) > 0) {
+        if (line[0] == '#') {
+            continue;
+        }
+        char *field = _ccnxPingCompare_Field(line, column);
+        if (field == NULL) {
+            continue;
+        }
+        char *end = NULL;
+        double value = strtod(field, &end);
+        if (end == field || value < 0.0) {
+            input->skippedLines++;
+            continue;
+        }
+        ccnxPingHistogram_Record(&input->histogram, (uint64_t) (value + 0.5));
+    }
+    free(line);
+}
+
+/**
+ * Load a histogram saved by the client (--histogram) or a per-ping trace, telling them apart by the header.
+ */
+static bool
+_ccnxPingCompare_Load(CCNxPingCompareInput *input, const char *path, int column)
+{
+    input->path = path;
+    input->skippedLines = 0;
+    ccnxPingHistogram_Init(&input->histogram);
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Unable to read %s\n", path);
+        return false;
+    }
+
+    char header[32];
+    bool isHistogram = fgets(header, sizeof(header), file) != NULL && strncmp(header, "ccnxPing-histogram ", 19) == 0;
+    rewind(file);
+
+    bool result = true;
+    if (isHistogram) {
+        result = ccnxPingHistogram_Load(&input->histogram, file);
+        if (!result) {
+            fprintf(stderr, "%s is not a valid histogram for this build\n", path);
+        }
+    } else {
+        _ccnxPingCompare_LoadTrace(input, file, column);
+        if (input->skippedLines > 0) {
+            fprintf(stderr, "%s: skipped %" PRIu64 " lines without a sample in column %d\n", path, input->skippedLines, column);
+        }
+    }
+    fclose(file);
+
+    if (result && ccnxPingHistogram_Count(&input->histogram) == 0) {
+        fprintf(stderr, "%s holds no samples\n", path);
+        result = false;
+    }
+    return result;
+}
+
+/**
+ * Draw from a Poisson distribution of the given mean.
+ */
+static uint64_t
+_ccnxPingCompare_Poisson(double mean, uint64_t *randomState)
+{
+    if (mean >= _poissonNormalThreshold) {
+        double u1 = ccnxPingDistribution_RandomUnit(randomState);
+        double u2 = ccnxPingDistribution_RandomUnit(randomState);
+        double normal = sqrt(-2.0 * log(1.0 - u1)) * cos(2.0 * M_PI * u2);
+        double value = mean + sqrt(mean) * normal + 0.5;
+        return value > 0.0 ? (uint64_t) value : 0;
+    }
+
+    double limit = exp(-mean);
+    double product = ccnxPingDistribution_RandomUnit(randomState);
+    uint64_t result = 0;
+    while (product > limit) {
+        product *= ccnxPingDistribution_RandomUnit(randomState);
+        result++;
+    }
+    return result;
+}
+
+/**
+ * Draw a Poisson bootstrap replicate of a histogram: every sample is given a Poisson(1) weight, so
+ * the count of each bucket is redrawn from a Poisson distribution of the same mean. The cost depends
+ * on the number of buckets, not on the number of samples.
+ */
+static void
+_ccnxPingCompare_Resample(CCNxPingHistogram *replicate, const CCNxPingHistogram *histogram, uint64_t *randomState)
+{
+    *replicate = *histogram;
+    replicate->count = 0;
+    for (size_t i = 0; i < ccnxPingHistogram_BucketCount; i++) {
+        if (histogram->buckets[i] > 0) {
+            replicate->buckets[i] = _ccnxPingCompare_Poisson((double) histogram->buckets[i], randomState);
+            replicate->count += replicate->buckets[i];
+        }
+    }
+}
+
+static double
+_ccnxPingCompare_RelativeDelta(uint64_t baseline, uint64_t candidate)
+{
+    return baseline > 0 ? ((double) candidate - (double) baseline) / (double) baseline : 0.0;
+}
+
+static int
+_ccnxPingCompare_CompareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Compute the percentile deltas of a candidate with the baseline and their bootstrap confidence
+ * intervals (percentile method, at level 1 - alpha).
+ */
+static void
+_ccnxPingCompare_Percentiles(const CCNxPingCompareInput *baseline, const CCNxPingCompareInput *candidate,
+                             const CCNxPingCompareOptions *options, CCNxPingComparePercentile *results)
+{
+    uint64_t randomState = options->seed;
+    double *deltas = malloc(options->replicates * options->percentileCount * sizeof(double));
+
+    CCNxPingHistogram baselineReplicate;
+    CCNxPingHistogram candidateReplicate;
+    for (size_t r = 0; r < options->replicates; r++) {
+        _ccnxPingCompare_Resample(&baselineReplicate, &baseline->histogram, &randomState);
+        _ccnxPingCompare_Resample(&candidateReplicate, &candidate->histogram, &randomState);
+        for (size_t p = 0; p < options->percentileCount; p++) {
+            deltas[p * options->replicates + r] =
+                _ccnxPingCompare_RelativeDelta(ccnxPingHistogram_Percentile(&baselineReplicate, options->percentiles[p]),
+                                               ccnxPingHistogram_Percentile(&candidateReplicate, options->percentiles[p]));
+        }
+    }
+
+    size_t lowIndex = (size_t) (options->alpha / 2.0 * (options->replicates - 1) + 0.5);
+    size_t highIndex = options->replicates - 1 - lowIndex;
+    for (size_t p = 0; p < options->percentileCount; p++) {
+        CCNxPingComparePercentile *result = &results[p];
+        double *replicates = &deltas[p * options->replicates];
+        qsort(replicates, options->replicates, sizeof(double), _ccnxPingCompare_CompareDoubles);
+
+        result->percentile = options->percentiles[p];
+        result->baseline = ccnxPingHistogram_Percentile(&baseline->histogram, result->percentile);
+        result->candidate = ccnxPingHistogram_Percentile(&candidate->histogram, result->percentile);
+        result->delta = _ccnxPingCompare_RelativeDelta(result->baseline, result->candidate);
+        result->low = replicates[lowIndex];
+        result->high = replicates[highIndex];
+
+        // Latencies: a rise that the whole interval places beyond the threshold is a regression.
+        if (result->low > options->threshold) {
+            result->result = "REGRESSED";
+        } else if (result->high < -options->threshold) {
+            result->result = "improved";
+        } else {
+            result->result = "ok";
+        }
+    }
+    free(deltas);
+}
+
+/**
+ * The Mann-Whitney U test of the candidate against the baseline, with the samples of a bucket
+ * treated as ties. `superiority` is the probability that a candidate sample exceeds a baseline one.
+ */
+static void
+_ccnxPingCompare_MannWhitney(const CCNxPingHistogram *baseline, const CCNxPingHistogram *candidate,
+                             CCNxPingCompareMannWhitney *result)
+{
+    double n1 = (double) ccnxPingHistogram_Count(candidate);
+    double n2 = (double) ccnxPingHistogram_Count(baseline);
+    double n = n1 + n2;
+
+    double u = 0.0;
+    double baselineBelow = 0.0;
+    double tieCorrection = 0.0;
+    for (size_t i = 0; i < ccnxPingHistogram_BucketCount; i++) {
+        double a = (double) candidate->buckets[i];
+        double b = (double) baseline->buckets[i];
+        u += a * (baselineBelow + b / 2.0);
+        baselineBelow += b;
+        double ties = a + b;
+        tieCorrection += ties * ties * ties - ties;
+    }
+
+    double mean = n1 * n2 / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1.0) - tieCorrection / (n * (n - 1.0)));
+
+    result->u = u;
+    result->superiority = u / (n1 * n2);
+    result->z = variance > 0.0 ? (u - mean) / sqrt(variance) : 0.0;
+    result->p = erfc(fabs(result->z) / M_SQRT2);
+}
+
+static void
+_ccnxPingCompare_WriteJSONInput(const CCNxPingCompareInput *input, FILE *output)
+{
+    fprintf(output, "\"path\":\"%s\",\"rtt_us\":", input->path);
+    ccnxPingHistogram_WriteJSON(&input->histogram, output);
+}
+
+static bool
+_ccnxPingCompare_ParsePercentiles(CCNxPingCompareOptions *options, const char *list)
+{
+    options->percentileCount = 0;
+    const char *cursor = list;
+    while (*cursor != '\0') {
+        char *end = NULL;
+        double percentile = strtod(cursor, &end);
+        if (end == cursor || percentile < 0.0 || percentile > 100.0 || options->percentileCount == _maxPercentiles) {
+            return false;
+        }
+        options->percentiles[options->percentileCount++] = percentile;
+        cursor = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return false;
+        }
+    }
+    return options->percentileCount > 0;
+}
+
+/**
+ * Display the usage message.
+ */
+static void
+_displayUsage(char *progName)
+{
+    printf("CCNx Ping Run Comparison\n");
+    printf("\n");
+    printf("Compares the latency distribution of one or more candidate runs with a baseline run. Each percentile\n");
+    printf("delta gets a bootstrap confidence interval, and the distributions a Mann-Whitney U test. A percentile\n");
+    printf("whose whole interval lies above the threshold is a regression.\n");
+    printf("\n");
+    printf("Every input is reduced to a fixed-size histogram as it is read: runs of any length use constant memory.\n");
+    printf("Inputs are histograms saved by `ccnxPing_Client --histogram FILE`, or traces with one sample (us) per line.\n");
+    printf("Percentiles are resolved to their histogram bucket, up to 6.25%% wide: smaller changes read as no change.\n");
+    printf("\n");
+    printf("Usage: %s [ -p percentiles ] [ -b replicates ] [ -a alpha ] [ -t percent ] [ -c column ] [ -j json ] baseline candidate ...\n", progName);
+    printf("       %s -h\n", progName);
+    printf("\n");
+    printf("Example:\n");
+    printf("    ccnxPing_Compare -p 50,99,99.9 -t 2 before.hist after.hist\n");
+    printf("\n");
+    printf("Options:\n");
+    printf("     -h (--help) Show this help message\n");
+    printf("     -p (--percentiles) Comma-separated percentiles to compare (default 50,90,99,99.9)\n");
+    printf("     -b (--bootstrap) Number of bootstrap replicates (default %d)\n", _defaultReplicates);
+    printf("     -a (--alpha) Significance level; the intervals have confidence 1 - alpha (default %.2f)\n", _defaultAlpha);
+    printf("     -t (--threshold) Smallest relative change, in percent, that counts as a regression (default %.2f)\n", _defaultThresholdPercent);
+    printf("     -c (--column) The column of the sample in trace files, counting from 1 (default 1)\n");
+    printf("     -s (--seed) Seed of the bootstrap (default 1)\n");
+    printf("     -j (--json) Also write the comparison to this file as JSON\n");
+}
+
+int
+main(int argc, char *argv[argc])
+{
+    static struct option longopts[] = {
+        { "percentiles", required_argument, NULL, 'p' },
+        { "bootstrap",   required_argument, NULL, 'b' },
+        { "alpha",       required_argument, NULL, 'a' },
+        { "threshold",   required_argument, NULL, 't' },
+        { "column",      required_argument, NULL, 'c' },
+        { "seed",        required_argument, NULL, 's' },
+        { "json",        required_argument, NULL, 'j' },
+        { "help",        no_argument,       NULL, 'h' },
+        { NULL,          0,                 NULL, 0   }
+    };
+
+    CCNxPingCompareOptions options;
+    _ccnxPingCompare_ParsePercentiles(&options, "50,90,99,99.9");
+    options.replicates = _defaultReplicates;
+    options.alpha = _defaultAlpha;
+    options.threshold = _defaultThresholdPercent / 100.0;
+    options.column = 1;
+    options.seed = 1;
+    const char *jsonPath = NULL;
+
+    int c;
+    while ((c = getopt_long(argc, argv, "p:b:a:t:c:s:j:h", longopts, NULL)) != -1) {
+        switch (c) {
+            case 'p':
+                if (!_ccnxPingCompare_ParsePercentiles(&options, optarg)) {
+                    fprintf(stderr, "Invalid percentiles: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'b':
+                options.replicates = (size_t) atol(optarg);
+                break;
+            case 'a':
+                options.alpha = atof(optarg);
+                break;
+            case 't':
+                options.threshold = atof(optarg) / 100.0;
+                break;
+            case 'c':
+                options.column = atoi(optarg);
+                break;
+            case 's':
+                options.seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'j':
+                jsonPath = optarg;
+                break;
+            case 'h':
+            default:
+                _displayUsage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    int fileCount = argc - optind;
+    if (fileCount < 2 || fileCount > _maxFiles || options.replicates < 10 || options.replicates > _maxReplicates
+        || options.alpha <= 0.0 || options.alpha >= 1.0 || options.threshold < 0.0 || options.column < 1) {
+        _displayUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    options.seed = options.seed == 0 ? 1 : options.seed;
+
+    CCNxPingCompareInput *inputs = malloc(fileCount * sizeof(CCNxPingCompareInput));
+    for (int i = 0; i < fileCount; i++) {
+        if (!_ccnxPingCompare_Load(&inputs[i], argv[optind + i], options.column)) {
+            free(inputs);
+            return EXIT_FAILURE;
+        }
+    }
+
+    FILE *json = NULL;
+    if (jsonPath != NULL && (json = fopen(jsonPath, "w")) == NULL) {
+        fprintf(stderr, "Unable to write the comparison to %s\n", jsonPath);
+    }
+    if (json != NULL) {
+        fprintf(json, "{\"alpha\":%.4f,\"threshold\":%.4f,\"replicates\":%zu,\"baseline\":{",
+                options.alpha, options.threshold, options.replicates);
+        _ccnxPingCompare_WriteJSONInput(&inputs[0], json);
+        fprintf(json, "},\"candidates\":[");
+    }
+
+    const CCNxPingCompareInput *baseline = &inputs[0];
+    printf("Baseline  %s: count %" PRIu64 " : mean %.1f us\n", baseline->path,
+           ccnxPingHistogram_Count(&baseline->histogram), ccnxPingHistogram_Mean(&baseline->histogram));
+
+    bool regressed = false;
+    for (int i = 1; i < fileCount; i++) {
+        const CCNxPingCompareInput *candidate = &inputs[i];
+        CCNxPingComparePercentile results[_maxPercentiles];
+        CCNxPingCompareMannWhitney mannWhitney;
+        _ccnxPingCompare_Percentiles(baseline, candidate, &options, results);
+        _ccnxPingCompare_MannWhitney(&baseline->histogram, &candidate->histogram, &mannWhitney);
+
+        printf("\nCandidate %s: count %" PRIu64 " : mean %.1f us\n", candidate->path,
+               ccnxPingHistogram_Count(&candidate->histogram), ccnxPingHistogram_Mean(&candidate->histogram));
+        printf("%-10s %12s %12s %9s   %-22s %s\n", "Percentile", "Baseline", "Candidate", "Delta",
+               "Confidence interval", "Result");
+
+        bool candidateRegressed = false;
+        for (size_t p = 0; p < options.percentileCount; p++) {
+            const CCNxPingComparePercentile *result = &results[p];
+            char interval[64];
+            snprintf(interval, sizeof(interval), "[%+.1f%%, %+.1f%%]", 100.0 * result->low, 100.0 * result->high);
+            printf("p%-9g %12" PRIu64 " %12" PRIu64 " %+8.1f%%   %-22s %s\n", result->percentile,
+                   result->baseline, result->candidate, 100.0 * result->delta, interval, result->result);
+            candidateRegressed |= strcmp(result->result, "REGRESSED") == 0;
+        }
+
+        bool shifted = mannWhitney.p < options.alpha;
+        printf("Mann-Whitney U = %.0f : z = %.2f : p = %.3g : P(candidate > baseline) = %.3f : %s\n",
+               mannWhitney.u, mannWhitney.z, mannWhitney.p, mannWhitney.superiority,
+               !shifted ? "no significant shift" : (mannWhitney.superiority > 0.5 ? "significantly slower" : "significantly faster"));
+        printf("Verdict: %s\n", candidateRegressed ? "REGRESSION" : "no regression");
+        regressed |= candidateRegressed;
+
+        if (json != NULL) {
+            fprintf(json, "%s{", i > 1 ? "," : "");
+            _ccnxPingCompare_WriteJSONInput(candidate, json);
+            fprintf(json, ",\"mann_whitney\":{\"u\":%.1f,\"z\":%.4f,\"p\":%.6g,\"superiority\":%.4f},\"percentiles\":[",
+                    mannWhitney.u, mannWhitney.z, mannWhitney.p, mannWhitney.superiority);
+            for (size_t p = 0; p < options.percentileCount; p++) {
+                const CCNxPingComparePercentile *result = &results[p];
+                fprintf(json, "%s{\"percentile\":%g,\"baseline\":%" PRIu64 ",\"candidate\":%" PRIu64
+                        ",\"delta\":%.4f,\"low\":%.4f,\"high\":%.4f,\"result\":\"%s\"}", p > 0 ? "," : "",
+                        result->percentile, result->baseline, result->candidate, result->delta,
+                        result->low, result->high, result->result);
+            }
+            fprintf(json, "],\"regressed\":%s}", candidateRegressed ? "true" : "false");
+        }
+    }
+
+    if (json != NULL) {
+        fprintf(json, "],\"regressed\":%s}\n", regressed ? "true" : "false");
+        fclose(json);
+    }
+
+    free(inputs);
+    return regressed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccnxPing_Distribution.h"
+
+void
+ccnxPingDistribution_InitConstant(CCNxPingDistribution *distribution, uint64_t value)
+{
+    distribution->type = CCNxPingDistributionType_Constant;
+    distribution->first = (double) value;
+    distribution->second = (double) value;
+    distribution->probability = 0.0;
+}
+
+bool
+ccnxPingDistribution_Parse(CCNxPingDistribution *distribution, const char *specification)
+{
+    CCNxPingDistribution result = { CCNxPingDistributionType_Constant, 0.0, 0.0, 0.0 };
+    int consumed = 0;
+
+    if (sscanf(specification, "const:%lf%n", &result.first, &consumed) == 1) {
+        result.second = result.first;
+    } else if (sscanf(specification, "uniform:%lf:%lf%n", &result.first, &result.second, &consumed) == 2) {
+        result.type = CCNxPingDistributionType_Uniform;
+        if (result.second < result.first) {
+            return false;
+        }
+    } else if (sscanf(specification, "exp:%lf%n", &result.first, &consumed) == 1) {
+        result.type = CCNxPingDistributionType_Exponential;
+    } else if (sscanf(specification, "bimodal:%lf:%lf:%lf%n", &result.first, &result.second, &result.probability, &consumed) == 3) {
+        result.type = CCNxPingDistributionType_Bimodal;
+        if (result.probability < 0.0 || result.probability > 1.0) {
+            return false;
+        }
+    } else if (sscanf(specification, "%lf%n", &result.first, &consumed) == 1) {
+        result.second = result.first;
+    } else {
+        return false;
+    }
+
+    if (specification[consumed] != '\0' || result.first < 0.0 || result.second < 0.0) {
+        return false;
+    }
+
+    *distribution = result;
+    return true;
+}
+
+uint64_t
+ccnxPingDistribution_Random(uint64_t *randomState)
+{
+    uint64_t x = *randomState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *randomState = x;
+    return x * UINT64_C(0x2545F4914F6CDD1D);
+}
+
+double
+ccnxPingDistribution_RandomUnit(uint64_t *randomState)
+{
+    // The top 53 bits fill the mantissa of a double exactly.
+    return (ccnxPingDistribution_Random(randomState) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+uint64_t
+ccnxPingDistribution_Sample(const CCNxPingDistribution *distribution, uint64_t *randomState)
+{
+    double value = distribution->first;
+
+    switch (distribution->type) {
+        case CCNxPingDistributionType_Uniform:
+            value = distribution->first + ccnxPingDistribution_RandomUnit(randomState) * (distribution->second - distribution->first + 1.0);
+            value = value > distribution->second ? distribution->second : value;
+            break;
+        case CCNxPingDistributionType_Exponential:
+            value = -distribution->first * log(1.0 - ccnxPingDistribution_RandomUnit(randomState));
+            break;
+        case CCNxPingDistributionType_Bimodal:
+            if (ccnxPingDistribution_RandomUnit(randomState) < distribution->probability) {
+                value = distribution->second;
+            }
+            break;
+        case CCNxPingDistributionType_Constant:
+        default:
+            break;
+    }
+
+    return (uint64_t) value;
+}
+
+double
+ccnxPingDistribution_Mean(const CCNxPingDistribution *distribution)
+{
+    switch (distribution->type) {
+        case CCNxPingDistributionType_Uniform:
+            return (distribution->first + distribution->second) / 2.0;
+        case CCNxPingDistributionType_Bimodal:
+            return distribution->first * (1.0 - distribution->probability) + distribution->second * distribution->probability;
+        case CCNxPingDistributionType_Exponential:
+        case CCNxPingDistributionType_Constant:
+        default:
+            return distribution->first;
+    }
+}
+
+void
+ccnxPingDistribution_Write(const CCNxPingDistribution *distribution, FILE *output)
+{
+    switch (distribution->type) {
+        case CCNxPingDistributionType_Uniform:
+            fprintf(output, "uniform:%g:%g", distribution->first, distribution->second);
+            break;
+        case CCNxPingDistributionType_Exponential:
+            fprintf(output, "exp:%g", distribution->first);
+            break;
+        case CCNxPingDistributionType_Bimodal:
+            fprintf(output, "bimodal:%g:%g:%g", distribution->first, distribution->second, distribution->probability);
+            break;
+        case CCNxPingDistributionType_Constant:
+        default:
+            fprintf(output, "const:%g", distribution->first);
+            break;
+    }
+}
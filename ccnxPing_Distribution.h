@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Distribution_h
+#define ccnxPing_Distribution_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * The supported families of random distributions.
+ */
+typedef enum {
+    CCNxPingDistributionType_Constant = 0,
+    CCNxPingDistributionType_Uniform,
+    CCNxPingDistributionType_Exponential,
+    CCNxPingDistributionType_Bimodal
+} CCNxPingDistributionType;
+
+/**
+ * A random distribution of non-negative integer values (e.g., delays in microseconds or sizes in bytes).
+ *
+ * Distributions are parsed from a short textual specification:
+ *
+ *   const:<value>                  always <value>
+ *   uniform:<low>:<high>           uniform in [low, high]
+ *   exp:<mean>                     exponential with the given mean
+ *   bimodal:<fast>:<slow>:<p>      <slow> with probability p, <fast> otherwise
+ *
+ * A bare number is accepted as a constant.
+ */
+typedef struct ccnx_ping_distribution {
+    CCNxPingDistributionType type;
+    double first;
+    double second;
+    double probability;
+} CCNxPingDistribution;
+
+/**
+ * Initialize a distribution that always yields the given value.
+ *
+ * @param [out] distribution The `CCNxPingDistribution` to initialize.
+ * @param [in] value The constant value.
+ */
+void ccnxPingDistribution_InitConstant(CCNxPingDistribution *distribution, uint64_t value);
+
+/**
+ * Parse a distribution specification (see `CCNxPingDistribution`).
+ *
+ * @param [out] distribution The `CCNxPingDistribution` to initialize.
+ * @param [in] specification The textual specification.
+ *
+ * @retval true If the specification was valid.
+ * @retval false Otherwise, in which case `distribution` is unchanged.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingDistribution delay;
+ *     if (ccnxPingDistribution_Parse(&delay, "exp:2000")) {
+ *         uint64_t seed = 1;
+ *         uint64_t delayInUs = ccnxPingDistribution_Sample(&delay, &seed);
+ *     }
+ * }
+ * @endcode
+ */
+bool ccnxPingDistribution_Parse(CCNxPingDistribution *distribution, const char *specification);
+
+/**
+ * Draw a value from the distribution.
+ *
+ * @param [in] distribution The `CCNxPingDistribution` to sample.
+ * @param [in,out] randomState The state of the caller's random number generator (see `ccnxPingDistribution_Random`).
+ *
+ * @return A value drawn from the distribution.
+ */
+uint64_t ccnxPingDistribution_Sample(const CCNxPingDistribution *distribution, uint64_t *randomState);
+
+/**
+ * @return The expected value of the distribution.
+ */
+double ccnxPingDistribution_Mean(const CCNxPingDistribution *distribution);
+
+/**
+ * Write the specification of the distribution in the same syntax accepted by `ccnxPingDistribution_Parse`.
+ *
+ * @param [in] distribution The `CCNxPingDistribution` instance.
+ * @param [in] output The stream to write to.
+ */
+void ccnxPingDistribution_Write(const CCNxPingDistribution *distribution, FILE *output);
+
+/**
+ * Return the next value of a small, fast pseudo-random generator (xorshift64*).
+ *
+ * The generator is not suitable for cryptographic use. The state must be seeded with a non-zero value.
+ *
+ * @param [in,out] randomState The generator state.
+ *
+ * @return A uniformly distributed 64-bit value.
+ */
+uint64_t ccnxPingDistribution_Random(uint64_t *randomState);
+
+/**
+ * Return a uniformly distributed value in [0, 1) using `ccnxPingDistribution_Random`.
+ *
+ * @param [in,out] randomState The generator state.
+ *
+ * @return A value in [0, 1).
+ */
+double ccnxPingDistribution_RandomUnit(uint64_t *randomState);
+#endif // ccnxPing_Distribution_h
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <parc/algol/parc_DisplayIndented.h>
+
+#include "ccnxPing_Common.h"
+#include "ccnxPing_Histogram.h"
+
+#define _subBucketHalf (1 << (ccnxPingHistogram_PrecisionBits - 1))
+#define _largestValue ((UINT64_C(1) << ccnxPingHistogram_MaxValueBits) - 1)
+
+void
+ccnxPingHistogram_Init(CCNxPingHistogram *histogram)
+{
+    memset(histogram, 0, sizeof(CCNxPingHistogram));
+    histogram->min = UINT64_MAX;
+}
+
+size_t
+ccnxPingHistogram_BucketIndex(uint64_t value)
+{
+    if (value < (2 * _subBucketHalf)) {
+        return (size_t) value;
+    }
+    if (value > _largestValue) {
+        value = _largestValue;
+    }
+
+    // Keep the top PrecisionBits bits of the value: the shift selects the power of two
+    // and the remaining bits select the linear sub-bucket within it.
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - (ccnxPingHistogram_PrecisionBits - 1);
+    return (size_t) shift * _subBucketHalf + (size_t) (value >> shift);
+}
+
+uint64_t
+ccnxPingHistogram_BucketLowerBound(size_t index)
+{
+    if (index < (2 * _subBucketHalf)) {
+        return index;
+    }
+    size_t shift = index / _subBucketHalf - 1;
+    uint64_t mantissa = index % _subBucketHalf + _subBucketHalf;
+    return mantissa << shift;
+}
+
+uint64_t
+ccnxPingHistogram_BucketUpperBound(size_t index)
+{
+    if (index < (2 * _subBucketHalf)) {
+        return index;
+    }
+    size_t shift = index / _subBucketHalf - 1;
+    uint64_t mantissa = index % _subBucketHalf + _subBucketHalf;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+void
+ccnxPingHistogram_Record(CCNxPingHistogram *histogram, uint64_t value)
+{
+    size_t index = ccnxPingHistogram_BucketIndex(value);
+
+    ccnxPingCommon_CounterAdd(histogram->buckets[index], 1);
+    ccnxPingCommon_CounterAdd(histogram->sum, value);
+    if (value < histogram->min) {
+        ccnxPingCommon_CounterSet(histogram->min, value);
+    }
+    if (value > histogram->max) {
+        ccnxPingCommon_CounterSet(histogram->max, value);
+    }
+
+    // The count is published last so that readers never see more samples than buckets.
+    ccnxPingCommon_CounterAdd(histogram->count, 1);
+}
+
+void
+ccnxPingHistogram_Snapshot(CCNxPingHistogram *snapshot, const CCNxPingHistogram *histogram)
+{
+    snapshot->count = ccnxPingCommon_CounterGet(histogram->count);
+    snapshot->sum = ccnxPingCommon_CounterGet(histogram->sum);
+    snapshot->min = ccnxPingCommon_CounterGet(histogram->min);
+    snapshot->max = ccnxPingCommon_CounterGet(histogram->max);
+    for (size_t i = 0; i < ccnxPingHistogram_BucketCount; i++) {
+        snapshot->buckets[i] = ccnxPingCommon_CounterGet(histogram->buckets[i]);
+    }
+}
+
+void
+ccnxPingHistogram_Merge(CCNxPingHistogram *histogram, const CCNxPingHistogram *other)
+{
+    if (other->count == 0) {
+        return;
+    }
+
+    histogram->count += other->count;
+    histogram->sum += other->sum;
+    histogram->min = other->min < histogram->min ? other->min : histogram->min;
+    histogram->max = other->max > histogram->max ? other->max : histogram->max;
+    for (size_t i = 0; i < ccnxPingHistogram_BucketCount; i++) {
+        histogram->buckets[i] += other->buckets[i];
+    }
+}
+
+uint64_t
+ccnxPingHistogram_Count(const CCNxPingHistogram *histogram)
+{
+    return histogram->count;
+}
+
+uint64_t
+ccnxPingHistogram_Min(const CCNxPingHistogram *histogram)
+{
+    return histogram->count > 0 ? histogram->min : 0;
+}
+
+uint64_t
+ccnxPingHistogram_Max(const CCNxPingHistogram *histogram)
+{
+    return histogram->max;
+}
+
+double
+ccnxPingHistogram_Mean(const CCNxPingHistogram *histogram)
+{
+    return histogram->count > 0 ? (double) histogram->sum / (double) histogram->count : 0.0;
+}
+
+uint64_t
+ccnxPingHistogram_Percentile(const CCNxPingHistogram *histogram, double percentile)
+{
+    if (histogram->count == 0) {
+        return 0;
+    }
+
+    percentile = percentile < 0.0 ? 0.0 : (percentile > 100.0 ? 100.0 : percentile);
+    uint64_t rank = (uint64_t) ((percentile / 100.0) * (double) histogram->count + 0.5);
+    rank = rank == 0 ? 1 : rank;
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < ccnxPingHistogram_BucketCount; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            uint64_t value = ccnxPingHistogram_BucketUpperBound(i);
+            value = value > histogram->max ? histogram->max : value;
+            value = value < histogram->min ? histogram->min : value;
+            return value;
+        }
+    }
+    return histogram->max;
+}
+
+void
+ccnxPingHistogram_Display(const CCNxPingHistogram *histogram, int indentation, const char *label)
+{
+    parcDisplayIndented_PrintLine(indentation,
+                                  "%s: count %llu : min %llu : mean %.1f : p50 %llu : p90 %llu : p99 %llu : p99.9 %llu : max %llu",
+                                  label,
+                                  (unsigned long long) ccnxPingHistogram_Count(histogram),
+                                  (unsigned long long) ccnxPingHistogram_Min(histogram),
+                                  ccnxPingHistogram_Mean(histogram),
+                                  (unsigned long long) ccnxPingHistogram_Percentile(histogram, 50.0),
+                                  (unsigned long long) ccnxPingHistogram_Percentile(histogram, 90.0),
+                                  (unsigned long long) ccnxPingHistogram_Percentile(histogram, 99.0),
+                                  (unsigned long long) ccnxPingHistogram_Percentile(histogram, 99.9),
+                                  (unsigned long long) ccnxPingHistogram_Max(histogram));
+}
+
+void
+ccnxPingHistogram_WriteText(const CCNxPingHistogram *histogram, FILE *output)
+{
+    fprintf(output, "count %llu : min %llu : mean %.1f : p50 %llu : p90 %llu : p99 %llu : p99.9 %llu : max %llu",
+            (unsigned long long) ccnxPingHistogram_Count(histogram),
+            (unsigned long long) ccnxPingHistogram_Min(histogram),
+            ccnxPingHistogram_Mean(histogram),
+            (unsigned long long) ccnxPingHistogram_Percentile(histogram, 50.0),
+            (unsigned long long) ccnxPingHistogram_Percentile(histogram, 90.0),
+            (unsigned long long) ccnxPingHistogram_Percentile(histogram, 99.0),
+            (unsigned long long) ccnxPingHistogram_Percentile(histogram, 99.9),
+            (unsigned long long) ccnxPingHistogram_Max(histogram));
+}
+
+void
+ccnxPingHistogram_WriteJSON(const CCNxPingHistogram *histogram, FILE *output)
+{
+    fprintf(output,
+            "{\"count\":%llu,\"min\":%llu,\"mean\":%.1f,\"p50\":%llu,\"p90\":%llu,\"p99\":%llu,\"p999\":%llu,\"max\":%llu}",
+            (unsigned long long) ccnxPingHistogram_Count(histogram),
+            (unsigned long long) ccnxPingHistogram_Min(histogram),
+            ccnxPingHistogram_Mean(histogram),
+            (unsigned long long) ccnxPingHistogram_Percentile(histogram, 50.0),
+            (unsigned long long) ccnxPingHistogram_Percentile(histogram, 90.0),
+            (unsigned long long) ccnxPingHistogram_Percentile(histogram, 99.0),
+            (unsigned long long) ccnxPingHistogram_Percentile(histogram, 99.9),
+            (unsigned long long) ccnxPingHistogram_Max(histogram));
+}
+
+#define _saveFormatVersion 1
+
+bool
+ccnxPingHistogram_Save(const CCNxPingHistogram *histogram, FILE *output)
+{
+    fprintf(output, "ccnxPing-histogram %d %d %d\n", _saveFormatVersion,
+            ccnxPingHistogram_PrecisionBits, ccnxPingHistogram_MaxValueBits);
+    fprintf(output, "%" PRIu64 " %" PRIu64 " %" PRIu64 " %" PRIu64 "\n",
+            histogram->count, histogram->sum, ccnxPingHistogram_Min(histogram), histogram->max);
+    for (size_t i = 0; i < ccnxPingHistogram_BucketCount; i++) {
+        if (histogram->buckets[i] > 0) {
+            fprintf(output, "%zu %" PRIu64 "\n", i, histogram->buckets[i]);
+        }
+    }
+    return !ferror(output);
+}
+
+bool
+ccnxPingHistogram_Load(CCNxPingHistogram *histogram, FILE *input)
+{
+    ccnxPingHistogram_Init(histogram);
+
+    int version;
+    int precisionBits;
+    int maxValueBits;
+    if (fscanf(input, "ccnxPing-histogram %d %d %d", &version, &precisionBits, &maxValueBits) != 3
+        || version != _saveFormatVersion
+        || precisionBits != ccnxPingHistogram_PrecisionBits
+        || maxValueBits != ccnxPingHistogram_MaxValueBits) {
+        return false;
+    }
+
+    uint64_t count;
+    uint64_t min;
+    if (fscanf(input, "%" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64, &count, &histogram->sum, &min, &histogram->max) != 4) {
+        ccnxPingHistogram_Init(histogram);
+        return false;
+    }
+
+    size_t index;
+    uint64_t bucketCount;
+    uint64_t total = 0;
+    while (fscanf(input, "%zu %" SCNu64, &index, &bucketCount) == 2) {
+        if (index >= ccnxPingHistogram_BucketCount) {
+            ccnxPingHistogram_Init(histogram);
+            return false;
+        }
+        histogram->buckets[index] += bucketCount;
+        total += bucketCount;
+    }
+
+    if (total != count) {
+        ccnxPingHistogram_Init(histogram);
+        return false;
+    }
+    histogram->count = count;
+    histogram->min = count > 0 ? min : UINT64_MAX;
+    return true;
+}
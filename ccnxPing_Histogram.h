@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Histogram_h
+#define ccnxPing_Histogram_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * Each power of two is split into 2^(ccnxPingHistogram_PrecisionBits - 1) linear sub-buckets.
+ * With five bits that is 16, so a bucket is at most 1/16 of its values wide: the relative error
+ * of any recorded value is bounded by 6.25%.
+ */
+#define ccnxPingHistogram_PrecisionBits 5
+
+/**
+ * Values at or above 2^ccnxPingHistogram_MaxValueBits are clamped into the last bucket.
+ * In microseconds this is a little over 19 hours.
+ */
+#define ccnxPingHistogram_MaxValueBits 36
+
+/**
+ * The number of buckets in a `CCNxPingHistogram`.
+ */
+#define ccnxPingHistogram_BucketCount \
+    (((ccnxPingHistogram_MaxValueBits - ccnxPingHistogram_PrecisionBits) + 2) << (ccnxPingHistogram_PrecisionBits - 1))
+
+/**
+ * A fixed-size log-linear histogram of unsigned values (e.g., latencies in microseconds).
+ *
+ * The structure is plain data so that it can be embedded in other structures or placed
+ * in shared memory. It has a single writer: `ccnxPingHistogram_Record` issues no locked
+ * instructions, but every store is atomic so that other threads may take a consistent
+ * enough `ccnxPingHistogram_Snapshot` at any time.
+ */
+typedef struct ccnx_ping_histogram {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[ccnxPingHistogram_BucketCount];
+} CCNxPingHistogram;
+
+/**
+ * Reset a `CCNxPingHistogram` to the empty state.
+ *
+ * @param [in] histogram The `CCNxPingHistogram` to initialize.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingHistogram histogram;
+ *     ccnxPingHistogram_Init(&histogram);
+ * }
+ * @endcode
+ */
+void ccnxPingHistogram_Init(CCNxPingHistogram *histogram);
+
+/**
+ * Return the index of the bucket that holds the given value.
+ *
+ * @param [in] value The value to locate.
+ *
+ * @return The bucket index, in the range [0, ccnxPingHistogram_BucketCount).
+ */
+size_t ccnxPingHistogram_BucketIndex(uint64_t value);
+
+/**
+ * Return the smallest value that maps to the bucket at the given index.
+ *
+ * @param [in] index The bucket index.
+ *
+ * @return The lower bound (inclusive) of the bucket.
+ */
+uint64_t ccnxPingHistogram_BucketLowerBound(size_t index);
+
+/**
+ * Return the largest value that maps to the bucket at the given index.
+ *
+ * @param [in] index The bucket index.
+ *
+ * @return The upper bound (inclusive) of the bucket.
+ */
+uint64_t ccnxPingHistogram_BucketUpperBound(size_t index);
+
+/**
+ * Record a single value.
+ *
+ * @param [in] histogram The `CCNxPingHistogram` instance.
+ * @param [in] value The value to record.
+ */
+void ccnxPingHistogram_Record(CCNxPingHistogram *histogram, uint64_t value);
+
+/**
+ * Copy a histogram that may be concurrently updated by its writer.
+ *
+ * @param [out] snapshot The destination `CCNxPingHistogram`.
+ * @param [in] histogram The source `CCNxPingHistogram`.
+ */
+void ccnxPingHistogram_Snapshot(CCNxPingHistogram *snapshot, const CCNxPingHistogram *histogram);
+
+/**
+ * Add the contents of `other` into `histogram`.
+ *
+ * @param [in,out] histogram The `CCNxPingHistogram` to accumulate into.
+ * @param [in] other The `CCNxPingHistogram` to add.
+ */
+void ccnxPingHistogram_Merge(CCNxPingHistogram *histogram, const CCNxPingHistogram *other);
+
+/**
+ * @return The number of values recorded in the histogram.
+ */
+uint64_t ccnxPingHistogram_Count(const CCNxPingHistogram *histogram);
+
+/**
+ * @return The smallest value recorded in the histogram, or 0 if it is empty.
+ */
+uint64_t ccnxPingHistogram_Min(const CCNxPingHistogram *histogram);
+
+/**
+ * @return The largest value recorded in the histogram, or 0 if it is empty.
+ */
+uint64_t ccnxPingHistogram_Max(const CCNxPingHistogram *histogram);
+
+/**
+ * @return The mean of the values recorded in the histogram, or 0 if it is empty.
+ */
+double ccnxPingHistogram_Mean(const CCNxPingHistogram *histogram);
+
+/**
+ * Return the value at the given percentile.
+ *
+ * The result is the upper bound of the bucket containing the percentile, clamped to
+ * the observed minimum and maximum.
+ *
+ * @param [in] histogram The `CCNxPingHistogram` instance.
+ * @param [in] percentile The percentile, in the range [0, 100].
+ *
+ * @return The value at the percentile, or 0 if the histogram is empty.
+ *
+ * Example
+ * @code
+ * {
+ *     uint64_t p99 = ccnxPingHistogram_Percentile(&histogram, 99.0);
+ * }
+ * @endcode
+ */
+uint64_t ccnxPingHistogram_Percentile(const CCNxPingHistogram *histogram, double percentile);
+
+/**
+ * Display a one-line summary (count, min, mean, percentiles and max) of the histogram.
+ *
+ * @param [in] histogram The `CCNxPingHistogram` instance.
+ * @param [in] indentation The indentation level passed to `parcDisplayIndented_PrintLine`.
+ * @param [in] label A label (including the unit) printed in front of the summary.
+ */
+void ccnxPingHistogram_Display(const CCNxPingHistogram *histogram, int indentation, const char *label);
+
+/**
+ * Write the same one-line summary as `ccnxPingHistogram_Display` to a stream, without a newline.
+ *
+ * @param [in] histogram The `CCNxPingHistogram` instance.
+ * @param [in] output The stream to write to.
+ */
+void ccnxPingHistogram_WriteText(const CCNxPingHistogram *histogram, FILE *output);
+
+/**
+ * Write the summary of the histogram as a JSON object.
+ *
+ * @param [in] histogram The `CCNxPingHistogram` instance.
+ * @param [in] output The stream to write to.
+ */
+void ccnxPingHistogram_WriteJSON(const CCNxPingHistogram *histogram, FILE *output);
+
+/**
+ * Save the complete histogram, every non-empty bucket included, in a text format that
+ * `ccnxPingHistogram_Load` reads back without loss:
+ *
+ *   ccnxPing-histogram 1 <precision bits> <max value bits>
+ *   <count> <sum> <min> <max>
+ *   <bucket index> <bucket count>
+ *   ...
+ *
+ * @param [in] histogram The `CCNxPingHistogram` instance.
+ * @param [in] output The stream to write to.
+ *
+ * @retval true If the histogram was written.
+ * @retval false Otherwise
+ */
+bool ccnxPingHistogram_Save(const CCNxPingHistogram *histogram, FILE *output);
+
+/**
+ * Load a histogram written by `ccnxPingHistogram_Save` with the same bucket layout.
+ *
+ * @param [out] histogram The `CCNxPingHistogram` to fill.
+ * @param [in] input The stream to read from.
+ *
+ * @retval true If a valid histogram was read.
+ * @retval false Otherwise, in which case `histogram` is empty.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingHistogram histogram;
+ *     FILE *input = fopen("rtt.hist", "r");
+ *     if (input != NULL && ccnxPingHistogram_Load(&histogram, input)) {
+ *         printf("p99 = %llu us\n", (unsigned long long) ccnxPingHistogram_Percentile(&histogram, 99.0));
+ *     }
+ * }
+ * @endcode
+ */
+bool ccnxPingHistogram_Load(CCNxPingHistogram *histogram, FILE *input);
+#endif // ccnxPing_Histogram_h
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <malloc.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "ccnxPing_Isolation.h"
+
+/**
+ * The heap grown and touched up front, so that tables growing during a run reuse resident memory.
+ */
+#define _heapReserveBytes (64 * 1024 * 1024)
+
+/**
+ * The stack touched up front.
+ */
+#define _stackReserveBytes (256 * 1024)
+
+/**
+ * The `SCHED_FIFO` priority of the hot loop; workers run one below it.
+ */
+#define _hotLoopPriority 50
+
+void
+ccnxPingIsolation_Init(CCNxPingIsolation *isolation)
+{
+    isolation->enabled = false;
+    isolation->cpuCount = 0;
+    isolation->workerCount = 0;
+}
+
+bool
+ccnxPingIsolation_Parse(CCNxPingIsolation *isolation, const char *cpuList)
+{
+    isolation->enabled = true;
+    isolation->cpuCount = 0;
+
+    const char *cursor = cpuList;
+    while (cursor != NULL && *cursor != '\0') {
+        char *end = NULL;
+        long first = strtol(cursor, &end, 10);
+        long last = first;
+        if (end == cursor || first < 0) {
+            return false;
+        }
+        if (*end == '-') {
+            cursor = end + 1;
+            last = strtol(cursor, &end, 10);
+            if (end == cursor || last < first) {
+                return false;
+            }
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            if (isolation->cpuCount == ccnxPingIsolation_MaxCpus || cpu >= CPU_SETSIZE) {
+                return false;
+            }
+            isolation->cpus[isolation->cpuCount++] = (int) cpu;
+        }
+        if (*end == ',') {
+            end++;
+        } else if (*end != '\0') {
+            return false;
+        }
+        cursor = end;
+    }
+    return true;
+}
+
+static bool
+_ccnxPingIsolation_Report(FILE *report, bool succeeded, int error, const char *step)
+{
+    if (succeeded) {
+        fprintf(report, "Isolation: %s: ok\n", step);
+    } else {
+        fprintf(report, "Isolation: %s: failed (%s)\n", step, strerror(error));
+    }
+    return succeeded;
+}
+
+static bool
+_ccnxPingIsolation_Pin(pthread_t thread, int cpu, const char *role, FILE *report)
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    int error = pthread_setaffinity_np(thread, sizeof(cpuSet), &cpuSet);
+
+    char step[128];
+    snprintf(step, sizeof(step), "pin the %s to CPU %d", role, cpu);
+    return _ccnxPingIsolation_Report(report, error == 0, error, step);
+}
+
+static bool
+_ccnxPingIsolation_SetFifo(pthread_t thread, int priority, const char *role, FILE *report)
+{
+    struct sched_param parameters = { .sched_priority = priority };
+    int error = pthread_setschedparam(thread, SCHED_FIFO, &parameters);
+
+    char step[128];
+    snprintf(step, sizeof(step), "run the %s as SCHED_FIFO priority %d", role, priority);
+    return _ccnxPingIsolation_Report(report, error == 0, error, step);
+}
+
+/**
+ * Touch the stack below the caller. Not inlined, so that the frame really is allocated.
+ */
+static void __attribute__((noinline))
+_ccnxPingIsolation_PrefaultStack(void)
+{
+    volatile uint8_t stack[_stackReserveBytes];
+    for (size_t i = 0; i < sizeof(stack); i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+bool
+ccnxPingIsolation_ApplyToProcess(CCNxPingIsolation *isolation, FILE *report)
+{
+    if (!isolation->enabled) {
+        return true;
+    }
+
+    bool result = true;
+    if (isolation->cpuCount > 0) {
+        result &= _ccnxPingIsolation_Pin(pthread_self(), isolation->cpus[0], "hot loop", report);
+    } else {
+        fprintf(report, "Isolation: no CPU list: threads are not pinned\n");
+    }
+
+    int error = mlockall(MCL_CURRENT | MCL_FUTURE) == 0 ? 0 : errno;
+    result &= _ccnxPingIsolation_Report(report, error == 0, error, "lock current and future memory");
+
+    // Keep freed memory in the process: returning it to the kernel would fault it in again later.
+    bool tuned = mallopt(M_TRIM_THRESHOLD, -1) == 1 && mallopt(M_MMAP_MAX, 0) == 1;
+    result &= _ccnxPingIsolation_Report(report, tuned, EINVAL, "keep freed heap memory resident");
+
+    volatile uint8_t *reserve = malloc(_heapReserveBytes);
+    if (reserve != NULL) {
+        for (size_t i = 0; i < _heapReserveBytes; i += 4096) {
+            reserve[i] = 0;
+        }
+        free((void *) reserve);
+    }
+    _ccnxPingIsolation_PrefaultStack();
+    result &= _ccnxPingIsolation_Report(report, reserve != NULL, ENOMEM, "prefault the heap reserve and the stack");
+
+    result &= _ccnxPingIsolation_SetFifo(pthread_self(), _hotLoopPriority, "hot loop", report);
+
+    return result;
+}
+
+bool
+ccnxPingIsolation_ApplyToThread(CCNxPingIsolation *isolation, pthread_t thread, const char *role, FILE *report)
+{
+    if (!isolation->enabled) {
+        return true;
+    }
+
+    bool result = true;
+    if (isolation->cpuCount > 1) {
+        int cpu = isolation->cpus[1 + isolation->workerCount % (isolation->cpuCount - 1)];
+        result &= _ccnxPingIsolation_Pin(thread, cpu, role, report);
+    } else {
+        fprintf(report, "Isolation: no spare CPU in the list: the %s is not pinned\n", role);
+    }
+    isolation->workerCount++;
+
+    result &= _ccnxPingIsolation_SetFifo(thread, _hotLoopPriority - 1, role, report);
+    return result;
+}
+
+void
+ccnxPingIsolation_Prefault(const void *address, size_t length)
+{
+    static size_t pageSize;
+    if (pageSize == 0) {
+        pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    }
+
+    const volatile uint8_t *bytes = address;
+    uint8_t sink = 0;
+    for (size_t offset = 0; offset < length; offset += pageSize) {
+        sink ^= bytes[offset];
+    }
+    if (length > 0) {
+        sink ^= bytes[length - 1];
+    }
+    (void) sink;
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Isolation_h
+#define ccnxPing_Isolation_h
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * The largest number of CPUs in an isolation CPU list.
+ */
+#define ccnxPingIsolation_MaxCpus 256
+
+/**
+ * Shields a measuring process from the sources of jitter that are not the network stack:
+ * migrations between CPUs, page faults and preemption by other processes.
+ *
+ * Isolating the process pins the calling (hot-loop) thread to the first CPU of the list, locks all
+ * current and future memory with `mlockall`, stops the allocator from returning memory to the kernel,
+ * prefaults a heap reserve and the stack, and requests `SCHED_FIFO`. Worker threads are then pinned
+ * round-robin to the remaining CPUs of the list. Every step is attempted even if an earlier one failed
+ * (e.g., for lack of `CAP_IPC_LOCK` or `CAP_SYS_NICE`), and its outcome is reported.
+ *
+ * Threads created before the process is isolated (such as those of the transport stack) keep their
+ * affinity and scheduling policy.
+ */
+typedef struct ccnx_ping_isolation {
+    bool enabled;
+    size_t cpuCount;
+    int cpus[ccnxPingIsolation_MaxCpus];
+    size_t workerCount;
+} CCNxPingIsolation;
+
+/**
+ * Initialize a disabled `CCNxPingIsolation`.
+ *
+ * @param [out] isolation The `CCNxPingIsolation` to initialize.
+ */
+void ccnxPingIsolation_Init(CCNxPingIsolation *isolation);
+
+/**
+ * Enable isolation on the given CPUs.
+ *
+ * @param [in,out] isolation The `CCNxPingIsolation` to update.
+ * @param [in] cpuList A list of CPUs such as `2,4-7`: the hot loop runs on the first and worker
+ *             threads on the others. NULL or an empty string leaves all threads unpinned.
+ *
+ * @retval true If the list was valid.
+ * @retval false Otherwise
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingIsolation isolation;
+ *     ccnxPingIsolation_Init(&isolation);
+ *     ccnxPingIsolation_Parse(&isolation, "2,3");
+ *     ...
+ *     ccnxPingIsolation_ApplyToProcess(&isolation, stdout);
+ *     ccnxPingIsolation_ApplyToThread(&isolation, workerThread, "signing worker 0", stdout);
+ * }
+ * @endcode
+ */
+bool ccnxPingIsolation_Parse(CCNxPingIsolation *isolation, const char *cpuList);
+
+/**
+ * Isolate the calling thread, which runs the hot loop, and lock and prefault the memory of the process.
+ * Does nothing if isolation is not enabled.
+ *
+ * @param [in,out] isolation The `CCNxPingIsolation` instance.
+ * @param [in] report The stream to which the outcome of every step is written.
+ *
+ * @retval true If every step succeeded.
+ * @retval false Otherwise
+ */
+bool ccnxPingIsolation_ApplyToProcess(CCNxPingIsolation *isolation, FILE *report);
+
+/**
+ * Pin a worker thread to the next of the remaining CPUs and request `SCHED_FIFO` for it, one priority
+ * below the hot loop. Does nothing if isolation is not enabled.
+ *
+ * @param [in,out] isolation The `CCNxPingIsolation` instance.
+ * @param [in] thread The worker thread.
+ * @param [in] role A description of the thread for the report.
+ * @param [in] report The stream to which the outcome of every step is written.
+ *
+ * @retval true If every step succeeded.
+ * @retval false Otherwise
+ */
+bool ccnxPingIsolation_ApplyToThread(CCNxPingIsolation *isolation, pthread_t thread, const char *role, FILE *report);
+
+/**
+ * Read every page of a memory region, such as a mapped payload, so that later reads do not fault.
+ *
+ * @param [in] address The start of the region.
+ * @param [in] length The length of the region (in bytes).
+ */
+void ccnxPingIsolation_Prefault(const void *address, size_t length);
+#endif // ccnxPing_Isolation_h
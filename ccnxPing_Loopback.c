@@ -0,0 +1,513 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include <ccnx/common/ccnx_ContentObject.h>
+#include <ccnx/common/ccnx_Interest.h>
+#include <ccnx/common/ccnx_NameSegment.h>
+
+#include "ccnxPing_Chunked.h"
+#include "ccnxPing_Common.h"
+#include "ccnxPing_Loopback.h"
+#include "ccnxPing_Timestamp.h"
+
+#define _defaultObjectSize (16 * 1024 * 1024)
+#define _defaultChunkSize 8192
+#define _defaultReorderDelayInUs 1000
+
+/**
+ * A message in flight on a link, ordered by delivery time and then by sending order.
+ */
+typedef struct ccnx_ping_loopback_entry {
+    uint64_t deliveryTimeInUs;
+    uint64_t sequence;
+    CCNxMetaMessage *message;
+} _CCNxPingLoopbackEntry;
+
+/**
+ * One direction of the loopback: a delay queue (a binary min-heap) shared by a sender and a receiver.
+ */
+typedef struct ccnx_ping_loopback_link {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    bool closed;
+
+    _CCNxPingLoopbackEntry *heap;
+    size_t size;
+    size_t capacity;
+    uint64_t sequence;
+
+    const CCNxPingImpairment *impairment;
+    uint64_t randomState;
+
+    uint64_t dropped;
+    uint64_t duplicated;
+    uint64_t reordered;
+} _CCNxPingLoopbackLink;
+
+struct ccnx_ping_loopback {
+    CCNxPingLoopbackOptions options;
+    CCNxName *prefix;
+    size_t sizeIndex;
+
+    _CCNxPingLoopbackLink toResponder;
+    _CCNxPingLoopbackLink toClient;
+    pthread_t responder;
+    bool responderStarted;
+};
+
+static bool
+_ccnxPingLoopbackEntry_Before(const _CCNxPingLoopbackEntry *a, const _CCNxPingLoopbackEntry *b)
+{
+    if (a->deliveryTimeInUs != b->deliveryTimeInUs) {
+        return a->deliveryTimeInUs < b->deliveryTimeInUs;
+    }
+    return a->sequence < b->sequence;
+}
+
+static void
+_ccnxPingLoopbackLink_Init(_CCNxPingLoopbackLink *link, const CCNxPingImpairment *impairment, uint64_t seed)
+{
+    pthread_mutex_init(&link->lock, NULL);
+
+    // Deadlines are computed on the monotonic clock, so the condition variable must use it too.
+    pthread_condattr_t attributes;
+    pthread_condattr_init(&attributes);
+    pthread_condattr_setclock(&attributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&link->changed, &attributes);
+    pthread_condattr_destroy(&attributes);
+
+    link->closed = false;
+    link->heap = NULL;
+    link->size = 0;
+    link->capacity = 0;
+    link->sequence = 0;
+    link->impairment = impairment;
+    link->randomState = seed | 1;
+    link->dropped = 0;
+    link->duplicated = 0;
+    link->reordered = 0;
+}
+
+static void
+_ccnxPingLoopbackLink_Fini(_CCNxPingLoopbackLink *link)
+{
+    for (size_t i = 0; i < link->size; i++) {
+        ccnxMetaMessage_Release(&link->heap[i].message);
+    }
+    free(link->heap);
+    pthread_cond_destroy(&link->changed);
+    pthread_mutex_destroy(&link->lock);
+}
+
+static void
+_ccnxPingLoopbackLink_Close(_CCNxPingLoopbackLink *link)
+{
+    pthread_mutex_lock(&link->lock);
+    link->closed = true;
+    pthread_cond_broadcast(&link->changed);
+    pthread_mutex_unlock(&link->lock);
+}
+
+/**
+ * Add a message to the heap. Called with the lock held.
+ */
+static void
+_ccnxPingLoopbackLink_Push(_CCNxPingLoopbackLink *link, const CCNxMetaMessage *message, uint64_t deliveryTimeInUs)
+{
+    if (link->size == link->capacity) {
+        link->capacity = link->capacity == 0 ? 256 : link->capacity * 2;
+        link->heap = realloc(link->heap, link->capacity * sizeof(_CCNxPingLoopbackEntry));
+    }
+
+    _CCNxPingLoopbackEntry entry = {
+        .deliveryTimeInUs = deliveryTimeInUs,
+        .sequence         = link->sequence++,
+        .message          = ccnxMetaMessage_Acquire(message)
+    };
+
+    size_t index = link->size++;
+    while (index > 0 && _ccnxPingLoopbackEntry_Before(&entry, &link->heap[(index - 1) / 2])) {
+        link->heap[index] = link->heap[(index - 1) / 2];
+        index = (index - 1) / 2;
+    }
+    link->heap[index] = entry;
+}
+
+/**
+ * Remove the earliest message from the heap. Called with the lock held.
+ */
+static CCNxMetaMessage *
+_ccnxPingLoopbackLink_Pop(_CCNxPingLoopbackLink *link)
+{
+    CCNxMetaMessage *message = link->heap[0].message;
+    _CCNxPingLoopbackEntry last = link->heap[--link->size];
+
+    size_t index = 0;
+    while (true) {
+        size_t child = 2 * index + 1;
+        if (child >= link->size) {
+            break;
+        }
+        if (child + 1 < link->size && _ccnxPingLoopbackEntry_Before(&link->heap[child + 1], &link->heap[child])) {
+            child++;
+        }
+        if (!_ccnxPingLoopbackEntry_Before(&link->heap[child], &last)) {
+            break;
+        }
+        link->heap[index] = link->heap[child];
+        index = child;
+    }
+    if (link->size > 0) {
+        link->heap[index] = last;
+    }
+    return message;
+}
+
+static bool
+_ccnxPingLoopbackLink_Send(_CCNxPingLoopbackLink *link, const CCNxMetaMessage *message)
+{
+    const CCNxPingImpairment *impairment = link->impairment;
+
+    pthread_mutex_lock(&link->lock);
+    bool result = !link->closed;
+    if (result) {
+        if (ccnxPingDistribution_RandomUnit(&link->randomState) < impairment->lossProbability) {
+            link->dropped++;
+        } else {
+            uint64_t nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+            uint64_t deliveryTimeInUs = nowInUs + ccnxPingDistribution_Sample(&impairment->delay, &link->randomState);
+            if (ccnxPingDistribution_RandomUnit(&link->randomState) < impairment->reorderProbability) {
+                deliveryTimeInUs += impairment->reorderDelayInUs;
+                link->reordered++;
+            }
+            _ccnxPingLoopbackLink_Push(link, message, deliveryTimeInUs);
+
+            if (ccnxPingDistribution_RandomUnit(&link->randomState) < impairment->duplicateProbability) {
+                uint64_t duplicateTimeInUs = nowInUs + ccnxPingDistribution_Sample(&impairment->delay, &link->randomState);
+                _ccnxPingLoopbackLink_Push(link, message, duplicateTimeInUs);
+                link->duplicated++;
+            }
+            pthread_cond_signal(&link->changed);
+        }
+    }
+    pthread_mutex_unlock(&link->lock);
+
+    return result;
+}
+
+static struct timespec
+_ccnxPingLoopback_ToTimespec(uint64_t timeInUs)
+{
+    struct timespec result;
+    result.tv_sec = (time_t) (timeInUs / 1000000);
+    result.tv_nsec = (long) (timeInUs % 1000000) * 1000;
+    return result;
+}
+
+static CCNxMetaMessage *
+_ccnxPingLoopbackLink_Receive(_CCNxPingLoopbackLink *link, const uint64_t *timeoutInUs)
+{
+    uint64_t deadlineInUs = timeoutInUs != NULL ? ccnxPingCommon_MonotonicTimeInUs() + *timeoutInUs : UINT64_MAX;
+    CCNxMetaMessage *message = NULL;
+
+    pthread_mutex_lock(&link->lock);
+    while (!link->closed) {
+        uint64_t nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+        if (link->size > 0 && link->heap[0].deliveryTimeInUs <= nowInUs) {
+            message = _ccnxPingLoopbackLink_Pop(link);
+            break;
+        }
+        if (nowInUs >= deadlineInUs) {
+            break;
+        }
+
+        uint64_t wakeupInUs = deadlineInUs;
+        if (link->size > 0 && link->heap[0].deliveryTimeInUs < wakeupInUs) {
+            wakeupInUs = link->heap[0].deliveryTimeInUs;
+        }
+        if (wakeupInUs == UINT64_MAX) {
+            pthread_cond_wait(&link->changed, &link->lock);
+        } else {
+            struct timespec wakeup = _ccnxPingLoopback_ToTimespec(wakeupInUs);
+            pthread_cond_timedwait(&link->changed, &link->lock, &wakeup);
+        }
+    }
+    pthread_mutex_unlock(&link->lock);
+
+    return message;
+}
+
+/**
+ * Build the response to an interest the way `ccnxPing_Server` does.
+ */
+static CCNxMetaMessage *
+_ccnxPingLoopback_BuildResponse(CCNxPingLoopback *loopback, const CCNxName *name)
+{
+    if (ccnxName_GetSegmentCount(name) <= loopback->sizeIndex || !ccnxName_StartsWith(name, loopback->prefix)) {
+        return NULL;
+    }
+
+    PARCBuffer *payload = NULL;
+    bool isChunk = false;
+    uint64_t chunkCount = 0;
+    uint64_t chunkNumber = 0;
+
+    if (ccnxPingChunked_GetChunkNumber(name, loopback->sizeIndex, &chunkNumber)) {
+        chunkCount = ccnxPingChunked_ChunkCount(loopback->options.objectSize, loopback->options.chunkSize);
+        if (chunkNumber >= chunkCount) {
+            return NULL;
+        }
+        size_t length = ccnxPingChunked_ChunkLength(loopback->options.objectSize, loopback->options.chunkSize, chunkNumber);
+        payload = ccnxPingChunked_CreatePayload(chunkNumber * loopback->options.chunkSize, length);
+        isChunk = true;
+    } else {
+        size_t size = 0;
+        ccnxPingCommon_GetPayloadSize(name, loopback->sizeIndex, &size);
+        if (loopback->options.echoTimestamps && size >= ccnxPingTimestamp_HeaderLength) {
+            // The pattern payload wraps a shared table, so the header that the responder fills in
+            // goes into a private copy, followed by the pattern as `ccnxPing_Server --echo` does.
+            PARCBuffer *content = ccnxPingChunked_CreatePayload(0, size - ccnxPingTimestamp_HeaderLength);
+            payload = parcBuffer_Allocate(ccnxPingTimestamp_HeaderLength + parcBuffer_Remaining(content));
+            ccnxPingTimestamp_Reserve(payload);
+            parcBuffer_PutArray(payload, parcBuffer_Remaining(content), parcBuffer_Overlay(content, 0));
+            parcBuffer_Flip(payload);
+            parcBuffer_Release(&content);
+        } else {
+            payload = ccnxPingChunked_CreatePayload(0, size);
+        }
+    }
+
+    CCNxContentObject *contentObject = ccnxContentObject_CreateWithNameAndPayload(name, payload);
+    if (isChunk) {
+        ccnxContentObject_SetFinalChunkNumber(contentObject, chunkCount - 1);
+    }
+    CCNxMetaMessage *response = ccnxMetaMessage_CreateFromContentObject(contentObject);
+    ccnxContentObject_Release(&contentObject);
+    parcBuffer_Release(&payload);
+
+    return response;
+}
+
+static void *
+_ccnxPingLoopback_Responder(void *arg)
+{
+    CCNxPingLoopback *loopback = arg;
+
+    CCNxMetaMessage *request = NULL;
+    while ((request = _ccnxPingLoopbackLink_Receive(&loopback->toResponder, NULL)) != NULL) {
+        uint64_t receiveTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+        CCNxInterest *interest = ccnxMetaMessage_GetInterest(request);
+        if (interest != NULL) {
+            CCNxMetaMessage *response = _ccnxPingLoopback_BuildResponse(loopback, ccnxInterest_GetName(interest));
+            if (response != NULL) {
+                if (loopback->options.echoTimestamps) {
+                    PARCBuffer *payload = ccnxContentObject_GetPayload(ccnxMetaMessage_GetContentObject(response));
+                    uint64_t sendTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+                    ccnxPingTimestamp_SetReceived(payload, receiveTimeInUs, sendTimeInUs - receiveTimeInUs);
+                    ccnxPingTimestamp_SetSent(payload, sendTimeInUs);
+                }
+                _ccnxPingLoopbackLink_Send(&loopback->toClient, response);
+                ccnxMetaMessage_Release(&response);
+            }
+        }
+        ccnxMetaMessage_Release(&request);
+    }
+
+    return NULL;
+}
+
+static bool
+_ccnxPingLoopback_Destructor(CCNxPingLoopback **loopbackPtr)
+{
+    CCNxPingLoopback *loopback = *loopbackPtr;
+
+    _ccnxPingLoopbackLink_Close(&loopback->toResponder);
+    _ccnxPingLoopbackLink_Close(&loopback->toClient);
+    if (loopback->responderStarted) {
+        pthread_join(loopback->responder, NULL);
+    }
+
+    _ccnxPingLoopbackLink_Fini(&loopback->toResponder);
+    _ccnxPingLoopbackLink_Fini(&loopback->toClient);
+    ccnxName_Release(&loopback->prefix);
+    return true;
+}
+
+parcObject_Override(CCNxPingLoopback, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingLoopback_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingLoopback, CCNxPingLoopback);
+parcObject_ImplementRelease(ccnxPingLoopback, CCNxPingLoopback);
+
+void
+ccnxPingLoopbackOptions_Init(CCNxPingLoopbackOptions *options)
+{
+    ccnxPingDistribution_InitConstant(&options->impairment.delay, 0);
+    options->impairment.lossProbability = 0.0;
+    options->impairment.duplicateProbability = 0.0;
+    options->impairment.reorderProbability = 0.0;
+    options->impairment.reorderDelayInUs = _defaultReorderDelayInUs;
+    options->objectSize = _defaultObjectSize;
+    options->chunkSize = _defaultChunkSize;
+    options->seed = 1;
+    options->echoTimestamps = false;
+}
+
+bool
+ccnxPingLoopbackOptions_Parse(CCNxPingLoopbackOptions *options, const char *specification)
+{
+    CCNxPingLoopbackOptions result = *options;
+    char *fields = parcMemory_StringDuplicate(specification, strlen(specification));
+    char *cursor = fields;
+    bool valid = true;
+
+    char *field = NULL;
+    while (valid && (field = strsep(&cursor, ",")) != NULL) {
+        if (*field == '\0') {
+            continue;
+        } else if (strncmp(field, "delay=", 6) == 0) {
+            valid = ccnxPingDistribution_Parse(&result.impairment.delay, field + 6);
+        } else if (strncmp(field, "loss=", 5) == 0) {
+            valid = sscanf(field + 5, "%lf", &result.impairment.lossProbability) == 1;
+        } else if (strncmp(field, "dup=", 4) == 0) {
+            valid = sscanf(field + 4, "%lf", &result.impairment.duplicateProbability) == 1;
+        } else if (strncmp(field, "reorder=", 8) == 0) {
+            valid = sscanf(field + 8, "%lf:%" SCNu64, &result.impairment.reorderProbability,
+                           &result.impairment.reorderDelayInUs) >= 1;
+        } else if (strncmp(field, "object=", 7) == 0) {
+            valid = sscanf(field + 7, "%" SCNu64, &result.objectSize) == 1;
+        } else if (strncmp(field, "chunk=", 6) == 0) {
+            valid = sscanf(field + 6, "%zu", &result.chunkSize) == 1
+                    && result.chunkSize > 0 && result.chunkSize <= ccnxPing_MaxPayloadSize;
+        } else if (strncmp(field, "seed=", 5) == 0) {
+            valid = sscanf(field + 5, "%" SCNu64, &result.seed) == 1;
+        } else if (strcmp(field, "echo") == 0) {
+            result.echoTimestamps = true;
+        } else {
+            valid = false;
+        }
+    }
+    parcMemory_Deallocate(&fields);
+
+    if (valid) {
+        *options = result;
+    }
+    return valid;
+}
+
+CCNxPingLoopback *
+ccnxPingLoopback_Create(const CCNxName *prefix, const CCNxPingLoopbackOptions *options)
+{
+    CCNxPingLoopback *loopback = parcObject_CreateInstance(CCNxPingLoopback);
+
+    loopback->options = *options;
+    loopback->prefix = ccnxName_Acquire(prefix);
+    loopback->sizeIndex = ccnxName_GetSegmentCount(prefix) + 1;
+    _ccnxPingLoopbackLink_Init(&loopback->toResponder, &loopback->options.impairment, options->seed);
+    _ccnxPingLoopbackLink_Init(&loopback->toClient, &loopback->options.impairment, options->seed * 0x9E3779B97F4A7C15ULL);
+
+    loopback->responderStarted = pthread_create(&loopback->responder, NULL, _ccnxPingLoopback_Responder, loopback) == 0;
+    if (!loopback->responderStarted) {
+        fprintf(stderr, "Unable to start the loopback responder\n");
+        ccnxPingLoopback_Release(&loopback);
+    }
+
+    return loopback;
+}
+
+bool
+ccnxPingLoopback_Send(CCNxPingLoopback *loopback, const CCNxMetaMessage *message)
+{
+    return _ccnxPingLoopbackLink_Send(&loopback->toResponder, message);
+}
+
+CCNxMetaMessage *
+ccnxPingLoopback_Receive(CCNxPingLoopback *loopback, const uint64_t *timeoutInUs)
+{
+    return _ccnxPingLoopbackLink_Receive(&loopback->toClient, timeoutInUs);
+}
+
+void
+ccnxPingLoopback_WriteCounters(const CCNxPingLoopback *loopback, FILE *output)
+{
+    CCNxPingLoopback *mutableLoopback = (CCNxPingLoopback *) loopback;
+    _CCNxPingLoopbackLink *links[] = { &mutableLoopback->toResponder, &mutableLoopback->toClient };
+
+    uint64_t dropped = 0;
+    uint64_t duplicated = 0;
+    uint64_t reordered = 0;
+    for (size_t i = 0; i < sizeof(links) / sizeof(links[0]); i++) {
+        pthread_mutex_lock(&links[i]->lock);
+        dropped += links[i]->dropped;
+        duplicated += links[i]->duplicated;
+        reordered += links[i]->reordered;
+        pthread_mutex_unlock(&links[i]->lock);
+    }
+
+    fprintf(output, "Loopback dropped = %" PRIu64 " : duplicated = %" PRIu64 " : reordered = %" PRIu64 "\n",
+            dropped, duplicated, reordered);
+}
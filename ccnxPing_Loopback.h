@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Loopback_h
+#define ccnxPing_Loopback_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ccnx/common/ccnx_Name.h>
+#include <ccnx/transport/common/transport_MetaMessage.h>
+
+#include "ccnxPing_Distribution.h"
+
+/**
+ * The impairments applied to every message crossing a loopback link, in either direction.
+ */
+typedef struct ccnx_ping_impairment {
+    // The one-way delay (in microseconds). Its spread is the jitter.
+    CCNxPingDistribution delay;
+    double lossProbability;
+    double duplicateProbability;
+    // A reordered message is held back by an extra `reorderDelayInUs`.
+    double reorderProbability;
+    uint64_t reorderDelayInUs;
+} CCNxPingImpairment;
+
+/**
+ * The configuration of a `CCNxPingLoopback`.
+ *
+ * Options are parsed from a comma-separated specification:
+ *
+ *   delay=<distribution>           the one-way delay in microseconds (see `CCNxPingDistribution`)
+ *   loss=<p>                       the probability that a message is dropped
+ *   dup=<p>                        the probability that a message is delivered twice
+ *   reorder=<p>[:<us>]             the probability that a message is held back (by 1000 us by default)
+ *   object=<bytes>                 the size of the object served to chunk interests (16 MiB by default)
+ *   chunk=<bytes>                  the chunk size of that object (8192 by default)
+ *   seed=<n>                       the seed of the impairment random number generator
+ *   echo                           stamp ping responses as `ccnxPing_Server --echo` does (see `CCNxPingTimestamp`)
+ */
+typedef struct ccnx_ping_loopback_options {
+    CCNxPingImpairment impairment;
+    uint64_t objectSize;
+    size_t chunkSize;
+    uint64_t seed;
+    bool echoTimestamps;
+} CCNxPingLoopbackOptions;
+
+/**
+ * Initialize loopback options to an unimpaired link.
+ *
+ * @param [out] options The `CCNxPingLoopbackOptions` to initialize.
+ */
+void ccnxPingLoopbackOptions_Init(CCNxPingLoopbackOptions *options);
+
+/**
+ * Parse a loopback specification (see `CCNxPingLoopbackOptions`) on top of the current options.
+ *
+ * @param [in,out] options The `CCNxPingLoopbackOptions` to update.
+ * @param [in] specification The textual specification. An empty string leaves the options unchanged.
+ *
+ * @retval true If the specification was valid.
+ * @retval false Otherwise
+ */
+bool ccnxPingLoopbackOptions_Parse(CCNxPingLoopbackOptions *options, const char *specification);
+
+/**
+ * An in-process stand-in for a forwarder and a ping server.
+ *
+ * Interests sent into the loopback cross an impaired link to a responder thread, which answers them
+ * the way `ccnxPing_Server` does: with a payload of the size carried in the name after the prefix and
+ * the nonce, or with a chunk of a virtual object when the name ends with a chunk number. Responses
+ * cross a second, independently impaired link back.
+ */
+struct ccnx_ping_loopback;
+typedef struct ccnx_ping_loopback CCNxPingLoopback;
+
+/**
+ * Create a `CCNxPingLoopback` and start its responder.
+ *
+ * @param [in] prefix The prefix of the names the responder answers.
+ * @param [in] options The impairments and the served object.
+ *
+ * @return A new `CCNxPingLoopback` that must be released with `ccnxPingLoopback_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingLoopbackOptions options;
+ *     ccnxPingLoopbackOptions_Init(&options);
+ *     ccnxPingLoopbackOptions_Parse(&options, "delay=uniform:50:150,loss=0.01");
+ *
+ *     CCNxPingLoopback *loopback = ccnxPingLoopback_Create(prefix, &options);
+ *     ccnxPingLoopback_Send(loopback, interestMessage);
+ *     CCNxMetaMessage *response = ccnxPingLoopback_Receive(loopback, CCNxStackTimeout_MicroSeconds(1000000));
+ *     ccnxPingLoopback_Release(&loopback);
+ * }
+ * @endcode
+ */
+CCNxPingLoopback *ccnxPingLoopback_Create(const CCNxName *prefix, const CCNxPingLoopbackOptions *options);
+
+/**
+ * Increase the number of references to a `CCNxPingLoopback`.
+ *
+ * @param [in] loopback A pointer to a `CCNxPingLoopback` instance.
+ *
+ * @return The input `CCNxPingLoopback` pointer.
+ */
+CCNxPingLoopback *ccnxPingLoopback_Acquire(const CCNxPingLoopback *loopback);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * The last release stops the responder and discards the messages still in flight.
+ *
+ * @param [in,out] loopbackPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingLoopback_Release(CCNxPingLoopback **loopbackPtr);
+
+/**
+ * Send a message towards the responder. Never blocks.
+ *
+ * @param [in] loopback The `CCNxPingLoopback` instance.
+ * @param [in] message The message; the loopback acquires its own reference.
+ *
+ * @return true, unless the loopback is shutting down. A message lost to impairment counts as sent.
+ */
+bool ccnxPingLoopback_Send(CCNxPingLoopback *loopback, const CCNxMetaMessage *message);
+
+/**
+ * Receive the next response whose delivery time has come.
+ *
+ * @param [in] loopback The `CCNxPingLoopback` instance.
+ * @param [in] timeoutInUs The maximum time to wait, or NULL to wait indefinitely.
+ *
+ * @return The next response, or NULL if none was delivered before the timeout.
+ */
+CCNxMetaMessage *ccnxPingLoopback_Receive(CCNxPingLoopback *loopback, const uint64_t *timeoutInUs);
+
+/**
+ * Write the number of messages dropped, duplicated and reordered by both links.
+ *
+ * @param [in] loopback The `CCNxPingLoopback` instance.
+ * @param [in] output The stream to write to.
+ */
+void ccnxPingLoopback_WriteCounters(const CCNxPingLoopback *loopback, FILE *output);
+#endif // ccnxPing_Loopback_h
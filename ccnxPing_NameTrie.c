@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <string.h>
+
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include <ccnx/common/ccnx_NameSegment.h>
+
+#include "ccnxPing_NameTrie.h"
+
+typedef struct ccnx_ping_name_trie_node _CCNxPingNameTrieNode;
+
+/**
+ * A labelled edge to a child node. Edges are ordered by (length, type, bytes).
+ */
+typedef struct ccnx_ping_name_trie_edge {
+    uint32_t type;
+    uint32_t length;
+    uint8_t *bytes;
+    _CCNxPingNameTrieNode *child;
+} _CCNxPingNameTrieEdge;
+
+struct ccnx_ping_name_trie_node {
+    void *value;
+    uint32_t edgeCount;
+    uint32_t edgeCapacity;
+    _CCNxPingNameTrieEdge *edges;
+};
+
+struct ccnx_ping_name_trie {
+    _CCNxPingNameTrieNode root;
+    size_t size;
+};
+
+/**
+ * The label of a name segment, as compared against the edges of a node.
+ */
+typedef struct ccnx_ping_name_trie_key {
+    uint32_t type;
+    uint32_t length;
+    const uint8_t *bytes;
+} _CCNxPingNameTrieKey;
+
+static _CCNxPingNameTrieKey
+_ccnxPingNameTrie_SegmentKey(const CCNxName *name, size_t index)
+{
+    CCNxNameSegment *segment = ccnxName_GetSegment(name, index);
+    PARCBuffer *value = ccnxNameSegment_GetValue(segment);
+
+    _CCNxPingNameTrieKey key;
+    key.type = (uint32_t) ccnxNameSegment_GetType(segment);
+    key.length = (uint32_t) parcBuffer_Remaining(value);
+    key.bytes = key.length > 0 ? parcBuffer_Overlay(value, 0) : NULL;
+    return key;
+}
+
+static int
+_ccnxPingNameTrie_Compare(const _CCNxPingNameTrieKey *key, const _CCNxPingNameTrieEdge *edge)
+{
+    if (key->length != edge->length) {
+        return key->length < edge->length ? -1 : 1;
+    }
+    if (key->type != edge->type) {
+        return key->type < edge->type ? -1 : 1;
+    }
+    return key->length == 0 ? 0 : memcmp(key->bytes, edge->bytes, key->length);
+}
+
+/**
+ * Bisect the edges of `node` for `key`.
+ *
+ * @return The index of the matching edge, or the index at which it would be inserted.
+ */
+static uint32_t
+_ccnxPingNameTrie_Search(const _CCNxPingNameTrieNode *node, const _CCNxPingNameTrieKey *key, bool *found)
+{
+    uint32_t low = 0;
+    uint32_t high = node->edgeCount;
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        int comparison = _ccnxPingNameTrie_Compare(key, &node->edges[middle]);
+        if (comparison == 0) {
+            *found = true;
+            return middle;
+        }
+        if (comparison < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    *found = false;
+    return low;
+}
+
+static _CCNxPingNameTrieNode *
+_ccnxPingNameTrie_AddChild(_CCNxPingNameTrieNode *node, uint32_t index, const _CCNxPingNameTrieKey *key)
+{
+    if (node->edgeCount == node->edgeCapacity) {
+        uint32_t capacity = node->edgeCapacity == 0 ? 1 : node->edgeCapacity * 2;
+        _CCNxPingNameTrieEdge *edges = parcMemory_Allocate(capacity * sizeof(_CCNxPingNameTrieEdge));
+        if (node->edgeCount > 0) {
+            memcpy(edges, node->edges, node->edgeCount * sizeof(_CCNxPingNameTrieEdge));
+            parcMemory_Deallocate(&node->edges);
+        }
+        node->edges = edges;
+        node->edgeCapacity = capacity;
+    }
+
+    memmove(&node->edges[index + 1], &node->edges[index], (node->edgeCount - index) * sizeof(_CCNxPingNameTrieEdge));
+    node->edgeCount++;
+
+    _CCNxPingNameTrieEdge *edge = &node->edges[index];
+    edge->type = key->type;
+    edge->length = key->length;
+    edge->bytes = NULL;
+    if (key->length > 0) {
+        edge->bytes = parcMemory_Allocate(key->length);
+        memcpy(edge->bytes, key->bytes, key->length);
+    }
+    edge->child = parcMemory_AllocateAndClear(sizeof(_CCNxPingNameTrieNode));
+    return edge->child;
+}
+
+static void
+_ccnxPingNameTrie_ClearNode(_CCNxPingNameTrieNode *node)
+{
+    for (uint32_t i = 0; i < node->edgeCount; i++) {
+        _ccnxPingNameTrie_ClearNode(node->edges[i].child);
+        parcMemory_Deallocate(&node->edges[i].child);
+        if (node->edges[i].bytes != NULL) {
+            parcMemory_Deallocate(&node->edges[i].bytes);
+        }
+    }
+    if (node->edges != NULL) {
+        parcMemory_Deallocate(&node->edges);
+    }
+}
+
+static bool
+_ccnxPingNameTrie_Destructor(CCNxPingNameTrie **triePtr)
+{
+    _ccnxPingNameTrie_ClearNode(&(*triePtr)->root);
+    return true;
+}
+
+parcObject_Override(CCNxPingNameTrie, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingNameTrie_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingNameTrie, CCNxPingNameTrie);
+parcObject_ImplementRelease(ccnxPingNameTrie, CCNxPingNameTrie);
+
+CCNxPingNameTrie *
+ccnxPingNameTrie_Create(void)
+{
+    CCNxPingNameTrie *trie = parcObject_CreateInstance(CCNxPingNameTrie);
+    memset(&trie->root, 0, sizeof(trie->root));
+    trie->size = 0;
+    return trie;
+}
+
+bool
+ccnxPingNameTrie_Insert(CCNxPingNameTrie *trie, const CCNxName *prefix, void *value)
+{
+    _CCNxPingNameTrieNode *node = &trie->root;
+
+    size_t segmentCount = ccnxName_GetSegmentCount(prefix);
+    for (size_t i = 0; i < segmentCount; i++) {
+        _CCNxPingNameTrieKey key = _ccnxPingNameTrie_SegmentKey(prefix, i);
+        bool found = false;
+        uint32_t index = _ccnxPingNameTrie_Search(node, &key, &found);
+        node = found ? node->edges[index].child : _ccnxPingNameTrie_AddChild(node, index, &key);
+    }
+
+    if (node->value != NULL) {
+        return false;
+    }
+    node->value = value;
+    trie->size++;
+    return true;
+}
+
+void *
+ccnxPingNameTrie_LongestPrefixMatch(const CCNxPingNameTrie *trie, const CCNxName *name, size_t *matchedSegments)
+{
+    const _CCNxPingNameTrieNode *node = &trie->root;
+    void *match = node->value;
+    size_t matchLength = 0;
+
+    size_t segmentCount = ccnxName_GetSegmentCount(name);
+    for (size_t i = 0; i < segmentCount && node->edgeCount > 0; i++) {
+        _CCNxPingNameTrieKey key = _ccnxPingNameTrie_SegmentKey(name, i);
+        bool found = false;
+        uint32_t index = _ccnxPingNameTrie_Search(node, &key, &found);
+        if (!found) {
+            break;
+        }
+        node = node->edges[index].child;
+        if (node->value != NULL) {
+            match = node->value;
+            matchLength = i + 1;
+        }
+    }
+
+    if (matchedSegments != NULL) {
+        *matchedSegments = matchLength;
+    }
+    return match;
+}
+
+size_t
+ccnxPingNameTrie_Size(const CCNxPingNameTrie *trie)
+{
+    return trie->size;
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_NameTrie_h
+#define ccnxPing_NameTrie_h
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <ccnx/common/ccnx_Name.h>
+
+/**
+ * A trie of name segments mapping name prefixes to opaque values, for longest-prefix-match dispatch.
+ *
+ * Every node keeps its children in a sorted array searched by bisection, so a lookup costs one
+ * binary search per name segment and a registered prefix costs one small node and one copy of
+ * each of its segments that is not shared with another prefix. Values are not owned by the trie.
+ */
+struct ccnx_ping_name_trie;
+typedef struct ccnx_ping_name_trie CCNxPingNameTrie;
+
+/**
+ * Create an empty `CCNxPingNameTrie`.
+ *
+ * @return A new `CCNxPingNameTrie` that must be released with `ccnxPingNameTrie_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingNameTrie *trie = ccnxPingNameTrie_Create();
+ *     ccnxPingNameTrie_Insert(trie, prefix, profile);
+ *
+ *     size_t matchedSegments = 0;
+ *     CCNxPingServerProfile *match = ccnxPingNameTrie_LongestPrefixMatch(trie, interestName, &matchedSegments);
+ *     ccnxPingNameTrie_Release(&trie);
+ * }
+ * @endcode
+ */
+CCNxPingNameTrie *ccnxPingNameTrie_Create(void);
+
+/**
+ * Increase the number of references to a `CCNxPingNameTrie`.
+ *
+ * @param [in] trie A pointer to a `CCNxPingNameTrie` instance.
+ *
+ * @return The input `CCNxPingNameTrie` pointer.
+ */
+CCNxPingNameTrie *ccnxPingNameTrie_Acquire(const CCNxPingNameTrie *trie);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] triePtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingNameTrie_Release(CCNxPingNameTrie **triePtr);
+
+/**
+ * Associate a value with a name prefix.
+ *
+ * @param [in] trie The `CCNxPingNameTrie` instance.
+ * @param [in] prefix The name prefix.
+ * @param [in] value The value, which must not be NULL.
+ *
+ * @retval true If the value was inserted.
+ * @retval false If the prefix already has a value, which is left unchanged.
+ */
+bool ccnxPingNameTrie_Insert(CCNxPingNameTrie *trie, const CCNxName *prefix, void *value);
+
+/**
+ * Find the value of the longest registered prefix of `name`.
+ *
+ * @param [in] trie The `CCNxPingNameTrie` instance.
+ * @param [in] name The name to look up.
+ * @param [out] matchedSegments If not NULL, receives the number of segments of the matching prefix.
+ *
+ * @return The value of the longest matching prefix, or NULL if no registered prefix matches.
+ */
+void *ccnxPingNameTrie_LongestPrefixMatch(const CCNxPingNameTrie *trie, const CCNxName *name, size_t *matchedSegments);
+
+/**
+ * @return The number of prefixes with a value.
+ */
+size_t ccnxPingNameTrie_Size(const CCNxPingNameTrie *trie);
+#endif // ccnxPing_NameTrie_h
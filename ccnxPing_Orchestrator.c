@@ -0,0 +1,428 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_DisplayIndented.h>
+
+#include "ccnxPing_Common.h"
+#include "ccnxPing_Orchestrator.h"
+
+/**
+ * The controller checks for exited children this often while it waits.
+ */
+#define _ccnxPingOrchestrator_PollIntervalInUs 10000
+
+typedef enum {
+    _CCNxPingOrchestratorState_Forked = 0,
+    _CCNxPingOrchestratorState_Running,
+    _CCNxPingOrchestratorState_Finished,
+    _CCNxPingOrchestratorState_Exited,
+    _CCNxPingOrchestratorState_Failed
+} _CCNxPingOrchestratorState;
+
+/**
+ * The shared memory segment: the start barrier followed by one slot per child.
+ */
+typedef struct ccnx_ping_orchestrator_segment {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    size_t ready;
+    bool started;
+
+    size_t processCount;
+    CCNxPingOrchestratorSlot slots[];
+} _CCNxPingOrchestratorSegment;
+
+struct ccnx_ping_orchestrator {
+    _CCNxPingOrchestratorSegment *segment;
+    size_t segmentSize;
+    pid_t controller;
+    size_t forked;
+};
+
+static bool
+_ccnxPingOrchestrator_Destructor(CCNxPingOrchestrator **orchestratorPtr)
+{
+    CCNxPingOrchestrator *orchestrator = *orchestratorPtr;
+    if (orchestrator->segment != NULL) {
+        if (orchestrator->controller == getpid()) {
+            pthread_cond_destroy(&orchestrator->segment->changed);
+            pthread_mutex_destroy(&orchestrator->segment->lock);
+        }
+        munmap(orchestrator->segment, orchestrator->segmentSize);
+    }
+    return true;
+}
+
+parcObject_Override(CCNxPingOrchestrator, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingOrchestrator_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingOrchestrator, CCNxPingOrchestrator);
+parcObject_ImplementRelease(ccnxPingOrchestrator, CCNxPingOrchestrator);
+
+CCNxPingOrchestrator *
+ccnxPingOrchestrator_Create(size_t processCount)
+{
+    size_t segmentSize = sizeof(_CCNxPingOrchestratorSegment) + processCount * sizeof(CCNxPingOrchestratorSlot);
+    _CCNxPingOrchestratorSegment *segment = mmap(NULL, segmentSize, PROT_READ | PROT_WRITE,
+                                                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (segment == MAP_FAILED) {
+        fprintf(stderr, "Unable to map %zu bytes of shared memory: %s\n", segmentSize, strerror(errno));
+        return NULL;
+    }
+
+    pthread_mutexattr_t mutexAttributes;
+    pthread_mutexattr_init(&mutexAttributes);
+    pthread_mutexattr_setpshared(&mutexAttributes, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&segment->lock, &mutexAttributes);
+    pthread_mutexattr_destroy(&mutexAttributes);
+
+    pthread_condattr_t condAttributes;
+    pthread_condattr_init(&condAttributes);
+    pthread_condattr_setpshared(&condAttributes, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&condAttributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&segment->changed, &condAttributes);
+    pthread_condattr_destroy(&condAttributes);
+
+    segment->ready = 0;
+    segment->started = false;
+    segment->processCount = processCount;
+    for (size_t i = 0; i < processCount; i++) {
+        CCNxPingOrchestratorSlot *slot = &segment->slots[i];
+        slot->segment = segment;
+        slot->index = i;
+        slot->pid = 0;
+        slot->state = _CCNxPingOrchestratorState_Forked;
+        slot->sent = 0;
+        slot->received = 0;
+        slot->startTimeInUs = 0;
+        slot->endTimeInUs = 0;
+        ccnxPingHistogram_Init(&slot->rtt);
+    }
+
+    CCNxPingOrchestrator *orchestrator = parcObject_CreateInstance(CCNxPingOrchestrator);
+    orchestrator->segment = segment;
+    orchestrator->segmentSize = segmentSize;
+    orchestrator->controller = getpid();
+    orchestrator->forked = 0;
+    return orchestrator;
+}
+
+CCNxPingOrchestratorSlot *
+ccnxPingOrchestrator_Fork(CCNxPingOrchestrator *orchestrator)
+{
+    _CCNxPingOrchestratorSegment *segment = orchestrator->segment;
+
+    // Buffered output would otherwise be written once by every child as well.
+    fflush(NULL);
+
+    for (size_t i = 0; i < segment->processCount; i++) {
+        CCNxPingOrchestratorSlot *slot = &segment->slots[i];
+        pid_t pid = fork();
+        if (pid == 0) {
+            int devNull = open("/dev/null", O_WRONLY);
+            if (devNull >= 0) {
+                dup2(devNull, STDOUT_FILENO);
+                close(devNull);
+            }
+            slot->pid = getpid();
+            return slot;
+        }
+        if (pid < 0) {
+            fprintf(stderr, "Unable to fork client process %zu: %s\n", i, strerror(errno));
+            slot->state = _CCNxPingOrchestratorState_Failed;
+            continue;
+        }
+        slot->pid = pid;
+        orchestrator->forked++;
+    }
+    return NULL;
+}
+
+static CCNxPingOrchestratorSlot *
+_ccnxPingOrchestrator_FindSlot(CCNxPingOrchestrator *orchestrator, pid_t pid)
+{
+    for (size_t i = 0; i < orchestrator->segment->processCount; i++) {
+        if (orchestrator->segment->slots[i].pid == pid) {
+            return &orchestrator->segment->slots[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Reap the children that have exited, without blocking.
+ *
+ * @return The number of children that are still running.
+ */
+static size_t
+_ccnxPingOrchestrator_Reap(CCNxPingOrchestrator *orchestrator, size_t *exitedBeforeStart)
+{
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        CCNxPingOrchestratorSlot *slot = _ccnxPingOrchestrator_FindSlot(orchestrator, pid);
+        if (slot == NULL) {
+            continue;
+        }
+        uint32_t state = ccnxPingCommon_CounterGet(slot->state);
+        if (state == _CCNxPingOrchestratorState_Forked && exitedBeforeStart != NULL) {
+            (*exitedBeforeStart)++;
+        }
+        bool success = WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS && state == _CCNxPingOrchestratorState_Finished;
+        if (!success) {
+            fprintf(stderr, "Client process %zu (pid %d) failed\n", slot->index, (int) pid);
+        }
+        ccnxPingCommon_CounterSet(slot->state, success ? _CCNxPingOrchestratorState_Exited : _CCNxPingOrchestratorState_Failed);
+        orchestrator->forked--;
+    }
+    return orchestrator->forked;
+}
+
+/**
+ * Wait until every child is ready (or has died before getting there), then start them all.
+ */
+static void
+_ccnxPingOrchestrator_Start(CCNxPingOrchestrator *orchestrator)
+{
+    _CCNxPingOrchestratorSegment *segment = orchestrator->segment;
+    size_t children = orchestrator->forked;
+    size_t exitedBeforeStart = 0;
+
+    pthread_mutex_lock(&segment->lock);
+    while (segment->ready + exitedBeforeStart < children) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += _ccnxPingOrchestrator_PollIntervalInUs * 1000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&segment->changed, &segment->lock, &deadline);
+        _ccnxPingOrchestrator_Reap(orchestrator, &exitedBeforeStart);
+    }
+    segment->started = true;
+    pthread_cond_broadcast(&segment->changed);
+    pthread_mutex_unlock(&segment->lock);
+}
+
+/**
+ * Sum the slots of all children into `total`.
+ */
+static void
+_ccnxPingOrchestrator_Aggregate(CCNxPingOrchestrator *orchestrator, CCNxPingOrchestratorSlot *total, size_t *running)
+{
+    CCNxPingHistogram snapshot;
+
+    total->sent = 0;
+    total->received = 0;
+    total->startTimeInUs = UINT64_MAX;
+    total->endTimeInUs = 0;
+    ccnxPingHistogram_Init(&total->rtt);
+    *running = 0;
+
+    for (size_t i = 0; i < orchestrator->segment->processCount; i++) {
+        CCNxPingOrchestratorSlot *slot = &orchestrator->segment->slots[i];
+        total->sent += ccnxPingCommon_CounterGet(slot->sent);
+        total->received += ccnxPingCommon_CounterGet(slot->received);
+
+        uint64_t startTimeInUs = ccnxPingCommon_CounterGet(slot->startTimeInUs);
+        uint64_t endTimeInUs = ccnxPingCommon_CounterGet(slot->endTimeInUs);
+        if (startTimeInUs != 0 && startTimeInUs < total->startTimeInUs) {
+            total->startTimeInUs = startTimeInUs;
+        }
+        if (endTimeInUs > total->endTimeInUs) {
+            total->endTimeInUs = endTimeInUs;
+        }
+        if (ccnxPingCommon_CounterGet(slot->state) == _CCNxPingOrchestratorState_Running) {
+            (*running)++;
+        }
+
+        ccnxPingHistogram_Snapshot(&snapshot, &slot->rtt);
+        ccnxPingHistogram_Merge(&total->rtt, &snapshot);
+    }
+}
+
+static void
+_ccnxPingOrchestrator_DisplayLive(CCNxPingOrchestrator *orchestrator, uint64_t startTimeInUs, uint64_t nowInUs)
+{
+    CCNxPingOrchestratorSlot total;
+    size_t running;
+    _ccnxPingOrchestrator_Aggregate(orchestrator, &total, &running);
+
+    double seconds = (nowInUs - startTimeInUs) / 1000000.0;
+    parcDisplayIndented_PrintLine(0, "[%7.1f s] Running = %zu/%zu : Sent = %llu : Received = %llu : RTT p50 = %llu us, p99 = %llu us",
+                                  seconds, running, orchestrator->segment->processCount,
+                                  (unsigned long long) total.sent, (unsigned long long) total.received,
+                                  (unsigned long long) ccnxPingHistogram_Percentile(&total.rtt, 50.0),
+                                  (unsigned long long) ccnxPingHistogram_Percentile(&total.rtt, 99.0));
+    fflush(stdout);
+}
+
+static void
+_ccnxPingOrchestrator_DisplayFinal(CCNxPingOrchestrator *orchestrator, FILE *json)
+{
+    CCNxPingOrchestratorSlot total;
+    size_t running;
+    _ccnxPingOrchestrator_Aggregate(orchestrator, &total, &running);
+
+    size_t failed = 0;
+    for (size_t i = 0; i < orchestrator->segment->processCount; i++) {
+        if (orchestrator->segment->slots[i].state == _CCNxPingOrchestratorState_Failed) {
+            failed++;
+        }
+    }
+
+    uint64_t durationInUs = total.endTimeInUs > total.startTimeInUs ? total.endTimeInUs - total.startTimeInUs : 0;
+    double throughput = durationInUs > 0 ? total.received * 1000000.0 / durationInUs : 0.0;
+
+    parcDisplayIndented_PrintLine(0, "Processes = %zu (%zu failed) : Sent = %llu : Received = %llu : Time = %.3f s : Throughput = %.1f/s",
+                                  orchestrator->segment->processCount, failed,
+                                  (unsigned long long) total.sent, (unsigned long long) total.received,
+                                  durationInUs / 1000000.0, throughput);
+    ccnxPingHistogram_Display(&total.rtt, 0, "RTT (us)");
+
+    if (json != NULL) {
+        fprintf(json, "{\"processes\":%zu,\"failed\":%zu,\"sent\":%llu,\"received\":%llu,\"duration_us\":%llu,\"throughput\":%.1f,\"rtt_us\":",
+                orchestrator->segment->processCount, failed,
+                (unsigned long long) total.sent, (unsigned long long) total.received,
+                (unsigned long long) durationInUs, throughput);
+        ccnxPingHistogram_WriteJSON(&total.rtt, json);
+        fprintf(json, "}\n");
+    }
+}
+
+bool
+ccnxPingOrchestrator_Run(CCNxPingOrchestrator *orchestrator, uint64_t reportIntervalInUs, FILE *json)
+{
+    _ccnxPingOrchestrator_Start(orchestrator);
+
+    uint64_t startTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+    uint64_t nextReportInUs = startTimeInUs + reportIntervalInUs;
+    while (_ccnxPingOrchestrator_Reap(orchestrator, NULL) > 0) {
+        uint64_t nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+        if (nowInUs >= nextReportInUs) {
+            _ccnxPingOrchestrator_DisplayLive(orchestrator, startTimeInUs, nowInUs);
+            nextReportInUs += reportIntervalInUs;
+        }
+        struct timespec pause = { 0, _ccnxPingOrchestrator_PollIntervalInUs * 1000 };
+        nanosleep(&pause, NULL);
+    }
+
+    _ccnxPingOrchestrator_DisplayFinal(orchestrator, json);
+
+    for (size_t i = 0; i < orchestrator->segment->processCount; i++) {
+        if (orchestrator->segment->slots[i].state != _CCNxPingOrchestratorState_Exited) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+ccnxPingOrchestratorSlot_WaitForStart(CCNxPingOrchestratorSlot *slot)
+{
+    if (ccnxPingCommon_CounterGet(slot->state) != _CCNxPingOrchestratorState_Forked) {
+        return;
+    }
+
+    _CCNxPingOrchestratorSegment *segment = slot->segment;
+    pthread_mutex_lock(&segment->lock);
+    segment->ready++;
+    pthread_cond_broadcast(&segment->changed);
+    while (!segment->started) {
+        pthread_cond_wait(&segment->changed, &segment->lock);
+    }
+    pthread_mutex_unlock(&segment->lock);
+
+    ccnxPingCommon_CounterSet(slot->startTimeInUs, ccnxPingCommon_MonotonicTimeInUs());
+    ccnxPingCommon_CounterSet(slot->state, _CCNxPingOrchestratorState_Running);
+}
+
+void
+ccnxPingOrchestratorSlot_RecordRequest(CCNxPingOrchestratorSlot *slot)
+{
+    ccnxPingCommon_CounterAdd(slot->sent, 1);
+}
+
+void
+ccnxPingOrchestratorSlot_RecordResponse(CCNxPingOrchestratorSlot *slot, uint64_t rttInUs)
+{
+    ccnxPingCommon_CounterAdd(slot->received, 1);
+    ccnxPingCommon_CounterSet(slot->endTimeInUs, ccnxPingCommon_MonotonicTimeInUs());
+    ccnxPingHistogram_Record(&slot->rtt, rttInUs);
+}
+
+void
+ccnxPingOrchestratorSlot_Finish(CCNxPingOrchestratorSlot *slot)
+{
+    // A child that never started (e.g., it could not open its portal) is reported as failed.
+    if (ccnxPingCommon_CounterGet(slot->state) == _CCNxPingOrchestratorState_Running) {
+        ccnxPingCommon_CounterSet(slot->state, _CCNxPingOrchestratorState_Finished);
+    }
+}
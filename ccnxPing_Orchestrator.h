@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Orchestrator_h
+#define ccnxPing_Orchestrator_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ccnxPing_Histogram.h"
+
+/**
+ * The per-process results of an orchestrated run. Slots live in a shared memory segment: each
+ * is written only by its own child process, with relaxed atomic stores and no locks, and read
+ * by the controller at any time.
+ */
+typedef struct ccnx_ping_orchestrator_slot {
+    struct ccnx_ping_orchestrator_segment *segment;
+    size_t index;
+    int pid;
+    uint32_t state;
+    uint64_t sent;
+    uint64_t received;
+    uint64_t startTimeInUs;
+    uint64_t endTimeInUs;
+    CCNxPingHistogram rtt;
+} CCNxPingOrchestratorSlot;
+
+/**
+ * Runs a load test as a controller process and N forked client processes.
+ *
+ * The children share one anonymous shared memory segment with the controller, holding one
+ * `CCNxPingOrchestratorSlot` per child and a start barrier. Each child prepares its own portal
+ * and then waits on the barrier; the controller releases all of them together once every child
+ * is ready (or has died), reports live aggregates while they run and the final aggregate when
+ * the last one has exited.
+ */
+struct ccnx_ping_orchestrator;
+typedef struct ccnx_ping_orchestrator CCNxPingOrchestrator;
+
+/**
+ * Create a `CCNxPingOrchestrator` and its shared memory segment.
+ *
+ * @param [in] processCount The number of client processes to fork.
+ *
+ * @return A new `CCNxPingOrchestrator`, or NULL if the shared memory could not be mapped.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingOrchestrator *orchestrator = ccnxPingOrchestrator_Create(8);
+ *     CCNxPingOrchestratorSlot *slot = ccnxPingOrchestrator_Fork(orchestrator);
+ *     if (slot != NULL) {
+ *         // In a child: open a portal, then
+ *         ccnxPingOrchestratorSlot_WaitForStart(slot);
+ *         ...
+ *         ccnxPingOrchestratorSlot_Finish(slot);
+ *         exit(0);
+ *     }
+ *     ccnxPingOrchestrator_Run(orchestrator, 1000000, stdout);
+ *     ccnxPingOrchestrator_Release(&orchestrator);
+ * }
+ * @endcode
+ */
+CCNxPingOrchestrator *ccnxPingOrchestrator_Create(size_t processCount);
+
+/**
+ * Increase the number of references to a `CCNxPingOrchestrator`.
+ *
+ * @param [in] orchestrator A pointer to a `CCNxPingOrchestrator` instance.
+ *
+ * @return The input `CCNxPingOrchestrator` pointer.
+ */
+CCNxPingOrchestrator *ccnxPingOrchestrator_Acquire(const CCNxPingOrchestrator *orchestrator);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] orchestratorPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingOrchestrator_Release(CCNxPingOrchestrator **orchestratorPtr);
+
+/**
+ * Fork the client processes.
+ *
+ * Each child returns its own slot, with its standard output redirected to `/dev/null` so that
+ * only the controller reports. The controller returns NULL once every child has been forked.
+ *
+ * @param [in] orchestrator The `CCNxPingOrchestrator` instance.
+ *
+ * @return The slot of the calling child, or NULL in the controller.
+ */
+CCNxPingOrchestratorSlot *ccnxPingOrchestrator_Fork(CCNxPingOrchestrator *orchestrator);
+
+/**
+ * Run the controller: release the children together, display a live aggregate every
+ * `reportIntervalInUs`, and display the final aggregate once every child has exited.
+ *
+ * @param [in] orchestrator The `CCNxPingOrchestrator` instance.
+ * @param [in] reportIntervalInUs The interval between live reports (in microseconds).
+ * @param [in] json If not NULL, the final aggregate is also written to this stream, in the
+ *                  format of `ccnxPingStats_WriteJSON`.
+ *
+ * @return true If every child exited successfully.
+ */
+bool ccnxPingOrchestrator_Run(CCNxPingOrchestrator *orchestrator, uint64_t reportIntervalInUs, FILE *json);
+
+/**
+ * In a child, signal that it is ready and wait until the controller starts all children.
+ * Only the first call waits.
+ *
+ * @param [in] slot The slot returned by `ccnxPingOrchestrator_Fork`.
+ */
+void ccnxPingOrchestratorSlot_WaitForStart(CCNxPingOrchestratorSlot *slot);
+
+/**
+ * Account for a request sent by the child.
+ *
+ * @param [in] slot The slot of the child.
+ */
+void ccnxPingOrchestratorSlot_RecordRequest(CCNxPingOrchestratorSlot *slot);
+
+/**
+ * Account for a (non-duplicate) response received by the child.
+ *
+ * @param [in] slot The slot of the child.
+ * @param [in] rttInUs The round trip time of the request (in microseconds).
+ */
+void ccnxPingOrchestratorSlot_RecordResponse(CCNxPingOrchestratorSlot *slot, uint64_t rttInUs);
+
+/**
+ * Mark the run of the child as complete. A child that exits without having started and
+ * finished its run is reported as failed.
+ *
+ * @param [in] slot The slot of the child.
+ */
+void ccnxPingOrchestratorSlot_Finish(CCNxPingOrchestratorSlot *slot);
+#endif // ccnxPing_Orchestrator_h
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxPing_Chunked.h"
+#include "ccnxPing_Common.h"
+#include "ccnxPing_Distribution.h"
+#include "ccnxPing_PayloadSource.h"
+
+#define _defaultRandomPoolSize (64 * 1024 * 1024)
+#define _hugePageSize (2 * 1024 * 1024)
+
+typedef enum {
+    _CCNxPingPayloadSourceType_Pattern,
+    _CCNxPingPayloadSourceType_Random,
+    _CCNxPingPayloadSourceType_File
+} _CCNxPingPayloadSourceType;
+
+struct ccnx_ping_payload_source {
+    _CCNxPingPayloadSourceType type;
+    char *description;
+
+    // The mapped memory of random and file sources.
+    uint8_t *memory;
+    size_t mappedSize;
+    uint64_t size;
+};
+
+static bool
+_ccnxPingPayloadSource_Destructor(CCNxPingPayloadSource **sourcePtr)
+{
+    CCNxPingPayloadSource *source = *sourcePtr;
+    if (source->memory != NULL) {
+        munmap(source->memory, source->mappedSize);
+    }
+    if (source->description != NULL) {
+        free(source->description);
+    }
+    return true;
+}
+
+parcObject_Override(CCNxPingPayloadSource, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingPayloadSource_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingPayloadSource, CCNxPingPayloadSource);
+parcObject_ImplementRelease(ccnxPingPayloadSource, CCNxPingPayloadSource);
+
+/**
+ * Map and fill the random pool, preferring explicit huge pages, then transparent huge pages.
+ */
+static bool
+_ccnxPingPayloadSource_MapRandomPool(CCNxPingPayloadSource *source, uint64_t size, bool huge)
+{
+    const char *backing = "";
+    source->mappedSize = size;
+    source->memory = MAP_FAILED;
+
+    if (huge) {
+        source->mappedSize = (size + _hugePageSize - 1) / _hugePageSize * _hugePageSize;
+#ifdef MAP_HUGETLB
+        source->memory = mmap(NULL, source->mappedSize, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        backing = " (huge pages)";
+#endif
+    }
+    if (source->memory == MAP_FAILED) {
+        source->memory = mmap(NULL, source->mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        backing = "";
+#ifdef MADV_HUGEPAGE
+        if (huge && source->memory != MAP_FAILED && madvise(source->memory, source->mappedSize, MADV_HUGEPAGE) == 0) {
+            backing = " (transparent huge pages)";
+        }
+#endif
+    }
+    if (source->memory == MAP_FAILED) {
+        source->memory = NULL;
+        return false;
+    }
+
+    uint64_t randomState = ccnxPingCommon_MonotonicTimeInUs() | 1;
+    for (size_t i = 0; i + sizeof(uint64_t) <= source->mappedSize; i += sizeof(uint64_t)) {
+        uint64_t value = ccnxPingDistribution_Random(&randomState);
+        memcpy(&source->memory[i], &value, sizeof(value));
+    }
+    mprotect(source->memory, source->mappedSize, PROT_READ);
+
+    source->size = size;
+    asprintf(&source->description, "random:%" PRIu64 "%s%s", size, huge ? ":huge" : "", backing);
+    return true;
+}
+
+static bool
+_ccnxPingPayloadSource_MapFile(CCNxPingPayloadSource *source, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || status.st_size == 0) {
+        fprintf(stderr, "%s: cannot serve an empty or unreadable file\n", path);
+        close(fd);
+        return false;
+    }
+
+    source->mappedSize = (size_t) status.st_size;
+    source->memory = mmap(NULL, source->mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (source->memory == MAP_FAILED) {
+        perror(path);
+        source->memory = NULL;
+        return false;
+    }
+    madvise(source->memory, source->mappedSize, MADV_WILLNEED);
+
+    source->size = (uint64_t) status.st_size;
+    asprintf(&source->description, "file:%s", path);
+    return true;
+}
+
+CCNxPingPayloadSource *
+ccnxPingPayloadSource_Create(const char *specification)
+{
+    CCNxPingPayloadSource *source = parcObject_CreateInstance(CCNxPingPayloadSource);
+    source->type = _CCNxPingPayloadSourceType_Pattern;
+    source->description = NULL;
+    source->memory = NULL;
+    source->mappedSize = 0;
+    source->size = 0;
+
+    bool result = false;
+    uint64_t size = _defaultRandomPoolSize;
+    int consumed = 0;
+
+    if (strcmp(specification, "pattern") == 0) {
+        source->description = strdup("pattern");
+        result = true;
+    } else if (strncmp(specification, "file:", 5) == 0) {
+        source->type = _CCNxPingPayloadSourceType_File;
+        result = _ccnxPingPayloadSource_MapFile(source, specification + 5);
+    } else if (strncmp(specification, "random", 6) == 0) {
+        const char *options = specification + 6;
+        bool huge = false;
+        if (sscanf(options, ":%" SCNu64 "%n", &size, &consumed) == 1) {
+            options += consumed;
+        }
+        if (strcmp(options, ":huge") == 0) {
+            huge = true;
+            options += 5;
+        }
+        if (*options == '\0' && size >= ccnxPing_MaxPayloadSize) {
+            source->type = _CCNxPingPayloadSourceType_Random;
+            result = _ccnxPingPayloadSource_MapRandomPool(source, size, huge);
+        }
+    }
+
+    if (!result) {
+        ccnxPingPayloadSource_Release(&source);
+    }
+    return source;
+}
+
+PARCBuffer *
+ccnxPingPayloadSource_CreatePayload(const CCNxPingPayloadSource *source, uint64_t offset, size_t length)
+{
+    length = length > ccnxPing_MaxPayloadSize ? ccnxPing_MaxPayloadSize : length;
+
+    if (source->type == _CCNxPingPayloadSourceType_Pattern) {
+        return ccnxPingChunked_CreatePayload(offset, length);
+    }
+
+    // Every slice must be contiguous, so offsets wrap around before the last `length` bytes.
+    uint64_t start = 0;
+    if (source->size <= length) {
+        length = (size_t) source->size;
+    } else {
+        start = offset % (source->size - length + 1);
+    }
+    return parcBuffer_Wrap(source->memory + start, length, 0, length);
+}
+
+uint64_t
+ccnxPingPayloadSource_GetSize(const CCNxPingPayloadSource *source)
+{
+    return source->type == _CCNxPingPayloadSourceType_Pattern ? ccnxPing_MaxPayloadSize : source->size;
+}
+
+const char *
+ccnxPingPayloadSource_GetDescription(const CCNxPingPayloadSource *source)
+{
+    return source->description;
+}
+
+const void *
+ccnxPingPayloadSource_GetMemory(const CCNxPingPayloadSource *source, size_t *length)
+{
+    *length = source->memory != NULL ? source->mappedSize : 0;
+    return source->memory;
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_PayloadSource_h
+#define ccnxPing_PayloadSource_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+/**
+ * A source of payload bytes for responses, sliced without copying.
+ *
+ * Sources are created from a short textual specification:
+ *
+ *   pattern                        the periodic pattern also used for chunked objects (the default)
+ *   random[:<bytes>[:huge]]        a pool of incompressible random bytes (64 MiB by default),
+ *                                  backed by huge pages if `huge` is given and the system has them
+ *   file:<path>                    the content of a file, mapped read-only
+ *
+ * Payloads wrap the memory of the source, so the source must outlive every payload it created.
+ */
+struct ccnx_ping_payload_source;
+typedef struct ccnx_ping_payload_source CCNxPingPayloadSource;
+
+/**
+ * Create a `CCNxPingPayloadSource` from a specification (see `CCNxPingPayloadSource`).
+ *
+ * @param [in] specification The textual specification.
+ *
+ * @return A new `CCNxPingPayloadSource`, or NULL if the specification is invalid or the memory or file could not be mapped.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingPayloadSource *source = ccnxPingPayloadSource_Create("random:268435456:huge");
+ *     PARCBuffer *payload = ccnxPingPayloadSource_CreatePayload(source, offset, 1500);
+ *     ...
+ *     parcBuffer_Release(&payload);
+ *     ccnxPingPayloadSource_Release(&source);
+ * }
+ * @endcode
+ */
+CCNxPingPayloadSource *ccnxPingPayloadSource_Create(const char *specification);
+
+/**
+ * Increase the number of references to a `CCNxPingPayloadSource`.
+ *
+ * @param [in] source A pointer to a `CCNxPingPayloadSource` instance.
+ *
+ * @return The input `CCNxPingPayloadSource` pointer.
+ */
+CCNxPingPayloadSource *ccnxPingPayloadSource_Acquire(const CCNxPingPayloadSource *source);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] sourcePtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingPayloadSource_Release(CCNxPingPayloadSource **sourcePtr);
+
+/**
+ * Create a payload of `length` bytes taken from the source at `offset`, without copying them.
+ *
+ * Offsets wrap around the end of the source. A file smaller than `length` yields a payload holding the whole file.
+ *
+ * @param [in] source The `CCNxPingPayloadSource` instance.
+ * @param [in] offset The offset of the first byte.
+ * @param [in] length The number of bytes, at most `ccnxPing_MaxPayloadSize`.
+ *
+ * @return A new `PARCBuffer` that must be released with `parcBuffer_Release`.
+ */
+PARCBuffer *ccnxPingPayloadSource_CreatePayload(const CCNxPingPayloadSource *source, uint64_t offset, size_t length);
+
+/**
+ * @return The number of distinct bytes held by the source.
+ */
+uint64_t ccnxPingPayloadSource_GetSize(const CCNxPingPayloadSource *source);
+
+/**
+ * @return A description of the source in the specification syntax, noting whether huge pages are in use.
+ */
+const char *ccnxPingPayloadSource_GetDescription(const CCNxPingPayloadSource *source);
+
+/**
+ * Return the memory mapped by the source, for example to prefault it.
+ *
+ * @param [in] source The `CCNxPingPayloadSource` instance.
+ * @param [out] length The length of the mapped memory (in bytes).
+ *
+ * @return The start of the mapped memory, or NULL (and a length of 0) for the built-in pattern.
+ */
+const void *ccnxPingPayloadSource_GetMemory(const CCNxPingPayloadSource *source, size_t *length);
+#endif // ccnxPing_PayloadSource_h
@@ -0,0 +1,414 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <ctype.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define _defaultTrials 5
+#define _defaultWarmupTrials 1
+#define _maxTrials 101
+
+/**
+ * The metrics that are gated, how to find them in the results written by `ccnxPing_Client --json`,
+ * and whether a regression is a drop or a rise.
+ */
+typedef struct ccnx_ping_perf_metric {
+    const char *name;
+    const char *resultObject;
+    const char *resultKey;
+    bool higherIsBetter;
+    double defaultTolerance;
+} CCNxPingPerfMetric;
+
+static const CCNxPingPerfMetric _ccnxPingPerfGate_Metrics[] = {
+    { "throughput", NULL,     "throughput", true,  0.25 },
+    { "p50_us",     "rtt_us", "p50",        false, 0.50 },
+    { "p99_us",     "rtt_us", "p99",        false, 1.00 },
+    { NULL,         NULL,     NULL,         false, 0.0  }
+};
+
+#define _metricCount (sizeof(_ccnxPingPerfGate_Metrics) / sizeof(_ccnxPingPerfGate_Metrics[0]) - 1)
+
+/**
+ * Read a whole file into a NUL-terminated string that must be freed by the caller.
+ */
+static char *
+_ccnxPingPerfGate_ReadFile(const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    size_t capacity = 4096;
+    size_t length = 0;
+    char *contents = malloc(capacity);
+    size_t count;
+    while ((count = fread(contents + length, 1, capacity - length - 1, file)) > 0) {
+        length += count;
+        if (capacity - length - 1 == 0) {
+            capacity *= 2;
+            contents = realloc(contents, capacity);
+        }
+    }
+    contents[length] = '\0';
+    fclose(file);
+
+    return contents;
+}
+
+/**
+ * Find the number stored under `key`, inside the object stored under `object` if it is not NULL.
+ *
+ * This is not a general JSON parser: it only has to read the flat objects written by the client and
+ * the baseline files, where every key is unique within its object.
+ */
+static bool
+_ccnxPingPerfGate_FindNumber(const char *json, const char *object, const char *key, double *value)
+{
+    char pattern[128];
+    const char *scope = json;
+
+    if (object != NULL) {
+        snprintf(pattern, sizeof(pattern), "\"%s\"", object);
+        scope = strstr(json, pattern);
+        if (scope == NULL) {
+            return false;
+        }
+        scope += strlen(pattern);
+    }
+
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+    const char *found = strstr(scope, pattern);
+    if (found == NULL) {
+        return false;
+    }
+    found += strlen(pattern);
+    while (isspace((unsigned char) *found)) {
+        found++;
+    }
+    if (*found != ':') {
+        return false;
+    }
+
+    char *end = NULL;
+    *value = strtod(found + 1, &end);
+    return end != found + 1;
+}
+
+/**
+ * Run one trial of the command with `--json <resultPath>` appended, discarding its standard output.
+ */
+static bool
+_ccnxPingPerfGate_RunTrial(char **command, int commandLength, const char *resultPath)
+{
+    char **arguments = calloc(commandLength + 3, sizeof(char *));
+    memcpy(arguments, command, commandLength * sizeof(char *));
+    arguments[commandLength] = "--json";
+    arguments[commandLength + 1] = (char *) resultPath;
+
+    pid_t child = fork();
+    if (child == 0) {
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        close(devNull);
+        execvp(arguments[0], arguments);
+        fprintf(stderr, "Unable to run %s\n", arguments[0]);
+        _exit(127);
+    }
+    free(arguments);
+
+    int status = 0;
+    if (child < 0 || waitpid(child, &status, 0) < 0) {
+        return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static int
+_ccnxPingPerfGate_CompareDoubles(const void *a, const void *b)
+{
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+static double
+_ccnxPingPerfGate_Median(double *values, size_t count)
+{
+    qsort(values, count, sizeof(double), _ccnxPingPerfGate_CompareDoubles);
+    return count % 2 == 1 ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) / 2.0;
+}
+
+/**
+ * Rewrite the baseline file with the measured medians, keeping its tolerances.
+ */
+static bool
+_ccnxPingPerfGate_WriteBaseline(const char *path, const char *description,
+                                const double *medians, const double *tolerances)
+{
+    FILE *output = fopen(path, "w");
+    if (output == NULL) {
+        return false;
+    }
+
+    fprintf(output, "{\n    \"description\": \"%s\"", description);
+    for (size_t m = 0; m < _metricCount; m++) {
+        fprintf(output, ",\n    \"%s\": { \"value\": %.1f, \"tolerance\": %.2f }",
+                _ccnxPingPerfGate_Metrics[m].name, medians[m], tolerances[m]);
+    }
+    fprintf(output, "\n}\n");
+
+    return fclose(output) == 0;
+}
+
+/**
+ * Copy the description of the baseline (the text of its `description` key), or an empty string.
+ */
+static void
+_ccnxPingPerfGate_GetDescription(const char *json, char *description, size_t length)
+{
+    description[0] = '\0';
+    const char *found = json != NULL ? strstr(json, "\"description\"") : NULL;
+    if (found != NULL && (found = strchr(found + strlen("\"description\""), '"')) != NULL) {
+        const char *end = strchr(found + 1, '"');
+        if (end != NULL && (size_t) (end - found) <= length) {
+            memcpy(description, found + 1, end - found - 1);
+            description[end - found - 1] = '\0';
+        }
+    }
+}
+
+/**
+ * Display the usage message.
+ */
+static void
+_displayUsage(char *progName)
+{
+    printf("CCNx Ping Performance Regression Gate\n");
+    printf("\n");
+    printf("Runs a client command several times and compares the medians of its throughput and of its\n");
+    printf("RTT p50 and p99 against a baseline. The command is run with --json FILE appended.\n");
+    printf("\n");
+    printf("Usage: %s -b baseline.json [ -n trials ] [ -W warmup ] [ -s scale ] [ -u ] -- command [ args ]\n", progName);
+    printf("       %s -h\n", progName);
+    printf("\n");
+    printf("Example:\n");
+    printf("    ccnxPing_PerfGate -b baselines/loopback_flood.json -n 7 -- ccnxPing_Client -f -c 20000 -o 8 --loopback\n");
+    printf("\n");
+    printf("Options:\n");
+    printf("     -h (--help) Show this help message\n");
+    printf("     -b (--baseline) The baseline file: {\"throughput\": {\"value\": V, \"tolerance\": T}, \"p50_us\": ..., \"p99_us\": ...}\n");
+    printf("                     A tolerance T lets throughput drop to V * (1 - T) and latencies rise to V * (1 + T)\n");
+    printf("     -n (--trials) Number of measured trials; their median is compared (default %d)\n", _defaultTrials);
+    printf("     -W (--warmup) Number of trials run first and discarded (default %d)\n", _defaultWarmupTrials);
+    printf("     -s (--scale) Multiply every tolerance by this factor, e.g., on noisy machines (default 1.0)\n");
+    printf("     -u (--update) Record the measured medians as the new baseline instead of comparing\n");
+}
+
+int
+main(int argc, char *argv[argc])
+{
+    static struct option longopts[] = {
+        { "baseline", required_argument, NULL, 'b' },
+        { "trials",   required_argument, NULL, 'n' },
+        { "warmup",   required_argument, NULL, 'W' },
+        { "scale",    required_argument, NULL, 's' },
+        { "update",   no_argument,       NULL, 'u' },
+        { "help",     no_argument,       NULL, 'h' },
+        { NULL,       0,                 NULL, 0   }
+    };
+
+    const char *baselinePath = NULL;
+    int trials = _defaultTrials;
+    int warmupTrials = _defaultWarmupTrials;
+    double toleranceScale = 1.0;
+    bool update = false;
+
+    int c;
+    while ((c = getopt_long(argc, argv, "b:n:W:s:uh", longopts, NULL)) != -1) {
+        switch (c) {
+            case 'b':
+                baselinePath = optarg;
+                break;
+            case 'n':
+                trials = atoi(optarg);
+                break;
+            case 'W':
+                warmupTrials = atoi(optarg);
+                break;
+            case 's':
+                toleranceScale = atof(optarg);
+                break;
+            case 'u':
+                update = true;
+                break;
+            case 'h':
+            default:
+                _displayUsage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (baselinePath == NULL || optind >= argc || trials < 1 || trials > _maxTrials || warmupTrials < 0 || toleranceScale <= 0) {
+        _displayUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    char **command = &argv[optind];
+    int commandLength = argc - optind;
+
+    char *baseline = _ccnxPingPerfGate_ReadFile(baselinePath);
+    if (baseline == NULL && !update) {
+        fprintf(stderr, "Unable to read the baseline %s\n", baselinePath);
+        return EXIT_FAILURE;
+    }
+
+    char resultPath[] = "/tmp/ccnxPing_PerfGate_XXXXXX";
+    int resultFd = mkstemp(resultPath);
+    if (resultFd < 0) {
+        fprintf(stderr, "Unable to create a results file\n");
+        return EXIT_FAILURE;
+    }
+    close(resultFd);
+
+    double samples[_metricCount][_maxTrials];
+    bool failed = false;
+
+    for (int trial = -warmupTrials; trial < trials && !failed; trial++) {
+        char *results = NULL;
+        if (!_ccnxPingPerfGate_RunTrial(command, commandLength, resultPath) ||
+            (results = _ccnxPingPerfGate_ReadFile(resultPath)) == NULL) {
+            fprintf(stderr, "%s %d: the command failed or wrote no results\n",
+                    trial < 0 ? "Warmup trial" : "Trial", trial < 0 ? trial + warmupTrials + 1 : trial + 1);
+            failed = true;
+            break;
+        }
+
+        for (size_t m = 0; m < _metricCount && trial >= 0; m++) {
+            const CCNxPingPerfMetric *metric = &_ccnxPingPerfGate_Metrics[m];
+            if (!_ccnxPingPerfGate_FindNumber(results, metric->resultObject, metric->resultKey, &samples[m][trial])) {
+                fprintf(stderr, "Trial %d: the results have no %s\n", trial + 1, metric->name);
+                failed = true;
+            }
+        }
+        if (trial >= 0 && !failed) {
+            printf("Trial %d:", trial + 1);
+            for (size_t m = 0; m < _metricCount; m++) {
+                printf(" %s = %.1f", _ccnxPingPerfGate_Metrics[m].name, samples[m][trial]);
+            }
+            printf("\n");
+        }
+        free(results);
+    }
+    unlink(resultPath);
+
+    if (failed) {
+        free(baseline);
+        return EXIT_FAILURE;
+    }
+
+    double medians[_metricCount];
+    double tolerances[_metricCount];
+    printf("\n%-12s %12s %10s %12s %12s %12s %14s  %s\n",
+           "Metric", "Baseline", "Tolerance", "Median", "Min", "Max", "Limit", "Result");
+
+    for (size_t m = 0; m < _metricCount; m++) {
+        const CCNxPingPerfMetric *metric = &_ccnxPingPerfGate_Metrics[m];
+        medians[m] = _ccnxPingPerfGate_Median(samples[m], trials);
+
+        double expected = 0;
+        bool gated = baseline != NULL && _ccnxPingPerfGate_FindNumber(baseline, metric->name, "value", &expected);
+        if (baseline == NULL || !_ccnxPingPerfGate_FindNumber(baseline, metric->name, "tolerance", &tolerances[m])) {
+            tolerances[m] = metric->defaultTolerance;
+        }
+        if (!gated || update) {
+            printf("%-12s %12s %10s %12.1f %12.1f %12.1f %14s  %s\n", metric->name, "-", "-",
+                   medians[m], samples[m][0], samples[m][trials - 1], "-", "-");
+            continue;
+        }
+
+        double tolerance = tolerances[m] * toleranceScale;
+        double limit = metric->higherIsBetter ? expected * (1.0 - tolerance) : expected * (1.0 + tolerance);
+        bool regressed = metric->higherIsBetter ? medians[m] < limit : medians[m] > limit;
+        failed |= regressed;
+
+        printf("%-12s %12.1f %9.0f%% %12.1f %12.1f %12.1f %2s %11.1f  %s\n", metric->name, expected, 100.0 * tolerance,
+               medians[m], samples[m][0], samples[m][trials - 1], metric->higherIsBetter ? ">=" : "<=", limit,
+               regressed ? "REGRESSED" : "ok");
+    }
+
+    if (update) {
+        char description[256];
+        _ccnxPingPerfGate_GetDescription(baseline, description, sizeof(description));
+        if (!_ccnxPingPerfGate_WriteBaseline(baselinePath, description, medians, tolerances)) {
+            fprintf(stderr, "Unable to write the baseline %s\n", baselinePath);
+            failed = true;
+        } else {
+            printf("\nRecorded the medians as the new baseline %s\n", baselinePath);
+        }
+    }
+
+    free(baseline);
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
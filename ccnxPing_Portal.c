@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <parc/algol/parc_Object.h>
+
+#include <ccnx/api/ccnx_Portal/ccnx_PortalRTA.h>
+
+#include "ccnxPing_Common.h"
+#include "ccnxPing_Portal.h"
+
+/**
+ * The default spin budget of the hybrid receive mode (in microseconds).
+ */
+#define _defaultMaxSpinInUs 50
+
+/**
+ * The weight (as a power of two) of each new wait in the moving average of the hybrid mode.
+ */
+#define _waitAverageShift 3
+
+struct ccnx_ping_portal {
+    CCNxPortal *portal;
+    CCNxPingLoopback *loopback;
+
+    CCNxPingPortalPolling polling;
+    uint64_t averageWaitInUs;
+    CCNxPingPortalPollCounters counters;
+};
+
+static bool
+_ccnxPingPortal_Destructor(CCNxPingPortal **portalPtr)
+{
+    CCNxPingPortal *portal = *portalPtr;
+    if (portal->portal != NULL) {
+        ccnxPortal_Release(&(portal->portal));
+    }
+    if (portal->loopback != NULL) {
+        ccnxPingLoopback_Release(&(portal->loopback));
+    }
+    return true;
+}
+
+parcObject_Override(CCNxPingPortal, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingPortal_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingPortal, CCNxPingPortal);
+parcObject_ImplementRelease(ccnxPingPortal, CCNxPingPortal);
+
+void
+ccnxPingPortalPolling_Init(CCNxPingPortalPolling *polling)
+{
+    polling->mode = CCNxPingPortalPollMode_Block;
+    polling->maxSpinInUs = _defaultMaxSpinInUs;
+}
+
+bool
+ccnxPingPortalPolling_Parse(CCNxPingPortalPolling *polling, const char *specification)
+{
+    if (strcmp(specification, "block") == 0) {
+        polling->mode = CCNxPingPortalPollMode_Block;
+    } else if (strcmp(specification, "spin") == 0) {
+        polling->mode = CCNxPingPortalPollMode_Spin;
+    } else if (strncmp(specification, "hybrid", strlen("hybrid")) == 0) {
+        const char *budget = specification + strlen("hybrid");
+        polling->mode = CCNxPingPortalPollMode_Hybrid;
+        polling->maxSpinInUs = _defaultMaxSpinInUs;
+        if (*budget == ':') {
+            char *end = NULL;
+            polling->maxSpinInUs = strtoull(budget + 1, &end, 10);
+            return end != budget + 1 && *end == '\0';
+        }
+        return *budget == '\0';
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char *
+ccnxPingPortalPolling_GetName(const CCNxPingPortalPolling *polling)
+{
+    switch (polling->mode) {
+        case CCNxPingPortalPollMode_Spin:
+            return "spin";
+        case CCNxPingPortalPollMode_Hybrid:
+            return "hybrid";
+        case CCNxPingPortalPollMode_Block:
+        default:
+            return "block";
+    }
+}
+
+static CCNxPingPortal *
+_ccnxPingPortal_CreateEmpty(void)
+{
+    CCNxPingPortal *portal = parcObject_CreateInstance(CCNxPingPortal);
+    portal->portal = NULL;
+    portal->loopback = NULL;
+    ccnxPingPortalPolling_Init(&portal->polling);
+    portal->averageWaitInUs = 0;
+    memset(&portal->counters, 0, sizeof(portal->counters));
+    return portal;
+}
+
+CCNxPingPortal *
+ccnxPingPortal_CreateRTA(const char *keystoreName, const char *keystorePassword, const char *subjectName)
+{
+    CCNxPingPortal *portal = _ccnxPingPortal_CreateEmpty();
+
+    CCNxPortalFactory *factory = ccnxPingCommon_SetupPortalFactory(keystoreName, keystorePassword, subjectName);
+    portal->portal = ccnxPortalFactory_CreatePortal(factory, ccnxPortalRTA_Message);
+    ccnxPortalFactory_Release(&factory);
+
+    return portal;
+}
+
+CCNxPingPortal *
+ccnxPingPortal_CreateLoopback(const CCNxName *prefix, const CCNxPingLoopbackOptions *options)
+{
+    CCNxPingPortal *portal = _ccnxPingPortal_CreateEmpty();
+    portal->loopback = ccnxPingLoopback_Create(prefix, options);
+
+    if (portal->loopback == NULL) {
+        ccnxPingPortal_Release(&portal);
+    }
+    return portal;
+}
+
+bool
+ccnxPingPortal_Listen(CCNxPingPortal *portal, const CCNxName *prefix, const time_t secondsToLive, const CCNxStackTimeout *timeout)
+{
+    if (portal->loopback != NULL) {
+        return true;
+    }
+    return ccnxPortal_Listen(portal->portal, prefix, secondsToLive, timeout);
+}
+
+bool
+ccnxPingPortal_Send(CCNxPingPortal *portal, const CCNxMetaMessage *message, const CCNxStackTimeout *timeout)
+{
+    if (portal->loopback != NULL) {
+        return ccnxPingLoopback_Send(portal->loopback, message);
+    }
+    return ccnxPortal_Send(portal->portal, message, timeout);
+}
+
+static CCNxMetaMessage *
+_ccnxPingPortal_ReceiveOnce(CCNxPingPortal *portal, const CCNxStackTimeout *timeout)
+{
+    if (portal->loopback != NULL) {
+        return ccnxPingLoopback_Receive(portal->loopback, timeout);
+    }
+    return ccnxPortal_Receive(portal->portal, timeout);
+}
+
+/**
+ * Fold the time a receive waited into the moving average that sets the hybrid spin budget.
+ */
+static void
+_ccnxPingPortal_RecordWait(CCNxPingPortal *portal, uint64_t waitInUs)
+{
+    int64_t delta = (int64_t) waitInUs - (int64_t) portal->averageWaitInUs;
+    portal->averageWaitInUs += delta / (1 << _waitAverageShift);
+}
+
+CCNxMetaMessage *
+ccnxPingPortal_Receive(CCNxPingPortal *portal, const CCNxStackTimeout *timeout)
+{
+    if (portal->polling.mode == CCNxPingPortalPollMode_Block) {
+        ccnxPingCommon_CounterAdd(portal->counters.blocks, 1);
+        return _ccnxPingPortal_ReceiveOnce(portal, timeout);
+    }
+
+    uint64_t startInUs = ccnxPingCommon_MonotonicTimeInUs();
+    uint64_t deadlineInUs = timeout != CCNxStackTimeout_Never ? startInUs + *timeout : UINT64_MAX;
+    uint64_t spinDeadlineInUs = deadlineInUs;
+    if (portal->polling.mode == CCNxPingPortalPollMode_Hybrid) {
+        uint64_t budgetInUs = portal->averageWaitInUs <= portal->polling.maxSpinInUs / 2 ? 2 * portal->averageWaitInUs :
+                              portal->averageWaitInUs <= portal->polling.maxSpinInUs ? portal->polling.maxSpinInUs : 0;
+        spinDeadlineInUs = startInUs + budgetInUs < deadlineInUs ? startInUs + budgetInUs : deadlineInUs;
+    }
+
+    // Always poll at least once, so that an immediate timeout still returns a waiting message.
+    const uint64_t immediate = 0;
+    uint64_t nowInUs = startInUs;
+    CCNxMetaMessage *message = NULL;
+    uint64_t polls = 0;
+    do {
+        message = _ccnxPingPortal_ReceiveOnce(portal, &immediate);
+        polls++;
+        if (message == NULL) {
+            nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+        }
+    } while (message == NULL && nowInUs < spinDeadlineInUs);
+    ccnxPingCommon_CounterAdd(portal->counters.polls, polls);
+
+    if (message != NULL) {
+        ccnxPingCommon_CounterAdd(portal->counters.spinHits, 1);
+        _ccnxPingPortal_RecordWait(portal, nowInUs - startInUs);
+        return message;
+    }
+
+    if (portal->polling.mode == CCNxPingPortalPollMode_Hybrid && nowInUs < deadlineInUs) {
+        ccnxPingCommon_CounterAdd(portal->counters.blocks, 1);
+        uint64_t remainingInUs = deadlineInUs - nowInUs;
+        message = _ccnxPingPortal_ReceiveOnce(portal, deadlineInUs == UINT64_MAX ? CCNxStackTimeout_Never : &remainingInUs);
+        nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+    }
+    _ccnxPingPortal_RecordWait(portal, nowInUs - startInUs);
+
+    return message;
+}
+
+void
+ccnxPingPortal_SetPolling(CCNxPingPortal *portal, const CCNxPingPortalPolling *polling)
+{
+    portal->polling = *polling;
+    portal->averageWaitInUs = 0;
+}
+
+void
+ccnxPingPortal_GetPollCounters(const CCNxPingPortal *portal, CCNxPingPortalPollCounters *counters)
+{
+    counters->polls = ccnxPingCommon_CounterGet(portal->counters.polls);
+    counters->spinHits = ccnxPingCommon_CounterGet(portal->counters.spinHits);
+    counters->blocks = ccnxPingCommon_CounterGet(portal->counters.blocks);
+}
+
+int
+ccnxPingPortal_GetError(const CCNxPingPortal *portal)
+{
+    return portal->portal != NULL ? ccnxPortal_GetError(portal->portal) : 0;
+}
+
+void
+ccnxPingPortal_WriteCounters(const CCNxPingPortal *portal, FILE *output)
+{
+    if (portal == NULL) {
+        return;
+    }
+    if (portal->polling.mode != CCNxPingPortalPollMode_Block) {
+        CCNxPingPortalPollCounters counters;
+        ccnxPingPortal_GetPollCounters(portal, &counters);
+        fprintf(output, "Receive = %s : Polls = %" PRIu64 " : Spin hits = %" PRIu64 " : Blocked = %" PRIu64 "\n",
+                ccnxPingPortalPolling_GetName(&portal->polling), counters.polls, counters.spinHits, counters.blocks);
+    }
+    if (portal->loopback != NULL) {
+        ccnxPingLoopback_WriteCounters(portal->loopback, output);
+    }
+}
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Portal_h
+#define ccnxPing_Portal_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <ccnx/api/ccnx_Portal/ccnx_Portal.h>
+
+#include "ccnxPing_Loopback.h"
+
+/**
+ * The send/receive interface used by the ping client and server, backed either by a CCNx portal
+ * over the RTA stack (which needs a forwarder) or by an in-process `CCNxPingLoopback`.
+ */
+struct ccnx_ping_portal;
+typedef struct ccnx_ping_portal CCNxPingPortal;
+
+/**
+ * How `ccnxPingPortal_Receive` waits for a message.
+ *
+ * `Block` sleeps in the stack until a message arrives, so every message pays for a scheduler wakeup.
+ * `Spin` busy-polls with immediate receives until a message arrives or the timeout passes, trading a
+ * whole CPU for the lowest latency. `Hybrid` spins for an adaptive budget of at most `maxSpinInUs`
+ * and then blocks: the budget is twice a moving average of recent waits, and no spinning at all
+ * once that average exceeds `maxSpinInUs`.
+ */
+typedef enum {
+    CCNxPingPortalPollMode_Block = 0,
+    CCNxPingPortalPollMode_Spin,
+    CCNxPingPortalPollMode_Hybrid
+} CCNxPingPortalPollMode;
+
+typedef struct ccnx_ping_portal_polling {
+    CCNxPingPortalPollMode mode;
+    uint64_t maxSpinInUs;
+} CCNxPingPortalPolling;
+
+/**
+ * What `ccnxPingPortal_Receive` did to obtain its messages.
+ */
+typedef struct ccnx_ping_portal_poll_counters {
+    // Immediate receives issued while spinning.
+    uint64_t polls;
+    // Messages found while spinning.
+    uint64_t spinHits;
+    // Receives that blocked, because the mode is `Block` or the spin budget ran out.
+    uint64_t blocks;
+} CCNxPingPortalPollCounters;
+
+/**
+ * Initialize `polling` to the blocking mode.
+ *
+ * @param [out] polling The `CCNxPingPortalPolling` to initialize.
+ */
+void ccnxPingPortalPolling_Init(CCNxPingPortalPolling *polling);
+
+/**
+ * Parse a receive mode: `block`, `spin` or `hybrid[:MAXUS]` (at most 50 us of spinning by default).
+ *
+ * @param [out] polling The `CCNxPingPortalPolling` to set.
+ * @param [in] specification The textual mode.
+ *
+ * @retval true If the specification was valid.
+ * @retval false Otherwise
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingPortalPolling polling;
+ *     ccnxPingPortalPolling_Init(&polling);
+ *     ccnxPingPortalPolling_Parse(&polling, "hybrid:20");
+ *     ccnxPingPortal_SetPolling(portal, &polling);
+ * }
+ * @endcode
+ */
+bool ccnxPingPortalPolling_Parse(CCNxPingPortalPolling *polling, const char *specification);
+
+/**
+ * @return The name of the receive mode (`block`, `spin` or `hybrid`).
+ */
+const char *ccnxPingPortalPolling_GetName(const CCNxPingPortalPolling *polling);
+
+/**
+ * Create a `CCNxPingPortal` over the RTA stack, with a newly generated identity.
+ *
+ * @param [in] keystoreName The name of the file to save the new identity.
+ * @param [in] keystorePassword The password of the file holding the identity.
+ * @param [in] subjectName The name of the owner of the identity.
+ *
+ * @return A new `CCNxPingPortal` that must be released with `ccnxPingPortal_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingPortal *portal = ccnxPingPortal_CreateRTA("client.keystore", "keystore_password", "client");
+ *     ccnxPingPortal_Send(portal, message, CCNxStackTimeout_Never);
+ *     ccnxPingPortal_Release(&portal);
+ * }
+ * @endcode
+ */
+CCNxPingPortal *ccnxPingPortal_CreateRTA(const char *keystoreName, const char *keystorePassword, const char *subjectName);
+
+/**
+ * Create a `CCNxPingPortal` over an in-process loopback responder (see `CCNxPingLoopback`).
+ *
+ * @param [in] prefix The prefix answered by the responder.
+ * @param [in] options The impairments and the served object.
+ *
+ * @return A new `CCNxPingPortal`, or NULL if the loopback could not be started.
+ */
+CCNxPingPortal *ccnxPingPortal_CreateLoopback(const CCNxName *prefix, const CCNxPingLoopbackOptions *options);
+
+/**
+ * Increase the number of references to a `CCNxPingPortal`.
+ *
+ * @param [in] portal A pointer to a `CCNxPingPortal` instance.
+ *
+ * @return The input `CCNxPingPortal` pointer.
+ */
+CCNxPingPortal *ccnxPingPortal_Acquire(const CCNxPingPortal *portal);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] portalPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingPortal_Release(CCNxPingPortal **portalPtr);
+
+/**
+ * Listen for interests under a prefix. A loopback portal has no upstream and accepts any prefix.
+ *
+ * @see ccnxPortal_Listen
+ */
+bool ccnxPingPortal_Listen(CCNxPingPortal *portal, const CCNxName *prefix, const time_t secondsToLive, const CCNxStackTimeout *timeout);
+
+/**
+ * Send a message.
+ *
+ * @see ccnxPortal_Send
+ */
+bool ccnxPingPortal_Send(CCNxPingPortal *portal, const CCNxMetaMessage *message, const CCNxStackTimeout *timeout);
+
+/**
+ * Receive a message, waiting at most `timeout` (`CCNxStackTimeout_Never` waits indefinitely).
+ *
+ * @see ccnxPortal_Receive
+ */
+CCNxMetaMessage *ccnxPingPortal_Receive(CCNxPingPortal *portal, const CCNxStackTimeout *timeout);
+
+/**
+ * Set how `ccnxPingPortal_Receive` waits for a message (see `CCNxPingPortalPolling`).
+ *
+ * @param [in] portal The `CCNxPingPortal` instance.
+ * @param [in] polling The receive mode.
+ */
+void ccnxPingPortal_SetPolling(CCNxPingPortal *portal, const CCNxPingPortalPolling *polling);
+
+/**
+ * Read the receive counters of the portal. Safe to call from any thread.
+ *
+ * @param [in] portal The `CCNxPingPortal` instance.
+ * @param [out] counters The counters.
+ */
+void ccnxPingPortal_GetPollCounters(const CCNxPingPortal *portal, CCNxPingPortalPollCounters *counters);
+
+/**
+ * @return The error of the last failed operation, or 0 for a loopback portal.
+ */
+int ccnxPingPortal_GetError(const CCNxPingPortal *portal);
+
+/**
+ * Write the receive counters of a polling portal and the impairment counters of a loopback portal.
+ *
+ * @param [in] portal The `CCNxPingPortal` instance.
+ * @param [in] output The stream to write to.
+ */
+void ccnxPingPortal_WriteCounters(const CCNxPingPortal *portal, FILE *output);
+#endif // ccnxPing_Portal_h
@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#include <parc/algol/parc_DisplayIndented.h>
+#include <parc/algol/parc_Object.h>
+
+#include "ccnxPing_ResourceUsage.h"
+
+/**
+ * Where the tracefs id of the `raw_syscalls:sys_enter` tracepoint may be found.
+ */
+static const char *_syscallTracepointIds[] = {
+    "/sys/kernel/tracing/events/raw_syscalls/sys_enter/id",
+    "/sys/kernel/debug/tracing/events/raw_syscalls/sys_enter/id",
+    NULL
+};
+
+static const char *_ccnxPingResourceCounter_Names[CCNxPingResourceCounter_Count] = {
+    "cycles", "instructions", "cache_misses", "syscalls"
+};
+
+struct ccnx_ping_resource_meter {
+    int fds[CCNxPingResourceCounter_Count];
+};
+
+static bool
+_ccnxPingResourceMeter_Destructor(CCNxPingResourceMeter **meterPtr)
+{
+    CCNxPingResourceMeter *meter = *meterPtr;
+    for (int i = 0; i < CCNxPingResourceCounter_Count; i++) {
+        if (meter->fds[i] >= 0) {
+            close(meter->fds[i]);
+        }
+    }
+    return true;
+}
+
+parcObject_Override(CCNxPingResourceMeter, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingResourceMeter_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingResourceMeter, CCNxPingResourceMeter);
+parcObject_ImplementRelease(ccnxPingResourceMeter, CCNxPingResourceMeter);
+
+#ifdef __linux__
+/**
+ * Open a counter of this process and the threads it creates from now on. Kernel events are
+ * counted when `perf_event_paranoid` allows it, and user space events only otherwise.
+ */
+static int
+_ccnxPingResourceMeter_Open(uint32_t type, uint64_t config)
+{
+    struct perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.inherit = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int fd = (int) syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+    if (fd < 0 && (errno == EACCES || errno == EPERM) && type != PERF_TYPE_TRACEPOINT) {
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        fd = (int) syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+    }
+    return fd;
+}
+
+static int
+_ccnxPingResourceMeter_OpenSyscalls(void)
+{
+    for (const char **path = _syscallTracepointIds; *path != NULL; path++) {
+        FILE *file = fopen(*path, "r");
+        if (file != NULL) {
+            uint64_t id;
+            bool found = fscanf(file, "%" SCNu64, &id) == 1;
+            fclose(file);
+            if (found) {
+                return _ccnxPingResourceMeter_Open(PERF_TYPE_TRACEPOINT, id);
+            }
+        }
+    }
+    return -1;
+}
+#endif
+
+CCNxPingResourceMeter *
+ccnxPingResourceMeter_Create(void)
+{
+    CCNxPingResourceMeter *meter = parcObject_CreateInstance(CCNxPingResourceMeter);
+
+    for (int i = 0; i < CCNxPingResourceCounter_Count; i++) {
+        meter->fds[i] = -1;
+    }
+#ifdef __linux__
+    meter->fds[CCNxPingResourceCounter_Cycles] = _ccnxPingResourceMeter_Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    meter->fds[CCNxPingResourceCounter_Instructions] = _ccnxPingResourceMeter_Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    meter->fds[CCNxPingResourceCounter_CacheMisses] = _ccnxPingResourceMeter_Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    meter->fds[CCNxPingResourceCounter_Syscalls] = _ccnxPingResourceMeter_OpenSyscalls();
+#endif
+
+    return meter;
+}
+
+static uint64_t
+_ccnxPingResourceUsage_TimevalInUs(const struct timeval *value)
+{
+    return (uint64_t) value->tv_sec * 1000000 + (uint64_t) value->tv_usec;
+}
+
+void
+ccnxPingResourceMeter_Read(const CCNxPingResourceMeter *meter, CCNxPingResourceUsage *usage)
+{
+    memset(usage, 0, sizeof(*usage));
+
+    struct rusage self;
+    if (getrusage(RUSAGE_SELF, &self) == 0) {
+        usage->userTimeInUs = _ccnxPingResourceUsage_TimevalInUs(&self.ru_utime);
+        usage->systemTimeInUs = _ccnxPingResourceUsage_TimevalInUs(&self.ru_stime);
+        usage->voluntaryContextSwitches = (uint64_t) self.ru_nvcsw;
+        usage->involuntaryContextSwitches = (uint64_t) self.ru_nivcsw;
+        usage->minorFaults = (uint64_t) self.ru_minflt;
+        usage->majorFaults = (uint64_t) self.ru_majflt;
+    }
+
+    for (int i = 0; i < CCNxPingResourceCounter_Count; i++) {
+        // The value, then the times the counter was enabled and actually running.
+        uint64_t values[3];
+        if (meter->fds[i] >= 0 && read(meter->fds[i], values, sizeof(values)) == sizeof(values)) {
+            double scale = values[2] > 0 && values[2] < values[1] ? (double) values[1] / values[2] : 1.0;
+            usage->counters[i] = (uint64_t) (values[0] * scale);
+            usage->available |= 1u << i;
+        }
+    }
+}
+
+void
+ccnxPingResourceUsage_Difference(CCNxPingResourceUsage *result, const CCNxPingResourceUsage *end, const CCNxPingResourceUsage *start)
+{
+    result->userTimeInUs = end->userTimeInUs - start->userTimeInUs;
+    result->systemTimeInUs = end->systemTimeInUs - start->systemTimeInUs;
+    result->voluntaryContextSwitches = end->voluntaryContextSwitches - start->voluntaryContextSwitches;
+    result->involuntaryContextSwitches = end->involuntaryContextSwitches - start->involuntaryContextSwitches;
+    result->minorFaults = end->minorFaults - start->minorFaults;
+    result->majorFaults = end->majorFaults - start->majorFaults;
+
+    result->available = end->available & start->available;
+    for (int i = 0; i < CCNxPingResourceCounter_Count; i++) {
+        result->counters[i] = (result->available & (1u << i)) ? end->counters[i] - start->counters[i] : 0;
+    }
+}
+
+static bool
+_ccnxPingResourceUsage_Has(const CCNxPingResourceUsage *usage, CCNxPingResourceCounter counter)
+{
+    return (usage->available & (1u << counter)) != 0;
+}
+
+/**
+ * Format the event counters that are available as ` : name value` pairs, each divided by `divisor`.
+ */
+static void
+_ccnxPingResourceUsage_FormatCounters(const CCNxPingResourceUsage *usage, double divisor, char *buffer, size_t length)
+{
+    buffer[0] = '\0';
+    size_t used = 0;
+    for (int i = 0; i < CCNxPingResourceCounter_Count && used < length; i++) {
+        if (_ccnxPingResourceUsage_Has(usage, i)) {
+            used += snprintf(buffer + used, length - used, " : %s %.*f", _ccnxPingResourceCounter_Names[i],
+                             divisor == 1.0 ? 0 : 3, usage->counters[i] / divisor);
+        }
+    }
+}
+
+void
+ccnxPingResourceUsage_Display(const CCNxPingResourceUsage *usage, int indentation, uint64_t operations, uint64_t bytes)
+{
+    char counters[256];
+    uint64_t cpuTimeInUs = usage->userTimeInUs + usage->systemTimeInUs;
+    uint64_t contextSwitches = usage->voluntaryContextSwitches + usage->involuntaryContextSwitches;
+    uint64_t faults = usage->minorFaults + usage->majorFaults;
+
+    parcDisplayIndented_PrintLine(indentation, "Resources = user %.3f s : sys %.3f s : ctxsw %" PRIu64 " voluntary, %" PRIu64 " involuntary : faults %" PRIu64 " minor, %" PRIu64 " major",
+                                  usage->userTimeInUs / 1000000.0, usage->systemTimeInUs / 1000000.0,
+                                  usage->voluntaryContextSwitches, usage->involuntaryContextSwitches,
+                                  usage->minorFaults, usage->majorFaults);
+    if (usage->available == 0) {
+        parcDisplayIndented_PrintLine(indentation, "Counters = unavailable (perf_event_open)");
+    } else {
+        _ccnxPingResourceUsage_FormatCounters(usage, 1.0, counters, sizeof(counters));
+        parcDisplayIndented_PrintLine(indentation, "Counters = %s", counters + 3);
+    }
+
+    if (operations > 0) {
+        _ccnxPingResourceUsage_FormatCounters(usage, (double) operations, counters, sizeof(counters));
+        parcDisplayIndented_PrintLine(indentation, "Per ping = cpu %.3f us : ctxsw %.3f : faults %.3f%s",
+                                      (double) cpuTimeInUs / operations, (double) contextSwitches / operations,
+                                      (double) faults / operations, counters);
+    }
+    if (bytes > 0) {
+        _ccnxPingResourceUsage_FormatCounters(usage, (double) bytes, counters, sizeof(counters));
+        parcDisplayIndented_PrintLine(indentation, "Per byte = cpu %.6f us%s", (double) cpuTimeInUs / bytes, counters);
+    }
+}
+
+void
+ccnxPingResourceUsage_WriteText(const CCNxPingResourceUsage *usage, uint64_t operations, uint64_t bytes, FILE *output)
+{
+    uint64_t cpuTimeInUs = usage->userTimeInUs + usage->systemTimeInUs;
+
+    fprintf(output, "user time           %.3f s\n", usage->userTimeInUs / 1000000.0);
+    fprintf(output, "system time         %.3f s\n", usage->systemTimeInUs / 1000000.0);
+    fprintf(output, "voluntary ctxsw     %" PRIu64 "\n", usage->voluntaryContextSwitches);
+    fprintf(output, "involuntary ctxsw   %" PRIu64 "\n", usage->involuntaryContextSwitches);
+    fprintf(output, "minor faults        %" PRIu64 "\n", usage->minorFaults);
+    fprintf(output, "major faults        %" PRIu64 "\n", usage->majorFaults);
+    for (int i = 0; i < CCNxPingResourceCounter_Count; i++) {
+        if (_ccnxPingResourceUsage_Has(usage, i)) {
+            fprintf(output, "%-19s %" PRIu64 "\n", _ccnxPingResourceCounter_Names[i], usage->counters[i]);
+        }
+    }
+    if (operations > 0) {
+        fprintf(output, "cpu per response    %.3f us\n", (double) cpuTimeInUs / operations);
+        if (_ccnxPingResourceUsage_Has(usage, CCNxPingResourceCounter_Cycles)) {
+            fprintf(output, "cycles per response %.1f\n", (double) usage->counters[CCNxPingResourceCounter_Cycles] / operations);
+        }
+        if (_ccnxPingResourceUsage_Has(usage, CCNxPingResourceCounter_Syscalls)) {
+            fprintf(output, "syscalls per resp.  %.3f\n", (double) usage->counters[CCNxPingResourceCounter_Syscalls] / operations);
+        }
+    }
+    if (bytes > 0) {
+        fprintf(output, "cpu per byte        %.6f us\n", (double) cpuTimeInUs / bytes);
+    }
+}
+
+/**
+ * Write the members of the normalized cost object, each value divided by `divisor`.
+ */
+static void
+_ccnxPingResourceUsage_WriteNormalized(const CCNxPingResourceUsage *usage, double divisor, FILE *output)
+{
+    fprintf(output, "{\"cpu_time_us\":%.6f,\"context_switches\":%.6f,\"faults\":%.6f",
+            (usage->userTimeInUs + usage->systemTimeInUs) / divisor,
+            (usage->voluntaryContextSwitches + usage->involuntaryContextSwitches) / divisor,
+            (usage->minorFaults + usage->majorFaults) / divisor);
+    for (int i = 0; i < CCNxPingResourceCounter_Count; i++) {
+        if (_ccnxPingResourceUsage_Has(usage, i)) {
+            fprintf(output, ",\"%s\":%.6f", _ccnxPingResourceCounter_Names[i], usage->counters[i] / divisor);
+        }
+    }
+    fprintf(output, "}");
+}
+
+void
+ccnxPingResourceUsage_WriteJSON(const CCNxPingResourceUsage *usage, uint64_t operations, uint64_t bytes, FILE *output)
+{
+    fprintf(output, "{\"user_time_us\":%" PRIu64 ",\"system_time_us\":%" PRIu64 ",\"voluntary_context_switches\":%" PRIu64
+            ",\"involuntary_context_switches\":%" PRIu64 ",\"minor_faults\":%" PRIu64 ",\"major_faults\":%" PRIu64,
+            usage->userTimeInUs, usage->systemTimeInUs, usage->voluntaryContextSwitches,
+            usage->involuntaryContextSwitches, usage->minorFaults, usage->majorFaults);
+    for (int i = 0; i < CCNxPingResourceCounter_Count; i++) {
+        if (_ccnxPingResourceUsage_Has(usage, i)) {
+            fprintf(output, ",\"%s\":%" PRIu64, _ccnxPingResourceCounter_Names[i], usage->counters[i]);
+        }
+    }
+    if (operations > 0) {
+        fprintf(output, ",\"per_op\":");
+        _ccnxPingResourceUsage_WriteNormalized(usage, (double) operations, output);
+    }
+    if (bytes > 0) {
+        fprintf(output, ",\"per_byte\":");
+        _ccnxPingResourceUsage_WriteNormalized(usage, (double) bytes, output);
+    }
+    fprintf(output, "}");
+}
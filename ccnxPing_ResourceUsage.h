@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_ResourceUsage_h
+#define ccnxPing_ResourceUsage_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * The hardware and kernel event counters read with perf_event_open(2) when the kernel allows it.
+ */
+typedef enum {
+    CCNxPingResourceCounter_Cycles,
+    CCNxPingResourceCounter_Instructions,
+    CCNxPingResourceCounter_CacheMisses,
+    CCNxPingResourceCounter_Syscalls,
+    CCNxPingResourceCounter_Count
+} CCNxPingResourceCounter;
+
+/**
+ * The resources used by the whole process (all of its threads) over some period.
+ *
+ * The event counters are valid only when their bit (`1 << CCNxPingResourceCounter_X`) is set in
+ * `available`. They are scaled up when the kernel had to multiplex them.
+ */
+typedef struct ccnx_ping_resource_usage {
+    uint64_t userTimeInUs;
+    uint64_t systemTimeInUs;
+    uint64_t voluntaryContextSwitches;
+    uint64_t involuntaryContextSwitches;
+    uint64_t minorFaults;
+    uint64_t majorFaults;
+
+    unsigned available;
+    uint64_t counters[CCNxPingResourceCounter_Count];
+} CCNxPingResourceUsage;
+
+/**
+ * Reads the resource usage of the process: getrusage(2), plus the counters of `CCNxPingResourceCounter`.
+ *
+ * The event counters follow the threads created after the meter, so it should be created before
+ * the portal and any worker thread. Counters that cannot be opened (no kernel support, or a
+ * restrictive `perf_event_paranoid`) are simply left out of the usage.
+ */
+struct ccnx_ping_resource_meter;
+typedef struct ccnx_ping_resource_meter CCNxPingResourceMeter;
+
+/**
+ * Create a `CCNxPingResourceMeter` and start its event counters.
+ *
+ * @return A new `CCNxPingResourceMeter` that must be released with `ccnxPingResourceMeter_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingResourceMeter *meter = ccnxPingResourceMeter_Create();
+ *     CCNxPingResourceUsage start, end, run;
+ *     ccnxPingResourceMeter_Read(meter, &start);
+ *     ...
+ *     ccnxPingResourceMeter_Read(meter, &end);
+ *     ccnxPingResourceUsage_Difference(&run, &end, &start);
+ *     ccnxPingResourceUsage_Display(&run, 0, responses, bytes);
+ *     ccnxPingResourceMeter_Release(&meter);
+ * }
+ * @endcode
+ */
+CCNxPingResourceMeter *ccnxPingResourceMeter_Create(void);
+
+/**
+ * Increase the number of references to a `CCNxPingResourceMeter`.
+ *
+ * @param [in] meter A pointer to a `CCNxPingResourceMeter` instance.
+ *
+ * @return The input `CCNxPingResourceMeter` pointer.
+ */
+CCNxPingResourceMeter *ccnxPingResourceMeter_Acquire(const CCNxPingResourceMeter *meter);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] meterPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingResourceMeter_Release(CCNxPingResourceMeter **meterPtr);
+
+/**
+ * Read the usage of the process since it started. May be called from any thread.
+ *
+ * @param [in] meter The `CCNxPingResourceMeter` instance.
+ * @param [out] usage The cumulative usage.
+ */
+void ccnxPingResourceMeter_Read(const CCNxPingResourceMeter *meter, CCNxPingResourceUsage *usage);
+
+/**
+ * Compute the usage between two readings of the same meter.
+ *
+ * @param [out] result The usage from `start` to `end`.
+ * @param [in] end The later reading.
+ * @param [in] start The earlier reading.
+ */
+void ccnxPingResourceUsage_Difference(CCNxPingResourceUsage *result, const CCNxPingResourceUsage *end, const CCNxPingResourceUsage *start);
+
+/**
+ * Display the usage, its cost per operation and its cost per byte.
+ *
+ * @param [in] usage The `CCNxPingResourceUsage` to display.
+ * @param [in] indentation The indentation level.
+ * @param [in] operations The number of operations (e.g., responses received) the usage bought.
+ * @param [in] bytes The number of payload bytes the usage bought.
+ */
+void ccnxPingResourceUsage_Display(const CCNxPingResourceUsage *usage, int indentation, uint64_t operations, uint64_t bytes);
+
+/**
+ * Write the usage as `name value` lines aligned like the telemetry text format.
+ *
+ * @param [in] usage The `CCNxPingResourceUsage` to write.
+ * @param [in] operations The number of operations the usage bought.
+ * @param [in] bytes The number of payload bytes the usage bought.
+ * @param [in] output The stream to write to.
+ */
+void ccnxPingResourceUsage_WriteText(const CCNxPingResourceUsage *usage, uint64_t operations, uint64_t bytes, FILE *output);
+
+/**
+ * Write the usage as a JSON object, with its cost normalized under `per_op` and `per_byte`.
+ *
+ * @param [in] usage The `CCNxPingResourceUsage` to write.
+ * @param [in] operations The number of operations the usage bought.
+ * @param [in] bytes The number of payload bytes the usage bought.
+ * @param [in] output The stream to write to.
+ *
+ * Example:
+ * @code
+ * {
+ *     ccnxPingResourceUsage_WriteJSON(&usage, 1000, 8192000, stdout);
+ *     // {"user_time_us":81000,"system_time_us":120000,...,"cycles":612000000,"per_op":{"cpu_time_us":201.0,...},"per_byte":{...}}
+ * }
+ * @endcode
+ */
+void ccnxPingResourceUsage_WriteJSON(const CCNxPingResourceUsage *usage, uint64_t operations, uint64_t bytes, FILE *output);
+#endif // ccnxPing_ResourceUsage_h
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxPing_Common.h"
+#include "ccnxPing_ResponseCache.h"
+
+typedef struct ccnx_ping_response_cache_entry {
+    CCNxName *name;
+    CCNxMetaMessage *response;
+} _CCNxPingResponseCacheEntry;
+
+struct ccnx_ping_response_cache {
+    size_t capacity;
+    size_t size;
+    uint64_t hits;
+    uint64_t misses;
+    _CCNxPingResponseCacheEntry *entries;
+};
+
+static void
+_ccnxPingResponseCache_ClearEntry(_CCNxPingResponseCacheEntry *entry)
+{
+    if (entry->name != NULL) {
+        ccnxName_Release(&entry->name);
+        ccnxMetaMessage_Release(&entry->response);
+    }
+}
+
+static bool
+_ccnxPingResponseCache_Destructor(CCNxPingResponseCache **cachePtr)
+{
+    CCNxPingResponseCache *cache = *cachePtr;
+    for (size_t i = 0; i < cache->capacity; i++) {
+        _ccnxPingResponseCache_ClearEntry(&cache->entries[i]);
+    }
+    parcMemory_Deallocate(&cache->entries);
+    return true;
+}
+
+parcObject_Override(CCNxPingResponseCache, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingResponseCache_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingResponseCache, CCNxPingResponseCache);
+parcObject_ImplementRelease(ccnxPingResponseCache, CCNxPingResponseCache);
+
+CCNxPingResponseCache *
+ccnxPingResponseCache_Create(size_t capacity)
+{
+    CCNxPingResponseCache *cache = parcObject_CreateInstance(CCNxPingResponseCache);
+
+    cache->capacity = capacity > 0 ? capacity : 1;
+    cache->size = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->entries = parcMemory_AllocateAndClear(cache->capacity * sizeof(_CCNxPingResponseCacheEntry));
+
+    return cache;
+}
+
+CCNxMetaMessage *
+ccnxPingResponseCache_Get(CCNxPingResponseCache *cache, const CCNxName *name)
+{
+    _CCNxPingResponseCacheEntry *entry = &cache->entries[ccnxName_HashCode(name) % cache->capacity];
+
+    if (entry->name != NULL && ccnxName_Equals(entry->name, name)) {
+        ccnxPingCommon_CounterAdd(cache->hits, 1);
+        return ccnxMetaMessage_Acquire(entry->response);
+    }
+
+    ccnxPingCommon_CounterAdd(cache->misses, 1);
+    return NULL;
+}
+
+void
+ccnxPingResponseCache_Put(CCNxPingResponseCache *cache, const CCNxName *name, const CCNxMetaMessage *response)
+{
+    _CCNxPingResponseCacheEntry *entry = &cache->entries[ccnxName_HashCode(name) % cache->capacity];
+
+    if (entry->name == NULL) {
+        ccnxPingCommon_CounterAdd(cache->size, 1);
+    }
+    _ccnxPingResponseCache_ClearEntry(entry);
+
+    entry->name = ccnxName_Acquire(name);
+    entry->response = ccnxMetaMessage_Acquire(response);
+}
+
+uint64_t
+ccnxPingResponseCache_GetHits(const CCNxPingResponseCache *cache)
+{
+    return ccnxPingCommon_CounterGet(cache->hits);
+}
+
+uint64_t
+ccnxPingResponseCache_GetMisses(const CCNxPingResponseCache *cache)
+{
+    return ccnxPingCommon_CounterGet(cache->misses);
+}
+
+size_t
+ccnxPingResponseCache_GetSize(const CCNxPingResponseCache *cache)
+{
+    return ccnxPingCommon_CounterGet(cache->size);
+}
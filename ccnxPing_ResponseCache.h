@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_ResponseCache_h
+#define ccnxPing_ResponseCache_h
+
+#include <stdint.h>
+
+#include <ccnx/common/ccnx_Name.h>
+#include <ccnx/transport/common/transport_MetaMessage.h>
+
+/**
+ * A fixed-size, direct-mapped cache of ready-to-send responses keyed by name.
+ *
+ * When the same names are requested repeatedly (e.g., a Zipf-distributed workload), a response that
+ * has already been built and signed can be sent again without paying for the signature. Each name
+ * hashes to exactly one slot, so lookups and insertions are O(1) and the memory is bounded by the
+ * capacity; a colliding insertion simply replaces the previous entry.
+ */
+struct ccnx_ping_response_cache;
+typedef struct ccnx_ping_response_cache CCNxPingResponseCache;
+
+/**
+ * Create an empty `CCNxPingResponseCache`.
+ *
+ * @param [in] capacity The number of slots.
+ *
+ * @return A new `CCNxPingResponseCache` that must be released with `ccnxPingResponseCache_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingResponseCache *cache = ccnxPingResponseCache_Create(65536);
+ *     CCNxMetaMessage *response = ccnxPingResponseCache_Get(cache, name);
+ *     if (response == NULL) {
+ *         response = _buildAndSign(name);
+ *         ccnxPingResponseCache_Put(cache, name, response);
+ *     }
+ *     ...
+ *     ccnxMetaMessage_Release(&response);
+ *     ccnxPingResponseCache_Release(&cache);
+ * }
+ * @endcode
+ */
+CCNxPingResponseCache *ccnxPingResponseCache_Create(size_t capacity);
+
+/**
+ * Increase the number of references to a `CCNxPingResponseCache`.
+ *
+ * @param [in] cache A pointer to a `CCNxPingResponseCache` instance.
+ *
+ * @return The input `CCNxPingResponseCache` pointer.
+ */
+CCNxPingResponseCache *ccnxPingResponseCache_Acquire(const CCNxPingResponseCache *cache);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] cachePtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingResponseCache_Release(CCNxPingResponseCache **cachePtr);
+
+/**
+ * Look up the response cached for a name.
+ *
+ * @param [in] cache The `CCNxPingResponseCache` instance.
+ * @param [in] name The name of the requested content.
+ *
+ * @return A new reference to the cached response, or NULL on a miss.
+ */
+CCNxMetaMessage *ccnxPingResponseCache_Get(CCNxPingResponseCache *cache, const CCNxName *name);
+
+/**
+ * Cache a response for a name, replacing whatever occupied its slot.
+ *
+ * @param [in] cache The `CCNxPingResponseCache` instance.
+ * @param [in] name The name of the content.
+ * @param [in] response The response to cache. The cache acquires its own reference.
+ */
+void ccnxPingResponseCache_Put(CCNxPingResponseCache *cache, const CCNxName *name, const CCNxMetaMessage *response);
+
+/**
+ * @return The number of lookups that found a cached response.
+ */
+uint64_t ccnxPingResponseCache_GetHits(const CCNxPingResponseCache *cache);
+
+/**
+ * @return The number of lookups that did not find a cached response.
+ */
+uint64_t ccnxPingResponseCache_GetMisses(const CCNxPingResponseCache *cache);
+
+/**
+ * @return The number of occupied slots.
+ */
+size_t ccnxPingResponseCache_GetSize(const CCNxPingResponseCache *cache);
+#endif // ccnxPing_ResponseCache_h
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_Object.h>
+
+#include "ccnxPing_Common.h"
+#include "ccnxPing_ResponseLog.h"
+
+/**
+ * The size of the writer's output buffer: lines are written in blocks of about this size.
+ */
+#define _outputBufferSize 65536
+
+/**
+ * How long the writer sleeps when the ring is empty.
+ */
+#define _idleSleepInUs 1000
+
+typedef struct ccnx_ping_response_log_record {
+    CCNxName *name;
+    uint32_t contentSize;
+    uint32_t rttInUs;
+} _CCNxPingResponseLogRecord;
+
+struct ccnx_ping_response_log {
+    int fd;
+    pthread_t thread;
+    bool threadStarted;
+    bool stopping;
+
+    _CCNxPingResponseLogRecord *records;
+    size_t mask;
+
+    // Each index is written by one side only: `tail` by the producer, `head` by the writer.
+    size_t tail __attribute__((aligned(64)));
+    uint64_t dropped;
+    size_t head __attribute__((aligned(64)));
+
+    char *buffer;
+    size_t bufferLength;
+};
+
+/**
+ * Write the output buffer to the file descriptor. Output errors discard the buffer: the measurement goes on.
+ */
+static void
+_ccnxPingResponseLog_Flush(CCNxPingResponseLog *log)
+{
+    size_t written = 0;
+    while (written < log->bufferLength) {
+        ssize_t result = write(log->fd, log->buffer + written, log->bufferLength - written);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            break;
+        }
+        written += (size_t) result;
+    }
+    log->bufferLength = 0;
+}
+
+static void
+_ccnxPingResponseLog_Format(CCNxPingResponseLog *log, const _CCNxPingResponseLogRecord *record)
+{
+    char *nameString = ccnxName_ToString(record->name);
+    size_t available = _outputBufferSize - log->bufferLength;
+    int length = snprintf(log->buffer + log->bufferLength, available, "%u bytes from %s: time=%u us\n",
+                          record->contentSize, nameString, record->rttInUs);
+    if (length >= 0 && (size_t) length >= available) {
+        _ccnxPingResponseLog_Flush(log);
+        length = snprintf(log->buffer, _outputBufferSize, "%u bytes from %s: time=%u us\n",
+                          record->contentSize, nameString, record->rttInUs);
+    }
+    if (length > 0) {
+        log->bufferLength += (size_t) length < _outputBufferSize ? (size_t) length : _outputBufferSize - 1;
+    }
+    parcMemory_Deallocate(&nameString);
+}
+
+static void *
+_ccnxPingResponseLog_Writer(void *arg)
+{
+    CCNxPingResponseLog *log = arg;
+    size_t head = log->head;
+
+    while (true) {
+        size_t tail = __atomic_load_n(&log->tail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            // Read the flag before checking the ring one last time, so no record appended before stopping is lost.
+            bool stopping = __atomic_load_n(&log->stopping, __ATOMIC_ACQUIRE);
+            if (stopping && head == __atomic_load_n(&log->tail, __ATOMIC_ACQUIRE)) {
+                break;
+            }
+            if (log->bufferLength > 0) {
+                _ccnxPingResponseLog_Flush(log);
+            }
+            struct timespec idle = { 0, _idleSleepInUs * 1000 };
+            nanosleep(&idle, NULL);
+            continue;
+        }
+
+        while (head != tail) {
+            _CCNxPingResponseLogRecord *record = &log->records[head & log->mask];
+            _ccnxPingResponseLog_Format(log, record);
+            ccnxName_Release(&record->name);
+            head++;
+        }
+        __atomic_store_n(&log->head, head, __ATOMIC_RELEASE);
+
+        if (log->bufferLength >= _outputBufferSize / 2) {
+            _ccnxPingResponseLog_Flush(log);
+        }
+    }
+
+    _ccnxPingResponseLog_Flush(log);
+    return NULL;
+}
+
+static bool
+_ccnxPingResponseLog_Destructor(CCNxPingResponseLog **logPtr)
+{
+    CCNxPingResponseLog *log = *logPtr;
+
+    if (log->threadStarted) {
+        __atomic_store_n(&log->stopping, true, __ATOMIC_RELEASE);
+        pthread_join(log->thread, NULL);
+    }
+
+    parcMemory_Deallocate(&log->buffer);
+    parcMemory_Deallocate(&log->records);
+    return true;
+}
+
+parcObject_Override(CCNxPingResponseLog, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingResponseLog_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingResponseLog, CCNxPingResponseLog);
+parcObject_ImplementRelease(ccnxPingResponseLog, CCNxPingResponseLog);
+
+CCNxPingResponseLog *
+ccnxPingResponseLog_Create(FILE *output, size_t capacity)
+{
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    fflush(output);
+
+    CCNxPingResponseLog *log = parcObject_CreateInstance(CCNxPingResponseLog);
+    log->fd = fileno(output);
+    log->threadStarted = false;
+    log->stopping = false;
+    log->records = parcMemory_AllocateAndClear(size * sizeof(_CCNxPingResponseLogRecord));
+    log->mask = size - 1;
+    log->tail = 0;
+    log->dropped = 0;
+    log->head = 0;
+    log->buffer = parcMemory_AllocateAndClear(_outputBufferSize);
+    log->bufferLength = 0;
+
+    if (pthread_create(&log->thread, NULL, _ccnxPingResponseLog_Writer, log) == 0) {
+        log->threadStarted = true;
+    } else {
+        fprintf(stderr, "Unable to start the output thread\n");
+        ccnxPingResponseLog_Release(&log);
+    }
+    return log;
+}
+
+bool
+ccnxPingResponseLog_Append(CCNxPingResponseLog *log, const CCNxName *name, size_t contentSize, uint64_t rttInUs)
+{
+    size_t tail = log->tail;
+    if (tail - __atomic_load_n(&log->head, __ATOMIC_ACQUIRE) > log->mask) {
+        ccnxPingCommon_CounterAdd(log->dropped, 1);
+        return false;
+    }
+
+    _CCNxPingResponseLogRecord *record = &log->records[tail & log->mask];
+    record->name = ccnxName_Acquire(name);
+    record->contentSize = contentSize < UINT32_MAX ? (uint32_t) contentSize : UINT32_MAX;
+    record->rttInUs = rttInUs < UINT32_MAX ? (uint32_t) rttInUs : UINT32_MAX;
+    __atomic_store_n(&log->tail, tail + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint64_t
+ccnxPingResponseLog_GetDropped(const CCNxPingResponseLog *log)
+{
+    return ccnxPingCommon_CounterGet(log->dropped);
+}
+
+pthread_t
+ccnxPingResponseLog_GetThread(const CCNxPingResponseLog *log)
+{
+    return log->thread;
+}
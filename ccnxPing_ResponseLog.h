@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_ResponseLog_h
+#define ccnxPing_ResponseLog_h
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <ccnx/common/ccnx_Name.h>
+
+/**
+ * Writes one line per response ("N bytes from NAME: time=T us") without slowing down the loop that
+ * measures them.
+ *
+ * The measurement loop appends a compact record (a reference to the name, the size and the RTT) to a
+ * lock-free single-producer, single-consumer ring. A writer thread formats the records and writes them
+ * in large blocks, sleeping briefly whenever the ring is empty, so the producer never waits on a lock,
+ * a wakeup or the output. When the ring is full, the line is dropped and counted instead.
+ *
+ * Names are shared with the writer thread by reference: PARC reference counts are atomic.
+ */
+struct ccnx_ping_response_log;
+typedef struct ccnx_ping_response_log CCNxPingResponseLog;
+
+/**
+ * Create a `CCNxPingResponseLog` and start its writer thread.
+ *
+ * Anything buffered in `output` is flushed first; from then on the lines are written directly to
+ * its file descriptor, and `output` must not be used until the log has been released.
+ *
+ * @param [in] output The stream to write to.
+ * @param [in] capacity The number of records the ring holds. It is rounded up to a power of two.
+ *
+ * @return A new `CCNxPingResponseLog`, or NULL if the writer thread could not be started.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingResponseLog *log = ccnxPingResponseLog_Create(stdout, 65536);
+ *     ccnxPingResponseLog_Append(log, name, contentSize, rttInUs);
+ *     ...
+ *     uint64_t dropped = ccnxPingResponseLog_GetDropped(log);
+ *     ccnxPingResponseLog_Release(&log);
+ * }
+ * @endcode
+ */
+CCNxPingResponseLog *ccnxPingResponseLog_Create(FILE *output, size_t capacity);
+
+/**
+ * Increase the number of references to a `CCNxPingResponseLog`.
+ *
+ * @param [in] log A pointer to a `CCNxPingResponseLog` instance.
+ *
+ * @return The input `CCNxPingResponseLog` pointer.
+ */
+CCNxPingResponseLog *ccnxPingResponseLog_Acquire(const CCNxPingResponseLog *log);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * The last release writes every line still in the ring and stops the writer thread.
+ *
+ * @param [in,out] logPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingResponseLog_Release(CCNxPingResponseLog **logPtr);
+
+/**
+ * Queue the line for one response. Only one thread may append to a log.
+ *
+ * @param [in] log The `CCNxPingResponseLog` instance.
+ * @param [in] name The name of the response.
+ * @param [in] contentSize The size of its payload (in bytes).
+ * @param [in] rttInUs Its round-trip time (in microseconds).
+ *
+ * @retval true If the line was queued.
+ * @retval false If the ring was full and the line was dropped.
+ */
+bool ccnxPingResponseLog_Append(CCNxPingResponseLog *log, const CCNxName *name, size_t contentSize, uint64_t rttInUs);
+
+/**
+ * @return The number of lines dropped because the ring was full.
+ */
+uint64_t ccnxPingResponseLog_GetDropped(const CCNxPingResponseLog *log);
+
+/**
+ * Return the thread that writes the lines, for example to set its affinity.
+ *
+ * @param [in] log The `CCNxPingResponseLog` instance.
+ *
+ * @return The writer thread.
+ */
+pthread_t ccnxPingResponseLog_GetThread(const CCNxPingResponseLog *log);
+#endif // ccnxPing_ResponseLog_h
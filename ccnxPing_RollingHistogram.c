@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include "ccnxPing_Common.h"
+#include "ccnxPing_RollingHistogram.h"
+
+/**
+ * The epoch of an interval that is being reset, or has never been used.
+ */
+#define _invalidEpoch UINT64_MAX
+
+/**
+ * Return the interval of `nowInUs`, resetting it first if it still holds an older epoch.
+ */
+static CCNxPingRollingInterval *
+_ccnxPingRollingHistogram_Current(CCNxPingRollingHistogram *rolling, uint64_t nowInUs)
+{
+    uint64_t epoch = nowInUs / rolling->intervalInUs;
+    CCNxPingRollingInterval *interval = &rolling->intervals[epoch % ccnxPingRollingHistogram_IntervalCount];
+
+    if (ccnxPingCommon_CounterGet(interval->epoch) != epoch) {
+        __atomic_store_n(&interval->epoch, _invalidEpoch, __ATOMIC_RELEASE);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        interval->sent = 0;
+        interval->lost = 0;
+        ccnxPingHistogram_Init(&interval->rtt);
+        __atomic_store_n(&interval->epoch, epoch, __ATOMIC_RELEASE);
+    }
+    return interval;
+}
+
+void
+ccnxPingRollingHistogram_Init(CCNxPingRollingHistogram *rolling, uint64_t intervalInUs)
+{
+    rolling->intervalInUs = intervalInUs;
+    for (size_t i = 0; i < ccnxPingRollingHistogram_IntervalCount; i++) {
+        rolling->intervals[i].epoch = _invalidEpoch;
+        rolling->intervals[i].sent = 0;
+        rolling->intervals[i].lost = 0;
+        ccnxPingHistogram_Init(&rolling->intervals[i].rtt);
+    }
+}
+
+void
+ccnxPingRollingHistogram_RecordSent(CCNxPingRollingHistogram *rolling, uint64_t nowInUs)
+{
+    CCNxPingRollingInterval *interval = _ccnxPingRollingHistogram_Current(rolling, nowInUs);
+    ccnxPingCommon_CounterAdd(interval->sent, 1);
+}
+
+void
+ccnxPingRollingHistogram_RecordResponse(CCNxPingRollingHistogram *rolling, uint64_t nowInUs, uint64_t rttInUs)
+{
+    CCNxPingRollingInterval *interval = _ccnxPingRollingHistogram_Current(rolling, nowInUs);
+    ccnxPingHistogram_Record(&interval->rtt, rttInUs);
+}
+
+void
+ccnxPingRollingHistogram_RecordLoss(CCNxPingRollingHistogram *rolling, uint64_t nowInUs)
+{
+    CCNxPingRollingInterval *interval = _ccnxPingRollingHistogram_Current(rolling, nowInUs);
+    ccnxPingCommon_CounterAdd(interval->lost, 1);
+}
+
+void
+ccnxPingRollingHistogram_Window(const CCNxPingRollingHistogram *rolling, uint64_t nowInUs, uint64_t windowInUs,
+                                CCNxPingRollingInterval *result)
+{
+    uint64_t currentEpoch = nowInUs / rolling->intervalInUs;
+    uint64_t intervalCount = (windowInUs + rolling->intervalInUs - 1) / rolling->intervalInUs;
+    if (intervalCount > ccnxPingRollingHistogram_IntervalCount) {
+        intervalCount = ccnxPingRollingHistogram_IntervalCount;
+    }
+
+    result->epoch = currentEpoch;
+    result->sent = 0;
+    result->lost = 0;
+    ccnxPingHistogram_Init(&result->rtt);
+
+    CCNxPingHistogram snapshot;
+    for (size_t i = 0; i < ccnxPingRollingHistogram_IntervalCount; i++) {
+        const CCNxPingRollingInterval *interval = &rolling->intervals[i];
+
+        uint64_t epoch = __atomic_load_n(&interval->epoch, __ATOMIC_ACQUIRE);
+        if (epoch == _invalidEpoch || epoch > currentEpoch || currentEpoch - epoch >= intervalCount) {
+            continue;
+        }
+        uint64_t sent = ccnxPingCommon_CounterGet(interval->sent);
+        uint64_t lost = ccnxPingCommon_CounterGet(interval->lost);
+        ccnxPingHistogram_Snapshot(&snapshot, &interval->rtt);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&interval->epoch, __ATOMIC_RELAXED) != epoch) {
+            continue;
+        }
+        result->sent += sent;
+        result->lost += lost;
+        ccnxPingHistogram_Merge(&result->rtt, &snapshot);
+    }
+}
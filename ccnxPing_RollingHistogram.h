@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_RollingHistogram_h
+#define ccnxPing_RollingHistogram_h
+
+#include <stdint.h>
+
+#include "ccnxPing_Histogram.h"
+
+/**
+ * The number of intervals kept by a `CCNxPingRollingHistogram`. With 10-second intervals they
+ * cover the 15-minute window.
+ */
+#define ccnxPingRollingHistogram_IntervalCount 90
+
+/**
+ * The probes of one interval, or the merge of several intervals.
+ */
+typedef struct ccnx_ping_rolling_interval {
+    uint64_t epoch;
+    uint64_t sent;
+    uint64_t lost;
+    CCNxPingHistogram rtt;
+} CCNxPingRollingInterval;
+
+/**
+ * Rolling-window probe statistics in fixed memory: a ring of `ccnxPingRollingHistogram_IntervalCount`
+ * intervals, each holding the probes sent and lost and the RTT histogram of the responses
+ * received during it. The interval of a time is `time / intervalInUs` (its epoch); an interval
+ * is reset when the ring wraps around onto it.
+ *
+ * There is a single writer. Other threads may call `ccnxPingRollingHistogram_Window` at any
+ * time: the epoch of an interval is invalidated while it is being reset, and readers skip
+ * intervals whose epoch changed while they were copying them.
+ */
+typedef struct ccnx_ping_rolling_histogram {
+    uint64_t intervalInUs;
+    CCNxPingRollingInterval intervals[ccnxPingRollingHistogram_IntervalCount];
+} CCNxPingRollingHistogram;
+
+/**
+ * Reset a `CCNxPingRollingHistogram` to the empty state.
+ *
+ * @param [in] rolling The `CCNxPingRollingHistogram` to initialize.
+ * @param [in] intervalInUs The length of each interval (in microseconds).
+ *
+ * Example
+ * @code
+ * {
+ *     static CCNxPingRollingHistogram rolling;
+ *     ccnxPingRollingHistogram_Init(&rolling, 10000000);
+ *     ccnxPingRollingHistogram_RecordSent(&rolling, now);
+ *     ccnxPingRollingHistogram_RecordResponse(&rolling, later, later - now);
+ *
+ *     CCNxPingRollingInterval lastMinute;
+ *     ccnxPingRollingHistogram_Window(&rolling, later, 60000000, &lastMinute);
+ * }
+ * @endcode
+ */
+void ccnxPingRollingHistogram_Init(CCNxPingRollingHistogram *rolling, uint64_t intervalInUs);
+
+/**
+ * Account for a probe sent at `nowInUs`.
+ */
+void ccnxPingRollingHistogram_RecordSent(CCNxPingRollingHistogram *rolling, uint64_t nowInUs);
+
+/**
+ * Account for a response received at `nowInUs` after `rttInUs` microseconds.
+ */
+void ccnxPingRollingHistogram_RecordResponse(CCNxPingRollingHistogram *rolling, uint64_t nowInUs, uint64_t rttInUs);
+
+/**
+ * Account for a probe declared lost at `nowInUs`.
+ */
+void ccnxPingRollingHistogram_RecordLoss(CCNxPingRollingHistogram *rolling, uint64_t nowInUs);
+
+/**
+ * Merge the intervals that overlap the last `windowInUs` microseconds before `nowInUs`.
+ *
+ * The window is rounded up to whole intervals, and it includes the current (partial) interval.
+ *
+ * @param [in] rolling The `CCNxPingRollingHistogram` instance.
+ * @param [in] nowInUs The current time (in microseconds).
+ * @param [in] windowInUs The length of the window (in microseconds).
+ * @param [out] result The merged statistics of the window.
+ */
+void ccnxPingRollingHistogram_Window(const CCNxPingRollingHistogram *rolling, uint64_t nowInUs, uint64_t windowInUs,
+                                     CCNxPingRollingInterval *result);
+#endif // ccnxPing_RollingHistogram_h
@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_Object.h>
+
+#include "ccnxPing_Scenario.h"
+
+struct ccnx_ping_scenario {
+    CCNxPingScenarioPhase *phases;
+    size_t phaseCount;
+};
+
+static bool
+_ccnxPingScenario_Destructor(CCNxPingScenario **scenarioPtr)
+{
+    CCNxPingScenario *scenario = *scenarioPtr;
+    if (scenario->phases != NULL) {
+        parcMemory_Deallocate(&scenario->phases);
+    }
+    return true;
+}
+
+parcObject_Override(CCNxPingScenario, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingScenario_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingScenario, CCNxPingScenario);
+parcObject_ImplementRelease(ccnxPingScenario, CCNxPingScenario);
+
+/**
+ * Strip leading and trailing blanks in place.
+ */
+static char *
+_ccnxPingScenario_Trim(char *text)
+{
+    while (isspace((unsigned char) *text)) {
+        text++;
+    }
+    size_t length = strlen(text);
+    while (length > 0 && isspace((unsigned char) text[length - 1])) {
+        text[--length] = '\0';
+    }
+    return text;
+}
+
+/**
+ * Parse a duration such as 500ms, 30s, 10m or 1h. A number without a unit is in seconds.
+ */
+static bool
+_ccnxPingScenario_ParseDuration(const char *text, uint64_t *durationInUs)
+{
+    static const struct {
+        const char *unit;
+        double scale;
+    } units[] = {
+        { "us", 1.0          },
+        { "ms", 1000.0       },
+        { "s",  1000000.0    },
+        { "m",  60000000.0   },
+        { "h",  3600000000.0 },
+        { "",   1000000.0    },
+        { NULL, 0.0          }
+    };
+
+    char *end = NULL;
+    double value = strtod(text, &end);
+    if (end == text || value <= 0.0) {
+        return false;
+    }
+    for (size_t i = 0; units[i].unit != NULL; i++) {
+        if (strcmp(end, units[i].unit) == 0) {
+            *durationInUs = (uint64_t) (value * units[i].scale);
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool
+_ccnxPingScenario_ParseRate(const char *text, CCNxPingScenarioPhase *phase)
+{
+    char *end = NULL;
+    phase->startRate = strtod(text, &end);
+    phase->endRate = phase->startRate;
+    if (end == text || phase->startRate < 0.0) {
+        return false;
+    }
+    if (*end == ':') {
+        const char *endRate = end + 1;
+        phase->endRate = strtod(endRate, &end);
+        if (end == endRate || phase->endRate < 0.0) {
+            return false;
+        }
+    }
+    return *end == '\0';
+}
+
+/**
+ * Apply one `key = value` line to a phase.
+ */
+static bool
+_ccnxPingScenario_SetKey(CCNxPingScenarioPhase *phase, const char *key, const char *value, size_t payloadSize)
+{
+    if (strcmp(key, "duration") == 0) {
+        return _ccnxPingScenario_ParseDuration(value, &phase->durationInUs);
+    } else if (strcmp(key, "rate") == 0) {
+        return _ccnxPingScenario_ParseRate(value, phase);
+    } else if (strcmp(key, "window") == 0) {
+        char *end = NULL;
+        phase->window = (size_t) strtoul(value, &end, 10);
+        return end != value && *end == '\0';
+    } else if (strcmp(key, "size") == 0 || strcmp(key, "names") == 0) {
+        if (!phase->hasWorkload) {
+            ccnxPingWorkloadOptions_Init(&phase->workloadOptions, payloadSize);
+            phase->hasWorkload = true;
+        }
+        if (strcmp(key, "size") == 0) {
+            return ccnxPingDistribution_Parse(&phase->workloadOptions.payloadSize, value);
+        }
+        return ccnxPingWorkloadOptions_Parse(&phase->workloadOptions, value);
+    }
+    return false;
+}
+
+static CCNxPingScenarioPhase *
+_ccnxPingScenario_AddPhase(CCNxPingScenario *scenario, const char *name)
+{
+    CCNxPingScenarioPhase *phases = parcMemory_AllocateAndClear((scenario->phaseCount + 1) * sizeof(CCNxPingScenarioPhase));
+    if (scenario->phases != NULL) {
+        memcpy(phases, scenario->phases, scenario->phaseCount * sizeof(CCNxPingScenarioPhase));
+        parcMemory_Deallocate(&scenario->phases);
+    }
+    scenario->phases = phases;
+    CCNxPingScenarioPhase *phase = &scenario->phases[scenario->phaseCount++];
+
+    snprintf(phase->name, sizeof(phase->name), "%s", name);
+    return phase;
+}
+
+CCNxPingScenario *
+ccnxPingScenario_Load(const char *path, size_t payloadSize)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return NULL;
+    }
+
+    CCNxPingScenario *scenario = parcObject_CreateInstance(CCNxPingScenario);
+    scenario->phases = NULL;
+    scenario->phaseCount = 0;
+
+    bool result = true;
+    size_t lineNumber = 0;
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    CCNxPingScenarioPhase *phase = NULL;
+    while (result && getline(&line, &lineCapacity, file) != -1) {
+        lineNumber++;
+        char *text = _ccnxPingScenario_Trim(line);
+        if (text[0] == '\0' || text[0] == '#') {
+            continue;
+        }
+
+        if (text[0] == '[') {
+            char *close = strchr(text, ']');
+            result = close != NULL && close[1] == '\0' && close > text + 1;
+            if (result) {
+                *close = '\0';
+                phase = _ccnxPingScenario_AddPhase(scenario, _ccnxPingScenario_Trim(text + 1));
+            }
+        } else {
+            char *equals = strchr(text, '=');
+            result = phase != NULL && equals != NULL;
+            if (result) {
+                *equals = '\0';
+                result = _ccnxPingScenario_SetKey(phase, _ccnxPingScenario_Trim(text), _ccnxPingScenario_Trim(equals + 1), payloadSize);
+            }
+        }
+        if (!result) {
+            fprintf(stderr, "%s:%zu: invalid scenario line\n", path, lineNumber);
+        }
+    }
+    free(line);
+    fclose(file);
+
+    for (size_t i = 0; result && i < scenario->phaseCount; i++) {
+        if (scenario->phases[i].durationInUs == 0) {
+            fprintf(stderr, "%s: phase '%s' has no duration\n", path, scenario->phases[i].name);
+            result = false;
+        }
+    }
+    if (result && scenario->phaseCount == 0) {
+        fprintf(stderr, "%s: the scenario has no phase\n", path);
+        result = false;
+    }
+
+    if (!result) {
+        ccnxPingScenario_Release(&scenario);
+    }
+    return scenario;
+}
+
+size_t
+ccnxPingScenario_GetPhaseCount(const CCNxPingScenario *scenario)
+{
+    return scenario->phaseCount;
+}
+
+const CCNxPingScenarioPhase *
+ccnxPingScenario_GetPhase(const CCNxPingScenario *scenario, size_t index)
+{
+    return &scenario->phases[index];
+}
+
+uint64_t
+ccnxPingScenario_GetDuration(const CCNxPingScenario *scenario)
+{
+    uint64_t durationInUs = 0;
+    for (size_t i = 0; i < scenario->phaseCount; i++) {
+        durationInUs += scenario->phases[i].durationInUs;
+    }
+    return durationInUs;
+}
+
+double
+ccnxPingScenarioPhase_GetRate(const CCNxPingScenarioPhase *phase, uint64_t elapsedInUs)
+{
+    double progress = elapsedInUs >= phase->durationInUs ? 1.0 : (double) elapsedInUs / (double) phase->durationInUs;
+    return phase->startRate + (phase->endRate - phase->startRate) * progress;
+}
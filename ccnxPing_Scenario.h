@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Scenario_h
+#define ccnxPing_Scenario_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ccnxPing_Workload.h"
+
+/**
+ * The longest phase name kept by a `CCNxPingScenario`.
+ */
+#define ccnxPingScenario_MaxNameLength 63
+
+/**
+ * One phase of a scenario.
+ *
+ * Interests are sent on an open-loop schedule whose rate moves linearly from `startRate` to
+ * `endRate` (interests per second) over the phase, and no more than `window` are kept outstanding.
+ * A rate of 0 sends as soon as the window allows; a window of 0 is unlimited. With a workload the
+ * names and payload sizes are drawn from it, otherwise from the client's own options.
+ */
+typedef struct ccnx_ping_scenario_phase {
+    char name[ccnxPingScenario_MaxNameLength + 1];
+    uint64_t durationInUs;
+    double startRate;
+    double endRate;
+    size_t window;
+
+    bool hasWorkload;
+    CCNxPingWorkloadOptions workloadOptions;
+} CCNxPingScenarioPhase;
+
+/**
+ * A sequence of phases read from a scenario file.
+ *
+ * The file has one `[name]` section per phase, in the order they are run, each with `key = value`
+ * lines. Blank lines and lines starting with `#` are ignored.
+ *
+ *   duration = <time>              the length of the phase: a number with the unit us, ms, s (default), m or h
+ *   rate = <start>[:<end>]         the offered rate in interests per second, ramped linearly from start to end
+ *   window = <n>                   the maximum number of outstanding interests
+ *   size = <distribution>          the payload-size mix (see `CCNxPingDistribution`)
+ *   names = <specification>        the name workload (see `ccnxPingWorkloadOptions_Parse`)
+ *
+ * Example
+ * @code
+ * [ramp-up]
+ * duration = 60s
+ * rate = 100:5000
+ *
+ * [steady]
+ * duration = 10m
+ * rate = 5000
+ * size = bimodal:64:8192:0.1
+ *
+ * [spike]
+ * duration = 30s
+ * rate = 50000
+ * window = 1024
+ * names = components=uniform:2:12,prefixes=10000
+ *
+ * [cool-down]
+ * duration = 60s
+ * rate = 5000:100
+ * @endcode
+ */
+struct ccnx_ping_scenario;
+typedef struct ccnx_ping_scenario CCNxPingScenario;
+
+/**
+ * Read a scenario file. Errors are reported on stderr with their line number.
+ *
+ * @param [in] path The path of the scenario file.
+ * @param [in] payloadSize The default payload size of the phases that set `size` or `names`.
+ *
+ * @return A new `CCNxPingScenario` that must be released with `ccnxPingScenario_Release`, or NULL
+ *         if the file could not be read or is invalid.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingScenario *scenario = ccnxPingScenario_Load("daily.scenario", 4096);
+ *     for (size_t i = 0; i < ccnxPingScenario_GetPhaseCount(scenario); i++) {
+ *         const CCNxPingScenarioPhase *phase = ccnxPingScenario_GetPhase(scenario, i);
+ *         ...
+ *     }
+ *     ccnxPingScenario_Release(&scenario);
+ * }
+ * @endcode
+ */
+CCNxPingScenario *ccnxPingScenario_Load(const char *path, size_t payloadSize);
+
+/**
+ * Increase the number of references to a `CCNxPingScenario`.
+ *
+ * @param [in] scenario A pointer to a `CCNxPingScenario` instance.
+ *
+ * @return The input `CCNxPingScenario` pointer.
+ */
+CCNxPingScenario *ccnxPingScenario_Acquire(const CCNxPingScenario *scenario);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] scenarioPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingScenario_Release(CCNxPingScenario **scenarioPtr);
+
+/**
+ * @return The number of phases of the scenario (at least one).
+ */
+size_t ccnxPingScenario_GetPhaseCount(const CCNxPingScenario *scenario);
+
+/**
+ * @return The phase at the given index.
+ */
+const CCNxPingScenarioPhase *ccnxPingScenario_GetPhase(const CCNxPingScenario *scenario, size_t index);
+
+/**
+ * @return The total duration of the scenario (in microseconds).
+ */
+uint64_t ccnxPingScenario_GetDuration(const CCNxPingScenario *scenario);
+
+/**
+ * Return the offered rate of a phase at some time into it.
+ *
+ * @param [in] phase The `CCNxPingScenarioPhase`.
+ * @param [in] elapsedInUs The time since the phase started (in microseconds).
+ *
+ * @return The rate in interests per second, or 0 if the phase is only limited by its window.
+ */
+double ccnxPingScenarioPhase_GetRate(const CCNxPingScenarioPhase *phase, uint64_t elapsedInUs);
+#endif // ccnxPing_Scenario_h
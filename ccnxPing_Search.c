@@ -0,0 +1,452 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <inttypes.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <parc/algol/parc_DisplayIndented.h>
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_Object.h>
+
+#include "ccnxPing_Search.h"
+
+static const char *_ccnxPingSearch_StepNames[] = { "bracket", "bisect", "confirm-low", "confirm-high" };
+
+struct ccnx_ping_search {
+    CCNxPingSearchOptions options;
+
+    CCNxPingSearchTrial *trials;
+    size_t trialCount;
+    size_t trialCapacity;
+
+    // The bracket: `low` is the highest rate known to pass and `high` the lowest known to fail (0 if none).
+    double low;
+    double high;
+
+    CCNxPingSearchStep step;
+    double rate;
+    size_t repetitionsLeft;
+
+    bool done;
+    bool incomplete;
+};
+
+void
+ccnxPingSearchOptions_Init(CCNxPingSearchOptions *options)
+{
+    options->percentile = 99.0;
+    options->maxLatencyInUs = 10000;
+    options->maxLoss = 0.001;
+    options->minSentRatio = 0.95;
+    options->minRate = 100.0;
+    options->maxRate = 1000000.0;
+    options->precision = 0.05;
+    options->warmupInUs = 1000000;
+    options->trialInUs = 5000000;
+    options->window = 1024;
+    options->confirmations = 3;
+    options->maxTrials = 60;
+}
+
+bool
+ccnxPingSearchOptions_Parse(CCNxPingSearchOptions *options, const char *specification)
+{
+    CCNxPingSearchOptions result = *options;
+    char *fields = parcMemory_StringDuplicate(specification, strlen(specification));
+    char *cursor = fields;
+
+    bool valid = true;
+    double seconds = 0.0;
+    char *field = NULL;
+    while (valid && (field = strsep(&cursor, ",")) != NULL) {
+        int consumed = 0;
+        if (*field == '\0') {
+            continue;
+        } else if (strncmp(field, "precision=", 10) == 0) {
+            valid = sscanf(field + 10, "%lf", &result.precision) == 1 && result.precision > 0.0;
+        } else if (field[0] == 'p') {
+            valid = sscanf(field, "p%lf=%" SCNu64 "%n", &result.percentile, &result.maxLatencyInUs, &consumed) == 2
+                    && field[consumed] == '\0' && result.percentile > 0.0 && result.percentile <= 100.0;
+        } else if (strncmp(field, "loss=", 5) == 0) {
+            valid = sscanf(field + 5, "%lf", &result.maxLoss) == 1 && result.maxLoss >= 0.0 && result.maxLoss < 1.0;
+        } else if (strncmp(field, "min=", 4) == 0) {
+            valid = sscanf(field + 4, "%lf", &result.minRate) == 1 && result.minRate > 0.0;
+        } else if (strncmp(field, "max=", 4) == 0) {
+            valid = sscanf(field + 4, "%lf", &result.maxRate) == 1 && result.maxRate > 0.0;
+        } else if (strncmp(field, "warmup=", 7) == 0) {
+            valid = sscanf(field + 7, "%lf", &seconds) == 1 && seconds >= 0.0;
+            result.warmupInUs = (uint64_t) (seconds * 1000000.0);
+        } else if (strncmp(field, "trial=", 6) == 0) {
+            valid = sscanf(field + 6, "%lf", &seconds) == 1 && seconds > 0.0;
+            result.trialInUs = (uint64_t) (seconds * 1000000.0);
+        } else if (strncmp(field, "window=", 7) == 0) {
+            valid = sscanf(field + 7, "%zu", &result.window) == 1;
+        } else if (strncmp(field, "confirm=", 8) == 0) {
+            valid = sscanf(field + 8, "%zu", &result.confirmations) == 1;
+        } else if (strncmp(field, "trials=", 7) == 0) {
+            valid = sscanf(field + 7, "%zu", &result.maxTrials) == 1 && result.maxTrials > 0;
+        } else {
+            valid = false;
+        }
+    }
+    parcMemory_Deallocate(&fields);
+
+    if (valid && result.minRate <= result.maxRate) {
+        *options = result;
+        return true;
+    }
+    return false;
+}
+
+static bool
+_ccnxPingSearch_Destructor(CCNxPingSearch **searchPtr)
+{
+    CCNxPingSearch *search = *searchPtr;
+    if (search->trials != NULL) {
+        parcMemory_Deallocate(&search->trials);
+    }
+    return true;
+}
+
+parcObject_Override(CCNxPingSearch, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingSearch_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingSearch, CCNxPingSearch);
+parcObject_ImplementRelease(ccnxPingSearch, CCNxPingSearch);
+
+CCNxPingSearch *
+ccnxPingSearch_Create(const CCNxPingSearchOptions *options)
+{
+    CCNxPingSearch *search = parcObject_CreateInstance(CCNxPingSearch);
+
+    search->options = *options;
+    search->trials = NULL;
+    search->trialCount = 0;
+    search->trialCapacity = 0;
+    search->low = 0.0;
+    search->high = 0.0;
+    search->step = CCNxPingSearchStep_Bracket;
+    search->rate = options->minRate;
+    search->repetitionsLeft = 0;
+    search->done = false;
+    search->incomplete = false;
+
+    return search;
+}
+
+const CCNxPingSearchOptions *
+ccnxPingSearch_GetOptions(const CCNxPingSearch *search)
+{
+    return &search->options;
+}
+
+double
+ccnxPingSearch_NextRate(const CCNxPingSearch *search)
+{
+    return search->done ? 0.0 : search->rate;
+}
+
+CCNxPingSearchStep
+ccnxPingSearch_NextStep(const CCNxPingSearch *search)
+{
+    return search->step;
+}
+
+/**
+ * Decide whether a trial met the objective.
+ */
+static void
+_ccnxPingSearch_Judge(const CCNxPingSearch *search, CCNxPingSearchTrial *trial)
+{
+    const CCNxPingSearchOptions *options = &search->options;
+    double loss = trial->sent > 0 ? 1.0 - (double) trial->received / trial->sent : 1.0;
+
+    trial->passed = false;
+    if (trial->sentRate < options->minSentRatio * trial->rate) {
+        trial->reason = "rate not offered";
+    } else if (trial->received == 0) {
+        trial->reason = "no response";
+    } else if (loss > options->maxLoss) {
+        trial->reason = "loss";
+    } else if (trial->latencyInUs > options->maxLatencyInUs) {
+        trial->reason = "latency";
+    } else {
+        trial->passed = true;
+        trial->reason = "ok";
+    }
+}
+
+/**
+ * @return true If some trial at `rate` failed.
+ */
+static bool
+_ccnxPingSearch_HasFailed(const CCNxPingSearch *search, double rate)
+{
+    for (size_t i = 0; i < search->trialCount; i++) {
+        if (!search->trials[i].passed && search->trials[i].rate == rate) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @return The highest rate below `rate` whose every trial passed, or 0 if there is none.
+ */
+static double
+_ccnxPingSearch_HighestPassBelow(const CCNxPingSearch *search, double rate)
+{
+    double result = 0.0;
+    for (size_t i = 0; i < search->trialCount; i++) {
+        const CCNxPingSearchTrial *trial = &search->trials[i];
+        if (trial->passed && trial->rate < rate && trial->rate > result && !_ccnxPingSearch_HasFailed(search, trial->rate)) {
+            result = trial->rate;
+        }
+    }
+    return result;
+}
+
+/**
+ * @return The lowest rate above `rate` at which a trial failed, or 0 if there is none.
+ */
+static double
+_ccnxPingSearch_LowestFailureAbove(const CCNxPingSearch *search, double rate)
+{
+    double result = 0.0;
+    for (size_t i = 0; i < search->trialCount; i++) {
+        const CCNxPingSearchTrial *trial = &search->trials[i];
+        if (!trial->passed && trial->rate > rate && (result == 0.0 || trial->rate < result)) {
+            result = trial->rate;
+        }
+    }
+    return result;
+}
+
+static void
+_ccnxPingSearch_Repeat(CCNxPingSearch *search, CCNxPingSearchStep step, double rate)
+{
+    search->step = step;
+    search->rate = rate;
+    search->repetitionsLeft = search->options.confirmations;
+    if (search->repetitionsLeft == 0) {
+        search->done = true;
+    }
+}
+
+/**
+ * Narrow the bracket, or confirm its lower bound once it is narrow enough.
+ */
+static void
+_ccnxPingSearch_Bisect(CCNxPingSearch *search)
+{
+    if (search->low == 0.0) {
+        search->done = true;
+    } else if (search->high == 0.0) {
+        if (search->low >= search->options.maxRate) {
+            _ccnxPingSearch_Repeat(search, CCNxPingSearchStep_ConfirmLow, search->low);
+        } else {
+            search->step = CCNxPingSearchStep_Bracket;
+            search->rate = fmin(search->low * 2.0, search->options.maxRate);
+        }
+    } else if (search->high <= search->low * (1.0 + search->options.precision)) {
+        _ccnxPingSearch_Repeat(search, CCNxPingSearchStep_ConfirmLow, search->low);
+    } else {
+        search->step = CCNxPingSearchStep_Bisect;
+        search->rate = sqrt(search->low * search->high);
+    }
+}
+
+void
+ccnxPingSearch_Record(CCNxPingSearch *search, CCNxPingSearchTrial *trial)
+{
+    trial->step = search->step;
+    _ccnxPingSearch_Judge(search, trial);
+
+    if (search->trialCount == search->trialCapacity) {
+        size_t capacity = search->trialCapacity > 0 ? search->trialCapacity * 2 : 16;
+        CCNxPingSearchTrial *trials = parcMemory_AllocateAndClear(capacity * sizeof(CCNxPingSearchTrial));
+        if (search->trials != NULL) {
+            memcpy(trials, search->trials, search->trialCount * sizeof(CCNxPingSearchTrial));
+            parcMemory_Deallocate(&search->trials);
+        }
+        search->trials = trials;
+        search->trialCapacity = capacity;
+    }
+    search->trials[search->trialCount++] = *trial;
+
+    switch (search->step) {
+        case CCNxPingSearchStep_Bracket:
+        case CCNxPingSearchStep_Bisect:
+            if (trial->passed) {
+                search->low = trial->rate;
+            } else {
+                search->high = trial->rate;
+            }
+            _ccnxPingSearch_Bisect(search);
+            break;
+
+        case CCNxPingSearchStep_ConfirmLow:
+            if (!trial->passed) {
+                // The lower bound does not hold: fall back to the best rate that never failed.
+                search->high = search->low;
+                search->low = _ccnxPingSearch_HighestPassBelow(search, search->high);
+                _ccnxPingSearch_Bisect(search);
+            } else if (--search->repetitionsLeft == 0) {
+                if (search->high == 0.0) {
+                    search->done = true;
+                } else {
+                    _ccnxPingSearch_Repeat(search, CCNxPingSearchStep_ConfirmHigh, search->high);
+                }
+            }
+            break;
+
+        case CCNxPingSearchStep_ConfirmHigh:
+            if (!trial->passed) {
+                search->done = true;
+            } else if (--search->repetitionsLeft == 0) {
+                // The upper bound passed every repetition: it was a fluke, so search above it.
+                search->low = search->high;
+                search->high = _ccnxPingSearch_LowestFailureAbove(search, search->low);
+                _ccnxPingSearch_Bisect(search);
+            }
+            break;
+    }
+
+    if (!search->done && search->trialCount >= search->options.maxTrials) {
+        search->done = true;
+        search->incomplete = true;
+    }
+}
+
+double
+ccnxPingSearch_GetCapacity(const CCNxPingSearch *search)
+{
+    return search->low;
+}
+
+bool
+ccnxPingSearch_IsIncomplete(const CCNxPingSearch *search)
+{
+    return search->incomplete;
+}
+
+size_t
+ccnxPingSearch_GetTrialCount(const CCNxPingSearch *search)
+{
+    return search->trialCount;
+}
+
+const CCNxPingSearchTrial *
+ccnxPingSearch_GetTrial(const CCNxPingSearch *search, size_t index)
+{
+    return &search->trials[index];
+}
+
+const char *
+ccnxPingSearchStep_GetName(CCNxPingSearchStep step)
+{
+    return _ccnxPingSearch_StepNames[step];
+}
+
+void
+ccnxPingSearch_DisplayTrial(const CCNxPingSearch *search, size_t index)
+{
+    const CCNxPingSearchTrial *trial = &search->trials[index];
+    double loss = trial->sent > 0 ? 1.0 - (double) trial->received / trial->sent : 1.0;
+
+    parcDisplayIndented_PrintLine(0, "Trial %2zu %-12s Rate = %.0f/s : Sent = %.0f/s : p%g = %" PRIu64 " us : Loss = %.3f%% : %s (%s)",
+                                  index + 1, ccnxPingSearchStep_GetName(trial->step), trial->rate, trial->sentRate,
+                                  search->options.percentile, trial->latencyInUs, 100.0 * loss,
+                                  trial->passed ? "PASS" : "FAIL", trial->reason);
+}
+
+void
+ccnxPingSearch_Display(const CCNxPingSearch *search)
+{
+    const CCNxPingSearchOptions *options = &search->options;
+    parcDisplayIndented_PrintLine(0, "Objective = p%g <= %" PRIu64 " us : Loss <= %.3f%% : Trials = %zu",
+                                  options->percentile, options->maxLatencyInUs, 100.0 * options->maxLoss, search->trialCount);
+    if (search->low == 0.0) {
+        parcDisplayIndented_PrintLine(0, "Capacity = 0 : even %.0f interests/s misses the objective", options->minRate);
+    } else if (search->incomplete) {
+        parcDisplayIndented_PrintLine(0, "Capacity = %.0f interests/s (unconfirmed: out of trials)", search->low);
+    } else if (search->high == 0.0) {
+        parcDisplayIndented_PrintLine(0, "Capacity = %.0f interests/s (the maximum rate searched)", search->low);
+    } else {
+        parcDisplayIndented_PrintLine(0, "Capacity = %.0f interests/s (%.0f/s fails)", search->low, search->high);
+    }
+}
+
+void
+ccnxPingSearch_WriteJSON(const CCNxPingSearch *search, FILE *output)
+{
+    const CCNxPingSearchOptions *options = &search->options;
+    fprintf(output, "{\"objective\":{\"percentile\":%g,\"max_latency_us\":%" PRIu64 ",\"max_loss\":%g},"
+            "\"capacity\":%.1f,\"failing_rate\":%.1f,\"confirmed\":%s,\"trials\":[",
+            options->percentile, options->maxLatencyInUs, options->maxLoss, search->low, search->high,
+            search->incomplete || search->low == 0.0 ? "false" : "true");
+    for (size_t i = 0; i < search->trialCount; i++) {
+        const CCNxPingSearchTrial *trial = &search->trials[i];
+        fprintf(output, "%s{\"step\":\"%s\",\"rate\":%.1f,\"sent_rate\":%.1f,\"sent\":%" PRIu64 ",\"received\":%" PRIu64
+                ",\"latency_us\":%" PRIu64 ",\"passed\":%s,\"reason\":\"%s\"}",
+                i > 0 ? "," : "", ccnxPingSearchStep_GetName(trial->step), trial->rate, trial->sentRate,
+                trial->sent, trial->received, trial->latencyInUs, trial->passed ? "true" : "false", trial->reason);
+    }
+    fprintf(output, "]}\n");
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Search_h
+#define ccnxPing_Search_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * The latency objective and the search parameters of a `CCNxPingSearch`.
+ */
+typedef struct ccnx_ping_search_options {
+    // A trial meets the objective when this percentile of its RTTs is at most `maxLatencyInUs`,
+    // at most `maxLoss` of its interests are lost, and it offered at least `minSentRatio` of its rate.
+    double percentile;
+    uint64_t maxLatencyInUs;
+    double maxLoss;
+    double minSentRatio;
+
+    // The offered rates searched, in interests per second, and the relative precision of the result.
+    double minRate;
+    double maxRate;
+    double precision;
+
+    // Each trial runs a warmup, whose results are discarded, before its measurement.
+    uint64_t warmupInUs;
+    uint64_t trialInUs;
+    size_t window;
+
+    // The number of repeated trials that confirm each bound of the final bracket, and the total number of trials allowed.
+    size_t confirmations;
+    size_t maxTrials;
+} CCNxPingSearchOptions;
+
+/**
+ * Initialize search options with their defaults: p99 <= 10 ms, no more than 0.1% loss, 95% of the
+ * rate offered, rates from 100 to 1000000 per second to 5%, 1 s warmups and 5 s trials, a window of
+ * 1024 interests, 3 confirmations and 60 trials.
+ */
+void ccnxPingSearchOptions_Init(CCNxPingSearchOptions *options);
+
+/**
+ * Parse a search specification into `options`.
+ *
+ * The specification is a comma-separated list of `pNN=US` (the latency objective, e.g. p99=2000 or
+ * p99.9=5000), `loss=FRACTION`, `min=RATE`, `max=RATE`, `precision=FRACTION`, `warmup=SECONDS`,
+ * `trial=SECONDS`, `window=N`, `confirm=N` and `trials=N`. Omitted items keep their value.
+ *
+ * @param [in,out] options The options to update.
+ * @param [in] specification The specification (e.g., "p99=2000,loss=0.001,max=50000").
+ *
+ * @retval true If the specification is valid; `options` is only modified in this case.
+ * @retval false Otherwise
+ */
+bool ccnxPingSearchOptions_Parse(CCNxPingSearchOptions *options, const char *specification);
+
+/**
+ * Why a trial was run.
+ */
+typedef enum {
+    CCNxPingSearchStep_Bracket,
+    CCNxPingSearchStep_Bisect,
+    CCNxPingSearchStep_ConfirmLow,
+    CCNxPingSearchStep_ConfirmHigh
+} CCNxPingSearchStep;
+
+/**
+ * The outcome of one trial.
+ */
+typedef struct ccnx_ping_search_trial {
+    CCNxPingSearchStep step;
+    double rate;
+
+    double sentRate;
+    uint64_t sent;
+    uint64_t received;
+    uint64_t latencyInUs;
+
+    bool passed;
+    const char *reason;
+} CCNxPingSearchTrial;
+
+/**
+ * A search for the highest offered rate that meets a latency objective.
+ *
+ * The rate doubles from the minimum until a trial fails, then the bracket between the last passing
+ * and the first failing rate is bisected (geometrically) to the requested precision. Each bound of
+ * the final bracket is then repeated: the lower bound must pass every repetition and the upper bound
+ * must fail at least one, otherwise the bracket moves and the search goes on. The capacity is the
+ * confirmed lower bound.
+ *
+ * The search only decides which rate to try next: the caller runs the trials.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingSearch *search = ccnxPingSearch_Create(&options);
+ *     double rate;
+ *     while ((rate = ccnxPingSearch_NextRate(search)) > 0.0) {
+ *         CCNxPingSearchTrial trial = { .rate = rate };
+ *         runTrial(&trial);
+ *         ccnxPingSearch_Record(search, &trial);
+ *     }
+ *     printf("%.0f\n", ccnxPingSearch_GetCapacity(search));
+ *     ccnxPingSearch_Release(&search);
+ * }
+ * @endcode
+ */
+struct ccnx_ping_search;
+typedef struct ccnx_ping_search CCNxPingSearch;
+
+/**
+ * Create a `CCNxPingSearch`.
+ *
+ * @param [in] options The objective and the search parameters.
+ *
+ * @return A new `CCNxPingSearch` that must be released with `ccnxPingSearch_Release`.
+ */
+CCNxPingSearch *ccnxPingSearch_Create(const CCNxPingSearchOptions *options);
+
+/**
+ * Increase the number of references to a `CCNxPingSearch`.
+ *
+ * @param [in] search A pointer to a `CCNxPingSearch` instance.
+ *
+ * @return The input `CCNxPingSearch` pointer.
+ */
+CCNxPingSearch *ccnxPingSearch_Acquire(const CCNxPingSearch *search);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] searchPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingSearch_Release(CCNxPingSearch **searchPtr);
+
+/**
+ * @return The options of the search.
+ */
+const CCNxPingSearchOptions *ccnxPingSearch_GetOptions(const CCNxPingSearch *search);
+
+/**
+ * Return the rate of the next trial.
+ *
+ * @param [in] search The `CCNxPingSearch` instance.
+ *
+ * @return The offered rate (in interests per second), or 0 if the search is over.
+ */
+double ccnxPingSearch_NextRate(const CCNxPingSearch *search);
+
+/**
+ * Return why the next trial is run.
+ */
+CCNxPingSearchStep ccnxPingSearch_NextStep(const CCNxPingSearch *search);
+
+/**
+ * Decide whether a trial met the objective, and record it.
+ *
+ * @param [in] search The `CCNxPingSearch` instance.
+ * @param [in,out] trial The trial run at the rate returned by `ccnxPingSearch_NextRate`. Its `step`,
+ *                 `passed` and `reason` are set.
+ */
+void ccnxPingSearch_Record(CCNxPingSearch *search, CCNxPingSearchTrial *trial);
+
+/**
+ * @return The highest rate confirmed to meet the objective (in interests per second), or 0 if even the minimum rate does not.
+ */
+double ccnxPingSearch_GetCapacity(const CCNxPingSearch *search);
+
+/**
+ * @return true If the search ended because it ran out of trials before confirming its bracket.
+ */
+bool ccnxPingSearch_IsIncomplete(const CCNxPingSearch *search);
+
+/**
+ * @return The number of trials recorded.
+ */
+size_t ccnxPingSearch_GetTrialCount(const CCNxPingSearch *search);
+
+/**
+ * @return The trial at the given index, in the order run.
+ */
+const CCNxPingSearchTrial *ccnxPingSearch_GetTrial(const CCNxPingSearch *search, size_t index);
+
+/**
+ * @return The name of a step (e.g., `bisect`).
+ */
+const char *ccnxPingSearchStep_GetName(CCNxPingSearchStep step);
+
+/**
+ * Display one trial on a line.
+ *
+ * @param [in] search The `CCNxPingSearch` instance.
+ * @param [in] index The index of the trial.
+ */
+void ccnxPingSearch_DisplayTrial(const CCNxPingSearch *search, size_t index);
+
+/**
+ * Display the objective and the capacity found.
+ */
+void ccnxPingSearch_Display(const CCNxPingSearch *search);
+
+/**
+ * Write the objective, the capacity and every trial as a single JSON object.
+ *
+ * @param [in] search The `CCNxPingSearch` instance.
+ * @param [in] output The stream to write to.
+ */
+void ccnxPingSearch_WriteJSON(const CCNxPingSearch *search, FILE *output);
+#endif // ccnxPing_Search_h
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <stdlib.h>
+
+#include <parc/algol/parc_DisplayIndented.h>
+
+#include "ccnxPing_Sequence.h"
+
+#define _ccnxPingSequence_JitterGain 16.0
+
+static inline bool
+_ccnxPingSequence_TestAndSet(CCNxPingSequence *sequence, uint64_t number)
+{
+    size_t position = number % ccnxPingSequence_WindowSize;
+    uint64_t mask = UINT64_C(1) << (position % 64);
+    bool wasSet = (sequence->window[position / 64] & mask) != 0;
+    sequence->window[position / 64] |= mask;
+    return wasSet;
+}
+
+/**
+ * Slide the window up to `number`, declaring lost every sequence number that leaves it unreceived.
+ */
+static void
+_ccnxPingSequence_Advance(CCNxPingSequence *sequence, uint64_t number)
+{
+    uint64_t distance = number - sequence->highestSequence;
+    uint64_t first = sequence->highestSequence + 1;
+
+    if (distance >= ccnxPingSequence_WindowSize) {
+        // The whole window leaves, followed by the numbers between the old window and the new one.
+        first = sequence->highestSequence + 1 - ccnxPingSequence_WindowSize;
+        sequence->declaredLost += distance - ccnxPingSequence_WindowSize;
+        distance = ccnxPingSequence_WindowSize;
+    } else {
+        first -= ccnxPingSequence_WindowSize;
+    }
+
+    // Wrap-around arithmetic: `leaving` may be "negative" early in the run, when it is below firstSequence.
+    for (uint64_t i = 0; i < distance; i++) {
+        uint64_t leaving = first + i;
+        size_t position = leaving % ccnxPingSequence_WindowSize;
+        uint64_t mask = UINT64_C(1) << (position % 64);
+        if (leaving >= sequence->firstSequence && leaving <= sequence->highestSequence
+            && (sequence->window[position / 64] & mask) == 0) {
+            sequence->declaredLost++;
+        }
+        sequence->window[position / 64] &= ~mask;
+    }
+
+    sequence->highestSequence = number;
+}
+
+static void
+_ccnxPingSequence_UpdateJitter(CCNxPingSequence *sequence, uint64_t sendTimeInUs, uint64_t receiveTimeInUs)
+{
+    int64_t transitInUs = (int64_t) (receiveTimeInUs - sendTimeInUs);
+    if (sequence->haveTransit) {
+        int64_t difference = llabs(transitInUs - sequence->lastTransitInUs);
+        sequence->jitterInUs += (difference - sequence->jitterInUs) / _ccnxPingSequence_JitterGain;
+    }
+    sequence->lastTransitInUs = transitInUs;
+    sequence->haveTransit = true;
+}
+
+void
+ccnxPingSequence_Init(CCNxPingSequence *sequence)
+{
+    for (size_t i = 0; i < ccnxPingSequence_WindowSize / 64; i++) {
+        sequence->window[i] = 0;
+    }
+    sequence->started = false;
+    sequence->firstSequence = 0;
+    sequence->highestSequence = 0;
+
+    sequence->received = 0;
+    sequence->duplicates = 0;
+    sequence->reordered = 0;
+    sequence->late = 0;
+    sequence->declaredLost = 0;
+    ccnxPingHistogram_Init(&sequence->reorderDistance);
+
+    sequence->haveTransit = false;
+    sequence->lastTransitInUs = 0;
+    sequence->jitterInUs = 0.0;
+}
+
+CCNxPingSequenceArrival
+ccnxPingSequence_Record(CCNxPingSequence *sequence, uint64_t number, uint64_t sendTimeInUs, uint64_t receiveTimeInUs)
+{
+    CCNxPingSequenceArrival arrival;
+
+    if (!sequence->started) {
+        sequence->started = true;
+        sequence->firstSequence = number;
+        sequence->highestSequence = number;
+        _ccnxPingSequence_TestAndSet(sequence, number);
+        arrival = CCNxPingSequenceArrival_InOrder;
+    } else if (number > sequence->highestSequence) {
+        _ccnxPingSequence_Advance(sequence, number);
+        _ccnxPingSequence_TestAndSet(sequence, number);
+        arrival = CCNxPingSequenceArrival_InOrder;
+    } else {
+        uint64_t distance = sequence->highestSequence - number;
+        if (distance >= ccnxPingSequence_WindowSize) {
+            sequence->late++;
+            arrival = CCNxPingSequenceArrival_Late;
+        } else if (_ccnxPingSequence_TestAndSet(sequence, number)) {
+            sequence->duplicates++;
+            return CCNxPingSequenceArrival_Duplicate;
+        } else {
+            if (number < sequence->firstSequence) {
+                sequence->firstSequence = number;
+            }
+            sequence->reordered++;
+            ccnxPingHistogram_Record(&sequence->reorderDistance, distance);
+            arrival = CCNxPingSequenceArrival_Reordered;
+        }
+    }
+
+    sequence->received++;
+    _ccnxPingSequence_UpdateJitter(sequence, sendTimeInUs, receiveTimeInUs);
+    return arrival;
+}
+
+void
+ccnxPingSequence_Display(const CCNxPingSequence *sequence, int indentation)
+{
+    parcDisplayIndented_PrintLine(indentation,
+                                  "Duplicates = %llu : Reordered = %llu : Late = %llu (of %llu declared lost) : Jitter = %.1f us",
+                                  (unsigned long long) sequence->duplicates,
+                                  (unsigned long long) sequence->reordered,
+                                  (unsigned long long) sequence->late,
+                                  (unsigned long long) sequence->declaredLost,
+                                  sequence->jitterInUs);
+    if (sequence->reordered > 0) {
+        ccnxPingHistogram_Display(&sequence->reorderDistance, indentation, "Reorder distance");
+    }
+}
+
+void
+ccnxPingSequence_WriteJSONMembers(const CCNxPingSequence *sequence, FILE *output)
+{
+    fprintf(output, "\"duplicates\":%llu,\"reordered\":%llu,\"late\":%llu,\"declared_lost\":%llu,\"jitter_us\":%.1f,\"reorder_distance\":",
+            (unsigned long long) sequence->duplicates,
+            (unsigned long long) sequence->reordered,
+            (unsigned long long) sequence->late,
+            (unsigned long long) sequence->declaredLost,
+            sequence->jitterInUs);
+    ccnxPingHistogram_WriteJSON(&sequence->reorderDistance, output);
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Sequence_h
+#define ccnxPing_Sequence_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "ccnxPing_Histogram.h"
+
+/**
+ * The number of sequence numbers tracked by the sliding window of a `CCNxPingSequence`.
+ * A sequence number that falls more than this many below the highest one received is
+ * declared lost. It must be a multiple of 64.
+ */
+#define ccnxPingSequence_WindowSize 4096
+
+/**
+ * The classification of a response by `ccnxPingSequence_Record`.
+ */
+typedef enum {
+    CCNxPingSequenceArrival_InOrder,   // Above every sequence number received so far
+    CCNxPingSequenceArrival_Reordered, // Below the highest sequence number received, first copy
+    CCNxPingSequenceArrival_Duplicate, // Already received
+    CCNxPingSequenceArrival_Late       // Received after it had slid out of the window and been declared lost
+} CCNxPingSequenceArrival;
+
+/**
+ * Tracks the sequence numbers of the responses to a stream of pings in a fixed-size bitmap
+ * window, and derives duplicate, reordering, late-arrival and jitter statistics from it.
+ *
+ * Every operation is O(1) in the number of responses and the structure is plain data of a
+ * fixed size, so a flood of any length runs in bounded memory. Advancing the window across a
+ * gap of missing responses costs one step per sequence number skipped, never more than
+ * `ccnxPingSequence_WindowSize` steps.
+ *
+ * Jitter is the RFC 3550 interarrival jitter: the smoothed mean deviation (gain 1/16) of the
+ * difference in transit time (here the round-trip time) between consecutive responses.
+ */
+typedef struct ccnx_ping_sequence {
+    uint64_t window[ccnxPingSequence_WindowSize / 64];
+    bool started;
+    uint64_t firstSequence;
+    uint64_t highestSequence;
+
+    uint64_t received;
+    uint64_t duplicates;
+    uint64_t reordered;
+    uint64_t late;
+    uint64_t declaredLost;
+    CCNxPingHistogram reorderDistance;
+
+    bool haveTransit;
+    int64_t lastTransitInUs;
+    double jitterInUs;
+} CCNxPingSequence;
+
+/**
+ * Reset a `CCNxPingSequence` to the empty state.
+ *
+ * @param [in] sequence The `CCNxPingSequence` to initialize.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingSequence sequence;
+ *     ccnxPingSequence_Init(&sequence);
+ *     if (ccnxPingSequence_Record(&sequence, 101, sendTime, receiveTime) != CCNxPingSequenceArrival_Duplicate) {
+ *         ...
+ *     }
+ * }
+ * @endcode
+ */
+void ccnxPingSequence_Init(CCNxPingSequence *sequence);
+
+/**
+ * Record the arrival of the response carrying sequence number `number`.
+ *
+ * Duplicates do not contribute to the jitter. Late arrivals cannot be told apart from the
+ * duplicate of a response that was received before it slid out of the window; callers that
+ * keep per-request state should check it to tell the two apart.
+ *
+ * @param [in] sequence The `CCNxPingSequence` instance.
+ * @param [in] number The sequence number of the response.
+ * @param [in] sendTimeInUs The time (in microseconds) the request was sent.
+ * @param [in] receiveTimeInUs The time (in microseconds) the response was received.
+ *
+ * @return The classification of the response.
+ */
+CCNxPingSequenceArrival ccnxPingSequence_Record(CCNxPingSequence *sequence, uint64_t number,
+                                                uint64_t sendTimeInUs, uint64_t receiveTimeInUs);
+
+/**
+ * Display the sequence statistics, one line plus the reorder distance histogram if any
+ * response was reordered.
+ *
+ * @param [in] sequence The `CCNxPingSequence` instance.
+ * @param [in] indentation The level of indentation.
+ */
+void ccnxPingSequence_Display(const CCNxPingSequence *sequence, int indentation);
+
+/**
+ * Write the sequence statistics as the members of a JSON object, without the enclosing braces:
+ * `"duplicates":N,"reordered":N,"late":N,"declared_lost":N,"jitter_us":X,"reorder_distance":{...}`.
+ *
+ * @param [in] sequence The `CCNxPingSequence` instance.
+ * @param [in] output The stream to write to.
+ */
+void ccnxPingSequence_WriteJSONMembers(const CCNxPingSequence *sequence, FILE *output);
+#endif // ccnxPing_Sequence_h
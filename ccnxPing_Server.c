@@ -58,7 +58,10 @@
  */
 #include <stdio.h>
 
+#include <errno.h>
 #include <getopt.h>
+#include <inttypes.h>
+#include <string.h>
 
 #include <LongBow/runtime.h>
 
@@ -70,32 +73,162 @@
 #include <ccnx/common/ccnx_Name.h>
 
 #include <ccnx/api/ccnx_Portal/ccnx_Portal.h>
-#include <ccnx/api/ccnx_Portal/ccnx_PortalRTA.h>
 
+#include "ccnxPing_Admission.h"
+#include "ccnxPing_Chunked.h"
 #include "ccnxPing_Common.h"
+#include "ccnxPing_Distribution.h"
+#include "ccnxPing_Histogram.h"
+#include "ccnxPing_Isolation.h"
+#include "ccnxPing_NameTrie.h"
+#include "ccnxPing_PayloadSource.h"
+#include "ccnxPing_Portal.h"
+#include "ccnxPing_ResourceUsage.h"
+#include "ccnxPing_ResponseCache.h"
+#include "ccnxPing_Signer.h"
+#include "ccnxPing_SigningPool.h"
+#include "ccnxPing_Telemetry.h"
+#include "ccnxPing_TimerWheel.h"
+#include "ccnxPing_Timestamp.h"
+
+/**
+ * The resolution and size of the timer wheel holding delayed responses: 100 us ticks,
+ * and a revolution of about 400 ms before timers share a slot with later ones.
+ */
+#define _pendingResponseTickInUs 100
+#define _pendingResponseSlots 4096
+
+/**
+ * While responses are out for signing the server polls the pool at least this often (in microseconds).
+ */
+#define _signingPollIntervalInUs 200
+
+/**
+ * The maximum number of responses queued on the signing pool per worker thread.
+ */
+#define _signingQueueDepthPerThread 256
+
+/**
+ * Always-on counters, updated only by the server loop and read by the telemetry thread.
+ */
+typedef struct ccnx_ping_server_counters {
+    uint64_t interestsReceived;
+    uint64_t responsesSent;
+    uint64_t payloadBytesSent;
+    uint64_t sendFailures;
+    uint64_t malformedInterests;
+    uint64_t otherMessages;
+    uint64_t responsesDelayed;
+    uint64_t responsesPending;
+    uint64_t signFailures;
+    uint64_t chunkInterests;
+    uint64_t unmatchedInterests;
+} CCNxPingServerCounters;
+
+/**
+ * The response profile of one registered prefix. Fields that are not given in the profile
+ * specification take the server-wide options when the server starts.
+ */
+typedef struct ccnx_ping_server_profile {
+    CCNxName *prefix;
+    size_t sizeIndex;
+
+    // A fixed payload size, or the size carried in the interest name.
+    bool hasPayloadSize;
+    size_t payloadSize;
+
+    bool hasServiceTimeModel;
+    CCNxPingDistribution serviceTimeModel;
+
+    // The key type, "none", or NULL for the server-wide choice. Signers are shared between profiles.
+    char *keyType;
+    CCNxPingSigner *signer;
+} CCNxPingServerProfile;
 
 typedef struct ccnx_ping_server {
-    CCNxPortal *portal;
+    CCNxPingPortal *portal;
     CCNxName *prefix;
     size_t payloadSize;
 
-    uint8_t generalPayload[ccnxPing_MaxPayloadSize];
+    // Response payloads are consecutive slices of this source.
+    CCNxPingPayloadSource *payloadSource;
+    uint64_t payloadOffset;
+
+    // The virtual object served as `payloadSize` chunks to interests that end with a chunk number.
+    bool servesObject;
+    uint64_t objectSize;
+
+    // With --echo unsigned responses start with a timestamp header carrying the receive
+    // time, processing time and send time of each, so that the client can split its round-trip times.
+    bool echoTimestamps;
+
+    // The synthetic service-time model: each response is delayed by a sample of this distribution,
+    // either by parking it on the timer wheel or by burning CPU for the whole time.
+    bool hasServiceTimeModel;
+    bool burnCpu;
+    CCNxPingDistribution serviceTimeModel;
+    uint64_t randomState;
+    CCNxPingTimerWheel *pendingResponses;
+
+    // The registered prefixes, dispatched by longest-prefix match. Without any profile the server
+    // registers `prefix` alone with the server-wide options.
+    CCNxPingNameTrie *profileTrie;
+    CCNxPingServerProfile **profiles;
+    size_t profileCount;
+
+    // Signing: responses are signed inline by the signer of their profile, or by `signingPool` when it
+    // has worker threads. There is one signer per key type in use, published with `signerCount`.
+    // Responses are looked up in `responseCache` (if any) before being built and signed.
+    const char *keyType;
+    size_t signingThreads;
+    size_t responseCacheEntries;
+    CCNxPingSigner *signers[ccnxPingSigner_MaxKeyTypes];
+    size_t signerCount;
+    CCNxPingSigningPool *signingPool;
+    CCNxPingResponseCache *responseCache;
+
+    // With --isolate the server loop and the signing workers are pinned, locked in memory and real-time.
+    CCNxPingIsolation isolation;
+
+    // How the server loop waits for interests (--busy-poll).
+    CCNxPingPortalPolling polling;
+
+    // The token-bucket capacity of the producer (--rate). Interests beyond it wait in the admission
+    // queue or are dropped. The admission exists only with a rate, and is published to the telemetry thread.
+    CCNxPingAdmissionOptions admissionOptions;
+    CCNxPingAdmission *admission;
+
+    char *telemetryPath;
+    CCNxPingTelemetry *telemetry;
+    uint64_t startTimeInUs;
+
+    // The resources used since the server started, reported per response and per payload byte.
+    CCNxPingResourceMeter *resourceMeter;
+    CCNxPingResourceUsage startUsage;
+
+    // Owned by the telemetry thread: the state at the previous snapshot, used to compute rates.
+    uint64_t lastSnapshotTimeInUs;
+    uint64_t lastSnapshotInterests;
+    uint64_t lastSnapshotResponses;
+
+    CCNxPingServerCounters counters;
+    CCNxPingHistogram serviceTime;
 } CCNxPingServer;
 
 /**
- * Create a new CCNxPortalFactory instance using a randomly generated identity saved to
- * the specified keystore.
+ * Open the server portal over the RTA stack using a randomly generated identity saved to
+ * the server keystore.
  *
- * @return A new CCNxPortalFactory instance which must eventually be released by calling ccnxPortalFactory_Release().
+ * @return A new `CCNxPingPortal` which must eventually be released by calling ccnxPingPortal_Release().
  */
-static CCNxPortalFactory *
-_setupServerPortalFactory(void)
+static CCNxPingPortal *
+_ccnxPingServer_OpenPortal(void)
 {
     const char *keystoreName = "server.keystore";
     const char *keystorePassword = "keystore_password";
     const char *subjectName = "server";
 
-    return ccnxPingCommon_SetupPortalFactory(keystoreName, keystorePassword, subjectName);
+    return ccnxPingPortal_CreateRTA(keystoreName, keystorePassword, subjectName);
 }
 
 /**
@@ -105,12 +238,51 @@ static bool
 _ccnxPingServer_Destructor(CCNxPingServer **serverPtr)
 {
     CCNxPingServer *server = *serverPtr;
+    if (server->telemetry != NULL) {
+        ccnxPingTelemetry_Release(&(server->telemetry));
+    }
+    if (server->resourceMeter != NULL) {
+        ccnxPingResourceMeter_Release(&(server->resourceMeter));
+    }
     if (server->portal != NULL) {
-        ccnxPortal_Release(&(server->portal));
+        ccnxPingPortal_Release(&(server->portal));
+    }
+    if (server->pendingResponses != NULL) {
+        ccnxPingTimerWheel_Release(&(server->pendingResponses));
+    }
+    if (server->admission != NULL) {
+        ccnxPingAdmission_Release(&(server->admission));
+    }
+    if (server->signingPool != NULL) {
+        ccnxPingSigningPool_Release(&(server->signingPool));
+    }
+    if (server->responseCache != NULL) {
+        ccnxPingResponseCache_Release(&(server->responseCache));
+    }
+    for (size_t i = 0; i < server->signerCount; i++) {
+        ccnxPingSigner_Release(&(server->signers[i]));
+    }
+    if (server->profileTrie != NULL) {
+        ccnxPingNameTrie_Release(&(server->profileTrie));
+    }
+    for (size_t i = 0; i < server->profileCount; i++) {
+        CCNxPingServerProfile *profile = server->profiles[i];
+        ccnxName_Release(&(profile->prefix));
+        if (profile->keyType != NULL) {
+            parcMemory_Deallocate(&(profile->keyType));
+        }
+        parcMemory_Deallocate(&profile);
+    }
+    if (server->profiles != NULL) {
+        parcMemory_Deallocate(&(server->profiles));
     }
     if (server->prefix != NULL) {
         ccnxName_Release(&(server->prefix));
     }
+    // Released last: cached and pending responses wrap its memory.
+    if (server->payloadSource != NULL) {
+        ccnxPingPayloadSource_Release(&(server->payloadSource));
+    }
     return true;
 }
 
@@ -130,69 +302,761 @@ ccnxPingServer_Create(void)
 
     server->prefix = ccnxName_CreateFromCString(ccnxPing_DefaultPrefix);
     server->payloadSize = ccnxPing_DefaultPayloadSize;
+    server->payloadSource = ccnxPingPayloadSource_Create("pattern");
+    server->payloadOffset = 0;
+    server->servesObject = false;
+    server->objectSize = 0;
+    server->echoTimestamps = false;
+    server->telemetryPath = NULL;
+    server->telemetry = NULL;
+    server->resourceMeter = NULL;
+    server->hasServiceTimeModel = false;
+    server->burnCpu = false;
+    ccnxPingDistribution_InitConstant(&server->serviceTimeModel, 0);
+    server->randomState = ((uint64_t) rand() << 1) | 1;
+    server->pendingResponses = NULL;
+    server->keyType = NULL;
+    server->signingThreads = 0;
+    server->responseCacheEntries = 0;
+    server->signerCount = 0;
+    server->signingPool = NULL;
+    server->profileTrie = ccnxPingNameTrie_Create();
+    server->profiles = NULL;
+    server->profileCount = 0;
+    server->responseCache = NULL;
+    ccnxPingAdmissionOptions_Init(&server->admissionOptions);
+    server->admission = NULL;
+
+    memset(&server->counters, 0, sizeof(server->counters));
+    ccnxPingIsolation_Init(&server->isolation);
+    ccnxPingPortalPolling_Init(&server->polling);
+    ccnxPingHistogram_Init(&server->serviceTime);
 
     return server;
 }
 
 /**
- * Create a `PARCBuffer` payload of the server-configured size.
+ * Create a `PARCBuffer` payload of the given size from the next bytes of the payload source.
  */
-PARCBuffer *
-_ccnxPingServer_MakePayload(CCNxPingServer *server, int size)
+static PARCBuffer *
+_ccnxPingServer_MakePayload(CCNxPingServer *server, size_t size)
 {
-    PARCBuffer *payload = parcBuffer_Wrap(server->generalPayload, size, 0, size);
+    PARCBuffer *payload = ccnxPingPayloadSource_CreatePayload(server->payloadSource, server->payloadOffset, size);
+    server->payloadOffset += size;
     return payload;
 }
 
+/**
+ * Create a payload of the given size that starts with a timestamp header, followed by the next bytes of
+ * the payload source. The header is written in place as the response is dispatched and sent, so the
+ * payload is a private copy rather than a slice of the source. A payload too short for the header is not stamped.
+ */
+static PARCBuffer *
+_ccnxPingServer_MakeStampedPayload(CCNxPingServer *server, size_t size)
+{
+    if (size < ccnxPingTimestamp_HeaderLength) {
+        return _ccnxPingServer_MakePayload(server, size);
+    }
+
+    PARCBuffer *content = _ccnxPingServer_MakePayload(server, size - ccnxPingTimestamp_HeaderLength);
+    PARCBuffer *payload = parcBuffer_Allocate(size);
+    ccnxPingTimestamp_Reserve(payload);
+    parcBuffer_PutArray(payload, parcBuffer_Remaining(content), parcBuffer_Overlay(content, 0));
+    parcBuffer_Release(&content);
+    return parcBuffer_Flip(payload);
+}
+
+/**
+ * Isolate the server loop and the signing workers (see `CCNxPingIsolation`), and prefault the payload source.
+ */
+static void
+_ccnxPingServer_Isolate(CCNxPingServer *server)
+{
+    if (!server->isolation.enabled) {
+        return;
+    }
+
+    ccnxPingIsolation_ApplyToProcess(&server->isolation, stdout);
+
+    size_t length = 0;
+    const void *memory = ccnxPingPayloadSource_GetMemory(server->payloadSource, &length);
+    ccnxPingIsolation_Prefault(memory, length);
+
+    if (server->signingPool != NULL) {
+        for (size_t i = 0; i < ccnxPingSigningPool_GetThreadCount(server->signingPool); i++) {
+            char role[64];
+            snprintf(role, sizeof(role), "signing worker %zu", i);
+            ccnxPingIsolation_ApplyToThread(&server->isolation, ccnxPingSigningPool_GetThread(server->signingPool, i), role, stdout);
+        }
+    }
+}
+
+/**
+ * Write a telemetry snapshot of the server counters. Called on the telemetry thread.
+ */
+static void
+_ccnxPingServer_WriteTelemetry(void *context, FILE *output, CCNxPingTelemetryFormat format)
+{
+    CCNxPingServer *server = context;
+
+    CCNxPingServerCounters counters;
+    counters.interestsReceived = ccnxPingCommon_CounterGet(server->counters.interestsReceived);
+    counters.responsesSent = ccnxPingCommon_CounterGet(server->counters.responsesSent);
+    counters.payloadBytesSent = ccnxPingCommon_CounterGet(server->counters.payloadBytesSent);
+    counters.sendFailures = ccnxPingCommon_CounterGet(server->counters.sendFailures);
+    counters.malformedInterests = ccnxPingCommon_CounterGet(server->counters.malformedInterests);
+    counters.otherMessages = ccnxPingCommon_CounterGet(server->counters.otherMessages);
+    counters.responsesDelayed = ccnxPingCommon_CounterGet(server->counters.responsesDelayed);
+    counters.responsesPending = ccnxPingCommon_CounterGet(server->counters.responsesPending);
+    counters.signFailures = ccnxPingCommon_CounterGet(server->counters.signFailures);
+    counters.chunkInterests = ccnxPingCommon_CounterGet(server->counters.chunkInterests);
+    counters.unmatchedInterests = ccnxPingCommon_CounterGet(server->counters.unmatchedInterests);
+
+    CCNxPingHistogram serviceTime;
+    ccnxPingHistogram_Snapshot(&serviceTime, &server->serviceTime);
+
+    // The signers and the pool are published by the server loop after the telemetry thread has started.
+    CCNxPingHistogram signatureTime;
+    ccnxPingHistogram_Init(&signatureTime);
+    size_t signerCount = __atomic_load_n(&server->signerCount, __ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < signerCount; i++) {
+        CCNxPingHistogram snapshot;
+        ccnxPingHistogram_Snapshot(&snapshot, ccnxPingSigner_GetSignatureTime(server->signers[i]));
+        ccnxPingHistogram_Merge(&signatureTime, &snapshot);
+    }
+    CCNxPingSigningPool *signingPool = __atomic_load_n(&server->signingPool, __ATOMIC_ACQUIRE);
+    if (signingPool != NULL) {
+        ccnxPingSigningPool_MergeSignatureTime(signingPool, &signatureTime);
+    }
+
+    uint64_t cacheHits = 0;
+    uint64_t cacheMisses = 0;
+    size_t cacheSize = 0;
+    CCNxPingResponseCache *responseCache = __atomic_load_n(&server->responseCache, __ATOMIC_ACQUIRE);
+    if (responseCache != NULL) {
+        cacheHits = ccnxPingResponseCache_GetHits(responseCache);
+        cacheMisses = ccnxPingResponseCache_GetMisses(responseCache);
+        cacheSize = ccnxPingResponseCache_GetSize(responseCache);
+    }
+
+    // The portal is published by the server loop after the telemetry thread has started.
+    CCNxPingPortalPollCounters pollCounters = { 0 };
+    CCNxPingPortal *portal = __atomic_load_n(&server->portal, __ATOMIC_ACQUIRE);
+    if (portal != NULL) {
+        ccnxPingPortal_GetPollCounters(portal, &pollCounters);
+    }
+
+    // The admission is published by the server loop after the telemetry thread has started.
+    CCNxPingAdmissionCounters admissionCounters = { 0 };
+    CCNxPingHistogram queueWait;
+    ccnxPingHistogram_Init(&queueWait);
+    CCNxPingAdmission *admission = __atomic_load_n(&server->admission, __ATOMIC_ACQUIRE);
+    if (admission != NULL) {
+        ccnxPingAdmission_GetCounters(admission, &admissionCounters);
+        ccnxPingHistogram_Snapshot(&queueWait, ccnxPingAdmission_GetQueueWait(admission));
+    }
+
+    CCNxPingResourceUsage usage;
+    ccnxPingResourceMeter_Read(server->resourceMeter, &usage);
+    ccnxPingResourceUsage_Difference(&usage, &usage, &server->startUsage);
+
+    uint64_t nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+    double uptime = (nowInUs - server->startTimeInUs) / 1000000.0;
+    double cpuTime = ccnxPingCommon_ProcessCpuTimeInUs() / 1000000.0;
+    double interval = (nowInUs - server->lastSnapshotTimeInUs) / 1000000.0;
+    double interestRate = interval > 0 ? (counters.interestsReceived - server->lastSnapshotInterests) / interval : 0.0;
+    double responseRate = interval > 0 ? (counters.responsesSent - server->lastSnapshotResponses) / interval : 0.0;
+
+    server->lastSnapshotTimeInUs = nowInUs;
+    server->lastSnapshotInterests = counters.interestsReceived;
+    server->lastSnapshotResponses = counters.responsesSent;
+
+    if (format == CCNxPingTelemetryFormat_JSON) {
+        fprintf(output, "{\"uptime_s\":%.3f,\"interests_received\":%" PRIu64 ",\"responses_sent\":%" PRIu64
+                ",\"payload_bytes_sent\":%" PRIu64 ",\"send_failures\":%" PRIu64 ",\"malformed_interests\":%" PRIu64
+                ",\"other_messages\":%" PRIu64 ",\"chunk_interests\":%" PRIu64 ",\"unmatched_interests\":%" PRIu64 ",\"prefixes\":%zu,\"responses_delayed\":%" PRIu64 ",\"responses_pending\":%" PRIu64
+                ",\"interest_rate\":%.1f,\"response_rate\":%.1f,\"payload_source\":\"%s\",\"key_type\":\"%s\",\"sign_failures\":%" PRIu64
+                ",\"cache_hits\":%" PRIu64 ",\"cache_misses\":%" PRIu64 ",\"cache_size\":%zu"
+                ",\"receive_mode\":\"%s\",\"receive_polls\":%" PRIu64 ",\"receive_spin_hits\":%" PRIu64 ",\"receive_blocks\":%" PRIu64
+                ",\"cpu_time_s\":%.3f,\"service_time_us\":",
+                uptime, counters.interestsReceived, counters.responsesSent, counters.payloadBytesSent,
+                counters.sendFailures, counters.malformedInterests, counters.otherMessages, counters.chunkInterests,
+                counters.unmatchedInterests, server->profileCount,
+                counters.responsesDelayed, counters.responsesPending, interestRate, responseRate,
+                ccnxPingPayloadSource_GetDescription(server->payloadSource),
+                server->keyType != NULL ? server->keyType : "none", counters.signFailures,
+                cacheHits, cacheMisses, cacheSize, ccnxPingPortalPolling_GetName(&server->polling),
+                pollCounters.polls, pollCounters.spinHits, pollCounters.blocks, cpuTime);
+        ccnxPingHistogram_WriteJSON(&serviceTime, output);
+        fprintf(output, ",\"signature_time_us\":");
+        ccnxPingHistogram_WriteJSON(&signatureTime, output);
+        if (admission != NULL) {
+            const CCNxPingAdmissionOptions *options = ccnxPingAdmission_GetOptions(admission);
+            fprintf(output, ",\"admission\":{\"rate\":%.1f,\"burst\":%.1f,\"queue_capacity\":%zu,\"max_wait_us\":%" PRIu64
+                    ",\"admitted\":%" PRIu64 ",\"queued\":%" PRIu64 ",\"dropped_rate_limited\":%" PRIu64
+                    ",\"dropped_queue_full\":%" PRIu64 ",\"dropped_queue_timeout\":%" PRIu64
+                    ",\"queue_depth\":%" PRIu64 ",\"queue_depth_max\":%" PRIu64 ",\"queue_wait_us\":",
+                    options->rate, options->burst, options->queueCapacity, options->maxWaitInUs,
+                    admissionCounters.admitted, admissionCounters.queued, admissionCounters.droppedRateLimited,
+                    admissionCounters.droppedQueueFull, admissionCounters.droppedQueueTimeout,
+                    admissionCounters.queueDepth, admissionCounters.maxQueueDepth);
+            ccnxPingHistogram_WriteJSON(&queueWait, output);
+            fprintf(output, "}");
+        }
+        fprintf(output, ",\"resources\":");
+        ccnxPingResourceUsage_WriteJSON(&usage, counters.responsesSent, counters.payloadBytesSent, output);
+        fprintf(output, "}\n");
+    } else {
+        fprintf(output, "uptime              %.3f s\n", uptime);
+        fprintf(output, "interests received  %" PRIu64 "\n", counters.interestsReceived);
+        fprintf(output, "responses sent      %" PRIu64 "\n", counters.responsesSent);
+        fprintf(output, "payload bytes sent  %" PRIu64 "\n", counters.payloadBytesSent);
+        fprintf(output, "send failures       %" PRIu64 "\n", counters.sendFailures);
+        fprintf(output, "malformed interests %" PRIu64 "\n", counters.malformedInterests);
+        fprintf(output, "other messages      %" PRIu64 "\n", counters.otherMessages);
+        fprintf(output, "chunk interests     %" PRIu64 "\n", counters.chunkInterests);
+        fprintf(output, "unmatched interests %" PRIu64 "\n", counters.unmatchedInterests);
+        fprintf(output, "prefixes            %zu\n", server->profileCount);
+        fprintf(output, "responses delayed   %" PRIu64 "\n", counters.responsesDelayed);
+        fprintf(output, "responses pending   %" PRIu64 "\n", counters.responsesPending);
+        fprintf(output, "interest rate       %.1f /s\n", interestRate);
+        fprintf(output, "response rate       %.1f /s\n", responseRate);
+        fprintf(output, "payload source      %s\n", ccnxPingPayloadSource_GetDescription(server->payloadSource));
+        fprintf(output, "key type            %s\n", server->keyType != NULL ? server->keyType : "none");
+        fprintf(output, "sign failures       %" PRIu64 "\n", counters.signFailures);
+        fprintf(output, "cache hits          %" PRIu64 "\n", cacheHits);
+        fprintf(output, "cache misses        %" PRIu64 "\n", cacheMisses);
+        fprintf(output, "cache size          %zu\n", cacheSize);
+        fprintf(output, "receive mode        %s\n", ccnxPingPortalPolling_GetName(&server->polling));
+        fprintf(output, "receive polls       %" PRIu64 "\n", pollCounters.polls);
+        fprintf(output, "receive spin hits   %" PRIu64 "\n", pollCounters.spinHits);
+        fprintf(output, "receive blocks      %" PRIu64 "\n", pollCounters.blocks);
+        fprintf(output, "cpu time            %.3f s\n", cpuTime);
+        fprintf(output, "service time (us)   ");
+        ccnxPingHistogram_WriteText(&serviceTime, output);
+        fprintf(output, "\n");
+        fprintf(output, "signature time (us) ");
+        ccnxPingHistogram_WriteText(&signatureTime, output);
+        fprintf(output, "\n");
+        if (admission != NULL) {
+            const CCNxPingAdmissionOptions *options = ccnxPingAdmission_GetOptions(admission);
+            fprintf(output, "admission rate      %.1f /s (burst %.1f, queue %zu)\n", options->rate, options->burst, options->queueCapacity);
+            fprintf(output, "admitted            %" PRIu64 "\n", admissionCounters.admitted);
+            fprintf(output, "queued              %" PRIu64 "\n", admissionCounters.queued);
+            fprintf(output, "dropped rate limit  %" PRIu64 "\n", admissionCounters.droppedRateLimited);
+            fprintf(output, "dropped queue full  %" PRIu64 "\n", admissionCounters.droppedQueueFull);
+            fprintf(output, "dropped queue wait  %" PRIu64 "\n", admissionCounters.droppedQueueTimeout);
+            fprintf(output, "queue depth         %" PRIu64 " (max %" PRIu64 ")\n", admissionCounters.queueDepth, admissionCounters.maxQueueDepth);
+            fprintf(output, "queue wait (us)     ");
+            ccnxPingHistogram_WriteText(&queueWait, output);
+            fprintf(output, "\n");
+        }
+        ccnxPingResourceUsage_WriteText(&usage, counters.responsesSent, counters.payloadBytesSent, output);
+    }
+}
+
+/**
+ * Send a response and account for it. The service time runs from `receiveTimeInUs` to send completion.
+ */
+static void
+_ccnxPingServer_SendResponse(CCNxPingServer *server, CCNxMetaMessage *message, uint64_t receiveTimeInUs)
+{
+    if (server->echoTimestamps) {
+        CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(message);
+        ccnxPingTimestamp_SetSent(ccnxContentObject_GetPayload(contentObject), ccnxPingCommon_MonotonicTimeInUs());
+    }
+
+    if (ccnxPingPortal_Send(server->portal, message, CCNxStackTimeout_Never)) {
+        CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(message);
+        size_t size = parcBuffer_Remaining(ccnxContentObject_GetPayload(contentObject));
+
+        ccnxPingHistogram_Record(&server->serviceTime, ccnxPingCommon_MonotonicTimeInUs() - receiveTimeInUs);
+        ccnxPingCommon_CounterAdd(server->counters.responsesSent, 1);
+        ccnxPingCommon_CounterAdd(server->counters.payloadBytesSent, (uint64_t) size);
+    } else {
+        ccnxPingCommon_CounterAdd(server->counters.sendFailures, 1);
+        fprintf(stderr, "ccnxPortal_Send failed: %d\n", ccnxPingPortal_GetError(server->portal));
+    }
+}
+
+/**
+ * Timer wheel callback: send a delayed response whose service time has elapsed.
+ */
+static void
+_ccnxPingServer_SendPendingResponse(void *context, void *item, uint64_t receiveTimeInUs)
+{
+    CCNxPingServer *server = context;
+    CCNxMetaMessage *message = item;
+
+    _ccnxPingServer_SendResponse(server, message, receiveTimeInUs);
+    ccnxMetaMessage_Release(&message);
+}
+
+/**
+ * Timer wheel callback: discard a delayed response when the server stops.
+ */
+static void
+_ccnxPingServer_DiscardPendingResponse(void *context, void *item, uint64_t receiveTimeInUs)
+{
+    CCNxMetaMessage *message = item;
+    ccnxMetaMessage_Release(&message);
+}
+
+/**
+ * Send a response now, after burning CPU, or later from the timer wheel, depending on the configured
+ * service-time model. Takes ownership of `message`.
+ */
+static void
+_ccnxPingServer_DispatchResponse(CCNxPingServer *server, CCNxMetaMessage *message, uint64_t receiveTimeInUs, uint64_t deadlineInUs)
+{
+    if (server->echoTimestamps) {
+        // The processing time ends here: what follows is the modelled service time.
+        CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(message);
+        ccnxPingTimestamp_SetReceived(ccnxContentObject_GetPayload(contentObject), receiveTimeInUs,
+                                      ccnxPingCommon_MonotonicTimeInUs() - receiveTimeInUs);
+    }
+
+    if (server->burnCpu) {
+        while (ccnxPingCommon_MonotonicTimeInUs() < deadlineInUs) {
+            // Model a CPU-bound producer: keep this core busy for the whole service time.
+        }
+    } else if (deadlineInUs > ccnxPingCommon_MonotonicTimeInUs()) {
+        ccnxPingTimerWheel_Schedule(server->pendingResponses, deadlineInUs, message, receiveTimeInUs);
+        ccnxPingCommon_CounterAdd(server->counters.responsesDelayed, 1);
+        ccnxPingCommon_CounterSet(server->counters.responsesPending, ccnxPingTimerWheel_Size(server->pendingResponses));
+        return;
+    }
+
+    _ccnxPingServer_SendResponse(server, message, receiveTimeInUs);
+    ccnxMetaMessage_Release(&message);
+}
+
+/**
+ * Signing pool callback: cache and dispatch a response that has been signed by a worker thread.
+ */
+static void
+_ccnxPingServer_CompleteSignedResponse(void *context, CCNxMetaMessage *message, uint64_t receiveTimeInUs,
+                                       uint64_t deadlineInUs, bool signedOk)
+{
+    CCNxPingServer *server = context;
+
+    if (!signedOk) {
+        ccnxPingCommon_CounterAdd(server->counters.signFailures, 1);
+        ccnxMetaMessage_Release(&message);
+        return;
+    }
+
+    if (server->responseCache != NULL) {
+        CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(message);
+        ccnxPingResponseCache_Put(server->responseCache, ccnxContentObject_GetName(contentObject), message);
+    }
+    _ccnxPingServer_DispatchResponse(server, message, receiveTimeInUs, deadlineInUs);
+}
+
+/**
+ * Build the (unsigned) response for one chunk of the virtual object.
+ *
+ * @return The response, or NULL if the server does not serve an object or the chunk is past its end.
+ */
+static CCNxMetaMessage *
+_ccnxPingServer_BuildChunk(CCNxPingServer *server, CCNxName *interestName, uint64_t chunkNumber)
+{
+    ccnxPingCommon_CounterAdd(server->counters.chunkInterests, 1);
+
+    uint64_t chunkCount = ccnxPingChunked_ChunkCount(server->objectSize, server->payloadSize);
+    if (!server->servesObject || chunkNumber >= chunkCount) {
+        return NULL;
+    }
+
+    size_t length = ccnxPingChunked_ChunkLength(server->objectSize, server->payloadSize, chunkNumber);
+    PARCBuffer *payload = ccnxPingChunked_CreatePayload(chunkNumber * server->payloadSize, length);
+    CCNxContentObject *contentObject = ccnxContentObject_CreateWithNameAndPayload(interestName, payload);
+    ccnxContentObject_SetFinalChunkNumber(contentObject, chunkCount - 1);
+    CCNxMetaMessage *message = ccnxMetaMessage_CreateFromContentObject(contentObject);
+    ccnxContentObject_Release(&contentObject);
+    parcBuffer_Release(&payload);
+
+    return message;
+}
+
+/**
+ * Build the (unsigned) response to an interest that matched `profile`.
+ *
+ * @return The response, or NULL if the interest name carries neither a payload size (when the profile
+ *         does not fix one) nor a valid chunk number.
+ */
+static CCNxMetaMessage *
+_ccnxPingServer_BuildResponse(CCNxPingServer *server, const CCNxPingServerProfile *profile, CCNxName *interestName)
+{
+    uint64_t chunkNumber = 0;
+    if (ccnxPingChunked_GetChunkNumber(interestName, profile->sizeIndex, &chunkNumber)) {
+        return _ccnxPingServer_BuildChunk(server, interestName, chunkNumber);
+    }
+
+    // Extract the size of the payload response from the client
+    size_t size = profile->payloadSize;
+    if (!profile->hasPayloadSize && !ccnxPingCommon_GetPayloadSize(interestName, profile->sizeIndex, &size)) {
+        return NULL;
+    }
+
+    // A signature covers the payload, so signed responses are never stamped.
+    PARCBuffer *payload = NULL;
+    if (server->echoTimestamps && profile->signer == NULL) {
+        payload = _ccnxPingServer_MakeStampedPayload(server, size);
+    } else {
+        payload = _ccnxPingServer_MakePayload(server, size);
+    }
+    CCNxMetaMessage *message = ccnxPingCommon_CreateResponse(interestName, payload);
+    parcBuffer_Release(&payload);
+
+    return message;
+}
+
+/**
+ * Dispatch an interest to the profile of its longest registered prefix, and answer it from the
+ * response cache or with a newly built, signed response.
+ */
+static void
+_ccnxPingServer_HandleInterest(CCNxPingServer *server, CCNxInterest *interest, uint64_t receiveTimeInUs)
+{
+    CCNxName *interestName = ccnxInterest_GetName(interest);
+    const CCNxPingServerProfile *profile = ccnxPingNameTrie_LongestPrefixMatch(server->profileTrie, interestName, NULL);
+    if (profile == NULL) {
+        ccnxPingCommon_CounterAdd(server->counters.unmatchedInterests, 1);
+        return;
+    }
+
+    uint64_t deadlineInUs = receiveTimeInUs;
+    if (profile->hasServiceTimeModel) {
+        deadlineInUs += ccnxPingDistribution_Sample(&profile->serviceTimeModel, &server->randomState);
+    }
+
+    if (server->responseCache != NULL) {
+        CCNxMetaMessage *cached = ccnxPingResponseCache_Get(server->responseCache, interestName);
+        if (cached != NULL) {
+            _ccnxPingServer_DispatchResponse(server, cached, receiveTimeInUs, deadlineInUs);
+            return;
+        }
+    }
+
+    CCNxMetaMessage *message = _ccnxPingServer_BuildResponse(server, profile, interestName);
+    if (message == NULL) {
+        ccnxPingCommon_CounterAdd(server->counters.malformedInterests, 1);
+        return;
+    }
+
+    if (profile->signer != NULL) {
+        if (server->signingPool != NULL
+            && ccnxPingSigningPool_Submit(server->signingPool, profile->signer, message, receiveTimeInUs, deadlineInUs)) {
+            return;
+        }
+        // Sign inline when there is no pool or its queue is full.
+        bool signedOk = ccnxPingSigner_Sign(profile->signer, ccnxMetaMessage_GetContentObject(message));
+        _ccnxPingServer_CompleteSignedResponse(server, message, receiveTimeInUs, deadlineInUs, signedOk);
+        return;
+    }
+
+    if (server->responseCache != NULL) {
+        ccnxPingResponseCache_Put(server->responseCache, interestName, message);
+    }
+    _ccnxPingServer_DispatchResponse(server, message, receiveTimeInUs, deadlineInUs);
+}
+
+/**
+ * Append a profile to the table of registered profiles, which takes ownership of it.
+ */
+static void
+_ccnxPingServer_AppendProfile(CCNxPingServer *server, CCNxPingServerProfile *profile)
+{
+    CCNxPingServerProfile **profiles = parcMemory_AllocateAndClear((server->profileCount + 1) * sizeof(CCNxPingServerProfile *));
+    if (server->profiles != NULL) {
+        memcpy(profiles, server->profiles, server->profileCount * sizeof(CCNxPingServerProfile *));
+        parcMemory_Deallocate(&(server->profiles));
+    }
+    server->profiles = profiles;
+    server->profiles[server->profileCount++] = profile;
+}
+
+/**
+ * Register a prefix profile from a specification `prefix[,size=N][,delay=SPEC][,sign=KEYTYPE|none]`.
+ *
+ * @return true if the specification is valid and its prefix was not already registered.
+ */
+static bool
+_ccnxPingServer_AddProfile(CCNxPingServer *server, const char *specification)
+{
+    char *fields = parcMemory_StringDuplicate(specification, strlen(specification));
+    char *cursor = fields;
+    char *prefixString = strsep(&cursor, ",");
+
+    CCNxPingServerProfile *profile = parcMemory_AllocateAndClear(sizeof(CCNxPingServerProfile));
+    profile->prefix = ccnxName_CreateFromCString(prefixString);
+
+    bool result = profile->prefix != NULL;
+    char *field = NULL;
+    while (result && (field = strsep(&cursor, ",")) != NULL) {
+        if (strncmp(field, "size=", 5) == 0) {
+            result = sscanf(field + 5, "%zu", &profile->payloadSize) == 1 && profile->payloadSize <= ccnxPing_MaxPayloadSize;
+            profile->hasPayloadSize = true;
+        } else if (strncmp(field, "delay=", 6) == 0) {
+            result = ccnxPingDistribution_Parse(&profile->serviceTimeModel, field + 6);
+            profile->hasServiceTimeModel = true;
+        } else if (strncmp(field, "sign=", 5) == 0 && profile->keyType == NULL) {
+            profile->keyType = parcMemory_StringDuplicate(field + 5, strlen(field + 5));
+        } else {
+            result = false;
+        }
+    }
+
+    if (result) {
+        profile->sizeIndex = ccnxName_GetSegmentCount(profile->prefix) + 1;
+        result = ccnxPingNameTrie_Insert(server->profileTrie, profile->prefix, profile);
+        if (!result) {
+            fprintf(stderr, "The prefix %s is registered twice\n", prefixString);
+        }
+    }
+
+    if (result) {
+        _ccnxPingServer_AppendProfile(server, profile);
+    } else {
+        fprintf(stderr, "Invalid prefix profile '%s'\n", specification);
+        if (profile->prefix != NULL) {
+            ccnxName_Release(&profile->prefix);
+        }
+        if (profile->keyType != NULL) {
+            parcMemory_Deallocate(&profile->keyType);
+        }
+        parcMemory_Deallocate(&profile);
+    }
+
+    parcMemory_Deallocate(&fields);
+    return result;
+}
+
+/**
+ * Register one prefix profile per line of a file. Empty lines and lines starting with '#' are ignored.
+ */
+static bool
+_ccnxPingServer_AddProfilesFromFile(CCNxPingServer *server, const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+
+    bool result = true;
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    while (result && getline(&line, &lineCapacity, file) != -1) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] != '\0' && line[0] != '#') {
+            result = _ccnxPingServer_AddProfile(server, line);
+        }
+    }
+
+    free(line);
+    fclose(file);
+    return result;
+}
+
+/**
+ * Return the signer for a key type, creating it on first use. Signers are shared by all profiles.
+ */
+static CCNxPingSigner *
+_ccnxPingServer_GetSigner(CCNxPingServer *server, const char *keyType)
+{
+    for (size_t i = 0; i < server->signerCount; i++) {
+        if (strcmp(ccnxPingSigner_GetKeyType(server->signers[i]), keyType) == 0) {
+            return server->signers[i];
+        }
+    }
+
+    CCNxPingSigner *signer = server->signerCount < ccnxPingSigner_MaxKeyTypes ? ccnxPingSigner_Create(keyType) : NULL;
+    if (signer != NULL) {
+        server->signers[server->signerCount] = signer;
+        __atomic_store_n(&server->signerCount, server->signerCount + 1, __ATOMIC_RELEASE);
+    }
+    return signer;
+}
+
+/**
+ * Complete every profile with the server-wide options and create the signers they use.
+ *
+ * @return false if a signer could not be created.
+ */
+static bool
+_ccnxPingServer_ResolveProfiles(CCNxPingServer *server)
+{
+    if (server->profileCount == 0) {
+        CCNxPingServerProfile *profile = parcMemory_AllocateAndClear(sizeof(CCNxPingServerProfile));
+        profile->prefix = ccnxName_Acquire(server->prefix);
+        profile->sizeIndex = ccnxName_GetSegmentCount(profile->prefix) + 1;
+        ccnxPingNameTrie_Insert(server->profileTrie, profile->prefix, profile);
+        _ccnxPingServer_AppendProfile(server, profile);
+    }
+
+    for (size_t i = 0; i < server->profileCount; i++) {
+        CCNxPingServerProfile *profile = server->profiles[i];
+        if (!profile->hasServiceTimeModel && server->hasServiceTimeModel) {
+            profile->serviceTimeModel = server->serviceTimeModel;
+            profile->hasServiceTimeModel = true;
+        }
+
+        const char *keyType = profile->keyType != NULL ? profile->keyType : server->keyType;
+        if (keyType != NULL && strcmp(keyType, "none") != 0) {
+            profile->signer = _ccnxPingServer_GetSigner(server, keyType);
+            if (profile->signer == NULL) {
+                fprintf(stderr, "Unable to create a '%s' signer\n", keyType);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Serve the interests of the admission queue for which tokens have accrued.
+ */
+static void
+_ccnxPingServer_ServeAdmitted(CCNxPingServer *server, uint64_t nowInUs)
+{
+    uint64_t receiveTimeInUs;
+    CCNxMetaMessage *request;
+    while ((request = ccnxPingAdmission_Poll(server->admission, nowInUs, &receiveTimeInUs)) != NULL) {
+        _ccnxPingServer_HandleInterest(server, ccnxMetaMessage_GetInterest(request), receiveTimeInUs);
+        ccnxMetaMessage_Release(&request);
+    }
+}
+
+/**
+ * Wait for the next message, waking up in time to send any delayed response that falls due first,
+ * to serve the admission queue as tokens accrue, and to collect the responses signed by the signing pool.
+ * `timedOut` is set when the wait ended without a message because such a deadline came.
+ *
+ * @return The next message, or NULL if the wait ended without one.
+ */
+static CCNxMetaMessage *
+_ccnxPingServer_Receive(CCNxPingServer *server, bool *timedOut)
+{
+    if (server->signingPool != NULL) {
+        ccnxPingSigningPool_Complete(server->signingPool, _ccnxPingServer_CompleteSignedResponse, server);
+    }
+
+    uint64_t nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+    ccnxPingTimerWheel_Expire(server->pendingResponses, nowInUs, _ccnxPingServer_SendPendingResponse, server);
+    ccnxPingCommon_CounterSet(server->counters.responsesPending, ccnxPingTimerWheel_Size(server->pendingResponses));
+
+    uint64_t nextDeadlineInUs = ccnxPingTimerWheel_NextDeadline(server->pendingResponses);
+    if (server->admission != NULL) {
+        _ccnxPingServer_ServeAdmitted(server, nowInUs);
+        uint64_t admissionDeadlineInUs = ccnxPingAdmission_NextDeadline(server->admission, nowInUs);
+        nextDeadlineInUs = admissionDeadlineInUs < nextDeadlineInUs ? admissionDeadlineInUs : nextDeadlineInUs;
+    }
+    if (server->signingPool != NULL && ccnxPingSigningPool_InFlight(server->signingPool) > 0) {
+        uint64_t pollDeadlineInUs = nowInUs + _signingPollIntervalInUs;
+        nextDeadlineInUs = pollDeadlineInUs < nextDeadlineInUs ? pollDeadlineInUs : nextDeadlineInUs;
+    }
+    if (nextDeadlineInUs == UINT64_MAX) {
+        *timedOut = false;
+        return ccnxPingPortal_Receive(server->portal, CCNxStackTimeout_Never);
+    }
+
+    nowInUs = ccnxPingCommon_MonotonicTimeInUs();
+    uint64_t timeoutInUs = nextDeadlineInUs > nowInUs ? nextDeadlineInUs - nowInUs : 0;
+    CCNxMetaMessage *message = ccnxPingPortal_Receive(server->portal, &timeoutInUs);
+    if (message == NULL) {
+        // A wait cut short by a transport error must not be taken for a deadline, or the loop would spin on it.
+        int error = ccnxPingPortal_GetError(server->portal);
+        *timedOut = ccnxPingCommon_MonotonicTimeInUs() >= nextDeadlineInUs
+                    || error == 0 || error == EINTR || error == EAGAIN || error == ETIMEDOUT;
+    }
+    return message;
+}
+
 /**
  * Run the `CCNxPingServer` indefinitely.
  */
 static void
 _ccnxPingServer_Run(CCNxPingServer *server)
 {
-    CCNxPortalFactory *factory = _setupServerPortalFactory();
-    server->portal = ccnxPortalFactory_CreatePortal(factory, ccnxPortalRTA_Message);
-    ccnxPortalFactory_Release(&factory);
+    server->startTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+    server->lastSnapshotTimeInUs = server->startTimeInUs;
+    server->lastSnapshotInterests = 0;
+    server->lastSnapshotResponses = 0;
+    server->pendingResponses = ccnxPingTimerWheel_Create(_pendingResponseTickInUs, _pendingResponseSlots, server->startTimeInUs);
+
+    // The meter comes before any thread, so that its counters follow all of them.
+    server->resourceMeter = ccnxPingResourceMeter_Create();
+    ccnxPingResourceMeter_Read(server->resourceMeter, &server->startUsage);
+    if (server->admissionOptions.rate > 0.0) {
+        __atomic_store_n(&server->admission, ccnxPingAdmission_Create(&server->admissionOptions, server->startTimeInUs), __ATOMIC_RELEASE);
+    }
+
+    // The telemetry thread must exist before the portal so that SIGUSR1 is routed to it alone.
+    server->telemetry = ccnxPingTelemetry_Create(server->telemetryPath, _ccnxPingServer_WriteTelemetry, server);
+
+    // The signing workers are started after the telemetry thread for the same reason.
+    if (server->responseCacheEntries > 0) {
+        __atomic_store_n(&server->responseCache, ccnxPingResponseCache_Create(server->responseCacheEntries), __ATOMIC_RELEASE);
+    }
+    if (!_ccnxPingServer_ResolveProfiles(server)) {
+        return;
+    }
+    if (server->signerCount > 0 && server->signingThreads > 0) {
+        CCNxPingSigningPool *signingPool = ccnxPingSigningPool_Create(server->signingThreads,
+                                                                     server->signingThreads * _signingQueueDepthPerThread);
+        __atomic_store_n(&server->signingPool, signingPool, __ATOMIC_RELEASE);
+    }
+
+    CCNxPingPortal *portal = _ccnxPingServer_OpenPortal();
+    if (portal != NULL) {
+        ccnxPingPortal_SetPolling(portal, &server->polling);
+    }
+    __atomic_store_n(&server->portal, portal, __ATOMIC_RELEASE);
 
     size_t yearInSeconds = 60 * 60 * 24 * 365;
 
-    size_t sizeIndex = ccnxName_GetSegmentCount(server->prefix) + 1;
+    bool listening = server->portal != NULL;
+    for (size_t i = 0; i < server->profileCount && listening; i++) {
+        listening = ccnxPingPortal_Listen(server->portal, server->profiles[i]->prefix, yearInSeconds, CCNxStackTimeout_Never);
+    }
+
+    if (listening) {
+        // Isolation comes last, so that the threads of the transport stack keep their default scheduling.
+        _ccnxPingServer_Isolate(server);
 
-    if (ccnxPortal_Listen(server->portal, server->prefix, yearInSeconds, CCNxStackTimeout_Never)) {
         while (true) {
-            CCNxMetaMessage *request = ccnxPortal_Receive(server->portal, CCNxStackTimeout_Never);
+            bool timedOut = false;
+            CCNxMetaMessage *request = _ccnxPingServer_Receive(server, &timedOut);
 
-            // This should never happen.
             if (request == NULL) {
+                // A bounded wait ends without a message when a delayed or signed response falls due.
+                if (timedOut) {
+                    continue;
+                }
+                fprintf(stderr, "ccnxPortal_Receive failed: %d\n", ccnxPingPortal_GetError(server->portal));
                 break;
             }
 
+            uint64_t receiveTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+
             CCNxInterest *interest = ccnxMetaMessage_GetInterest(request);
             if (interest != NULL) {
-                CCNxName *interestName = ccnxInterest_GetName(interest);
-
-                // Extract the size of the payload response from the client
-                CCNxNameSegment *sizeSegment = ccnxName_GetSegment(interestName, sizeIndex);
-                char *segmentString = ccnxNameSegment_ToString(sizeSegment);
-                int size = atoi(segmentString);
-                size = size > ccnxPing_MaxPayloadSize ? ccnxPing_MaxPayloadSize : size;
-
-                PARCBuffer *payload = _ccnxPingServer_MakePayload(server, size);
-
-                CCNxContentObject *contentObject = ccnxContentObject_CreateWithNameAndPayload(interestName, payload);
-                CCNxMetaMessage *message = ccnxMetaMessage_CreateFromContentObject(contentObject);
-
-                if (ccnxPortal_Send(server->portal, message, CCNxStackTimeout_Never) == false) {
-                    fprintf(stderr, "ccnxPortal_Send failed: %d\n", ccnxPortal_GetError(server->portal));
+                ccnxPingCommon_CounterAdd(server->counters.interestsReceived, 1);
+                // Queued and dropped interests are accounted for by the admission.
+                if (server->admission == NULL
+                    || ccnxPingAdmission_Offer(server->admission, request, receiveTimeInUs) == CCNxPingAdmissionResult_Admitted) {
+                    _ccnxPingServer_HandleInterest(server, interest, receiveTimeInUs);
                 }
-
-                ccnxMetaMessage_Release(&message);
-                parcBuffer_Release(&payload);
-
+            } else {
+                ccnxPingCommon_CounterAdd(server->counters.otherMessages, 1);
             }
             ccnxMetaMessage_Release(&request);
         }
     }
+
+    ccnxPingTimerWheel_Drain(server->pendingResponses, _ccnxPingServer_DiscardPendingResponse, server);
 }
 
 /**
@@ -203,16 +1067,41 @@ _displayUsage(char *progName)
 {
     printf("CCNx Simple Ping Performance Test\n");
     printf("\n");
-    printf("Usage: %s [-l locator] [-s size] \n", progName);
+    printf("Usage: %s [-l locator] [-s size] [-t socket] [-d delay [-b]] [-k keytype [-w threads]] [-c entries] [-o bytes] [-p source] [-r rate]\n", progName);
+    printf("       %s [-P profile ...] [-F file] [-e] [options]\n", progName);
     printf("       %s -h\n", progName);
     printf("\n");
     printf("Example:\n");
-    printf("    ccnxPing_Server -l ccnx:/some/prefix -s 4096\n");
+    printf("    ccnxPing_Server -l ccnx:/some/prefix -s 4096 -t /tmp/ccnxPing_Server.sock\n");
+    printf("    ccnxPing_Server -l ccnx:/some/prefix -k rsa2048 -w 4 -c 65536\n");
+    printf("    ccnxPing_Server -l ccnx:/some/prefix -o 1073741824 -s 8192\n");
+    printf("    ccnxPing_Server -l ccnx:/some/prefix -p random:268435456:huge\n");
+    printf("    ccnxPing_Server -P ccnx:/a,size=1200 -P ccnx:/b,delay=exp:500,sign=rsa2048 -w 4\n");
+    printf("    ccnxPing_Server -l ccnx:/some/prefix -r 20000,burst=200,queue=1000,wait=50000\n");
     printf("\n");
     printf("Options:\n");
     printf("     -h (--help) Show this help message\n");
     printf("     -l (--locator) Set the locator for this server. The default is 'ccnx:/locator'. \n");
+    printf("     -P (--prefix) Register a prefix profile: PREFIX[,size=N][,delay=SPEC][,sign=KEYTYPE|none]. May be repeated.\n");
+    printf("                   Unset fields take the -d and -k options; without size=N the size is read from the name.\n");
+    printf("     -F (--prefix-file) Register one prefix profile per line of this file\n");
     printf("     -s (--size) Set the payload size (less than 64000 - see `ccnxPing_MaxPayloadSize` in ccnxPing_Common.h)\n");
+    printf("     -p (--payload) Payload source: pattern (default), random[:BYTES[:huge]] or file:PATH\n");
+    printf("     -o (--object) Serve a virtual object of this many bytes as chunks of the payload size (-s)\n");
+    printf("     -d (--delay) Service-time model (us): N, const:N, uniform:LOW:HIGH, exp:MEAN or bimodal:FAST:SLOW:P\n");
+    printf("     -b (--burn) Burn CPU for the service time instead of scheduling the response for later\n");
+    printf("     -e (--echo) Start unsigned payloads with the receive, processing and send times of the server,\n");
+    printf("                   so that the client reports the request and response legs of its round-trip times\n");
+    printf("     -k (--sign) Sign responses with a new key: rsa1024, rsa2048, rsa4096, ecdsa or hmac\n");
+    printf("     -w (--workers) Sign on this many worker threads instead of the server loop\n");
+    printf("     -c (--cache) Keep up to this many responses (signed, if -k is given) for repeated names\n");
+    printf("     -r (--rate) Admit at most RATE interests per second: RATE[,burst=N][,queue=N][,wait=US]. Excess interests\n");
+    printf("                   wait in a queue of N (default 0) for at most US microseconds, or are dropped and counted.\n");
+    printf("     -B (--busy-poll[=MODE]) Wait for interests by spinning (spin, the default) or by spinning for an adaptive\n");
+    printf("                   budget of at most US microseconds before blocking (hybrid[:US]). CPU time is in the telemetry.\n");
+    printf("     -I (--isolate[=CPUS]) Pin the server loop to the first CPU of a list such as 2,4-7 and the signing workers\n");
+    printf("                   to the others; lock and prefault memory and request SCHED_FIFO. Each step is reported.\n");
+    printf("     -t (--telemetry) Serve counters on this UNIX-domain socket (send 'json' or 'text'). SIGUSR1 dumps them to stderr.\n");
 }
 
 /**
@@ -222,21 +1111,48 @@ static bool
 _ccnxPingServer_ParseCommandline(CCNxPingServer *server, int argc, char *argv[argc])
 {
     static struct option longopts[] = {
-        { "locator", required_argument, NULL, 'l' },
-        { "size",    required_argument, NULL, 's' },
-        { "help",    no_argument,       NULL, 'h' },
-        { NULL,      0,                 NULL, 0   }
+        { "locator",     required_argument, NULL, 'l' },
+        { "size",        required_argument, NULL, 's' },
+        { "telemetry",   required_argument, NULL, 't' },
+        { "delay",       required_argument, NULL, 'd' },
+        { "burn",        no_argument,       NULL, 'b' },
+        { "echo",        no_argument,       NULL, 'e' },
+        { "sign",        required_argument, NULL, 'k' },
+        { "workers",     required_argument, NULL, 'w' },
+        { "cache",       required_argument, NULL, 'c' },
+        { "object",      required_argument, NULL, 'o' },
+        { "payload",     required_argument, NULL, 'p' },
+        { "prefix",      required_argument, NULL, 'P' },
+        { "prefix-file", required_argument, NULL, 'F' },
+        { "isolate",     optional_argument, NULL, 'I' },
+        { "busy-poll",   optional_argument, NULL, 'B' },
+        { "rate",        required_argument, NULL, 'r' },
+        { "help",        no_argument,       NULL, 'h' },
+        { NULL,          0,                 NULL, 0   }
     };
 
     // Default value
     server->payloadSize = ccnxPing_MaxPayloadSize;
 
     int c;
-    while ((c = getopt_long(argc, argv, "l:s:h", longopts, NULL)) != -1) {
+    while ((c = getopt_long(argc, argv, "l:s:t:d:bek:w:c:o:p:P:F:I::B::r:h", longopts, NULL)) != -1) {
         switch (c) {
             case 'l':
+                ccnxName_Release(&(server->prefix));
                 server->prefix = ccnxName_CreateFromCString(optarg);
                 break;
+            case 'P':
+                if (!_ccnxPingServer_AddProfile(server, optarg)) {
+                    _displayUsage(argv[0]);
+                    return false;
+                }
+                break;
+            case 'F':
+                if (!_ccnxPingServer_AddProfilesFromFile(server, optarg)) {
+                    _displayUsage(argv[0]);
+                    return false;
+                }
+                break;
             case 's':
                 sscanf(optarg, "%zu", &(server->payloadSize));
                 if (server->payloadSize > ccnxPing_MaxPayloadSize) {
@@ -244,6 +1160,63 @@ _ccnxPingServer_ParseCommandline(CCNxPingServer *server, int argc, char *argv[ar
                     return false;
                 }
                 break;
+            case 't':
+                server->telemetryPath = optarg;
+                break;
+            case 'd':
+                if (!ccnxPingDistribution_Parse(&server->serviceTimeModel, optarg)) {
+                    _displayUsage(argv[0]);
+                    return false;
+                }
+                server->hasServiceTimeModel = true;
+                break;
+            case 'b':
+                server->burnCpu = true;
+                break;
+            case 'e':
+                server->echoTimestamps = true;
+                break;
+            case 'k':
+                server->keyType = optarg;
+                break;
+            case 'w':
+                sscanf(optarg, "%zu", &(server->signingThreads));
+                break;
+            case 'c':
+                sscanf(optarg, "%zu", &(server->responseCacheEntries));
+                break;
+            case 'o':
+                sscanf(optarg, "%" SCNu64, &(server->objectSize));
+                server->servesObject = true;
+                break;
+            case 'p': {
+                CCNxPingPayloadSource *payloadSource = ccnxPingPayloadSource_Create(optarg);
+                if (payloadSource == NULL) {
+                    _displayUsage(argv[0]);
+                    return false;
+                }
+                ccnxPingPayloadSource_Release(&(server->payloadSource));
+                server->payloadSource = payloadSource;
+                break;
+            }
+            case 'B':
+                if (!ccnxPingPortalPolling_Parse(&server->polling, optarg != NULL ? optarg : "spin")) {
+                    fprintf(stderr, "Invalid receive mode: %s\n", optarg);
+                    return false;
+                }
+                break;
+            case 'r':
+                if (!ccnxPingAdmissionOptions_Parse(&server->admissionOptions, optarg)) {
+                    fprintf(stderr, "Invalid rate: %s\n", optarg);
+                    return false;
+                }
+                break;
+            case 'I':
+                if (!ccnxPingIsolation_Parse(&server->isolation, optarg)) {
+                    fprintf(stderr, "Invalid CPU list: %s\n", optarg);
+                    return false;
+                }
+                break;
             case 'h':
                 _displayUsage(argv[0]);
                 return false;
@@ -252,6 +1225,15 @@ _ccnxPingServer_ParseCommandline(CCNxPingServer *server, int argc, char *argv[ar
         }
     }
 
+    if (server->servesObject && server->payloadSize == 0) {
+        _displayUsage(argv[0]);
+        return false;
+    }
+    if (server->echoTimestamps && server->responseCacheEntries > 0) {
+        fprintf(stderr, "--echo stamps each response in place, which a cached response shared between interests cannot carry\n");
+        return false;
+    }
+
     return true;
 };
 
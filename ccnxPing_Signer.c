@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include <parc/security/parc_CryptoHasher.h>
+#include <parc/security/parc_KeyId.h>
+#include <parc/security/parc_KeyStore.h>
+#include <parc/security/parc_Pkcs12KeyStore.h>
+#include <parc/security/parc_PublicKeySigner.h>
+#include <parc/security/parc_Signature.h>
+#include <parc/security/parc_Signer.h>
+#include <parc/security/parc_SymmetricKeySigner.h>
+#include <parc/security/parc_SymmetricKeyStore.h>
+
+#include <ccnx/common/ccnx_Name.h>
+#include <ccnx/common/ccnx_NameSegment.h>
+
+#include "ccnxPing_Common.h"
+#include "ccnxPing_Signer.h"
+
+#define _keystorePassword "keystore_password"
+#define _keyValidityInDays 30
+#define _hmacKeyBits 256
+
+typedef enum {
+    _CCNxPingSignerKind_PublicKey,
+    _CCNxPingSignerKind_Hmac
+} _CCNxPingSignerKind;
+
+typedef struct ccnx_ping_signer_key_type {
+    const char *name;
+    _CCNxPingSignerKind kind;
+    unsigned int keyLength;
+    PARCCryptoSuite suite;
+} _CCNxPingSignerKeyType;
+
+static const _CCNxPingSignerKeyType _ccnxPingSigner_KeyTypes[] = {
+    { "rsa1024", _CCNxPingSignerKind_PublicKey, 1024, PARCCryptoSuite_RSA_SHA256   },
+    { "rsa2048", _CCNxPingSignerKind_PublicKey, 2048, PARCCryptoSuite_RSA_SHA256   },
+    { "rsa4096", _CCNxPingSignerKind_PublicKey, 4096, PARCCryptoSuite_RSA_SHA256   },
+#ifdef CCNX_PING_HAVE_ECDSA
+    { "ecdsa",   _CCNxPingSignerKind_PublicKey, 256,  PARCCryptoSuite_ECDSA_SHA256 },
+#endif
+    { "hmac",    _CCNxPingSignerKind_Hmac,      256,  PARCCryptoSuite_HMAC_SHA256  },
+    { NULL,      0,                             0,    0                            }
+};
+
+struct ccnx_ping_signer {
+    const _CCNxPingSignerKeyType *keyType;
+    char *keystoreName;
+    PARCBuffer *secretKey;
+
+    PARCSigner *signer;
+    PARCKeyId *keyId;
+
+    CCNxPingHistogram signatureTime;
+    uint64_t failures;
+};
+
+static bool
+_ccnxPingSigner_Destructor(CCNxPingSigner **signerPtr)
+{
+    CCNxPingSigner *signer = *signerPtr;
+    if (signer->keyId != NULL) {
+        parcKeyId_Release(&signer->keyId);
+    }
+    if (signer->signer != NULL) {
+        parcSigner_Release(&signer->signer);
+    }
+    if (signer->secretKey != NULL) {
+        parcBuffer_Release(&signer->secretKey);
+    }
+    if (signer->keystoreName != NULL) {
+        parcMemory_Deallocate(&signer->keystoreName);
+    }
+    return true;
+}
+
+parcObject_Override(CCNxPingSigner, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingSigner_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingSigner, CCNxPingSigner);
+parcObject_ImplementRelease(ccnxPingSigner, CCNxPingSigner);
+
+static bool
+_ccnxPingSigner_CreateKeyStoreFile(const _CCNxPingSignerKeyType *keyType, const char *keystoreName)
+{
+#ifdef CCNX_PING_HAVE_ECDSA
+    PARCSigningAlgorithm algorithm = keyType->suite == PARCCryptoSuite_ECDSA_SHA256 ? PARCSigningAlgorithm_ECDSA : PARCSigningAlgorithm_RSA;
+    return parcPkcs12KeyStore_CreateFile(keystoreName, _keystorePassword, "server", algorithm,
+                                         keyType->keyLength, _keyValidityInDays);
+#else
+    return parcPkcs12KeyStore_CreateFile(keystoreName, _keystorePassword, "server",
+                                         keyType->keyLength, _keyValidityInDays);
+#endif
+}
+
+/**
+ * Instantiate the PARC signer over the key material held by `signer`.
+ */
+static bool
+_ccnxPingSigner_OpenSigner(CCNxPingSigner *signer)
+{
+    if (signer->keyType->kind == _CCNxPingSignerKind_Hmac) {
+        PARCSymmetricKeyStore *keyStore = parcSymmetricKeyStore_Create(signer->secretKey);
+        PARCSymmetricKeySigner *hmacSigner = parcSymmetricKeySigner_Create(keyStore, PARCCryptoHashType_SHA256);
+        signer->signer = parcSigner_Create(hmacSigner, PARCSymmetricKeySignerAsSigner);
+        parcSymmetricKeySigner_Release(&hmacSigner);
+        parcSymmetricKeyStore_Release(&keyStore);
+    } else {
+        PARCPkcs12KeyStore *pkcs12 = parcPkcs12KeyStore_Open(signer->keystoreName, _keystorePassword, PARCCryptoHashType_SHA256);
+        if (pkcs12 == NULL) {
+            return false;
+        }
+        PARCKeyStore *keyStore = parcKeyStore_Create(pkcs12, PARCPkcs12KeyStoreAsKeyStore);
+        PARCPublicKeySigner *publicKeySigner = parcPublicKeySigner_Create(keyStore, signer->keyType->suite);
+        signer->signer = parcSigner_Create(publicKeySigner, PARCPublicKeySignerAsSigner);
+        parcPublicKeySigner_Release(&publicKeySigner);
+        parcKeyStore_Release(&keyStore);
+        parcPkcs12KeyStore_Release(&pkcs12);
+    }
+
+    if (signer->signer == NULL) {
+        return false;
+    }
+    signer->keyId = parcSigner_CreateKeyId(signer->signer);
+    return true;
+}
+
+static CCNxPingSigner *
+_ccnxPingSigner_CreateEmpty(const _CCNxPingSignerKeyType *keyType)
+{
+    CCNxPingSigner *signer = parcObject_CreateInstance(CCNxPingSigner);
+
+    signer->keyType = keyType;
+    signer->keystoreName = NULL;
+    signer->secretKey = NULL;
+    signer->signer = NULL;
+    signer->keyId = NULL;
+    signer->failures = 0;
+    ccnxPingHistogram_Init(&signer->signatureTime);
+
+    return signer;
+}
+
+CCNxPingSigner *
+ccnxPingSigner_Create(const char *keyTypeName)
+{
+    const _CCNxPingSignerKeyType *keyType = _ccnxPingSigner_KeyTypes;
+    while (keyType->name != NULL && strcmp(keyType->name, keyTypeName) != 0) {
+        keyType++;
+    }
+    if (keyType->name == NULL) {
+        return NULL;
+    }
+
+    CCNxPingSigner *signer = _ccnxPingSigner_CreateEmpty(keyType);
+
+    if (keyType->kind == _CCNxPingSignerKind_Hmac) {
+        signer->secretKey = parcSymmetricKeyStore_CreateKey(_hmacKeyBits);
+    } else {
+        char *keystoreName = NULL;
+        asprintf(&keystoreName, "server_%s.keystore", keyType->name);
+        signer->keystoreName = parcMemory_StringDuplicate(keystoreName, strlen(keystoreName));
+        free(keystoreName);
+
+        if (!_ccnxPingSigner_CreateKeyStoreFile(keyType, signer->keystoreName)) {
+            fprintf(stderr, "Unable to create the %s keystore %s\n", keyType->name, signer->keystoreName);
+            ccnxPingSigner_Release(&signer);
+            return NULL;
+        }
+    }
+
+    if (!_ccnxPingSigner_OpenSigner(signer)) {
+        fprintf(stderr, "Unable to create a %s signer\n", keyType->name);
+        ccnxPingSigner_Release(&signer);
+    }
+
+    return signer;
+}
+
+CCNxPingSigner *
+ccnxPingSigner_Clone(const CCNxPingSigner *original)
+{
+    CCNxPingSigner *signer = _ccnxPingSigner_CreateEmpty(original->keyType);
+
+    if (original->secretKey != NULL) {
+        signer->secretKey = parcBuffer_Acquire(original->secretKey);
+    }
+    if (original->keystoreName != NULL) {
+        signer->keystoreName = parcMemory_StringDuplicate(original->keystoreName, strlen(original->keystoreName));
+    }
+
+    if (!_ccnxPingSigner_OpenSigner(signer)) {
+        ccnxPingSigner_Release(&signer);
+    }
+
+    return signer;
+}
+
+bool
+ccnxPingSigner_Sign(CCNxPingSigner *signer, CCNxContentObject *contentObject)
+{
+    uint64_t startTimeInUs = ccnxPingCommon_MonotonicTimeInUs();
+
+    // Digest what a real producer would cover: every name segment followed by the payload.
+    PARCCryptoHasher *hasher = parcSigner_GetCryptoHasher(signer->signer);
+    parcCryptoHasher_Init(hasher);
+
+    CCNxName *name = ccnxContentObject_GetName(contentObject);
+    size_t segmentCount = ccnxName_GetSegmentCount(name);
+    for (size_t i = 0; i < segmentCount; i++) {
+        parcCryptoHasher_UpdateBuffer(hasher, ccnxNameSegment_GetValue(ccnxName_GetSegment(name, i)));
+    }
+    PARCBuffer *payload = ccnxContentObject_GetPayload(contentObject);
+    if (payload != NULL) {
+        parcCryptoHasher_UpdateBuffer(hasher, payload);
+    }
+
+    PARCCryptoHash *digest = parcCryptoHasher_Finalize(hasher);
+    PARCSignature *signature = parcSigner_SignDigest(signer->signer, digest);
+    parcCryptoHash_Release(&digest);
+
+    bool result = false;
+    if (signature != NULL) {
+        result = ccnxContentObject_SetSignature(contentObject, parcKeyId_GetKeyId(signer->keyId), signature, NULL);
+        parcSignature_Release(&signature);
+    }
+
+    if (result) {
+        ccnxPingHistogram_Record(&signer->signatureTime, ccnxPingCommon_MonotonicTimeInUs() - startTimeInUs);
+    } else {
+        ccnxPingCommon_CounterAdd(signer->failures, 1);
+    }
+    return result;
+}
+
+const CCNxPingHistogram *
+ccnxPingSigner_GetSignatureTime(const CCNxPingSigner *signer)
+{
+    return &signer->signatureTime;
+}
+
+uint64_t
+ccnxPingSigner_GetFailures(const CCNxPingSigner *signer)
+{
+    return ccnxPingCommon_CounterGet(signer->failures);
+}
+
+const char *
+ccnxPingSigner_GetKeyType(const CCNxPingSigner *signer)
+{
+    return signer->keyType->name;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Signer_h
+#define ccnxPing_Signer_h
+
+#include <stdbool.h>
+
+#include <ccnx/common/ccnx_ContentObject.h>
+
+#include "ccnxPing_Histogram.h"
+
+/**
+ * Signs content objects with a selectable key type and accounts for the cost of every signature.
+ *
+ * The supported key types are `rsa1024`, `rsa2048`, `rsa4096`, `hmac` (HMAC-SHA256 with a random
+ * 256-bit key) and, when the PARC library supports it, `ecdsa` (P-256). RSA and ECDSA keys are
+ * generated into a fresh keystore file when the signer is created.
+ *
+ * A `CCNxPingSigner` is not thread-safe: use `ccnxPingSigner_Clone` to obtain one signer per thread.
+ */
+struct ccnx_ping_signer;
+typedef struct ccnx_ping_signer CCNxPingSigner;
+
+/**
+ * An upper bound on the number of supported key types, and so on the number of distinct signers a process needs.
+ */
+#define ccnxPingSigner_MaxKeyTypes 8
+
+/**
+ * Create a `CCNxPingSigner` with a newly generated key of the given type.
+ *
+ * @param [in] keyType One of `rsa1024`, `rsa2048`, `rsa4096`, `ecdsa` or `hmac`.
+ *
+ * @return A new `CCNxPingSigner`, or NULL if the key type is unknown or the key could not be created.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingSigner *signer = ccnxPingSigner_Create("rsa2048");
+ *     ccnxPingSigner_Sign(signer, contentObject);
+ *     ccnxPingSigner_Release(&signer);
+ * }
+ * @endcode
+ */
+CCNxPingSigner *ccnxPingSigner_Create(const char *keyType);
+
+/**
+ * Create an independent `CCNxPingSigner` over the same key, for use by another thread.
+ *
+ * @param [in] signer The `CCNxPingSigner` to clone.
+ *
+ * @return A new `CCNxPingSigner` with its own hasher and cost accounting.
+ */
+CCNxPingSigner *ccnxPingSigner_Clone(const CCNxPingSigner *signer);
+
+/**
+ * Increase the number of references to a `CCNxPingSigner`.
+ *
+ * @param [in] signer A pointer to a `CCNxPingSigner` instance.
+ *
+ * @return The input `CCNxPingSigner` pointer.
+ */
+CCNxPingSigner *ccnxPingSigner_Acquire(const CCNxPingSigner *signer);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] signerPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingSigner_Release(CCNxPingSigner **signerPtr);
+
+/**
+ * Sign a content object in place.
+ *
+ * The digest covers the name segments and the payload. The time taken to compute the digest and
+ * the signature is recorded in the signer's cost histogram.
+ *
+ * @param [in] signer The `CCNxPingSigner` instance.
+ * @param [in,out] contentObject The `CCNxContentObject` to sign.
+ *
+ * @retval true If the content object was signed.
+ * @retval false Otherwise
+ */
+bool ccnxPingSigner_Sign(CCNxPingSigner *signer, CCNxContentObject *contentObject);
+
+/**
+ * Return the histogram of signing times (in microseconds). It may be read by other threads with
+ * `ccnxPingHistogram_Snapshot`.
+ *
+ * @param [in] signer The `CCNxPingSigner` instance.
+ *
+ * @return The signer's cost histogram.
+ */
+const CCNxPingHistogram *ccnxPingSigner_GetSignatureTime(const CCNxPingSigner *signer);
+
+/**
+ * @return The number of content objects that could not be signed.
+ */
+uint64_t ccnxPingSigner_GetFailures(const CCNxPingSigner *signer);
+
+/**
+ * @return The name of the key type of the signer (e.g., `rsa2048`).
+ */
+const char *ccnxPingSigner_GetKeyType(const CCNxPingSigner *signer);
+#endif // ccnxPing_Signer_h
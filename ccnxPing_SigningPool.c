@@ -0,0 +1,334 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <pthread.h>
+#include <stdio.h>
+
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxPing_Common.h"
+#include "ccnxPing_SigningPool.h"
+
+typedef struct ccnx_ping_signing_job {
+    const CCNxPingSigner *signer;
+    CCNxMetaMessage *response;
+    uint64_t receiveTimeInUs;
+    uint64_t deadlineInUs;
+    bool signedOk;
+} _CCNxPingSigningJob;
+
+/**
+ * A bounded FIFO of jobs. The pool never holds more than `capacity` jobs in total, so neither queue can overflow.
+ */
+typedef struct ccnx_ping_signing_queue {
+    _CCNxPingSigningJob *jobs;
+    size_t head;
+    size_t count;
+} _CCNxPingSigningQueue;
+
+/**
+ * A worker clones each signer it is given on first use. Clones are only added, and `cloneCount`
+ * is published last, so that other threads can read the cost histograms of the clones.
+ */
+typedef struct ccnx_ping_signing_worker {
+    struct ccnx_ping_signing_pool *pool;
+    pthread_t thread;
+    size_t cloneCount;
+    const CCNxPingSigner *originals[ccnxPingSigner_MaxKeyTypes];
+    CCNxPingSigner *clones[ccnxPingSigner_MaxKeyTypes];
+} _CCNxPingSigningWorker;
+
+struct ccnx_ping_signing_pool {
+    size_t capacity;
+    size_t inFlight;
+
+    pthread_mutex_t lock;
+    pthread_cond_t workAvailable;
+    bool stopping;
+    _CCNxPingSigningQueue pending;
+    _CCNxPingSigningQueue completed;
+
+    size_t workerCount;
+    _CCNxPingSigningWorker *workers;
+};
+
+static void
+_ccnxPingSigningQueue_Push(_CCNxPingSigningQueue *queue, size_t capacity, const _CCNxPingSigningJob *job)
+{
+    queue->jobs[(queue->head + queue->count) % capacity] = *job;
+    queue->count++;
+}
+
+static _CCNxPingSigningJob
+_ccnxPingSigningQueue_Pop(_CCNxPingSigningQueue *queue, size_t capacity)
+{
+    _CCNxPingSigningJob job = queue->jobs[queue->head];
+    queue->head = (queue->head + 1) % capacity;
+    queue->count--;
+    return job;
+}
+
+/**
+ * Return the worker's clone of `signer`, creating it if needed.
+ *
+ * @return The clone, or NULL if it could not be created.
+ */
+static CCNxPingSigner *
+_ccnxPingSigningPool_GetClone(_CCNxPingSigningWorker *worker, const CCNxPingSigner *signer)
+{
+    for (size_t i = 0; i < worker->cloneCount; i++) {
+        if (worker->originals[i] == signer) {
+            return worker->clones[i];
+        }
+    }
+    if (worker->cloneCount == ccnxPingSigner_MaxKeyTypes) {
+        return NULL;
+    }
+
+    CCNxPingSigner *clone = ccnxPingSigner_Clone(signer);
+    if (clone != NULL) {
+        worker->originals[worker->cloneCount] = signer;
+        worker->clones[worker->cloneCount] = clone;
+        __atomic_store_n(&worker->cloneCount, worker->cloneCount + 1, __ATOMIC_RELEASE);
+    }
+    return clone;
+}
+
+static void *
+_ccnxPingSigningPool_Worker(void *arg)
+{
+    _CCNxPingSigningWorker *worker = arg;
+    CCNxPingSigningPool *pool = worker->pool;
+
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (pool->pending.count == 0 && !pool->stopping) {
+            pthread_cond_wait(&pool->workAvailable, &pool->lock);
+        }
+        if (pool->stopping) {
+            break;
+        }
+
+        _CCNxPingSigningJob job = _ccnxPingSigningQueue_Pop(&pool->pending, pool->capacity);
+        pthread_mutex_unlock(&pool->lock);
+
+        CCNxPingSigner *signer = _ccnxPingSigningPool_GetClone(worker, job.signer);
+        if (signer != NULL) {
+            job.signedOk = ccnxPingSigner_Sign(signer, ccnxMetaMessage_GetContentObject(job.response));
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        _ccnxPingSigningQueue_Push(&pool->completed, pool->capacity, &job);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+static bool
+_ccnxPingSigningPool_Destructor(CCNxPingSigningPool **poolPtr)
+{
+    CCNxPingSigningPool *pool = *poolPtr;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->workAvailable);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t i = 0; i < pool->workerCount; i++) {
+        _CCNxPingSigningWorker *worker = &pool->workers[i];
+        pthread_join(worker->thread, NULL);
+        for (size_t j = 0; j < worker->cloneCount; j++) {
+            ccnxPingSigner_Release(&worker->clones[j]);
+        }
+    }
+
+    while (pool->pending.count > 0) {
+        _CCNxPingSigningJob job = _ccnxPingSigningQueue_Pop(&pool->pending, pool->capacity);
+        ccnxMetaMessage_Release(&job.response);
+    }
+    while (pool->completed.count > 0) {
+        _CCNxPingSigningJob job = _ccnxPingSigningQueue_Pop(&pool->completed, pool->capacity);
+        ccnxMetaMessage_Release(&job.response);
+    }
+
+    pthread_cond_destroy(&pool->workAvailable);
+    pthread_mutex_destroy(&pool->lock);
+    parcMemory_Deallocate(&pool->pending.jobs);
+    parcMemory_Deallocate(&pool->completed.jobs);
+    parcMemory_Deallocate(&pool->workers);
+    return true;
+}
+
+parcObject_Override(CCNxPingSigningPool, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingSigningPool_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingSigningPool, CCNxPingSigningPool);
+parcObject_ImplementRelease(ccnxPingSigningPool, CCNxPingSigningPool);
+
+CCNxPingSigningPool *
+ccnxPingSigningPool_Create(size_t threadCount, size_t queueCapacity)
+{
+    CCNxPingSigningPool *pool = parcObject_CreateInstance(CCNxPingSigningPool);
+
+    pool->capacity = queueCapacity > 0 ? queueCapacity : 1;
+    pool->inFlight = 0;
+    pool->stopping = false;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->workAvailable, NULL);
+
+    pool->pending.jobs = parcMemory_Allocate(pool->capacity * sizeof(_CCNxPingSigningJob));
+    pool->pending.head = 0;
+    pool->pending.count = 0;
+    pool->completed.jobs = parcMemory_Allocate(pool->capacity * sizeof(_CCNxPingSigningJob));
+    pool->completed.head = 0;
+    pool->completed.count = 0;
+
+    pool->workerCount = 0;
+    pool->workers = parcMemory_AllocateAndClear(threadCount * sizeof(_CCNxPingSigningWorker));
+    for (size_t i = 0; i < threadCount; i++) {
+        _CCNxPingSigningWorker *worker = &pool->workers[pool->workerCount];
+        worker->pool = pool;
+        worker->cloneCount = 0;
+        if (pthread_create(&worker->thread, NULL, _ccnxPingSigningPool_Worker, worker) != 0) {
+            fprintf(stderr, "Unable to start signing worker %zu\n", i);
+            break;
+        }
+        pool->workerCount++;
+    }
+
+    return pool;
+}
+
+bool
+ccnxPingSigningPool_Submit(CCNxPingSigningPool *pool, const CCNxPingSigner *signer, CCNxMetaMessage *response, uint64_t receiveTimeInUs, uint64_t deadlineInUs)
+{
+    if (pool->inFlight >= pool->capacity || pool->workerCount == 0) {
+        return false;
+    }
+
+    _CCNxPingSigningJob job = {
+        .signer          = signer,
+        .response        = response,
+        .receiveTimeInUs = receiveTimeInUs,
+        .deadlineInUs    = deadlineInUs,
+        .signedOk        = false
+    };
+
+    pthread_mutex_lock(&pool->lock);
+    _ccnxPingSigningQueue_Push(&pool->pending, pool->capacity, &job);
+    pthread_cond_signal(&pool->workAvailable);
+    pthread_mutex_unlock(&pool->lock);
+
+    pool->inFlight++;
+    return true;
+}
+
+size_t
+ccnxPingSigningPool_Complete(CCNxPingSigningPool *pool, CCNxPingSigningPoolCallback *callback, void *context)
+{
+    size_t completed = 0;
+
+    while (true) {
+        pthread_mutex_lock(&pool->lock);
+        if (pool->completed.count == 0) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        _CCNxPingSigningJob job = _ccnxPingSigningQueue_Pop(&pool->completed, pool->capacity);
+        pthread_mutex_unlock(&pool->lock);
+
+        pool->inFlight--;
+        completed++;
+        callback(context, job.response, job.receiveTimeInUs, job.deadlineInUs, job.signedOk);
+    }
+
+    return completed;
+}
+
+size_t
+ccnxPingSigningPool_InFlight(const CCNxPingSigningPool *pool)
+{
+    return pool->inFlight;
+}
+
+void
+ccnxPingSigningPool_MergeSignatureTime(const CCNxPingSigningPool *pool, CCNxPingHistogram *result)
+{
+    CCNxPingHistogram snapshot;
+    for (size_t i = 0; i < pool->workerCount; i++) {
+        const _CCNxPingSigningWorker *worker = &pool->workers[i];
+        size_t cloneCount = __atomic_load_n(&worker->cloneCount, __ATOMIC_ACQUIRE);
+        for (size_t j = 0; j < cloneCount; j++) {
+            ccnxPingHistogram_Snapshot(&snapshot, ccnxPingSigner_GetSignatureTime(worker->clones[j]));
+            ccnxPingHistogram_Merge(result, &snapshot);
+        }
+    }
+}
+
+size_t
+ccnxPingSigningPool_GetThreadCount(const CCNxPingSigningPool *pool)
+{
+    return pool->workerCount;
+}
+
+pthread_t
+ccnxPingSigningPool_GetThread(const CCNxPingSigningPool *pool, size_t index)
+{
+    return pool->workers[index].thread;
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_SigningPool_h
+#define ccnxPing_SigningPool_h
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <ccnx/transport/common/transport_MetaMessage.h>
+
+#include "ccnxPing_Histogram.h"
+#include "ccnxPing_Signer.h"
+
+/**
+ * A pool of worker threads that sign responses in parallel, so that signing throughput scales with cores.
+ *
+ * The owning loop submits unsigned responses and later collects the signed ones with
+ * `ccnxPingSigningPool_Complete`; the workers never touch the portal. Each worker signs with its own
+ * clone of the signer given with each response, so no lock is held while signing.
+ */
+struct ccnx_ping_signing_pool;
+typedef struct ccnx_ping_signing_pool CCNxPingSigningPool;
+
+/**
+ * The callback invoked by `ccnxPingSigningPool_Complete` for each finished response.
+ *
+ * @param [in] context The context given to `ccnxPingSigningPool_Complete`.
+ * @param [in] response The response; ownership passes to the callback.
+ * @param [in] receiveTimeInUs The receive time given to `ccnxPingSigningPool_Submit`.
+ * @param [in] deadlineInUs The deadline given to `ccnxPingSigningPool_Submit`.
+ * @param [in] signedOk Whether the response was signed successfully.
+ */
+typedef void (CCNxPingSigningPoolCallback)(void *context, CCNxMetaMessage *response, uint64_t receiveTimeInUs,
+                                           uint64_t deadlineInUs, bool signedOk);
+
+/**
+ * Create a `CCNxPingSigningPool` and start its workers.
+ *
+ * @param [in] threadCount The number of worker threads.
+ * @param [in] queueCapacity The maximum number of responses in flight.
+ *
+ * @return A new `CCNxPingSigningPool` that must be released with `ccnxPingSigningPool_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingSigningPool *pool = ccnxPingSigningPool_Create(4, 1024);
+ *     ccnxPingSigningPool_Submit(pool, signer, response, receiveTime, deadline);
+ *     ...
+ *     ccnxPingSigningPool_Complete(pool, _sendSignedResponse, server);
+ *     ccnxPingSigningPool_Release(&pool);
+ * }
+ * @endcode
+ */
+CCNxPingSigningPool *ccnxPingSigningPool_Create(size_t threadCount, size_t queueCapacity);
+
+/**
+ * Increase the number of references to a `CCNxPingSigningPool`.
+ *
+ * @param [in] pool A pointer to a `CCNxPingSigningPool` instance.
+ *
+ * @return The input `CCNxPingSigningPool` pointer.
+ */
+CCNxPingSigningPool *ccnxPingSigningPool_Acquire(const CCNxPingSigningPool *pool);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * The last release stops the workers and discards any response still in flight.
+ *
+ * @param [in,out] poolPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingSigningPool_Release(CCNxPingSigningPool **poolPtr);
+
+/**
+ * Queue a response for signing.
+ *
+ * @param [in] pool The `CCNxPingSigningPool` instance.
+ * @param [in] signer The signer whose key signs the response. Each worker signs with its own clone of it,
+ *                    so it must outlive the pool and at most `ccnxPingSigner_MaxKeyTypes` distinct signers may be used.
+ * @param [in] response The response to sign. On success the pool takes over this reference.
+ * @param [in] receiveTimeInUs Passed back to the completion callback.
+ * @param [in] deadlineInUs Passed back to the completion callback.
+ *
+ * @retval true If the response was queued.
+ * @retval false If the pool already holds `queueCapacity` responses; the caller keeps the reference.
+ */
+bool ccnxPingSigningPool_Submit(CCNxPingSigningPool *pool, const CCNxPingSigner *signer, CCNxMetaMessage *response, uint64_t receiveTimeInUs, uint64_t deadlineInUs);
+
+/**
+ * Invoke `callback` for every response that has been signed since the last call. Never blocks.
+ *
+ * @param [in] pool The `CCNxPingSigningPool` instance.
+ * @param [in] callback The function to invoke for each finished response.
+ * @param [in] context The context passed to `callback`.
+ *
+ * @return The number of responses passed to `callback`.
+ */
+size_t ccnxPingSigningPool_Complete(CCNxPingSigningPool *pool, CCNxPingSigningPoolCallback *callback, void *context);
+
+/**
+ * @return The number of responses submitted but not yet collected by `ccnxPingSigningPool_Complete`.
+ */
+size_t ccnxPingSigningPool_InFlight(const CCNxPingSigningPool *pool);
+
+/**
+ * Merge the signing-time histograms of all workers into `result`. Safe to call from any thread.
+ *
+ * @param [in] pool The `CCNxPingSigningPool` instance.
+ * @param [in,out] result The histogram to accumulate into.
+ */
+void ccnxPingSigningPool_MergeSignatureTime(const CCNxPingSigningPool *pool, CCNxPingHistogram *result);
+
+/**
+ * @return The number of worker threads of the pool.
+ */
+size_t ccnxPingSigningPool_GetThreadCount(const CCNxPingSigningPool *pool);
+
+/**
+ * Return a worker thread of the pool, for example to set its affinity.
+ *
+ * @param [in] pool The `CCNxPingSigningPool` instance.
+ * @param [in] index The index of the worker, less than `ccnxPingSigningPool_GetThreadCount`.
+ *
+ * @return The thread of the worker.
+ */
+pthread_t ccnxPingSigningPool_GetThread(const CCNxPingSigningPool *pool, size_t index);
+#endif // ccnxPing_SigningPool_h
@@ -57,32 +57,121 @@
  * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
  */
 #include <stdio.h>
+#include <string.h>
 
 #include <ccnx/common/ccnx_Name.h>
 #include <ccnx/transport/common/transport_MetaMessage.h>
 
 #include <parc/algol/parc_HashMap.h>
+#include <parc/algol/parc_Memory.h>
 #include <parc/algol/parc_Object.h>
 #include <parc/algol/parc_DisplayIndented.h>
 
+#include "ccnxPing_Common.h"
+#include "ccnxPing_Histogram.h"
+#include "ccnxPing_Sequence.h"
 #include "ccnxPing_Stats.h"
+#include "ccnxPing_Timestamp.h"
+
+/**
+ * At the histogram level, the number of most recent send times kept, indexed by sequence number.
+ */
+#define _sendTimeSlots 65536
 
 typedef struct ping_stats_entry {
     uint64_t sendTimeInUs;
     uint64_t receivedTimeInUs;
     uint64_t rtt;
+    uint64_t sequence;
     size_t size;
     CCNxName *nameSent;
     CCNxMetaMessage *message;
 } CCNxPingStatsEntry;
 
+/**
+ * The send time of one ping at the histogram level. `sequence` is offset by one so that 0 marks an empty slot.
+ */
+typedef struct ping_stats_slot {
+    uint64_t sequence;
+    uint64_t sendTimeInUs;
+    bool received;
+} CCNxPingStatsSlot;
+
+static const char *_ccnxPingStats_LevelNames[] = { "counters", "histogram", "trace" };
+
 struct ping_stats {
+    CCNxPingStatsLevel level;
+
     uint64_t totalRtt;
     size_t totalReceived;
     size_t totalSent;
+    uint64_t totalBytesReceived;
+
+    uint64_t firstRequestTimeInUs;
+    uint64_t lastResponseTimeInUs;
+    CCNxPingHistogram rtt;
+    CCNxPingSequence sequence;
+
+    // When set, the caller matches the responses to their requests and supplies their RTTs,
+    // and the sequence numbers are not analysed.
+    bool externalMatching;
+
+    // The histogram level: the recent send times.
+    CCNxPingStatsSlot *slots;
+
+    // The trace level: every ping, by name and in the order sent.
     PARCHashMap *pings;
+    CCNxPingStatsEntry **trace;
+    size_t traceCapacity;
+
+    bool hasResourceUsage;
+    CCNxPingResourceUsage resourceUsage;
+
+    // When set, the pings are also counted in the cells of this breakdown.
+    CCNxPingBreakdown *breakdown;
+    size_t breakdownPhase;
+
+    // Created by the first response that carries a server timestamp header.
+    CCNxPingTimestampLegs *legs;
 };
 
+/**
+ * The level of a `CCNxPingStats`: a constant when it is fixed at build time, so that the dispatch
+ * in the record functions folds away.
+ */
+static inline CCNxPingStatsLevel
+_ccnxPingStats_Level(const CCNxPingStats *stats)
+{
+#ifdef CCNX_PING_STATS_LEVEL
+    return CCNX_PING_STATS_LEVEL;
+#else
+    return stats->level;
+#endif
+}
+
+bool
+ccnxPingStatsLevel_Parse(const char *name, CCNxPingStatsLevel *level)
+{
+    for (int i = CCNxPingStatsLevel_Counters; i <= CCNxPingStatsLevel_Trace; i++) {
+        if (strcmp(name, _ccnxPingStats_LevelNames[i]) == 0) {
+#ifdef CCNX_PING_STATS_LEVEL
+            if (i != CCNX_PING_STATS_LEVEL) {
+                return false;
+            }
+#endif
+            *level = (CCNxPingStatsLevel) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *
+ccnxPingStatsLevel_GetName(CCNxPingStatsLevel level)
+{
+    return _ccnxPingStats_LevelNames[level];
+}
+
 static bool
 _ccnxPingStatsEntry_Destructor(CCNxPingStatsEntry **statsPtr)
 {
@@ -94,14 +183,6 @@ _ccnxPingStatsEntry_Destructor(CCNxPingStatsEntry **statsPtr)
     return true;
 }
 
-static bool
-_ccnxPingStats_Destructor(CCNxPingStats **statsPtr)
-{
-    CCNxPingStats *stats = *statsPtr;
-    parcHashMap_Release(&stats->pings);
-    return true;
-}
-
 parcObject_Override(CCNxPingStatsEntry, PARCObject,
                     .destructor = (PARCObjectDestructor *) _ccnxPingStatsEntry_Destructor);
 
@@ -114,6 +195,31 @@ ccnxPingStatsEntry_Create()
     return parcObject_CreateInstance(CCNxPingStatsEntry);
 }
 
+static bool
+_ccnxPingStats_Destructor(CCNxPingStats **statsPtr)
+{
+    CCNxPingStats *stats = *statsPtr;
+    if (stats->pings != NULL) {
+        parcHashMap_Release(&stats->pings);
+    }
+    if (stats->trace != NULL) {
+        for (size_t i = 0; i < stats->totalSent; i++) {
+            ccnxPingStatsEntry_Release(&stats->trace[i]);
+        }
+        parcMemory_Deallocate(&stats->trace);
+    }
+    if (stats->slots != NULL) {
+        parcMemory_Deallocate(&stats->slots);
+    }
+    if (stats->breakdown != NULL) {
+        ccnxPingBreakdown_Release(&stats->breakdown);
+    }
+    if (stats->legs != NULL) {
+        parcMemory_Deallocate(&stats->legs);
+    }
+    return true;
+}
+
 parcObject_Override(CCNxPingStats, PARCObject,
                     .destructor = (PARCObjectDestructor *) _ccnxPingStats_Destructor);
 
@@ -121,48 +227,194 @@ parcObject_ImplementAcquire(ccnxPingStats, CCNxPingStats);
 parcObject_ImplementRelease(ccnxPingStats, CCNxPingStats);
 
 CCNxPingStats *
-ccnxPingStats_Create(void)
+ccnxPingStats_Create(CCNxPingStatsLevel level)
 {
     CCNxPingStats *stats = parcObject_CreateInstance(CCNxPingStats);
 
-    stats->pings = parcHashMap_Create();
+#ifdef CCNX_PING_STATS_LEVEL
+    stats->level = CCNX_PING_STATS_LEVEL;
+#else
+    stats->level = level;
+#endif
+    stats->pings = NULL;
+    stats->trace = NULL;
+    stats->traceCapacity = 0;
+    stats->slots = NULL;
+    if (stats->level == CCNxPingStatsLevel_Histogram) {
+        stats->slots = parcMemory_AllocateAndClear(_sendTimeSlots * sizeof(CCNxPingStatsSlot));
+    } else if (stats->level == CCNxPingStatsLevel_Trace) {
+        stats->pings = parcHashMap_Create();
+    }
+
     stats->totalSent = 0;
     stats->totalReceived = 0;
     stats->totalRtt = 0;
+    stats->totalBytesReceived = 0;
+    stats->hasResourceUsage = false;
+    stats->externalMatching = false;
+    stats->breakdown = NULL;
+    stats->breakdownPhase = 0;
+    stats->legs = NULL;
+    stats->firstRequestTimeInUs = 0;
+    stats->lastResponseTimeInUs = 0;
+    ccnxPingHistogram_Init(&stats->rtt);
+    ccnxPingSequence_Init(&stats->sequence);
 
     return stats;
 }
 
-void
-ccnxPingStats_RecordRequest(CCNxPingStats *stats, CCNxName *name, uint64_t currentTime)
+CCNxPingStatsLevel
+ccnxPingStats_GetLevel(const CCNxPingStats *stats)
+{
+    return _ccnxPingStats_Level(stats);
+}
+
+static void
+_ccnxPingStats_RecordRequestSlot(CCNxPingStats *stats, const CCNxName *name, uint64_t currentTime)
+{
+    uint64_t sequenceNumber;
+    if (ccnxPingCommon_GetSequenceNumber(name, &sequenceNumber)) {
+        CCNxPingStatsSlot *slot = &stats->slots[sequenceNumber % _sendTimeSlots];
+        slot->sequence = sequenceNumber + 1;
+        slot->sendTimeInUs = currentTime;
+        slot->received = false;
+    }
+}
+
+static void
+_ccnxPingStats_RecordRequestEntry(CCNxPingStats *stats, CCNxName *name, uint64_t currentTime)
 {
     CCNxPingStatsEntry *entry = ccnxPingStatsEntry_Create();
 
     entry->nameSent = ccnxName_Acquire(name);
     entry->message = NULL;
     entry->sendTimeInUs = currentTime;
+    entry->receivedTimeInUs = 0;
+    entry->rtt = 0;
+    entry->size = 0;
+    if (!ccnxPingCommon_GetSequenceNumber(name, &entry->sequence)) {
+        entry->sequence = 0;
+    }
+
+    parcHashMap_Put(stats->pings, name, entry);
+
+    // The trace keeps the entry (the map holds its own reference) in the order sent.
+    if (stats->totalSent == stats->traceCapacity) {
+        size_t capacity = stats->traceCapacity > 0 ? stats->traceCapacity * 2 : 1024;
+        CCNxPingStatsEntry **trace = parcMemory_AllocateAndClear(capacity * sizeof(CCNxPingStatsEntry *));
+        if (stats->trace != NULL) {
+            memcpy(trace, stats->trace, stats->totalSent * sizeof(CCNxPingStatsEntry *));
+            parcMemory_Deallocate(&stats->trace);
+        }
+        stats->trace = trace;
+        stats->traceCapacity = capacity;
+    }
+    stats->trace[stats->totalSent] = entry;
+}
+
+void
+ccnxPingStats_RecordRequest(CCNxPingStats *stats, CCNxName *name, uint64_t currentTime)
+{
+    switch (_ccnxPingStats_Level(stats)) {
+        case CCNxPingStatsLevel_Counters:
+            break;
+        case CCNxPingStatsLevel_Histogram:
+            if (!stats->externalMatching) {
+                _ccnxPingStats_RecordRequestSlot(stats, name, currentTime);
+            }
+            break;
+        case CCNxPingStatsLevel_Trace:
+            _ccnxPingStats_RecordRequestEntry(stats, name, currentTime);
+            break;
+    }
+    if (stats->breakdown != NULL) {
+        ccnxPingBreakdown_RecordRequest(stats->breakdown, stats->breakdownPhase, name);
+    }
 
+    if (stats->totalSent == 0) {
+        stats->firstRequestTimeInUs = currentTime;
+    }
     stats->totalSent++;
+}
 
-    parcHashMap_Put(stats->pings, name, entry);
+/**
+ * Account for a distinct response and its round-trip time.
+ *
+ * @return The size of its payload.
+ */
+static size_t
+_ccnxPingStats_AccountResponse(CCNxPingStats *stats, const CCNxName *name, uint64_t rtt, uint64_t currentTime, CCNxMetaMessage *message)
+{
+    stats->totalReceived++;
+    stats->totalRtt += rtt;
+    stats->lastResponseTimeInUs = currentTime;
+    ccnxPingHistogram_Record(&stats->rtt, rtt);
+    if (stats->breakdown != NULL) {
+        ccnxPingBreakdown_RecordResponse(stats->breakdown, stats->breakdownPhase, name, rtt);
+    }
+
+    CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(message);
+    PARCBuffer *payload = ccnxContentObject_GetPayload(contentObject);
+    size_t size = parcBuffer_Remaining(payload);
+    stats->totalBytesReceived += size;
+
+    CCNxPingTimestamp timestamp;
+    if (ccnxPingTimestamp_Read(payload, &timestamp)) {
+        if (stats->legs == NULL) {
+            stats->legs = parcMemory_Allocate(sizeof(CCNxPingTimestampLegs));
+            ccnxPingTimestampLegs_Init(stats->legs);
+        }
+        ccnxPingTimestampLegs_Record(stats->legs, currentTime - rtt, currentTime, &timestamp);
+    }
+    return size;
 }
 
-size_t
-ccnxPingStats_RecordResponse(CCNxPingStats *stats, CCNxName *nameResponse, uint64_t currentTime, CCNxMetaMessage *message)
+static size_t
+_ccnxPingStats_RecordResponseSlot(CCNxPingStats *stats, const CCNxName *nameResponse, uint64_t currentTime, CCNxMetaMessage *message)
+{
+    uint64_t sequenceNumber;
+    if (!ccnxPingCommon_GetSequenceNumber(nameResponse, &sequenceNumber)) {
+        return 0;
+    }
+    CCNxPingStatsSlot *slot = &stats->slots[sequenceNumber % _sendTimeSlots];
+    if (slot->sequence != sequenceNumber + 1 || slot->received) {
+        // Unknown, a duplicate, or sent so long ago that its slot has been reused.
+        return 0;
+    }
+
+    CCNxPingSequenceArrival arrival = ccnxPingSequence_Record(&stats->sequence, sequenceNumber, slot->sendTimeInUs, currentTime);
+    if (arrival == CCNxPingSequenceArrival_Duplicate) {
+        return 0;
+    }
+    slot->received = true;
+
+    uint64_t rtt = currentTime - slot->sendTimeInUs;
+    _ccnxPingStats_AccountResponse(stats, nameResponse, rtt, currentTime, message);
+    return rtt;
+}
+
+static size_t
+_ccnxPingStats_RecordResponseEntry(CCNxPingStats *stats, CCNxName *nameResponse, uint64_t currentTime, CCNxMetaMessage *message)
 {
-    size_t pingsReceived = stats->totalReceived + 1;
     CCNxPingStatsEntry *entry = (CCNxPingStatsEntry *) parcHashMap_Get(stats->pings, nameResponse);
 
     if (entry != NULL) {
-        stats->totalReceived++;
+        uint64_t sequenceNumber;
+        if (ccnxPingCommon_GetSequenceNumber(nameResponse, &sequenceNumber)) {
+            CCNxPingSequenceArrival arrival =
+                ccnxPingSequence_Record(&stats->sequence, sequenceNumber, entry->sendTimeInUs, currentTime);
+            if (arrival == CCNxPingSequenceArrival_Duplicate) {
+                return 0;
+            }
+        }
+        if (entry->receivedTimeInUs != 0) {
+            // A duplicate of a response that has already slid out of the sequence window.
+            return 0;
+        }
 
         entry->receivedTimeInUs = currentTime;
         entry->rtt = entry->receivedTimeInUs - entry->sendTimeInUs;
-        stats->totalRtt += entry->rtt;
-
-        CCNxContentObject *contentObject = ccnxMetaMessage_GetContentObject(message);
-        PARCBuffer *payload = ccnxContentObject_GetPayload(contentObject);
-        entry->size = parcBuffer_Remaining(payload);
+        entry->size = _ccnxPingStats_AccountResponse(stats, nameResponse, entry->rtt, currentTime, message);
 
         return entry->rtt;
     }
@@ -170,13 +422,159 @@ ccnxPingStats_RecordResponse(CCNxPingStats *stats, CCNxName *nameResponse, uint6
     return 0;
 }
 
+size_t
+ccnxPingStats_RecordResponse(CCNxPingStats *stats, CCNxName *nameResponse, uint64_t currentTime, CCNxMetaMessage *message)
+{
+    switch (_ccnxPingStats_Level(stats)) {
+        case CCNxPingStatsLevel_Counters:
+            stats->totalReceived++;
+            stats->lastResponseTimeInUs = currentTime;
+            return 0;
+        case CCNxPingStatsLevel_Histogram:
+            return _ccnxPingStats_RecordResponseSlot(stats, nameResponse, currentTime, message);
+        case CCNxPingStatsLevel_Trace:
+            return _ccnxPingStats_RecordResponseEntry(stats, nameResponse, currentTime, message);
+    }
+    return 0;
+}
+
+size_t
+ccnxPingStats_RecordMatchedResponse(CCNxPingStats *stats, CCNxName *nameResponse, uint64_t rtt, uint64_t currentTime,
+                                    CCNxMetaMessage *message)
+{
+    CCNxPingStatsEntry *entry;
+    switch (_ccnxPingStats_Level(stats)) {
+        case CCNxPingStatsLevel_Counters:
+            stats->totalReceived++;
+            stats->lastResponseTimeInUs = currentTime;
+            return 0;
+        case CCNxPingStatsLevel_Histogram:
+            _ccnxPingStats_AccountResponse(stats, nameResponse, rtt, currentTime, message);
+            return rtt;
+        case CCNxPingStatsLevel_Trace:
+            entry = (CCNxPingStatsEntry *) parcHashMap_Get(stats->pings, nameResponse);
+            if (entry == NULL || entry->receivedTimeInUs != 0) {
+                return 0;
+            }
+            entry->receivedTimeInUs = currentTime;
+            entry->rtt = rtt;
+            entry->size = _ccnxPingStats_AccountResponse(stats, nameResponse, rtt, currentTime, message);
+            return rtt;
+    }
+    return 0;
+}
+
+size_t
+ccnxPingStats_GetReceivedCount(const CCNxPingStats *stats)
+{
+    return stats->totalReceived;
+}
+
+const CCNxPingHistogram *
+ccnxPingStats_GetRtt(const CCNxPingStats *stats)
+{
+    return &stats->rtt;
+}
+
+void
+ccnxPingStats_SetResourceUsage(CCNxPingStats *stats, const CCNxPingResourceUsage *usage)
+{
+    stats->resourceUsage = *usage;
+    stats->hasResourceUsage = true;
+}
+
+void
+ccnxPingStats_SetExternalMatching(CCNxPingStats *stats)
+{
+    stats->externalMatching = true;
+}
+
+void
+ccnxPingStats_SetBreakdown(CCNxPingStats *stats, CCNxPingBreakdown *breakdown, size_t phase)
+{
+    if (stats->breakdown != NULL) {
+        ccnxPingBreakdown_Release(&stats->breakdown);
+    }
+    stats->breakdown = ccnxPingBreakdown_Acquire(breakdown);
+    stats->breakdownPhase = phase;
+}
+
 bool
 ccnxPingStats_Display(CCNxPingStats *stats)
 {
     if (stats->totalReceived > 0) {
+        if (_ccnxPingStats_Level(stats) == CCNxPingStatsLevel_Counters) {
+            parcDisplayIndented_PrintLine(0, "Sent = %zu : Received = %zu : Round-trip times are not recorded at the counters level",
+                                          stats->totalSent, stats->totalReceived);
+            return true;
+        }
         parcDisplayIndented_PrintLine(0, "Sent = %zu : Received = %zu : AvgDelay %llu us",
                                       stats->totalSent, stats->totalReceived, stats->totalRtt / stats->totalReceived);
+        ccnxPingHistogram_Display(&stats->rtt, 0, "RTT (us)");
+        if (!stats->externalMatching) {
+            ccnxPingSequence_Display(&stats->sequence, 0);
+        }
+        if (stats->legs != NULL) {
+            ccnxPingTimestampLegs_Calibrate(stats->legs);
+            ccnxPingTimestampLegs_Display(stats->legs, 0);
+        }
+        if (stats->hasResourceUsage) {
+            ccnxPingResourceUsage_Display(&stats->resourceUsage, 0, stats->totalReceived, stats->totalBytesReceived);
+        }
         return true;
     }
     return false;
 }
+
+void
+ccnxPingStats_WriteJSON(const CCNxPingStats *stats, FILE *output)
+{
+    uint64_t durationInUs = 0;
+    if (stats->totalReceived > 0 && stats->lastResponseTimeInUs > stats->firstRequestTimeInUs) {
+        durationInUs = stats->lastResponseTimeInUs - stats->firstRequestTimeInUs;
+    }
+    double throughput = durationInUs > 0 ? stats->totalReceived * 1000000.0 / durationInUs : 0.0;
+
+    fprintf(output, "{\"level\":\"%s\",\"sent\":%zu,\"received\":%zu,\"duration_us\":%llu,\"throughput\":%.1f",
+            ccnxPingStatsLevel_GetName(_ccnxPingStats_Level(stats)), stats->totalSent, stats->totalReceived,
+            (unsigned long long) durationInUs, throughput);
+    if (_ccnxPingStats_Level(stats) != CCNxPingStatsLevel_Counters) {
+        fprintf(output, ",\"rtt_us\":");
+        ccnxPingHistogram_WriteJSON(&stats->rtt, output);
+        if (!stats->externalMatching) {
+            fprintf(output, ",");
+            ccnxPingSequence_WriteJSONMembers(&stats->sequence, output);
+        }
+        if (stats->legs != NULL) {
+            ccnxPingTimestampLegs_Calibrate(stats->legs);
+            fprintf(output, ",\"legs\":{");
+            ccnxPingTimestampLegs_WriteJSONMembers(stats->legs, output);
+            fprintf(output, "}");
+        }
+        if (stats->hasResourceUsage) {
+            fprintf(output, ",\"resources\":");
+            ccnxPingResourceUsage_WriteJSON(&stats->resourceUsage, stats->totalReceived, stats->totalBytesReceived, output);
+        }
+    }
+    fprintf(output, "}\n");
+}
+
+bool
+ccnxPingStats_WriteTrace(const CCNxPingStats *stats, FILE *output)
+{
+    if (_ccnxPingStats_Level(stats) != CCNxPingStatsLevel_Trace) {
+        return false;
+    }
+
+    fprintf(output, "# rtt_us sequence send_us size\n");
+    for (size_t i = 0; i < stats->totalSent; i++) {
+        const CCNxPingStatsEntry *entry = stats->trace[i];
+        if (entry->receivedTimeInUs != 0) {
+            fprintf(output, "%llu %llu %llu %zu\n", (unsigned long long) entry->rtt, (unsigned long long) entry->sequence,
+                    (unsigned long long) entry->sendTimeInUs, entry->size);
+        } else {
+            fprintf(output, "- %llu %llu -\n", (unsigned long long) entry->sequence, (unsigned long long) entry->sendTimeInUs);
+        }
+    }
+    return true;
+}
@@ -59,6 +59,70 @@
 #ifndef ccnxPing_Stats_h
 #define ccnxPing_Stats_h
 
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "ccnxPing_Breakdown.h"
+#include "ccnxPing_Histogram.h"
+#include "ccnxPing_ResourceUsage.h"
+#include "ccnxPing_Timestamp.h"
+
+/**
+ * How much a `CCNxPingStats` records for each ping, and so what each ping costs.
+ *
+ * - `Counters` counts requests and responses, and the time from the first request to the last
+ *   response: a few additions and no memory access beyond the stats themselves. There are no
+ *   round-trip times, and duplicate responses are counted as responses.
+ * - `Histogram` also keeps the send times of the last 65536 pings in a table indexed by their
+ *   sequence number, parsed from the name. The round-trip times go to the histogram and the
+ *   sequence analysis (see `CCNxPingSequence`). It does not allocate per ping, but a response to
+ *   a ping sent more than 65536 pings earlier is not matched.
+ * - `Trace` keeps an entry per ping, indexed by name in a hash map, for the whole run. It
+ *   allocates and takes references per ping, and its table grows with the run. The entries can
+ *   be written as a per-ping trace with `ccnxPingStats_WriteTrace`.
+ *
+ * The cost of a ping thus rises from level to level, and only that of `Trace` grows with the run as
+ * its map and entries outgrow the caches. Run `ccnxPing_Bench stats/Ping` to measure the cost of a
+ * request and its response at each level on the target machine, with the real CCNx and PARC libraries.
+ *
+ * Since `Counters` keeps no per-ping state, it cannot tell a duplicate response from a new one, nor
+ * which ping a response answers. The client rejects it with --ping, --scenario and the other modes
+ * that report per-ping or per-phase results.
+ *
+ * Defining `CCNX_PING_STATS_LEVEL` to one of the levels (the `CCNX_PING_STATS_LEVEL` CMake option)
+ * fixes the level at build time: the others are compiled out of the record functions.
+ */
+typedef enum {
+    CCNxPingStatsLevel_Counters = 0,
+    CCNxPingStatsLevel_Histogram = 1,
+    CCNxPingStatsLevel_Trace = 2
+} CCNxPingStatsLevel;
+
+/**
+ * The level used unless another one is selected: the level fixed at build time, if any, or `Trace`.
+ */
+#ifdef CCNX_PING_STATS_LEVEL
+#define ccnxPingStats_DefaultLevel CCNX_PING_STATS_LEVEL
+#else
+#define ccnxPingStats_DefaultLevel CCNxPingStatsLevel_Trace
+#endif
+
+/**
+ * Parse the name of a level: `counters`, `histogram` or `trace`.
+ *
+ * @param [in] name The name of the level.
+ * @param [out] level The level.
+ *
+ * @retval true If `name` is a level available in this build.
+ * @retval false Otherwise
+ */
+bool ccnxPingStatsLevel_Parse(const char *name, CCNxPingStatsLevel *level);
+
+/**
+ * @return The name of a level.
+ */
+const char *ccnxPingStatsLevel_GetName(CCNxPingStatsLevel level);
+
 /**
  * Structure to collect and display the performance statistics.
  */
@@ -70,16 +134,23 @@ typedef struct ping_stats CCNxPingStats;
  *
  * The returned result must be freed via {@link ccnxPingStats_Release}
  *
+ * @param [in] level What to record for each ping. It is ignored when the level is fixed at build time.
+ *
  * @return A newly allocated `CCNxPingStats`.
  *
  * Example
  * @code
  * {
- *     CCNxPingStats *stats = ccnxPingStats_Create();
+ *     CCNxPingStats *stats = ccnxPingStats_Create(ccnxPingStats_DefaultLevel);
  * }
  * @endcode
  */
-CCNxPingStats *ccnxPingStats_Create(void);
+CCNxPingStats *ccnxPingStats_Create(CCNxPingStatsLevel level);
+
+/**
+ * @return The level of the `CCNxPingStats`.
+ */
+CCNxPingStatsLevel ccnxPingStats_GetLevel(const CCNxPingStats *stats);
 
 /**
  * Increase the number of references to a `CCNxPingStats`.
@@ -95,7 +166,7 @@ CCNxPingStats *ccnxPingStats_Create(void);
  * Example:
  * @code
  * {
- *     CCNxPingStats *stats = ccnxPingStats_Create();
+ *     CCNxPingStats *stats = ccnxPingStats_Create(ccnxPingStats_DefaultLevel);
  *     CCNxPingStats *copy = ccnxPingStats_Acquire(stats);
  *     ccnxPingStats_Release(&stats);
  *     ccnxPingStats_Release(&copy);
@@ -119,7 +190,7 @@ CCNxPingStats *ccnxPingStats_Acquire(const CCNxPingStats *stats);
  * Example:
  * @code
  * {
- *     CCNxPingStats *stats = ccnxPingStats_Create();
+ *     CCNxPingStats *stats = ccnxPingStats_Create(ccnxPingStats_DefaultLevel);
  *     CCNxPingStats *copy = ccnxPingStats_Acquire(stats);
  *     ccnxPingStats_Release(&stats);
  *     ccnxPingStats_Release(&copy);
@@ -145,17 +216,116 @@ void ccnxPingStats_RecordRequest(CCNxPingStats *stats, CCNxName *name, uint64_t
  * @param [in] timeInUs The send time (in microseconds).
  * @param [in] message The response `CCNxMetaMessage`.
  *
- * @return The delta between the request and response (in microseconds).
+ * A duplicate response is counted once, as a duplicate, and does not contribute to the totals.
+ * The sequence number in the last name segment is also used to detect reordering, late
+ * arrivals and jitter (see `CCNxPingSequence`).
+ *
+ * @return The delta between the request and response (in microseconds), or 0 if the response
+ *         is unknown or a duplicate, or at the counters level.
  */
 size_t ccnxPingStats_RecordResponse(CCNxPingStats *stats, CCNxName *name, uint64_t timeInUs, CCNxMetaMessage *message);
 
+/**
+ * Record a response that the caller has already matched to its request (see `ccnxPingStats_SetExternalMatching`).
+ *
+ * @param [in] stats The `CCNxPingStats` instance.
+ * @param [in] name The `CCNxName` name structure.
+ * @param [in] rtt The round-trip time of the response (in microseconds).
+ * @param [in] timeInUs The receive time (in microseconds).
+ * @param [in] message The response `CCNxMetaMessage`.
+ *
+ * @return `rtt`, or 0 at the counters level or if the trace level does not know the request.
+ */
+size_t ccnxPingStats_RecordMatchedResponse(CCNxPingStats *stats, CCNxName *name, uint64_t rtt, uint64_t timeInUs,
+                                           CCNxMetaMessage *message);
+
+/**
+ * @return The number of distinct responses received so far.
+ */
+size_t ccnxPingStats_GetReceivedCount(const CCNxPingStats *stats);
+
+/**
+ * @return The histogram of the round-trip times (in microseconds) of the distinct responses.
+ */
+const CCNxPingHistogram *ccnxPingStats_GetRtt(const CCNxPingStats *stats);
+
+/**
+ * Attach the resources used by the run, to be reported per response and per payload byte.
+ *
+ * @param [in] stats The `CCNxPingStats` instance.
+ * @param [in] usage The usage of the process over the run.
+ */
+void ccnxPingStats_SetResourceUsage(CCNxPingStats *stats, const CCNxPingResourceUsage *usage);
+
+/**
+ * Leave the matching of the responses to the caller, which records them with `ccnxPingStats_RecordMatchedResponse`.
+ *
+ * For senders whose sequence numbers are not one ordered stream (e.g., the virtual users): the
+ * histogram level keeps no send times, and no reordering, late arrivals or jitter are reported.
+ *
+ * @param [in] stats The `CCNxPingStats` instance.
+ */
+void ccnxPingStats_SetExternalMatching(CCNxPingStats *stats);
+
+/**
+ * Also count every ping and the round-trip time of every distinct response in a `CCNxPingBreakdown`.
+ *
+ * Several `CCNxPingStats` (e.g., one per phase) may share a breakdown. It needs the histogram or the
+ * trace level: at the counters level no round-trip time is known.
+ *
+ * @param [in] stats The `CCNxPingStats` instance.
+ * @param [in] breakdown The `CCNxPingBreakdown` to record into. It is acquired.
+ * @param [in] phase The phase the pings of these statistics are counted in.
+ */
+void ccnxPingStats_SetBreakdown(CCNxPingStats *stats, CCNxPingBreakdown *breakdown, size_t phase);
+
 /**
  * Display the average statistics stored in this `CCNxPingStats` instance.
  *
+ * When the responses carried the timestamp header of a server run with --echo, their
+ * round-trip times are also split into request leg, server processing, server hold and response leg.
+ *
  * @param [in] stats The `CCNxPingStats` instance from which to draw the average data.
  *
  * @retval true If the stats were displayed correctly
  * @retval false Otherwise
  */
 bool ccnxPingStats_Display(CCNxPingStats *stats);
+
+/**
+ * Write the statistics stored in this `CCNxPingStats` instance as a single JSON object.
+ *
+ * The object holds the level, the number of requests sent and responses received, the duration from the
+ * first request to the last response, the throughput in responses per second over that duration,
+ * and the distribution of round-trip times (in microseconds) under `rtt_us`. The resource usage,
+ * if any, is under `resources` (see `ccnxPingResourceUsage_WriteJSON`). At the counters level
+ * only the counts, the duration and the throughput are written.
+ *
+ * @param [in] stats The `CCNxPingStats` instance.
+ * @param [in] output The stream to write to.
+ *
+ * Example:
+ * @code
+ * {
+ *     ccnxPingStats_WriteJSON(stats, stdout);
+ *     // {"level":"trace","sent":1000,"received":1000,"duration_us":52113,"throughput":19188.9,"rtt_us":{"count":1000,...}}
+ * }
+ * @endcode
+ */
+void ccnxPingStats_WriteJSON(const CCNxPingStats *stats, FILE *output);
+
+/**
+ * Write every ping of a trace-level `CCNxPingStats`, in the order sent, one per line.
+ *
+ * The columns are the round-trip time in microseconds (`-` if no response was received), the
+ * sequence number, the send time in microseconds and the payload size. The first column can be
+ * compared directly with `ccnxPing_Compare`.
+ *
+ * @param [in] stats The `CCNxPingStats` instance.
+ * @param [in] output The stream to write to.
+ *
+ * @retval true If the trace was written.
+ * @retval false If the stats are not at the trace level.
+ */
+bool ccnxPingStats_WriteTrace(const CCNxPingStats *stats, FILE *output);
 #endif // ccnxPing_Stats_h
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxPing_Telemetry.h"
+
+/**
+ * How long (in milliseconds) to wait for a monitoring client to name the format it wants.
+ */
+#define _requestTimeoutInMs 100
+
+struct ccnx_ping_telemetry {
+    char *socketPath;
+    int listenFd;
+    int wakeupPipe[2];
+
+    CCNxPingTelemetryWriter *writer;
+    void *context;
+
+    bool threadStarted;
+    pthread_t thread;
+};
+
+/**
+ * The write end of the wakeup pipe of the instance that owns SIGUSR1, or -1.
+ */
+static volatile sig_atomic_t _ccnxPingTelemetry_SignalFd = -1;
+
+static void
+_ccnxPingTelemetry_HandleSignal(int signalNumber)
+{
+    int savedErrno = errno;
+    int fd = _ccnxPingTelemetry_SignalFd;
+    if (fd >= 0) {
+        char command = 'd';
+        ssize_t ignored = write(fd, &command, 1);
+        (void) ignored;
+    }
+    errno = savedErrno;
+}
+
+/**
+ * Format a snapshot into memory and return it. The caller must free() the result.
+ */
+static char *
+_ccnxPingTelemetry_FormatSnapshot(CCNxPingTelemetry *telemetry, CCNxPingTelemetryFormat format, size_t *length)
+{
+    char *buffer = NULL;
+    FILE *output = open_memstream(&buffer, length);
+    if (output == NULL) {
+        return NULL;
+    }
+    telemetry->writer(telemetry->context, output, format);
+    fclose(output);
+    return buffer;
+}
+
+static void
+_ccnxPingTelemetry_ServeConnection(CCNxPingTelemetry *telemetry, int fd)
+{
+    CCNxPingTelemetryFormat format = CCNxPingTelemetryFormat_Text;
+
+    struct pollfd request = { .fd = fd, .events = POLLIN };
+    if (poll(&request, 1, _requestTimeoutInMs) > 0 && (request.revents & POLLIN)) {
+        char command[16] = { 0 };
+        ssize_t nread = recv(fd, command, sizeof(command) - 1, 0);
+        if (nread > 0 && strncmp(command, "json", 4) == 0) {
+            format = CCNxPingTelemetryFormat_JSON;
+        }
+    }
+
+    size_t length = 0;
+    char *snapshot = _ccnxPingTelemetry_FormatSnapshot(telemetry, format, &length);
+    if (snapshot != NULL) {
+        size_t written = 0;
+        while (written < length) {
+            ssize_t nwritten = send(fd, snapshot + written, length - written, MSG_NOSIGNAL);
+            if (nwritten <= 0) {
+                break;
+            }
+            written += (size_t) nwritten;
+        }
+        free(snapshot);
+    }
+}
+
+static void *
+_ccnxPingTelemetry_Thread(void *arg)
+{
+    CCNxPingTelemetry *telemetry = arg;
+
+    // This is the only thread that accepts SIGUSR1, see ccnxPingTelemetry_Create().
+    sigset_t usr1;
+    sigemptyset(&usr1);
+    sigaddset(&usr1, SIGUSR1);
+    pthread_sigmask(SIG_UNBLOCK, &usr1, NULL);
+
+    struct pollfd fds[2] = {
+        { .fd = telemetry->wakeupPipe[0], .events = POLLIN },
+        { .fd = telemetry->listenFd,      .events = POLLIN },
+    };
+    nfds_t nfds = telemetry->listenFd >= 0 ? 2 : 1;
+
+    while (true) {
+        if (poll(fds, nfds, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            char command;
+            if (read(telemetry->wakeupPipe[0], &command, 1) == 1) {
+                if (command == 'q') {
+                    break;
+                }
+                size_t length = 0;
+                char *snapshot = _ccnxPingTelemetry_FormatSnapshot(telemetry, CCNxPingTelemetryFormat_Text, &length);
+                if (snapshot != NULL) {
+                    fwrite(snapshot, 1, length, stderr);
+                    fflush(stderr);
+                    free(snapshot);
+                }
+            }
+        }
+
+        if (nfds > 1 && (fds[1].revents & POLLIN)) {
+            int fd = accept(telemetry->listenFd, NULL, NULL);
+            if (fd >= 0) {
+                _ccnxPingTelemetry_ServeConnection(telemetry, fd);
+                close(fd);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+static int
+_ccnxPingTelemetry_OpenSocket(const char *socketPath)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Telemetry socket path is too long: %s\n", socketPath);
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        fprintf(stderr, "Unable to create the telemetry socket: %s\n", strerror(errno));
+        return -1;
+    }
+
+    unlink(socketPath);
+    if (bind(fd, (struct sockaddr *) &address, sizeof(address)) < 0 || listen(fd, 8) < 0) {
+        fprintf(stderr, "Unable to listen on the telemetry socket %s: %s\n", socketPath, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static bool
+_ccnxPingTelemetry_Destructor(CCNxPingTelemetry **telemetryPtr)
+{
+    CCNxPingTelemetry *telemetry = *telemetryPtr;
+
+    if (telemetry->threadStarted) {
+        char command = 'q';
+        ssize_t ignored = write(telemetry->wakeupPipe[1], &command, 1);
+        (void) ignored;
+        pthread_join(telemetry->thread, NULL);
+    }
+
+    if (_ccnxPingTelemetry_SignalFd == telemetry->wakeupPipe[1]) {
+        _ccnxPingTelemetry_SignalFd = -1;
+    }
+
+    if (telemetry->listenFd >= 0) {
+        close(telemetry->listenFd);
+        unlink(telemetry->socketPath);
+    }
+    if (telemetry->wakeupPipe[0] >= 0) {
+        close(telemetry->wakeupPipe[0]);
+        close(telemetry->wakeupPipe[1]);
+    }
+    if (telemetry->socketPath != NULL) {
+        parcMemory_Deallocate(&telemetry->socketPath);
+    }
+    return true;
+}
+
+parcObject_Override(CCNxPingTelemetry, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingTelemetry_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingTelemetry, CCNxPingTelemetry);
+parcObject_ImplementRelease(ccnxPingTelemetry, CCNxPingTelemetry);
+
+CCNxPingTelemetry *
+ccnxPingTelemetry_Create(const char *socketPath, CCNxPingTelemetryWriter *writer, void *context)
+{
+    CCNxPingTelemetry *telemetry = parcObject_CreateInstance(CCNxPingTelemetry);
+
+    telemetry->writer = writer;
+    telemetry->context = context;
+    telemetry->socketPath = NULL;
+    telemetry->listenFd = -1;
+    telemetry->wakeupPipe[0] = -1;
+    telemetry->wakeupPipe[1] = -1;
+    telemetry->threadStarted = false;
+
+    if (socketPath != NULL) {
+        telemetry->socketPath = parcMemory_StringDuplicate(socketPath, strlen(socketPath));
+        telemetry->listenFd = _ccnxPingTelemetry_OpenSocket(socketPath);
+    }
+
+    if (pipe2(telemetry->wakeupPipe, O_CLOEXEC | O_NONBLOCK) < 0) {
+        fprintf(stderr, "Unable to create the telemetry pipe: %s\n", strerror(errno));
+        telemetry->wakeupPipe[0] = -1;
+        telemetry->wakeupPipe[1] = -1;
+        return telemetry;
+    }
+
+    // Route SIGUSR1 to the telemetry thread only, so that it never interrupts a portal call.
+    sigset_t usr1;
+    sigemptyset(&usr1);
+    sigaddset(&usr1, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &usr1, NULL);
+
+    _ccnxPingTelemetry_SignalFd = telemetry->wakeupPipe[1];
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = _ccnxPingTelemetry_HandleSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, NULL);
+
+    if (pthread_create(&telemetry->thread, NULL, _ccnxPingTelemetry_Thread, telemetry) == 0) {
+        telemetry->threadStarted = true;
+    } else {
+        fprintf(stderr, "Unable to start the telemetry thread\n");
+    }
+
+    return telemetry;
+}
+
+bool
+ccnxPingTelemetry_IsListening(const CCNxPingTelemetry *telemetry)
+{
+    return telemetry->listenFd >= 0 && telemetry->threadStarted;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Telemetry_h
+#define ccnxPing_Telemetry_h
+
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * The formats in which a telemetry snapshot can be requested.
+ */
+typedef enum {
+    CCNxPingTelemetryFormat_Text,
+    CCNxPingTelemetryFormat_JSON
+} CCNxPingTelemetryFormat;
+
+/**
+ * A callback that writes a snapshot of the owner's counters to `output` in the given format.
+ *
+ * The callback is always invoked from the telemetry thread, never concurrently with itself.
+ */
+typedef void (CCNxPingTelemetryWriter)(void *context, FILE *output, CCNxPingTelemetryFormat format);
+
+/**
+ * Serves telemetry snapshots on a local UNIX-domain socket and dumps them to stderr on SIGUSR1.
+ *
+ * A monitoring client connects to the socket, optionally writes `json` or `text` followed by
+ * a newline, and reads one snapshot until the socket is closed. All of this work happens on a
+ * background thread so the owner's hot loop only has to update its counters.
+ */
+struct ccnx_ping_telemetry;
+typedef struct ccnx_ping_telemetry CCNxPingTelemetry;
+
+/**
+ * Create a `CCNxPingTelemetry` instance and start its background thread.
+ *
+ * SIGUSR1 is blocked in the calling thread (and therefore in every thread it creates afterwards)
+ * so that only the telemetry thread is interrupted by it. Call this before creating any portal.
+ *
+ * @param [in] socketPath The path of the UNIX-domain socket to serve, or NULL to only handle SIGUSR1.
+ * @param [in] writer The callback that formats a snapshot.
+ * @param [in] context The context passed to `writer`.
+ *
+ * @return A new `CCNxPingTelemetry` instance that must be released with `ccnxPingTelemetry_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingTelemetry *telemetry = ccnxPingTelemetry_Create("/tmp/ccnxPing.sock", _writeSnapshot, server);
+ *     ...
+ *     ccnxPingTelemetry_Release(&telemetry);
+ * }
+ * @endcode
+ */
+CCNxPingTelemetry *ccnxPingTelemetry_Create(const char *socketPath, CCNxPingTelemetryWriter *writer, void *context);
+
+/**
+ * Increase the number of references to a `CCNxPingTelemetry`.
+ *
+ * @param [in] telemetry A pointer to a `CCNxPingTelemetry` instance.
+ *
+ * @return The input `CCNxPingTelemetry` pointer.
+ */
+CCNxPingTelemetry *ccnxPingTelemetry_Acquire(const CCNxPingTelemetry *telemetry);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * When the last reference is released the background thread is stopped and the socket is removed.
+ *
+ * @param [in,out] telemetryPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingTelemetry_Release(CCNxPingTelemetry **telemetryPtr);
+
+/**
+ * Report whether the UNIX-domain socket is being served.
+ *
+ * @param [in] telemetry The `CCNxPingTelemetry` instance.
+ *
+ * @retval true If the socket was created and is accepting connections.
+ * @retval false Otherwise
+ */
+bool ccnxPingTelemetry_IsListening(const CCNxPingTelemetry *telemetry);
+#endif // ccnxPing_Telemetry_h
@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include <LongBow/runtime.h>
+
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_Memory.h>
+
+#include "ccnxPing_TimerWheel.h"
+
+#define _noEntry UINT32_MAX
+#define _initialPoolCapacity 256
+
+typedef struct ccnx_ping_timer_entry {
+    uint64_t deadlineInUs;
+    uint64_t data;
+    void *item;
+    uint32_t next;
+} _CCNxPingTimerEntry;
+
+struct ccnx_ping_timer_wheel {
+    uint64_t tickInUs;
+    size_t slotCount;
+    uint64_t currentTick;
+    size_t size;
+
+    uint32_t *slots;
+    uint64_t *occupied;
+
+    _CCNxPingTimerEntry *pool;
+    uint32_t poolCapacity;
+    uint32_t freeList;
+};
+
+static bool
+_ccnxPingTimerWheel_Destructor(CCNxPingTimerWheel **wheelPtr)
+{
+    CCNxPingTimerWheel *wheel = *wheelPtr;
+    parcMemory_Deallocate(&wheel->slots);
+    parcMemory_Deallocate(&wheel->occupied);
+    parcMemory_Deallocate(&wheel->pool);
+    return true;
+}
+
+parcObject_Override(CCNxPingTimerWheel, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingTimerWheel_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingTimerWheel, CCNxPingTimerWheel);
+parcObject_ImplementRelease(ccnxPingTimerWheel, CCNxPingTimerWheel);
+
+/**
+ * Thread the entries in [from, to) onto the free list.
+ */
+static void
+_ccnxPingTimerWheel_AddToFreeList(CCNxPingTimerWheel *wheel, uint32_t from, uint32_t to)
+{
+    for (uint32_t i = to; i > from; i--) {
+        wheel->pool[i - 1].next = wheel->freeList;
+        wheel->freeList = i - 1;
+    }
+}
+
+CCNxPingTimerWheel *
+ccnxPingTimerWheel_Create(uint64_t tickInUs, size_t slotCount, uint64_t nowInUs)
+{
+    assertTrue(tickInUs > 0, "The tick must be positive");
+
+    CCNxPingTimerWheel *wheel = parcObject_CreateInstance(CCNxPingTimerWheel);
+
+    wheel->tickInUs = tickInUs;
+    wheel->slotCount = ((slotCount + 63) / 64) * 64;
+    wheel->slotCount = wheel->slotCount == 0 ? 64 : wheel->slotCount;
+    wheel->currentTick = nowInUs / tickInUs;
+    wheel->size = 0;
+
+    wheel->slots = parcMemory_Allocate(wheel->slotCount * sizeof(uint32_t));
+    for (size_t i = 0; i < wheel->slotCount; i++) {
+        wheel->slots[i] = _noEntry;
+    }
+    wheel->occupied = parcMemory_AllocateAndClear(wheel->slotCount / 64 * sizeof(uint64_t));
+
+    wheel->poolCapacity = _initialPoolCapacity;
+    wheel->pool = parcMemory_Allocate(wheel->poolCapacity * sizeof(_CCNxPingTimerEntry));
+    wheel->freeList = _noEntry;
+    _ccnxPingTimerWheel_AddToFreeList(wheel, 0, wheel->poolCapacity);
+
+    return wheel;
+}
+
+static uint32_t
+_ccnxPingTimerWheel_AllocateEntry(CCNxPingTimerWheel *wheel)
+{
+    if (wheel->freeList == _noEntry) {
+        uint32_t oldCapacity = wheel->poolCapacity;
+        uint32_t newCapacity = oldCapacity * 2;
+        _CCNxPingTimerEntry *pool = parcMemory_Allocate(newCapacity * sizeof(_CCNxPingTimerEntry));
+        memcpy(pool, wheel->pool, oldCapacity * sizeof(_CCNxPingTimerEntry));
+        parcMemory_Deallocate(&wheel->pool);
+        wheel->pool = pool;
+        wheel->poolCapacity = newCapacity;
+        _ccnxPingTimerWheel_AddToFreeList(wheel, oldCapacity, newCapacity);
+    }
+
+    uint32_t index = wheel->freeList;
+    wheel->freeList = wheel->pool[index].next;
+    return index;
+}
+
+static void
+_ccnxPingTimerWheel_LinkEntry(CCNxPingTimerWheel *wheel, size_t slot, uint32_t index)
+{
+    wheel->pool[index].next = wheel->slots[slot];
+    wheel->slots[slot] = index;
+    wheel->occupied[slot / 64] |= UINT64_C(1) << (slot % 64);
+}
+
+void
+ccnxPingTimerWheel_Schedule(CCNxPingTimerWheel *wheel, uint64_t deadlineInUs, void *item, uint64_t data)
+{
+    uint32_t index = _ccnxPingTimerWheel_AllocateEntry(wheel);
+    wheel->pool[index].deadlineInUs = deadlineInUs;
+    wheel->pool[index].item = item;
+    wheel->pool[index].data = data;
+
+    uint64_t tick = deadlineInUs / wheel->tickInUs;
+    tick = tick < wheel->currentTick ? wheel->currentTick : tick;
+    _ccnxPingTimerWheel_LinkEntry(wheel, tick % wheel->slotCount, index);
+
+    wheel->size++;
+}
+
+/**
+ * Fire every entry of a slot whose deadline is at or before `nowInUs` (or every entry if `all`).
+ */
+static size_t
+_ccnxPingTimerWheel_ProcessSlot(CCNxPingTimerWheel *wheel, size_t slot, uint64_t nowInUs, bool all,
+                                CCNxPingTimerWheelCallback *callback, void *context)
+{
+    size_t fired = 0;
+
+    uint32_t index = wheel->slots[slot];
+    wheel->slots[slot] = _noEntry;
+    wheel->occupied[slot / 64] &= ~(UINT64_C(1) << (slot % 64));
+
+    while (index != _noEntry) {
+        _CCNxPingTimerEntry *entry = &wheel->pool[index];
+        uint32_t next = entry->next;
+
+        if (all || entry->deadlineInUs <= nowInUs) {
+            void *item = entry->item;
+            uint64_t data = entry->data;
+
+            // Free the entry before the callback, which may schedule (and grow the pool).
+            entry->next = wheel->freeList;
+            wheel->freeList = index;
+            wheel->size--;
+            fired++;
+
+            callback(context, item, data);
+        } else {
+            _ccnxPingTimerWheel_LinkEntry(wheel, slot, index);
+        }
+
+        index = next;
+    }
+
+    return fired;
+}
+
+size_t
+ccnxPingTimerWheel_Expire(CCNxPingTimerWheel *wheel, uint64_t nowInUs, CCNxPingTimerWheelCallback *callback, void *context)
+{
+    uint64_t nowTick = nowInUs / wheel->tickInUs;
+    if (nowTick < wheel->currentTick) {
+        return 0;
+    }
+
+    uint64_t ticks = nowTick - wheel->currentTick + 1;
+    ticks = ticks > wheel->slotCount ? wheel->slotCount : ticks;
+
+    size_t fired = 0;
+    for (uint64_t i = 0; i < ticks && wheel->size > 0; i++) {
+        size_t slot = (nowTick - i) % wheel->slotCount;
+        if (wheel->occupied[slot / 64] & (UINT64_C(1) << (slot % 64))) {
+            fired += _ccnxPingTimerWheel_ProcessSlot(wheel, slot, nowInUs, false, callback, context);
+        }
+    }
+
+    // The slot of nowTick is visited again next time, since it may hold later deadlines in this tick.
+    wheel->currentTick = nowTick;
+    return fired;
+}
+
+size_t
+ccnxPingTimerWheel_Drain(CCNxPingTimerWheel *wheel, CCNxPingTimerWheelCallback *callback, void *context)
+{
+    size_t drained = 0;
+    for (size_t slot = 0; slot < wheel->slotCount && wheel->size > 0; slot++) {
+        if (wheel->slots[slot] != _noEntry) {
+            drained += _ccnxPingTimerWheel_ProcessSlot(wheel, slot, 0, true, callback, context);
+        }
+    }
+    return drained;
+}
+
+uint64_t
+ccnxPingTimerWheel_NextDeadline(const CCNxPingTimerWheel *wheel)
+{
+    if (wheel->size == 0) {
+        return UINT64_MAX;
+    }
+
+    uint64_t earliest = UINT64_MAX;
+    for (size_t offset = 0; offset < wheel->slotCount; offset++) {
+        uint64_t tick = wheel->currentTick + offset;
+        size_t slot = tick % wheel->slotCount;
+
+        // Skip whole empty words of the occupancy bitmap.
+        uint64_t word = wheel->occupied[slot / 64] >> (slot % 64);
+        if (word == 0) {
+            offset += 63 - (slot % 64);
+            continue;
+        }
+        if ((word & 1) == 0) {
+            continue;
+        }
+
+        // Deadlines that belong to this revolution of the wheel end the search.
+        uint64_t revolutionEnd = (tick + 1) * wheel->tickInUs;
+        uint64_t inRevolution = UINT64_MAX;
+        for (uint32_t index = wheel->slots[slot]; index != _noEntry; index = wheel->pool[index].next) {
+            uint64_t deadline = wheel->pool[index].deadlineInUs;
+            earliest = deadline < earliest ? deadline : earliest;
+            if (deadline < revolutionEnd && deadline < inRevolution) {
+                inRevolution = deadline;
+            }
+        }
+        if (inRevolution != UINT64_MAX) {
+            return inRevolution;
+        }
+    }
+
+    return earliest;
+}
+
+size_t
+ccnxPingTimerWheel_Size(const CCNxPingTimerWheel *wheel)
+{
+    return wheel->size;
+}
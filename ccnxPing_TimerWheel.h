@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_TimerWheel_h
+#define ccnxPing_TimerWheel_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A hashed timing wheel for scheduling large numbers of short timers from a single-threaded loop.
+ *
+ * Timers are hashed into `slotCount` slots of `tickInUs` microseconds each. Scheduling and
+ * cancelling-by-expiry are O(1); timers further away than one revolution simply stay in their
+ * slot until their deadline passes. Timer entries are kept in an internal pool, so scheduling
+ * does not allocate once the pool has grown to the working-set size.
+ */
+struct ccnx_ping_timer_wheel;
+typedef struct ccnx_ping_timer_wheel CCNxPingTimerWheel;
+
+/**
+ * The callback invoked by `ccnxPingTimerWheel_Expire` for each timer whose deadline has passed.
+ *
+ * @param [in] context The context given to `ccnxPingTimerWheel_Expire`.
+ * @param [in] item The item given to `ccnxPingTimerWheel_Schedule`.
+ * @param [in] data The data given to `ccnxPingTimerWheel_Schedule`.
+ */
+typedef void (CCNxPingTimerWheelCallback)(void *context, void *item, uint64_t data);
+
+/**
+ * Create an empty `CCNxPingTimerWheel`.
+ *
+ * @param [in] tickInUs The resolution of the wheel (in microseconds).
+ * @param [in] slotCount The number of slots. It is rounded up to a multiple of 64.
+ * @param [in] nowInUs The current time (in microseconds) of the clock used for all deadlines.
+ *
+ * @return A new `CCNxPingTimerWheel` that must be released with `ccnxPingTimerWheel_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingTimerWheel *wheel = ccnxPingTimerWheel_Create(100, 4096, ccnxPingCommon_MonotonicTimeInUs());
+ *     ccnxPingTimerWheel_Schedule(wheel, deadline, message, 0);
+ *     ...
+ *     ccnxPingTimerWheel_Expire(wheel, ccnxPingCommon_MonotonicTimeInUs(), _sendMessage, server);
+ *     ccnxPingTimerWheel_Release(&wheel);
+ * }
+ * @endcode
+ */
+CCNxPingTimerWheel *ccnxPingTimerWheel_Create(uint64_t tickInUs, size_t slotCount, uint64_t nowInUs);
+
+/**
+ * Increase the number of references to a `CCNxPingTimerWheel`.
+ *
+ * @param [in] wheel A pointer to a `CCNxPingTimerWheel` instance.
+ *
+ * @return The input `CCNxPingTimerWheel` pointer.
+ */
+CCNxPingTimerWheel *ccnxPingTimerWheel_Acquire(const CCNxPingTimerWheel *wheel);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * Pending timers are discarded without invoking any callback; the owner is responsible for
+ * the items they reference (see `ccnxPingTimerWheel_Drain`).
+ *
+ * @param [in,out] wheelPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingTimerWheel_Release(CCNxPingTimerWheel **wheelPtr);
+
+/**
+ * Schedule a timer.
+ *
+ * @param [in] wheel The `CCNxPingTimerWheel` instance.
+ * @param [in] deadlineInUs The time (in microseconds) at or after which the timer expires.
+ * @param [in] item An opaque item passed back to the expiry callback.
+ * @param [in] data An opaque value passed back to the expiry callback.
+ */
+void ccnxPingTimerWheel_Schedule(CCNxPingTimerWheel *wheel, uint64_t deadlineInUs, void *item, uint64_t data);
+
+/**
+ * Invoke `callback` for every timer whose deadline is at or before `nowInUs`, and remove them.
+ *
+ * The callback may schedule new timers.
+ *
+ * @param [in] wheel The `CCNxPingTimerWheel` instance.
+ * @param [in] nowInUs The current time (in microseconds).
+ * @param [in] callback The function to invoke for each expired timer.
+ * @param [in] context The context passed to `callback`.
+ *
+ * @return The number of timers that expired.
+ */
+size_t ccnxPingTimerWheel_Expire(CCNxPingTimerWheel *wheel, uint64_t nowInUs, CCNxPingTimerWheelCallback *callback, void *context);
+
+/**
+ * Invoke `callback` for every pending timer regardless of its deadline, and remove them.
+ *
+ * @param [in] wheel The `CCNxPingTimerWheel` instance.
+ * @param [in] callback The function to invoke for each timer.
+ * @param [in] context The context passed to `callback`.
+ *
+ * @return The number of timers that were drained.
+ */
+size_t ccnxPingTimerWheel_Drain(CCNxPingTimerWheel *wheel, CCNxPingTimerWheelCallback *callback, void *context);
+
+/**
+ * Return a time at which `ccnxPingTimerWheel_Expire` should next be called.
+ *
+ * The result is never later than the earliest pending deadline (rounded up to the tick), but it
+ * may be earlier for timers that are more than one revolution away.
+ *
+ * @param [in] wheel The `CCNxPingTimerWheel` instance.
+ *
+ * @return The next wakeup time (in microseconds), or UINT64_MAX if no timer is pending.
+ */
+uint64_t ccnxPingTimerWheel_NextDeadline(const CCNxPingTimerWheel *wheel);
+
+/**
+ * @return The number of pending timers.
+ */
+size_t ccnxPingTimerWheel_Size(const CCNxPingTimerWheel *wheel);
+#endif // ccnxPing_TimerWheel_h
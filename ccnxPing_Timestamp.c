@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <string.h>
+
+#include <parc/algol/parc_DisplayIndented.h>
+
+#include "ccnxPing_Timestamp.h"
+
+static const uint8_t _ccnxPingTimestamp_Magic[8] = { 'C', 'C', 'N', 'x', 'T', 'S', '0', '1' };
+
+#define _ccnxPingTimestamp_ReceiveOffset    8
+#define _ccnxPingTimestamp_ProcessingOffset 16
+#define _ccnxPingTimestamp_SendOffset       24
+
+static inline void
+_ccnxPingTimestamp_Encode(uint8_t *field, uint64_t value)
+{
+    for (int i = 7; i >= 0; i--) {
+        field[i] = (uint8_t) value;
+        value >>= 8;
+    }
+}
+
+static inline uint64_t
+_ccnxPingTimestamp_Decode(const uint8_t *field)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value = (value << 8) | field[i];
+    }
+    return value;
+}
+
+/**
+ * Return the timestamp header at the position of `payload`, or NULL if it does not start with one.
+ */
+static uint8_t *
+_ccnxPingTimestamp_Header(const PARCBuffer *payload)
+{
+    if (payload == NULL || parcBuffer_Remaining(payload) < ccnxPingTimestamp_HeaderLength) {
+        return NULL;
+    }
+    uint8_t *header = parcBuffer_Overlay((PARCBuffer *) payload, 0);
+    if (memcmp(header, _ccnxPingTimestamp_Magic, sizeof(_ccnxPingTimestamp_Magic)) != 0) {
+        return NULL;
+    }
+    return header;
+}
+
+bool
+ccnxPingTimestamp_Reserve(PARCBuffer *payload)
+{
+    if (parcBuffer_Remaining(payload) < ccnxPingTimestamp_HeaderLength) {
+        return false;
+    }
+    uint8_t *header = parcBuffer_Overlay(payload, ccnxPingTimestamp_HeaderLength);
+    memset(header, 0, ccnxPingTimestamp_HeaderLength);
+    memcpy(header, _ccnxPingTimestamp_Magic, sizeof(_ccnxPingTimestamp_Magic));
+    return true;
+}
+
+bool
+ccnxPingTimestamp_SetReceived(PARCBuffer *payload, uint64_t receiveTimeInUs, uint64_t processingTimeInUs)
+{
+    uint8_t *header = _ccnxPingTimestamp_Header(payload);
+    if (header == NULL) {
+        return false;
+    }
+    _ccnxPingTimestamp_Encode(header + _ccnxPingTimestamp_ReceiveOffset, receiveTimeInUs);
+    _ccnxPingTimestamp_Encode(header + _ccnxPingTimestamp_ProcessingOffset, processingTimeInUs);
+    return true;
+}
+
+bool
+ccnxPingTimestamp_SetSent(PARCBuffer *payload, uint64_t sendTimeInUs)
+{
+    uint8_t *header = _ccnxPingTimestamp_Header(payload);
+    if (header == NULL) {
+        return false;
+    }
+    _ccnxPingTimestamp_Encode(header + _ccnxPingTimestamp_SendOffset, sendTimeInUs);
+    return true;
+}
+
+bool
+ccnxPingTimestamp_Read(const PARCBuffer *payload, CCNxPingTimestamp *timestamp)
+{
+    const uint8_t *header = _ccnxPingTimestamp_Header(payload);
+    if (header == NULL) {
+        return false;
+    }
+    timestamp->receiveTimeInUs = _ccnxPingTimestamp_Decode(header + _ccnxPingTimestamp_ReceiveOffset);
+    timestamp->processingTimeInUs = _ccnxPingTimestamp_Decode(header + _ccnxPingTimestamp_ProcessingOffset);
+    timestamp->sendTimeInUs = _ccnxPingTimestamp_Decode(header + _ccnxPingTimestamp_SendOffset);
+    return true;
+}
+
+void
+ccnxPingTimestampLegs_Init(CCNxPingTimestampLegs *legs)
+{
+    memset(legs, 0, sizeof(*legs));
+    ccnxPingHistogram_Init(&legs->requestLeg);
+    ccnxPingHistogram_Init(&legs->processing);
+    ccnxPingHistogram_Init(&legs->hold);
+    ccnxPingHistogram_Init(&legs->responseLeg);
+}
+
+/**
+ * The network delay of an exchange: its round-trip time less the time it spent at the server.
+ */
+static uint64_t
+_ccnxPingTimestampLegs_Delay(const CCNxPingTimestampSample *sample)
+{
+    uint64_t roundTrip = sample->receiveTimeInUs - sample->sendTimeInUs;
+    uint64_t atServer = sample->server.sendTimeInUs - sample->server.receiveTimeInUs;
+    return roundTrip > atServer ? roundTrip - atServer : 0;
+}
+
+/**
+ * The offset of the server clock from the client clock that makes both legs of an exchange equal.
+ * The differences are taken modulo 2^64 and then as signed, so clocks with unrelated epochs work.
+ */
+static int64_t
+_ccnxPingTimestampLegs_Offset(const CCNxPingTimestampSample *sample)
+{
+    int64_t toServer = (int64_t) (sample->server.receiveTimeInUs - sample->sendTimeInUs);
+    int64_t fromServer = (int64_t) (sample->server.sendTimeInUs - sample->receiveTimeInUs);
+    return toServer / 2 + fromServer / 2;
+}
+
+static uint64_t
+_ccnxPingTimestampLegs_Clamp(CCNxPingTimestampLegs *legs, int64_t leg)
+{
+    if (leg < 0) {
+        legs->clamped++;
+        return 0;
+    }
+    return (uint64_t) leg;
+}
+
+static void
+_ccnxPingTimestampLegs_Account(CCNxPingTimestampLegs *legs, const CCNxPingTimestampSample *sample)
+{
+    int64_t requestLeg = (int64_t) (sample->server.receiveTimeInUs - sample->sendTimeInUs) - legs->offsetInUs;
+    int64_t responseLeg = (int64_t) (sample->receiveTimeInUs - sample->server.sendTimeInUs) + legs->offsetInUs;
+    uint64_t atServer = sample->server.sendTimeInUs - sample->server.receiveTimeInUs;
+    uint64_t processing = sample->server.processingTimeInUs;
+
+    ccnxPingHistogram_Record(&legs->requestLeg, _ccnxPingTimestampLegs_Clamp(legs, requestLeg));
+    ccnxPingHistogram_Record(&legs->processing, processing);
+    ccnxPingHistogram_Record(&legs->hold, atServer > processing ? atServer - processing : 0);
+    ccnxPingHistogram_Record(&legs->responseLeg, _ccnxPingTimestampLegs_Clamp(legs, responseLeg));
+}
+
+void
+ccnxPingTimestampLegs_Record(CCNxPingTimestampLegs *legs, uint64_t sendTimeInUs, uint64_t receiveTimeInUs,
+                             const CCNxPingTimestamp *timestamp)
+{
+    if (timestamp->sendTimeInUs < timestamp->receiveTimeInUs || receiveTimeInUs < sendTimeInUs) {
+        // Not sent, or a client clock step: there are no legs to split.
+        return;
+    }
+
+    CCNxPingTimestampSample sample = {
+        .sendTimeInUs    = sendTimeInUs,
+        .receiveTimeInUs = receiveTimeInUs,
+        .server          = *timestamp
+    };
+    legs->stamped++;
+
+    if (legs->calibrated) {
+        _ccnxPingTimestampLegs_Account(legs, &sample);
+        return;
+    }
+    legs->calibration[legs->pending++] = sample;
+    if (legs->pending == ccnxPingTimestampLegs_CalibrationSamples) {
+        ccnxPingTimestampLegs_Calibrate(legs);
+    }
+}
+
+void
+ccnxPingTimestampLegs_Calibrate(CCNxPingTimestampLegs *legs)
+{
+    if (legs->calibrated || legs->pending == 0) {
+        return;
+    }
+
+    const CCNxPingTimestampSample *best = &legs->calibration[0];
+    for (size_t i = 1; i < legs->pending; i++) {
+        if (_ccnxPingTimestampLegs_Delay(&legs->calibration[i]) < _ccnxPingTimestampLegs_Delay(best)) {
+            best = &legs->calibration[i];
+        }
+    }
+    legs->offsetInUs = _ccnxPingTimestampLegs_Offset(best);
+    legs->offsetDelayInUs = _ccnxPingTimestampLegs_Delay(best);
+    legs->calibrated = true;
+
+    for (size_t i = 0; i < legs->pending; i++) {
+        _ccnxPingTimestampLegs_Account(legs, &legs->calibration[i]);
+    }
+    legs->pending = 0;
+}
+
+void
+ccnxPingTimestampLegs_Display(const CCNxPingTimestampLegs *legs, int indentation)
+{
+    parcDisplayIndented_PrintLine(indentation,
+                                  "Stamped responses = %llu : Clock offset (server - client) = %lld +/- %llu us : Clamped legs = %llu",
+                                  (unsigned long long) legs->stamped,
+                                  (long long) legs->offsetInUs,
+                                  (unsigned long long) (legs->offsetDelayInUs / 2),
+                                  (unsigned long long) legs->clamped);
+    ccnxPingHistogram_Display(&legs->requestLeg, indentation, "Request leg");
+    ccnxPingHistogram_Display(&legs->processing, indentation, "Server processing");
+    ccnxPingHistogram_Display(&legs->hold, indentation, "Server hold");
+    ccnxPingHistogram_Display(&legs->responseLeg, indentation, "Response leg");
+}
+
+void
+ccnxPingTimestampLegs_WriteJSONMembers(const CCNxPingTimestampLegs *legs, FILE *output)
+{
+    fprintf(output, "\"stamped\":%llu,\"clock_offset_us\":%lld,\"clock_offset_error_us\":%llu,\"clamped\":%llu,\"request_leg\":",
+            (unsigned long long) legs->stamped,
+            (long long) legs->offsetInUs,
+            (unsigned long long) (legs->offsetDelayInUs / 2),
+            (unsigned long long) legs->clamped);
+    ccnxPingHistogram_WriteJSON(&legs->requestLeg, output);
+    fprintf(output, ",\"processing\":");
+    ccnxPingHistogram_WriteJSON(&legs->processing, output);
+    fprintf(output, ",\"hold\":");
+    ccnxPingHistogram_WriteJSON(&legs->hold, output);
+    fprintf(output, ",\"response_leg\":");
+    ccnxPingHistogram_WriteJSON(&legs->responseLeg, output);
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Timestamp_h
+#define ccnxPing_Timestamp_h
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <parc/algol/parc_Buffer.h>
+
+#include "ccnxPing_Histogram.h"
+
+/**
+ * The length of the timestamp header a server writes at the start of a payload: an 8-byte magic
+ * followed by the receive time, the processing time and the send time, each a big-endian 64-bit
+ * count of microseconds on the server's clock. A payload shorter than this is never stamped.
+ */
+#define ccnxPingTimestamp_HeaderLength 32
+
+/**
+ * The number of stamped responses a `CCNxPingTimestampLegs` buffers before it fixes its estimate
+ * of the offset between the server clock and the client clock.
+ */
+#define ccnxPingTimestampLegs_CalibrationSamples 64
+
+/**
+ * The server's side of one exchange, as echoed in the timestamp header of a response.
+ */
+typedef struct ccnx_ping_timestamp {
+    uint64_t receiveTimeInUs;    // When the server received the interest
+    uint64_t processingTimeInUs; // From receipt until the response was ready to be dispatched
+    uint64_t sendTimeInUs;       // When the server handed the response to its portal
+} CCNxPingTimestamp;
+
+/**
+ * Reserve a timestamp header at the start of a payload under construction, with every time zero.
+ *
+ * The header is written at the position of `payload`, which is advanced past it so that the
+ * content may be put after it.
+ *
+ * @param [in] payload A buffer of at least `ccnxPingTimestamp_HeaderLength` bytes remaining.
+ *
+ * @return true The header was written.
+ * @return false Fewer than `ccnxPingTimestamp_HeaderLength` bytes remain; `payload` is unchanged.
+ *
+ * Example:
+ * @code
+ * {
+ *     PARCBuffer *payload = parcBuffer_Allocate(size);
+ *     ccnxPingTimestamp_Reserve(payload);
+ *     parcBuffer_PutArray(payload, size - ccnxPingTimestamp_HeaderLength, content);
+ *     parcBuffer_Flip(payload);
+ * }
+ * @endcode
+ */
+bool ccnxPingTimestamp_Reserve(PARCBuffer *payload);
+
+/**
+ * Record the receive and processing times in the timestamp header of a payload, in place.
+ *
+ * @param [in] payload A payload whose header was written by `ccnxPingTimestamp_Reserve`.
+ * @param [in] receiveTimeInUs When the interest was received.
+ * @param [in] processingTimeInUs How long the response took to prepare.
+ *
+ * @return true The header was updated.
+ * @return false `payload` does not start with a timestamp header; it is unchanged.
+ */
+bool ccnxPingTimestamp_SetReceived(PARCBuffer *payload, uint64_t receiveTimeInUs, uint64_t processingTimeInUs);
+
+/**
+ * Record the send time in the timestamp header of a payload, in place.
+ *
+ * @param [in] payload A payload whose header was written by `ccnxPingTimestamp_Reserve`.
+ * @param [in] sendTimeInUs When the response is handed to the portal.
+ *
+ * @return true The header was updated.
+ * @return false `payload` does not start with a timestamp header; it is unchanged.
+ */
+bool ccnxPingTimestamp_SetSent(PARCBuffer *payload, uint64_t sendTimeInUs);
+
+/**
+ * Read the timestamp header at the position of a payload, without copying the payload or moving
+ * its position.
+ *
+ * @param [in] payload The payload of a response, or NULL.
+ * @param [out] timestamp Set to the times in the header, when there is one.
+ *
+ * @return true `payload` starts with a timestamp header.
+ * @return false It does not; `timestamp` is unchanged.
+ *
+ * Example:
+ * @code
+ * {
+ *     CCNxPingTimestamp timestamp;
+ *     if (ccnxPingTimestamp_Read(ccnxContentObject_GetPayload(contentObject), &timestamp)) {
+ *         ccnxPingTimestampLegs_Record(legs, sendTimeInUs, receiveTimeInUs, &timestamp);
+ *     }
+ * }
+ * @endcode
+ */
+bool ccnxPingTimestamp_Read(const PARCBuffer *payload, CCNxPingTimestamp *timestamp);
+
+/**
+ * One stamped exchange: the client's send and receive times (t1 and t4) around the server's.
+ */
+typedef struct ccnx_ping_timestamp_sample {
+    uint64_t sendTimeInUs;
+    uint64_t receiveTimeInUs;
+    CCNxPingTimestamp server;
+} CCNxPingTimestampSample;
+
+/**
+ * Splits the round-trip times of stamped responses into their legs: the request leg (client to
+ * server), the server's processing time, the time the response was then held before it was sent
+ * (a modelled service time, a signing queue or timer lateness), and the response leg (server to
+ * client).
+ *
+ * The request and response legs compare a client time with a server time, so they need the
+ * offset between the two clocks. It is estimated as NTP does, from the four times of an exchange:
+ * offset = ((t2 - t1) + (t3 - t4)) / 2, which is exact when both legs take equally long and wrong
+ * by at most half the network delay (t4 - t1) - (t3 - t2) otherwise. The first
+ * `ccnxPingTimestampLegs_CalibrationSamples` exchanges are buffered, the offset is taken from the
+ * one with the smallest network delay, whose error bound is the tightest, and they are then
+ * replayed. When both sides run on one host and read the same monotonic clock the offset comes
+ * out close to zero, and the legs are as exact as the clock.
+ *
+ * A leg that comes out negative under the estimated offset is counted and recorded as zero.
+ */
+typedef struct ccnx_ping_timestamp_legs {
+    uint64_t stamped;
+    uint64_t clamped;
+
+    bool calibrated;
+    int64_t offsetInUs;
+    uint64_t offsetDelayInUs;
+    size_t pending;
+    CCNxPingTimestampSample calibration[ccnxPingTimestampLegs_CalibrationSamples];
+
+    CCNxPingHistogram requestLeg;
+    CCNxPingHistogram processing;
+    CCNxPingHistogram hold;
+    CCNxPingHistogram responseLeg;
+} CCNxPingTimestampLegs;
+
+/**
+ * Initialize an empty `CCNxPingTimestampLegs`.
+ *
+ * @param [in] legs The instance to initialize.
+ */
+void ccnxPingTimestampLegs_Init(CCNxPingTimestampLegs *legs);
+
+/**
+ * Record one stamped exchange.
+ *
+ * @param [in] legs An instance of `CCNxPingTimestampLegs`.
+ * @param [in] sendTimeInUs When the client sent the interest, on the client clock.
+ * @param [in] receiveTimeInUs When the client received the response, on the same clock.
+ * @param [in] timestamp The server's times, echoed in the response.
+ */
+void ccnxPingTimestampLegs_Record(CCNxPingTimestampLegs *legs, uint64_t sendTimeInUs, uint64_t receiveTimeInUs,
+                                  const CCNxPingTimestamp *timestamp);
+
+/**
+ * Fix the clock offset from the exchanges buffered so far, if it is not fixed yet, and account for them.
+ * Called before the legs are reported, for runs shorter than the calibration.
+ *
+ * @param [in] legs An instance of `CCNxPingTimestampLegs`.
+ */
+void ccnxPingTimestampLegs_Calibrate(CCNxPingTimestampLegs *legs);
+
+/**
+ * Print the clock offset and a summary line of each leg. `ccnxPingTimestampLegs_Calibrate` must have been called.
+ *
+ * @param [in] legs An instance of `CCNxPingTimestampLegs`.
+ * @param [in] indentation The indentation level.
+ */
+void ccnxPingTimestampLegs_Display(const CCNxPingTimestampLegs *legs, int indentation);
+
+/**
+ * Write the legs as members of a JSON object (no enclosing braces). `ccnxPingTimestampLegs_Calibrate` must have been called.
+ *
+ * @param [in] legs An instance of `CCNxPingTimestampLegs`.
+ * @param [in] output The stream to write to.
+ */
+void ccnxPingTimestampLegs_WriteJSONMembers(const CCNxPingTimestampLegs *legs, FILE *output);
+#endif // ccnxPing_Timestamp_h
@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_DisplayIndented.h>
+
+#include "ccnxPing_Common.h"
+#include "ccnxPing_Histogram.h"
+#include "ccnxPing_TimerWheel.h"
+#include "ccnxPing_VirtualUsers.h"
+
+#define _defaultUserCount 1000
+#define _defaultThinkTimeInUs 1000000
+#define _defaultDurationInUs 10000000ULL
+
+/**
+ * The resolution and the size of the wheel that schedules the users: one revolution is about 4 s.
+ */
+#define _userTickInUs 250
+#define _userSlots 16384
+
+/**
+ * The events of a user on the wheel. The data of a timer is `(sequence << 1) | event`.
+ */
+typedef enum {
+    _CCNxPingVirtualUserEvent_Send = 0,
+    _CCNxPingVirtualUserEvent_Timeout = 1
+} _CCNxPingVirtualUserEvent;
+
+typedef struct ccnx_ping_virtual_user {
+    int nonce;
+    CCNxPingDistribution thinkTime;
+    uint64_t randomState;
+    uint64_t round;
+
+    // The sequence number (plus one) of the interest in flight in each slot, or 0 if the slot is free,
+    // and the time it was sent.
+    uint64_t *inFlight;
+    uint64_t *sendTimes;
+    size_t outstanding;
+
+    uint64_t sent;
+    uint64_t received;
+    uint64_t timeouts;
+} _CCNxPingVirtualUser;
+
+struct ccnx_ping_virtual_users {
+    CCNxPingVirtualUsersOptions options;
+    CCNxName *prefix;
+    uint64_t receiveTimeoutInUs;
+
+    _CCNxPingVirtualUser *users;
+    uint64_t *inFlight;
+    uint64_t *sendTimes;
+    CCNxPingTimerWheel *wheel;
+    bool stopped;
+
+    size_t outstanding;
+    uint64_t sent;
+    uint64_t received;
+    uint64_t timeouts;
+    uint64_t lateResponses;
+    uint64_t sendFailures;
+
+    // Set for the duration of ccnxPingVirtualUsers_Expire.
+    CCNxPingVirtualUsersSendCallback *sendCallback;
+    void *sendContext;
+    uint64_t nowInUs;
+    size_t sentNow;
+};
+
+static bool
+_ccnxPingVirtualUsers_Destructor(CCNxPingVirtualUsers **usersPtr)
+{
+    CCNxPingVirtualUsers *users = *usersPtr;
+    ccnxPingTimerWheel_Release(&users->wheel);
+    parcMemory_Deallocate(&users->inFlight);
+    parcMemory_Deallocate(&users->sendTimes);
+    parcMemory_Deallocate(&users->users);
+    ccnxName_Release(&users->prefix);
+    return true;
+}
+
+parcObject_Override(CCNxPingVirtualUsers, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingVirtualUsers_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingVirtualUsers, CCNxPingVirtualUsers);
+parcObject_ImplementRelease(ccnxPingVirtualUsers, CCNxPingVirtualUsers);
+
+void
+ccnxPingVirtualUsersOptions_Init(CCNxPingVirtualUsersOptions *options, size_t payloadSize)
+{
+    options->userCount = _defaultUserCount;
+    ccnxPingDistribution_Parse(&options->thinkTime, "exp:1000000");
+    options->thinkTimeSpread = 0.0;
+    options->outstanding = 1;
+    ccnxPingDistribution_InitConstant(&options->payloadSize, payloadSize);
+    options->durationInUs = _defaultDurationInUs;
+    options->seed = 1;
+}
+
+bool
+ccnxPingVirtualUsersOptions_Parse(CCNxPingVirtualUsersOptions *options, const char *specification)
+{
+    CCNxPingVirtualUsersOptions result = *options;
+    char *fields = parcMemory_StringDuplicate(specification, strlen(specification));
+    char *cursor = fields;
+    bool valid = true;
+    double seconds = 0.0;
+
+    char *field = NULL;
+    while (valid && (field = strsep(&cursor, ",")) != NULL) {
+        if (*field == '\0') {
+            continue;
+        } else if (strncmp(field, "users=", 6) == 0) {
+            valid = sscanf(field + 6, "%zu", &result.userCount) == 1 && result.userCount > 0;
+        } else if (strncmp(field, "think=", 6) == 0) {
+            valid = ccnxPingDistribution_Parse(&result.thinkTime, field + 6);
+        } else if (strncmp(field, "spread=", 7) == 0) {
+            valid = sscanf(field + 7, "%lf", &result.thinkTimeSpread) == 1
+                    && result.thinkTimeSpread >= 0.0 && result.thinkTimeSpread <= 1.0;
+        } else if (strncmp(field, "outstanding=", 12) == 0) {
+            valid = sscanf(field + 12, "%zu", &result.outstanding) == 1 && result.outstanding > 0;
+        } else if (strncmp(field, "size=", 5) == 0) {
+            valid = ccnxPingDistribution_Parse(&result.payloadSize, field + 5);
+        } else if (strncmp(field, "duration=", 9) == 0) {
+            valid = sscanf(field + 9, "%lf", &seconds) == 1 && seconds > 0.0;
+            result.durationInUs = (uint64_t) (seconds * 1000000.0);
+        } else if (strncmp(field, "seed=", 5) == 0) {
+            valid = sscanf(field + 5, "%" SCNu64, &result.seed) == 1;
+        } else {
+            valid = false;
+        }
+    }
+    parcMemory_Deallocate(&fields);
+
+    if (valid) {
+        *options = result;
+    }
+    return valid;
+}
+
+static void
+_ccnxPingVirtualUsers_ScheduleSend(CCNxPingVirtualUsers *users, _CCNxPingVirtualUser *user, uint64_t deadlineInUs)
+{
+    if (!users->stopped) {
+        ccnxPingTimerWheel_Schedule(users->wheel, deadlineInUs, user, _CCNxPingVirtualUserEvent_Send);
+    }
+}
+
+static void
+_ccnxPingVirtualUsers_Think(CCNxPingVirtualUsers *users, _CCNxPingVirtualUser *user, uint64_t nowInUs)
+{
+    _ccnxPingVirtualUsers_ScheduleSend(users, user, nowInUs + ccnxPingDistribution_Sample(&user->thinkTime, &user->randomState));
+}
+
+/**
+ * Free the slot of `user` holding the interest `sequence`.
+ *
+ * @return true If the interest was still in flight.
+ */
+static bool
+_ccnxPingVirtualUsers_Complete(CCNxPingVirtualUsers *users, _CCNxPingVirtualUser *user, uint64_t sequence, uint64_t *sendTimeInUs)
+{
+    for (size_t slot = 0; slot < users->options.outstanding; slot++) {
+        if (user->inFlight[slot] == sequence + 1) {
+            user->inFlight[slot] = 0;
+            *sendTimeInUs = user->sendTimes[slot];
+            user->outstanding--;
+            users->outstanding--;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void
+_ccnxPingVirtualUsers_Send(CCNxPingVirtualUsers *users, _CCNxPingVirtualUser *user)
+{
+    size_t slot = 0;
+    while (slot < users->options.outstanding && user->inFlight[slot] != 0) {
+        slot++;
+    }
+    if (slot == users->options.outstanding) {
+        return;
+    }
+
+    size_t index = user - users->users;
+    uint64_t sequence = user->round * users->options.userCount + index;
+    user->round++;
+
+    uint64_t payloadSize = ccnxPingDistribution_Sample(&users->options.payloadSize, &user->randomState);
+    payloadSize = payloadSize > ccnxPing_MaxPayloadSize ? ccnxPing_MaxPayloadSize : payloadSize;
+    CCNxName *name = ccnxPingCommon_CreatePingName(users->prefix, user->nonce, (int) payloadSize, (int) sequence);
+
+    if (users->sendCallback(users->sendContext, name, users->nowInUs)) {
+        user->inFlight[slot] = sequence + 1;
+        user->sendTimes[slot] = users->nowInUs;
+        user->outstanding++;
+        user->sent++;
+        users->outstanding++;
+        users->sent++;
+        users->sentNow++;
+        ccnxPingTimerWheel_Schedule(users->wheel, users->nowInUs + users->receiveTimeoutInUs, user,
+                                    (sequence << 1) | _CCNxPingVirtualUserEvent_Timeout);
+    } else {
+        users->sendFailures++;
+        _ccnxPingVirtualUsers_Think(users, user, users->nowInUs);
+    }
+    ccnxName_Release(&name);
+}
+
+static void
+_ccnxPingVirtualUsers_OnTimer(void *context, void *item, uint64_t data)
+{
+    CCNxPingVirtualUsers *users = context;
+    _CCNxPingVirtualUser *user = item;
+    uint64_t sendTimeInUs;
+
+    if ((data & 1) == _CCNxPingVirtualUserEvent_Send) {
+        if (!users->stopped) {
+            _ccnxPingVirtualUsers_Send(users, user);
+        }
+    } else if (_ccnxPingVirtualUsers_Complete(users, user, data >> 1, &sendTimeInUs)) {
+        // The response did not arrive in time: the user gives up on it and moves on.
+        user->timeouts++;
+        users->timeouts++;
+        _ccnxPingVirtualUsers_Think(users, user, users->nowInUs);
+    }
+}
+
+CCNxPingVirtualUsers *
+ccnxPingVirtualUsers_Create(const CCNxPingVirtualUsersOptions *options, const CCNxName *prefix,
+                            int nonce, uint64_t receiveTimeoutInUs, uint64_t nowInUs)
+{
+    CCNxPingVirtualUsers *users = parcObject_CreateInstance(CCNxPingVirtualUsers);
+
+    users->options = *options;
+    users->prefix = ccnxName_Acquire(prefix);
+    users->receiveTimeoutInUs = receiveTimeoutInUs;
+    users->users = parcMemory_AllocateAndClear(options->userCount * sizeof(_CCNxPingVirtualUser));
+    users->inFlight = parcMemory_AllocateAndClear(options->userCount * options->outstanding * sizeof(uint64_t));
+    users->sendTimes = parcMemory_AllocateAndClear(options->userCount * options->outstanding * sizeof(uint64_t));
+    users->wheel = ccnxPingTimerWheel_Create(_userTickInUs, _userSlots, nowInUs);
+    users->stopped = false;
+    users->outstanding = 0;
+    users->sent = 0;
+    users->received = 0;
+    users->timeouts = 0;
+    users->lateResponses = 0;
+    users->sendFailures = 0;
+    users->sendCallback = NULL;
+    users->sendContext = NULL;
+    users->nowInUs = nowInUs;
+    users->sentNow = 0;
+
+    uint64_t randomState = options->seed * 0x9E3779B97F4A7C15ULL + 1;
+    for (size_t i = 0; i < options->userCount; i++) {
+        _CCNxPingVirtualUser *user = &users->users[i];
+        user->nonce = nonce + (int) i;
+        user->randomState = ccnxPingDistribution_Random(&randomState) | 1;
+        user->round = 0;
+        user->inFlight = &users->inFlight[i * options->outstanding];
+        user->sendTimes = &users->sendTimes[i * options->outstanding];
+        user->outstanding = 0;
+
+        // Each user thinks at its own pace: the distribution scaled by a factor of its own.
+        user->thinkTime = options->thinkTime;
+        double scale = 1.0 + options->thinkTimeSpread * (2.0 * ccnxPingDistribution_RandomUnit(&randomState) - 1.0);
+        user->thinkTime.first *= scale;
+        user->thinkTime.second *= scale;
+
+        // Spread the first interests of every slot over one think time, so the users do not start in lockstep.
+        for (size_t slot = 0; slot < options->outstanding; slot++) {
+            uint64_t offset = ccnxPingDistribution_Sample(&user->thinkTime, &user->randomState);
+            _ccnxPingVirtualUsers_ScheduleSend(users, user, nowInUs + (uint64_t) (offset * ccnxPingDistribution_RandomUnit(&user->randomState)));
+        }
+    }
+
+    return users;
+}
+
+size_t
+ccnxPingVirtualUsers_Expire(CCNxPingVirtualUsers *users, uint64_t nowInUs,
+                            CCNxPingVirtualUsersSendCallback *callback, void *context)
+{
+    users->sendCallback = callback;
+    users->sendContext = context;
+    users->nowInUs = nowInUs;
+    users->sentNow = 0;
+
+    ccnxPingTimerWheel_Expire(users->wheel, nowInUs, _ccnxPingVirtualUsers_OnTimer, users);
+
+    users->sendCallback = NULL;
+    users->sendContext = NULL;
+    return users->sentNow;
+}
+
+bool
+ccnxPingVirtualUsers_RecordResponse(CCNxPingVirtualUsers *users, const CCNxName *name, uint64_t nowInUs, uint64_t *rttInUs)
+{
+    uint64_t sequence;
+    if (!ccnxPingCommon_GetSequenceNumber(name, &sequence)) {
+        return false;
+    }
+
+    _CCNxPingVirtualUser *user = &users->users[sequence % users->options.userCount];
+    uint64_t sendTimeInUs;
+    if (!_ccnxPingVirtualUsers_Complete(users, user, sequence, &sendTimeInUs)) {
+        users->lateResponses++;
+        return false;
+    }
+    *rttInUs = nowInUs - sendTimeInUs;
+    user->received++;
+    users->received++;
+    _ccnxPingVirtualUsers_Think(users, user, nowInUs);
+    return true;
+}
+
+void
+ccnxPingVirtualUsers_Stop(CCNxPingVirtualUsers *users)
+{
+    users->stopped = true;
+}
+
+size_t
+ccnxPingVirtualUsers_GetOutstanding(const CCNxPingVirtualUsers *users)
+{
+    return users->outstanding;
+}
+
+uint64_t
+ccnxPingVirtualUsers_NextDeadline(const CCNxPingVirtualUsers *users)
+{
+    return ccnxPingTimerWheel_NextDeadline(users->wheel);
+}
+
+void
+ccnxPingVirtualUsers_Display(const CCNxPingVirtualUsers *users, int indentation)
+{
+    const CCNxPingVirtualUsersOptions *options = &users->options;
+
+    parcDisplayIndented_PrintLine(indentation, "Users = %zu : Mean think time = %.0f us (spread %.0f%%) : Outstanding per user = %zu",
+                                  options->userCount, ccnxPingDistribution_Mean(&options->thinkTime),
+                                  options->thinkTimeSpread * 100.0, options->outstanding);
+    parcDisplayIndented_PrintLine(indentation, "Sent = %" PRIu64 " : Answered = %" PRIu64 " : Timeouts = %" PRIu64
+                                  " : Late = %" PRIu64 " : Send failures = %" PRIu64,
+                                  users->sent, users->received, users->timeouts, users->lateResponses, users->sendFailures);
+
+    // Fold the users into one distribution, to show whether some of them were starved.
+    CCNxPingHistogram perUser;
+    ccnxPingHistogram_Init(&perUser);
+    size_t starved = 0;
+    for (size_t i = 0; i < options->userCount; i++) {
+        ccnxPingHistogram_Record(&perUser, users->users[i].received);
+        if (users->users[i].sent > 0 && users->users[i].received == 0) {
+            starved++;
+        }
+    }
+    ccnxPingHistogram_Display(&perUser, indentation, "Responses per user");
+    if (starved > 0) {
+        parcDisplayIndented_PrintLine(indentation, "%zu users received no response", starved);
+    }
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_VirtualUsers_h
+#define ccnxPing_VirtualUsers_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ccnx/common/ccnx_Name.h>
+
+#include "ccnxPing_Distribution.h"
+
+/**
+ * The population simulated by a `CCNxPingVirtualUsers` engine.
+ *
+ * Options are parsed from a comma-separated specification:
+ *
+ *   users=<n>                      the number of virtual users (1000 by default)
+ *   think=<distribution>           the think time of a user, in microseconds, between a response
+ *                                  (or a timeout) and its next interest (exp:1000000 by default)
+ *   spread=<fraction>              each user scales the think time by its own factor, drawn
+ *                                  uniformly in [1 - spread, 1 + spread] (0 by default)
+ *   outstanding=<n>                the number of interests a user may have outstanding (1 by default)
+ *   size=<distribution>            the payload size requested by each interest (the client's -s by default)
+ *   duration=<seconds>             how long the users send interests (10 by default)
+ *   seed=<n>                       the seed of the users' generators
+ *
+ * Distributions are those of `CCNxPingDistribution` (e.g., `uniform:50000:150000`).
+ */
+typedef struct ccnx_ping_virtual_users_options {
+    size_t userCount;
+    CCNxPingDistribution thinkTime;
+    double thinkTimeSpread;
+    size_t outstanding;
+    CCNxPingDistribution payloadSize;
+    uint64_t durationInUs;
+    uint64_t seed;
+} CCNxPingVirtualUsersOptions;
+
+/**
+ * Initialize virtual users options to their defaults.
+ *
+ * @param [out] options The `CCNxPingVirtualUsersOptions` to initialize.
+ * @param [in] payloadSize The payload size requested by every interest.
+ */
+void ccnxPingVirtualUsersOptions_Init(CCNxPingVirtualUsersOptions *options, size_t payloadSize);
+
+/**
+ * Parse a virtual users specification (see `CCNxPingVirtualUsersOptions`) on top of the current options.
+ *
+ * @param [in,out] options The `CCNxPingVirtualUsersOptions` to update.
+ * @param [in] specification The textual specification (e.g., "users=10000,think=exp:500000").
+ *
+ * @retval true If the specification was valid.
+ * @retval false Otherwise, in which case `options` is unchanged.
+ */
+bool ccnxPingVirtualUsersOptions_Parse(CCNxPingVirtualUsersOptions *options, const char *specification);
+
+/**
+ * A population of independent, closed-loop consumers driven from a single thread.
+ *
+ * Each user has its own nonce (its names live under `prefix/<nonce + user>`), its own think-time
+ * distribution and random generator, and `outstanding` slots. Each slot cycles on its own: send an
+ * interest, wait for its response or for the receive timeout, think, send again. The sends and the
+ * timeouts of every user are scheduled on one `CCNxPingTimerWheel`, so the cost of the engine
+ * depends on the rate of events, not on the number of users.
+ *
+ * The sequence number of an interest encodes its user (`sequence % userCount`), so a response is
+ * matched to its user in O(1) without hashing its name.
+ *
+ * The engine does not own the transport: the caller sends the interests it produces and hands it
+ * the responses it receives, and records them in its own (shared) statistics. Each user runs at its
+ * own pace, so the sequence numbers of the responses are no global order: the engine matches every
+ * response to the send time of its own user and returns its round-trip time, which the caller
+ * records with `ccnxPingStats_RecordMatchedResponse`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingVirtualUsers *users = ccnxPingVirtualUsers_Create(&options, prefix, nonce, timeoutInUs, now);
+ *     while (ccnxPingVirtualUsers_GetOutstanding(users) > 0 || !stopped) {
+ *         ccnxPingVirtualUsers_Expire(users, now, sendInterest, portal);
+ *         ... wait until ccnxPingVirtualUsers_NextDeadline(users) for a response ...
+ *         if (ccnxPingVirtualUsers_RecordResponse(users, responseName, now, &rtt)) {
+ *             ccnxPingStats_RecordMatchedResponse(stats, responseName, rtt, now, response);
+ *         }
+ *     }
+ *     ccnxPingVirtualUsers_Display(users, 0);
+ *     ccnxPingVirtualUsers_Release(&users);
+ * }
+ * @endcode
+ */
+struct ccnx_ping_virtual_users;
+typedef struct ccnx_ping_virtual_users CCNxPingVirtualUsers;
+
+/**
+ * The callback invoked by `ccnxPingVirtualUsers_Expire` for each interest a user sends.
+ *
+ * @param [in] context The context given to `ccnxPingVirtualUsers_Expire`.
+ * @param [in] name The name of the interest. The callback must acquire it to keep it.
+ * @param [in] nowInUs The time of the send.
+ *
+ * @retval true If the interest was sent.
+ * @retval false Otherwise, in which case the user thinks again before its next attempt.
+ */
+typedef bool (CCNxPingVirtualUsersSendCallback)(void *context, CCNxName *name, uint64_t nowInUs);
+
+/**
+ * Create the users and schedule their first interests, spread over one think time.
+ *
+ * @param [in] options The population to simulate.
+ * @param [in] prefix The prefix served by the server.
+ * @param [in] nonce The nonce of the client: user `i` uses `nonce + i`.
+ * @param [in] receiveTimeoutInUs How long a user waits for a response before giving up on it.
+ * @param [in] nowInUs The current time (in microseconds) of the clock used for all calls.
+ *
+ * @return A new `CCNxPingVirtualUsers` that must be released with `ccnxPingVirtualUsers_Release`.
+ */
+CCNxPingVirtualUsers *ccnxPingVirtualUsers_Create(const CCNxPingVirtualUsersOptions *options, const CCNxName *prefix,
+                                                  int nonce, uint64_t receiveTimeoutInUs, uint64_t nowInUs);
+
+/**
+ * Increase the number of references to a `CCNxPingVirtualUsers`.
+ *
+ * @param [in] users A pointer to a `CCNxPingVirtualUsers` instance.
+ *
+ * @return The input `CCNxPingVirtualUsers` pointer.
+ */
+CCNxPingVirtualUsers *ccnxPingVirtualUsers_Acquire(const CCNxPingVirtualUsers *users);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] usersPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingVirtualUsers_Release(CCNxPingVirtualUsers **usersPtr);
+
+/**
+ * Run the sends and the timeouts that are due: `callback` is invoked for each interest to send.
+ *
+ * @param [in] users The `CCNxPingVirtualUsers` instance.
+ * @param [in] nowInUs The current time (in microseconds).
+ * @param [in] callback The function that sends an interest.
+ * @param [in] context The context passed to `callback`.
+ *
+ * @return The number of interests sent.
+ */
+size_t ccnxPingVirtualUsers_Expire(CCNxPingVirtualUsers *users, uint64_t nowInUs,
+                                   CCNxPingVirtualUsersSendCallback *callback, void *context);
+
+/**
+ * Hand a response to the user that sent its interest, which then thinks before its next send.
+ *
+ * @param [in] users The `CCNxPingVirtualUsers` instance.
+ * @param [in] name The name of the response.
+ * @param [in] nowInUs The time the response was received.
+ * @param [out] rttInUs Set to the round-trip time of the response, from the time its user sent the interest.
+ *
+ * @retval true If the response answers an outstanding interest of a user.
+ * @retval false Otherwise (e.g., a duplicate, or it arrived after the receive timeout).
+ */
+bool ccnxPingVirtualUsers_RecordResponse(CCNxPingVirtualUsers *users, const CCNxName *name, uint64_t nowInUs, uint64_t *rttInUs);
+
+/**
+ * Stop sending: the users only wait for their outstanding interests from now on.
+ *
+ * @param [in] users The `CCNxPingVirtualUsers` instance.
+ */
+void ccnxPingVirtualUsers_Stop(CCNxPingVirtualUsers *users);
+
+/**
+ * @return The number of interests of all users that are awaiting a response or a timeout.
+ */
+size_t ccnxPingVirtualUsers_GetOutstanding(const CCNxPingVirtualUsers *users);
+
+/**
+ * Return the time at which `ccnxPingVirtualUsers_Expire` should next be called.
+ *
+ * @param [in] users The `CCNxPingVirtualUsers` instance.
+ *
+ * @return The next wakeup time (in microseconds), or UINT64_MAX if nothing is scheduled.
+ */
+uint64_t ccnxPingVirtualUsers_NextDeadline(const CCNxPingVirtualUsers *users);
+
+/**
+ * Display the population, the engine's totals and the distribution across users of the responses
+ * each of them received.
+ *
+ * @param [in] users The `CCNxPingVirtualUsers` instance.
+ * @param [in] indentation The level of indentation.
+ */
+void ccnxPingVirtualUsers_Display(const CCNxPingVirtualUsers *users, int indentation);
+#endif // ccnxPing_VirtualUsers_h
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <parc/algol/parc_Memory.h>
+#include <parc/algol/parc_Object.h>
+#include <parc/algol/parc_DisplayIndented.h>
+
+#include "ccnxPing_Common.h"
+#include "ccnxPing_Workload.h"
+
+#define _defaultComponentLength 8
+#define _defaultPoolSize 4096
+#define _maxComponentCount 64
+#define _maxComponentLength 255
+
+static const char _componentAlphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+
+struct ccnx_ping_workload {
+    CCNxPingWorkloadOptions options;
+    CCNxName **pool;
+    size_t next;
+
+    size_t totalComponents;
+    size_t totalNameBytes;
+    size_t totalPayloadBytes;
+};
+
+static bool
+_ccnxPingWorkload_Destructor(CCNxPingWorkload **workloadPtr)
+{
+    CCNxPingWorkload *workload = *workloadPtr;
+    for (size_t i = 0; i < workload->options.poolSize; i++) {
+        if (workload->pool[i] != NULL) {
+            ccnxName_Release(&workload->pool[i]);
+        }
+    }
+    parcMemory_Deallocate(&workload->pool);
+    return true;
+}
+
+parcObject_Override(CCNxPingWorkload, PARCObject,
+                    .destructor = (PARCObjectDestructor *) _ccnxPingWorkload_Destructor);
+
+parcObject_ImplementAcquire(ccnxPingWorkload, CCNxPingWorkload);
+parcObject_ImplementRelease(ccnxPingWorkload, CCNxPingWorkload);
+
+void
+ccnxPingWorkloadOptions_Init(CCNxPingWorkloadOptions *options, size_t payloadSize)
+{
+    ccnxPingDistribution_InitConstant(&options->componentCount, 0);
+    ccnxPingDistribution_InitConstant(&options->componentLength, _defaultComponentLength);
+    options->prefixCount = 1;
+    ccnxPingDistribution_InitConstant(&options->payloadSize, payloadSize);
+    options->poolSize = _defaultPoolSize;
+    options->seed = 1;
+}
+
+bool
+ccnxPingWorkloadOptions_Parse(CCNxPingWorkloadOptions *options, const char *specification)
+{
+    CCNxPingWorkloadOptions result = *options;
+    char *fields = parcMemory_StringDuplicate(specification, strlen(specification));
+    char *cursor = fields;
+    bool valid = true;
+
+    char *field = NULL;
+    while (valid && (field = strsep(&cursor, ",")) != NULL) {
+        if (*field == '\0') {
+            continue;
+        } else if (strncmp(field, "components=", 11) == 0) {
+            valid = ccnxPingDistribution_Parse(&result.componentCount, field + 11);
+        } else if (strncmp(field, "length=", 7) == 0) {
+            valid = ccnxPingDistribution_Parse(&result.componentLength, field + 7);
+        } else if (strncmp(field, "prefixes=", 9) == 0) {
+            valid = sscanf(field + 9, "%zu", &result.prefixCount) == 1 && result.prefixCount > 0;
+        } else if (strncmp(field, "size=", 5) == 0) {
+            valid = ccnxPingDistribution_Parse(&result.payloadSize, field + 5);
+        } else if (strncmp(field, "pool=", 5) == 0) {
+            valid = sscanf(field + 5, "%zu", &result.poolSize) == 1 && result.poolSize > 0;
+        } else if (strncmp(field, "seed=", 5) == 0) {
+            valid = sscanf(field + 5, "%" SCNu64, &result.seed) == 1;
+        } else {
+            valid = false;
+        }
+    }
+    parcMemory_Deallocate(&fields);
+
+    if (valid) {
+        *options = result;
+    }
+    return valid;
+}
+
+static uint64_t
+_ccnxPingWorkload_SampleClamped(const CCNxPingDistribution *distribution, uint64_t *randomState, uint64_t low, uint64_t high)
+{
+    uint64_t value = ccnxPingDistribution_Sample(distribution, randomState);
+    return value < low ? low : (value > high ? high : value);
+}
+
+/**
+ * Generate one name of the pool.
+ */
+static CCNxName *
+_ccnxPingWorkload_Generate(CCNxPingWorkload *workload, const CCNxName *prefix, int nonce, uint64_t *randomState)
+{
+    const CCNxPingWorkloadOptions *options = &workload->options;
+    char component[_maxComponentLength + 1];
+
+    size_t prefixIndex = ccnxPingDistribution_Random(randomState) % options->prefixCount;
+    snprintf(component, sizeof(component), "%x", (unsigned int) (nonce + prefixIndex));
+    CCNxName *name = ccnxName_ComposeNAME(prefix, component);
+    workload->totalNameBytes += strlen(component);
+
+    uint64_t payloadSize = _ccnxPingWorkload_SampleClamped(&options->payloadSize, randomState, 0, ccnxPing_MaxPayloadSize);
+    snprintf(component, sizeof(component), "%" PRIu64, payloadSize);
+    CCNxName *sized = ccnxName_ComposeNAME(name, component);
+    ccnxName_Release(&name);
+    name = sized;
+    workload->totalNameBytes += strlen(component);
+    workload->totalPayloadBytes += payloadSize;
+
+    uint64_t componentCount = _ccnxPingWorkload_SampleClamped(&options->componentCount, randomState, 0, _maxComponentCount);
+    for (uint64_t i = 0; i < componentCount; i++) {
+        uint64_t length = _ccnxPingWorkload_SampleClamped(&options->componentLength, randomState, 1, _maxComponentLength);
+        for (uint64_t j = 0; j < length; j++) {
+            component[j] = _componentAlphabet[ccnxPingDistribution_Random(randomState) % (sizeof(_componentAlphabet) - 1)];
+        }
+        component[length] = '\0';
+
+        CCNxName *longer = ccnxName_ComposeNAME(name, component);
+        ccnxName_Release(&name);
+        name = longer;
+        workload->totalNameBytes += length;
+    }
+    workload->totalComponents += componentCount;
+
+    return name;
+}
+
+CCNxPingWorkload *
+ccnxPingWorkload_Create(const CCNxName *prefix, int nonce, const CCNxPingWorkloadOptions *options)
+{
+    CCNxPingWorkload *workload = parcObject_CreateInstance(CCNxPingWorkload);
+
+    workload->options = *options;
+    workload->next = 0;
+    workload->totalComponents = 0;
+    workload->totalNameBytes = 0;
+    workload->totalPayloadBytes = 0;
+    workload->pool = parcMemory_AllocateAndClear(options->poolSize * sizeof(CCNxName *));
+
+    // xorshift64* never leaves a zero state.
+    uint64_t randomState = options->seed | 1;
+    for (size_t i = 0; i < options->poolSize; i++) {
+        workload->pool[i] = _ccnxPingWorkload_Generate(workload, prefix, nonce, &randomState);
+    }
+
+    return workload;
+}
+
+CCNxName *
+ccnxPingWorkload_CreateName(CCNxPingWorkload *workload, uint64_t counter)
+{
+    char component[24];
+    snprintf(component, sizeof(component), "%06" PRIu64, counter);
+
+    CCNxName *name = ccnxName_ComposeNAME(workload->pool[workload->next], component);
+    workload->next = (workload->next + 1) % workload->options.poolSize;
+    return name;
+}
+
+void
+ccnxPingWorkload_Display(const CCNxPingWorkload *workload, int indentation)
+{
+    double poolSize = (double) workload->options.poolSize;
+    parcDisplayIndented_PrintLine(indentation,
+                                  "Workload = %zu names over %zu prefixes : Components = %.1f : Suffix = %.1f bytes : Payload = %.1f bytes",
+                                  workload->options.poolSize, workload->options.prefixCount,
+                                  workload->totalComponents / poolSize, workload->totalNameBytes / poolSize,
+                                  workload->totalPayloadBytes / poolSize);
+}
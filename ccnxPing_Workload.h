@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * * Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL XEROX OR PARC BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * ################################################################################
+ * #
+ * # PATENT NOTICE
+ * #
+ * # This software is distributed under the BSD 2-clause License (see LICENSE
+ * # file).  This BSD License does not make any patent claims and as such, does
+ * # not act as a patent grant.  The purpose of this section is for each contributor
+ * # to define their intentions with respect to intellectual property.
+ * #
+ * # Each contributor to this source code is encouraged to state their patent
+ * # claims and licensing mechanisms for any contributions made. At the end of
+ * # this section contributors may each make their own statements.  Contributor's
+ * # claims and grants only apply to the pieces (source code, programs, text,
+ * # media, etc) that they have contributed directly to this software.
+ * #
+ * # There is no guarantee that this section is complete, up to date or accurate. It
+ * # is up to the contributors to maintain their portion of this section and up to
+ * # the user of the software to verify any claims herein.
+ * #
+ * # Do not remove this header notification.  The contents of this section must be
+ * # present in all distributions of the software.  You may only modify your own
+ * # intellectual property statements.  Please provide contact information.
+ *
+ * - Palo Alto Research Center, Inc
+ * This software distribution does not grant any rights to patents owned by Palo
+ * Alto Research Center, Inc (PARC). Rights to these patents are available via
+ * various mechanisms. As of January 2016 PARC has committed to FRAND licensing any
+ * intellectual property used by its contributions to this software. You may
+ * contact PARC at cipo@parc.com for more information or visit http://www.ccnx.org
+ */
+/**
+ * @copyright (c) 2016, Xerox Corporation (Xerox) and Palo Alto Research Center, Inc (PARC).  All rights reserved.
+ */
+#ifndef ccnxPing_Workload_h
+#define ccnxPing_Workload_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <ccnx/common/ccnx_Name.h>
+
+#include "ccnxPing_Distribution.h"
+
+/**
+ * The shape of the names generated by a `CCNxPingWorkload`.
+ *
+ * Options are parsed from a comma-separated specification:
+ *
+ *   components=<distribution>      the number of generated components per name (0 by default)
+ *   length=<distribution>          the length of each generated component in bytes (8 by default)
+ *   prefixes=<n>                   the number of distinct prefixes the names are spread over (1 by default)
+ *   size=<distribution>            the payload size requested by each name (the client's -s by default)
+ *   pool=<n>                       the number of names generated ahead of time (4096 by default)
+ *   seed=<n>                       the seed of the generator
+ *
+ * Distributions are those of `CCNxPingDistribution` (e.g., `uniform:2:12`).
+ */
+typedef struct ccnx_ping_workload_options {
+    CCNxPingDistribution componentCount;
+    CCNxPingDistribution componentLength;
+    size_t prefixCount;
+    CCNxPingDistribution payloadSize;
+    size_t poolSize;
+    uint64_t seed;
+} CCNxPingWorkloadOptions;
+
+/**
+ * Initialize workload options to the default shape: one prefix, no generated components.
+ *
+ * @param [out] options The `CCNxPingWorkloadOptions` to initialize.
+ * @param [in] payloadSize The payload size requested by every name.
+ */
+void ccnxPingWorkloadOptions_Init(CCNxPingWorkloadOptions *options, size_t payloadSize);
+
+/**
+ * Parse a workload specification (see `CCNxPingWorkloadOptions`) on top of the current options.
+ *
+ * @param [in,out] options The `CCNxPingWorkloadOptions` to update.
+ * @param [in] specification The textual specification.
+ *
+ * @retval true If the specification was valid.
+ * @retval false Otherwise, in which case `options` is unchanged.
+ */
+bool ccnxPingWorkloadOptions_Parse(CCNxPingWorkloadOptions *options, const char *specification);
+
+/**
+ * A pool of ping names of configurable shape, generated ahead of time.
+ *
+ * Every name in the pool has the form `prefix/<nonce + p>/<size>/<c1>/.../<ck>`, where `p`
+ * selects one of the distinct prefixes, `size` is the requested payload size (read by the
+ * server) and `c1..ck` are random components. `ccnxPingWorkload_CreateName` cycles through the
+ * pool and only appends the sequence number, so that the cost of generating names is paid
+ * before the measurement and every interest is still unique.
+ */
+struct ccnx_ping_workload;
+typedef struct ccnx_ping_workload CCNxPingWorkload;
+
+/**
+ * Create a `CCNxPingWorkload` and generate its pool of names.
+ *
+ * @param [in] prefix The prefix served by the server.
+ * @param [in] nonce The nonce of the client.
+ * @param [in] options The shape of the names.
+ *
+ * @return A new `CCNxPingWorkload` that must be released with `ccnxPingWorkload_Release`.
+ *
+ * Example
+ * @code
+ * {
+ *     CCNxPingWorkloadOptions options;
+ *     ccnxPingWorkloadOptions_Init(&options, 4096);
+ *     ccnxPingWorkloadOptions_Parse(&options, "components=uniform:2:12,length=exp:10,prefixes=1000");
+ *
+ *     CCNxPingWorkload *workload = ccnxPingWorkload_Create(prefix, nonce, &options);
+ *     CCNxName *name = ccnxPingWorkload_CreateName(workload, 101);
+ *     ...
+ *     ccnxName_Release(&name);
+ *     ccnxPingWorkload_Release(&workload);
+ * }
+ * @endcode
+ */
+CCNxPingWorkload *ccnxPingWorkload_Create(const CCNxName *prefix, int nonce, const CCNxPingWorkloadOptions *options);
+
+/**
+ * Increase the number of references to a `CCNxPingWorkload`.
+ *
+ * @param [in] workload A pointer to a `CCNxPingWorkload` instance.
+ *
+ * @return The input `CCNxPingWorkload` pointer.
+ */
+CCNxPingWorkload *ccnxPingWorkload_Acquire(const CCNxPingWorkload *workload);
+
+/**
+ * Release a previously acquired reference to the specified instance.
+ *
+ * @param [in,out] workloadPtr A pointer to a pointer to the instance to release.
+ */
+void ccnxPingWorkload_Release(CCNxPingWorkload **workloadPtr);
+
+/**
+ * Create the next name of the workload: the next name of the pool followed by `counter`, in
+ * the format of `ccnxPingCommon_CreatePingName`.
+ *
+ * @param [in] workload The `CCNxPingWorkload` instance.
+ * @param [in] counter The sequence number of the interest.
+ *
+ * @return A new `CCNxName` that must be released with `ccnxName_Release`.
+ */
+CCNxName *ccnxPingWorkload_CreateName(CCNxPingWorkload *workload, uint64_t counter);
+
+/**
+ * Display the shape of the generated pool: its size, the number of prefixes and the mean
+ * number of generated components, length of the suffix after the prefix and payload size.
+ *
+ * @param [in] workload The `CCNxPingWorkload` instance.
+ * @param [in] indentation The level of indentation.
+ */
+void ccnxPingWorkload_Display(const CCNxPingWorkload *workload, int indentation);
+#endif // ccnxPing_Workload_h